@@ -0,0 +1,125 @@
+#define _POSIX_C_SOURCE 200809L
+
+/*
+ * Example consumer of "crypto feed --shm NAME"
+ *
+ * Prints the current quote of every coin (or of the ids given), then
+ * follows the update ring and prints each change as it is published.
+ * Reads are plain loads from the mapping; the only syscall in the loop is
+ * the short sleep when there is nothing new.
+ *
+ *   crypto feed --shm /crypto-quotes --coins btc,eth,sol &
+ *   crypto-feed-reader /crypto-quotes bitcoin solana
+ *
+ * Build: make feed-reader (needs only quotefeed.c, not libcurl)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include "../include/quotefeed.h"
+
+#define IDLE_SLEEP_NS 1000000L   // 1 ms between polls when idle
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static void print_record(const quote_record_t *q) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    double age_ms = ((double)now.tv_sec * 1e9 + (double)now.tv_nsec - (double)q->published_ns) / 1e6;
+
+    printf("%-16s %-6s %14.6f %-4s %+7.2f%%  high %.6f  low %.6f  (published %.1f ms ago)\n",
+           q->id, q->symbol, q->current_price, q->currency, q->price_change_percentage_24h,
+           q->high_24h, q->low_24h, age_ms);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s NAME [ID...]\n", argv[0]);
+        return 1;
+    }
+
+    quote_feed_t feed;
+    if (quote_feed_open(argv[1], &feed) != 0) {
+        fprintf(stderr, "Cannot open feed %s (is 'crypto feed --shm %s' running?)\n", argv[1], argv[1]);
+        return 1;
+    }
+
+    // Slots to show: the ids given, or all of them
+    int slot_count = (int)feed.header->slot_count;
+    char *wanted = calloc((size_t)slot_count, 1);
+    if (!wanted) {
+        quote_feed_close(&feed);
+        return 1;
+    }
+    for (int i = 2; i < argc; i++) {
+        int slot = quote_feed_find(&feed, argv[i]);
+        if (slot < 0) {
+            fprintf(stderr, "Warning: %s is not in the feed\n", argv[i]);
+        } else {
+            wanted[slot] = 1;
+        }
+    }
+    if (argc == 2) {
+        memset(wanted, 1, (size_t)slot_count);
+    }
+
+    // Take the ring position first so no update between the two is missed
+    uint64_t cursor = quote_feed_head(&feed);
+    quote_record_t record;
+    for (int slot = 0; slot < slot_count; slot++) {
+        if (wanted[slot] && quote_feed_read(&feed, slot, &record) == 0) {
+            print_record(&record);
+        }
+    }
+    fflush(stdout);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    uint64_t lost = 0;
+    long stale_after_ms = feed.header->interval ? (long)feed.header->interval * QUOTE_FEED_STALE_INTERVALS * 1000L : 0;
+    int warned = 0;
+    while (!stop_requested) {
+        uint32_t slot;
+        int got = 0;
+        while (quote_feed_next(&feed, &cursor, &slot, &lost)) {
+            got = 1;
+            if (wanted[slot] && quote_feed_read(&feed, (int)slot, &record) == 0) {
+                print_record(&record);
+            }
+        }
+        if (got) {
+            fflush(stdout);
+            continue;
+        }
+
+        long age = quote_feed_heartbeat_age_ms(&feed);
+        if (stale_after_ms && age > stale_after_ms && !warned) {
+            fprintf(stderr, "Warning: no refresh for %ld ms; the writer may have stopped\n", age);
+            warned = 1;
+        } else if (age >= 0 && age <= stale_after_ms) {
+            warned = 0;
+        }
+
+        struct timespec idle = { 0, IDLE_SLEEP_NS };
+        nanosleep(&idle, NULL);
+    }
+
+    if (lost) {
+        fprintf(stderr, "%llu update(s) were overwritten before they were read\n", (unsigned long long)lost);
+    }
+    free(wanted);
+    quote_feed_close(&feed);
+    return 0;
+}
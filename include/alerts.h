@@ -0,0 +1,137 @@
+#ifndef ALERTS_H
+#define ALERTS_H
+
+/**
+ * @file alerts.h
+ * @brief Price alert rules with an indexed threshold evaluator
+ *
+ * Rules are read from a text file, one per line:
+ *
+ *     BTC > 70000
+ *     ETH 24h change < -5%
+ *     solana market cap >= 100000000000
+ *
+ * Each (coin, metric) pair keeps its thresholds sorted, so a tick only
+ * binary-searches the old->new value range instead of scanning every rule.
+ */
+
+#include "parser.h"
+
+/**
+ * @brief Value a rule compares against
+ */
+typedef enum {
+    ALERT_METRIC_PRICE = 0,
+    ALERT_METRIC_CHANGE_24H,   // 24h change in percent
+    ALERT_METRIC_MARKET_CAP,
+    ALERT_METRIC_VOLUME_24H,
+    ALERT_METRIC_COUNT
+} alert_metric_t;
+
+/**
+ * @brief Comparison operator of a rule
+ */
+typedef enum {
+    ALERT_OP_GT = 0,
+    ALERT_OP_GE,
+    ALERT_OP_LT,
+    ALERT_OP_LE
+} alert_op_t;
+
+/**
+ * @brief Single alert rule as read from the rules file
+ */
+typedef struct {
+    int coin;              // Index into alert_set_t.coins
+    alert_metric_t metric;
+    alert_op_t op;
+    double threshold;
+    int line;              // Line number in the rules file
+    char *text;            // Rule text (trimmed)
+} alert_rule_t;
+
+/**
+ * @brief Sorted thresholds for one direction of one (coin, metric) pair
+ */
+typedef struct {
+    double *thresholds;    // Ascending
+    int *rules;            // Rule index for each threshold
+    int count;
+} alert_index_t;
+
+/**
+ * @brief Per-coin evaluation state
+ */
+typedef struct {
+    char *id;                                  // CoinGecko ID
+    double last[ALERT_METRIC_COUNT];           // Values seen at the previous tick
+    int has_last;
+    alert_index_t rising[ALERT_METRIC_COUNT];  // ">" and ">=" rules
+    alert_index_t falling[ALERT_METRIC_COUNT]; // "<" and "<=" rules
+} alert_coin_t;
+
+/**
+ * @brief Loaded rule set with its index
+ */
+typedef struct {
+    alert_rule_t *rules;
+    int rule_count;
+    alert_coin_t *coins;
+    int coin_count;
+    int *coin_table;       // Open-addressing hash of coin ids -> coin index
+    int table_size;
+} alert_set_t;
+
+/**
+ * @brief Callback invoked for every rule that crossed during a tick
+ *
+ * @param rule The rule that fired
+ * @param coin Coin state (id)
+ * @param value Current value of the rule's metric
+ * @param ctx User context
+ */
+typedef void (*alert_fire_fn)(const alert_rule_t *rule, const alert_coin_t *coin, double value, void *ctx);
+
+/**
+ * @brief Load and index rules from a file
+ *
+ * Blank lines and lines starting with '#' are ignored. Malformed lines are
+ * reported on stderr and skipped.
+ *
+ * @param path Rules file path
+ * @param set Output rule set
+ * @return int 0 on success, -1 on error (file unreadable or no valid rules)
+ */
+int alerts_load(const char *path, alert_set_t *set);
+
+/**
+ * @brief Evaluate one tick of quotes against the rule set
+ *
+ * On the first tick for a coin every rule that already holds fires; after
+ * that only rules whose condition became true since the previous tick fire.
+ *
+ * @param set Rule set (per-coin last values are updated)
+ * @param quotes Quotes fetched for this tick
+ * @param fire Callback for each triggered rule
+ * @param ctx User context passed to the callback
+ * @return int Number of rules that fired
+ */
+int alerts_evaluate(alert_set_t *set, const markets_data_t *quotes, alert_fire_fn fire, void *ctx);
+
+/**
+ * @brief Free a rule set
+ *
+ * @param set Rule set to free
+ */
+void alerts_free(alert_set_t *set);
+
+/**
+ * @brief Entry point for "crypto alerts RULES [options]"
+ *
+ * @param argc Argument count (argv[0] is "alerts")
+ * @param argv Arguments
+ * @return int Process exit code
+ */
+int alerts_command(int argc, char *argv[]);
+
+#endif /* ALERTS_H */
@@ -1,68 +1,342 @@
-#ifndef API_H
-#define API_H
-
-/**
- * @file api.h
- * @brief HTTP API client for CoinGecko API
- */
-
-/**
- * @brief Fetch cryptocurrency data from CoinGecko API
- * 
- * @param symbol Cryptocurrency symbol (e.g., "bitcoin", "ethereum")
- * @param buffer Output buffer to store JSON response
- * @param buffer_size Size of the output buffer
- * @return int 0 on success, -1 on error
- */
-int fetch_crypto_data(const char *symbol, char *buffer, size_t buffer_size);
-
-/**
- * @brief Get CoinGecko API URL for a cryptocurrency symbol
- * 
- * @param symbol Cryptocurrency symbol (e.g., "bitcoin")
- * @return char* Allocated string with URL (must be freed by caller)
- */
-char *get_api_url(const char *symbol);
-
-/**
- * @brief Get CoinGecko API URL for a cryptocurrency symbol with custom currency
- * 
- * @param symbol Cryptocurrency symbol (e.g., "bitcoin")
- * @param currency Currency code (e.g., "eur", "gbp", "jpy"). If NULL, defaults to "usd"
- * @return char* Allocated string with URL (must be freed by caller)
- */
-char *get_api_url_with_currency(const char *symbol, const char *currency);
-
-/**
- * @brief Fetch cryptocurrency data from CoinGecko API with custom currency
- * 
- * @param symbol Cryptocurrency symbol (e.g., "bitcoin", "ethereum")
- * @param currency Currency code (e.g., "eur", "gbp", "jpy"). If NULL, defaults to "usd"
- * @param buffer Output buffer to store JSON response
- * @param buffer_size Size of the output buffer
- * @return int 0 on success, -1 on error
- */
-int fetch_crypto_data_with_currency(const char *symbol, const char *currency, char *buffer, size_t buffer_size);
-
-/**
- * @brief Fetch OHLC (Open, High, Low, Close) data from CoinGecko API
- * 
- * @param symbol Cryptocurrency symbol (e.g., "bitcoin", "ethereum")
- * @param buffer Output buffer to store JSON response
- * @param buffer_size Size of the output buffer
- * @return int 0 on success, -1 on error
- */
-int fetch_ohlc_data(const char *symbol, char *buffer, size_t buffer_size);
-
-/**
- * @brief Fetch markets data (top coins) from CoinGecko API
- * 
- * @param limit Number of coins to fetch (default: 10)
- * @param buffer Output buffer to store JSON response
- * @param buffer_size Size of the output buffer
- * @return int 0 on success, -1 on error
- */
-int fetch_markets_data(int limit, char *buffer, size_t buffer_size);
-
-#endif /* API_H */
-
+#ifndef API_H
+#define API_H
+
+/**
+ * @file api.h
+ * @brief HTTP API client for CoinGecko API
+ *
+ * All requests advertise compressed transfer (gzip/deflate/br/zstd, decoded
+ * by libcurl as data streams in) and negotiate HTTP/2 over TLS.
+ *
+ * If CRYPTO_CLI_REPLAY_DIR is set, responses are served from recorded files
+ * in that directory (price.json, ohlc.json, markets.json, market_chart.json) instead.
+ *
+ * CRYPTO_CLI_COINGECKO_URL replaces the CoinGecko base URL
+ * (https://api.coingecko.com/api/v3), e.g. to point at a local fixture server.
+ */
+
+#include <stddef.h>
+
+/** Default number of concurrent transfers for api_fetch_parallel() and api_async_new() */
+#define API_DEFAULT_MAX_IN_FLIGHT 4
+
+/** Default whole-request timeout */
+#define API_DEFAULT_TIMEOUT_MS 10000L
+
+/** Idle handles (and their open connections) a pool keeps for reuse */
+#define API_POOL_MAX_IDLE 8
+
+/**
+ * @brief One request of a parallel fetch
+ */
+typedef struct {
+    const char *url;   // Request URL (input)
+    char *data;        // NUL-terminated response body, caller frees (output)
+    size_t size;       // Body length in bytes (output)
+    long status;       // HTTP status code (output)
+    int result;        // 0 on success, -1 on error (output)
+} api_request_t;
+
+/**
+ * @brief Incremental fetcher: add requests as capacity frees up, collect
+ * them as they complete (see api_async_new())
+ */
+typedef struct api_async api_async_t;
+
+/**
+ * @brief Reusable connections, DNS cache and TLS sessions, safe to share
+ * between threads (see api_pool_new())
+ */
+typedef struct api_pool api_pool_t;
+
+/**
+ * @brief Release libcurl global state if a request ever initialised it
+ * 
+ * libcurl and the TLS library are initialised lazily by the first request,
+ * so commands that never hit the network do not pay for it. Safe to call
+ * more than once and from atexit().
+ */
+void api_cleanup(void);
+
+/**
+ * @brief Give a forked child a connection pool of its own
+ * 
+ * Call in the child right after fork(). The default pool's handles share
+ * their sockets and TLS state with the parent, so the child abandons them
+ * (cleaning them up would write to those sockets) and starts from an empty
+ * pool. Does nothing if no request has initialised libcurl yet.
+ */
+void api_after_fork(void);
+
+/**
+ * @brief Set an overall time budget for every request that follows
+ * 
+ * Each request's timeout is cut to the time left, requests started after
+ * the deadline fail at once, and transfers still running when it passes
+ * are cancelled (their api_request_t keeps result -1, completed ones keep
+ * their data). Call before starting threads that fetch.
+ * 
+ * @param budget_ms Milliseconds from now (<= 0 removes the deadline)
+ */
+void api_set_deadline(long budget_ms);
+
+/**
+ * @brief Milliseconds left before the deadline
+ * 
+ * @return long 0 once the deadline has passed, LONG_MAX if none is set
+ */
+long api_remaining_ms(void);
+
+/**
+ * @brief CLOCK_MONOTONIC in milliseconds, the clock the deadline runs on
+ */
+long long api_monotonic_ms(void);
+
+/**
+ * @brief CLOCK_MONOTONIC in nanoseconds, for timings finer than a millisecond
+ */
+long long api_monotonic_ns(void);
+
+/**
+ * @brief Whether CRYPTO_CLI_REPLAY_DIR serves responses from recorded files
+ */
+int api_replay_enabled(void);
+
+/**
+ * @brief Create a connection pool
+ * 
+ * Requests made through the same pool reuse idle connections and TLS
+ * sessions. The pool may be used from several threads at once.
+ * 
+ * @param timeout_ms Whole-request timeout (<= 0 uses API_DEFAULT_TIMEOUT_MS)
+ * @return api_pool_t* Pool, or NULL if libcurl could not be initialised
+ */
+api_pool_t *api_pool_new(long timeout_ms);
+
+/**
+ * @brief Close a pool's connections and free it
+ */
+void api_pool_free(api_pool_t *pool);
+
+/**
+ * @brief GET a URL into a newly allocated buffer
+ * 
+ * @param pool Pool to take a connection from (NULL = process-wide pool)
+ * @param url Request URL
+ * @param data Output: NUL-terminated response body (caller frees)
+ * @param size Output: body length in bytes (may be NULL)
+ * @return int 0 on success, -1 on transport error or non-200 status
+ */
+int api_fetch_url(api_pool_t *pool, const char *url, char **data, size_t *size);
+
+/**
+ * @brief Fetch cryptocurrency data from CoinGecko API
+ * 
+ * @param symbol Cryptocurrency symbol (e.g., "bitcoin", "ethereum")
+ * @param buffer Output buffer to store JSON response
+ * @param buffer_size Size of the output buffer
+ * @return int 0 on success, -1 on error
+ */
+int fetch_crypto_data(const char *symbol, char *buffer, size_t buffer_size);
+
+/**
+ * @brief Resolve a provider base URL
+ * 
+ * @param env_name Environment variable that overrides the base URL (may be NULL)
+ * @param fallback Base URL used when the variable is unset or empty
+ * @return const char* Base URL without a trailing slash (not to be freed)
+ */
+const char *api_base_url(const char *env_name, const char *fallback);
+
+/**
+ * @brief CoinGecko base URL (honours CRYPTO_CLI_COINGECKO_URL)
+ */
+const char *api_coingecko_base(void);
+
+/**
+ * @brief Get CoinGecko API URL for a cryptocurrency symbol
+ * 
+ * @param symbol Cryptocurrency symbol (e.g., "bitcoin")
+ * @return char* Allocated string with URL (must be freed by caller)
+ */
+char *get_api_url(const char *symbol);
+
+/**
+ * @brief Get CoinGecko API URL for a cryptocurrency symbol with custom currency
+ * 
+ * @param symbol Cryptocurrency symbol (e.g., "bitcoin")
+ * @param currency Currency code (e.g., "eur", "gbp", "jpy"). If NULL, defaults to "usd"
+ * @return char* Allocated string with URL (must be freed by caller)
+ */
+char *get_api_url_with_currency(const char *symbol, const char *currency);
+
+/**
+ * @brief Get a simple/price URL that asks only for the given fields
+ * 
+ * include_24hr_change, include_market_cap, include_24hr_vol and
+ * include_last_updated_at are sent only for the fields that need them.
+ * 
+ * @param ids Comma-separated CoinGecko IDs
+ * @param currency Currency code. If NULL, defaults to "usd"
+ * @param fields PLAN_* mask from planner.h (0 for every field)
+ * @return char* Allocated string with URL (must be freed by caller)
+ */
+char *get_simple_price_url(const char *ids, const char *currency, unsigned fields);
+
+/**
+ * @brief Fetch cryptocurrency data from CoinGecko API with custom currency
+ * 
+ * @param symbol Cryptocurrency symbol (e.g., "bitcoin", "ethereum")
+ * @param currency Currency code (e.g., "eur", "gbp", "jpy"). If NULL, defaults to "usd"
+ * @param buffer Output buffer to store JSON response
+ * @param buffer_size Size of the output buffer
+ * @return int 0 on success, -1 on error
+ */
+int fetch_crypto_data_with_currency(const char *symbol, const char *currency, char *buffer, size_t buffer_size);
+
+/**
+ * @brief Fetch simple/price data for several coins in one request
+ * 
+ * @param ids_csv Comma-separated CoinGecko IDs (e.g., "bitcoin,ethereum")
+ * @param currency Currency code (e.g., "eur"). If NULL, defaults to "usd"
+ * @param buffer Output buffer to store JSON response
+ * @param buffer_size Size of the output buffer
+ * @return int 0 on success, -1 on error
+ */
+int fetch_simple_price_batch(const char *ids_csv, const char *currency, char *buffer, size_t buffer_size);
+
+/**
+ * @brief Fetch OHLC (Open, High, Low, Close) data from CoinGecko API
+ * 
+ * @param symbol Cryptocurrency symbol (e.g., "bitcoin", "ethereum")
+ * @param buffer Output buffer to store JSON response
+ * @param buffer_size Size of the output buffer
+ * @return int 0 on success, -1 on error
+ */
+int fetch_ohlc_data(const char *symbol, char *buffer, size_t buffer_size);
+
+/**
+ * @brief Get the CoinGecko coin list URL (id, symbol and name of every coin)
+ * 
+ * @return char* Allocated string with URL (must be freed by caller)
+ */
+char *get_coin_list_url(void);
+
+/**
+ * @brief Get CoinGecko markets URL (top coins by market cap, USD)
+ * 
+ * @param limit Number of coins
+ * @return char* Allocated string with URL (must be freed by caller)
+ */
+char *get_markets_url(int limit);
+
+/**
+ * @brief Get one page of the CoinGecko markets listing (USD)
+ * 
+ * @param per_page Coins per page (the API caps this at 250)
+ * @param page Page number, starting at 1
+ * @return char* Allocated string with URL (must be freed by caller)
+ */
+char *get_markets_url_page(int per_page, int page);
+
+/**
+ * @brief Get CoinGecko markets URL for given coins in any currency
+ * 
+ * One response carries price, 24h change, market cap, volume, 24h high/low,
+ * name and last update of every coin listed.
+ * 
+ * @param ids Comma-separated CoinGecko IDs (e.g., "bitcoin,ethereum")
+ * @param currency Currency code (e.g., "eur"). If NULL, defaults to "usd"
+ * @return char* Allocated string with URL (must be freed by caller)
+ */
+char *get_markets_url_for_ids(const char *ids, const char *currency);
+
+/**
+ * @brief Get CoinGecko OHLC URL (candles for the last N days)
+ * 
+ * @param id CoinGecko ID (e.g., "bitcoin")
+ * @param currency Currency code (e.g., "eur"). If NULL, defaults to "usd"
+ * @param days "1", "7", "14", "30", "90", "180", "365" or "max"
+ * @return char* Allocated string with URL (must be freed by caller)
+ */
+char *get_ohlc_url(const char *id, const char *currency, const char *days);
+
+/**
+ * @brief Get CoinGecko market_chart URL (price, market cap and volume history)
+ * 
+ * @param id CoinGecko ID (e.g., "bitcoin")
+ * @param currency Currency code (e.g., "eur"). If NULL, defaults to "usd"
+ * @param days Number of days, or "max" for the full history
+ * @return char* Allocated string with URL (must be freed by caller)
+ */
+char *get_market_chart_url(const char *id, const char *currency, const char *days);
+
+/**
+ * @brief Fetch markets data (top coins) from CoinGecko API
+ * 
+ * @param limit Number of coins to fetch (default: 10)
+ * @param buffer Output buffer to store JSON response
+ * @param buffer_size Size of the output buffer
+ * @return int 0 on success, -1 on error
+ */
+int fetch_markets_data(int limit, char *buffer, size_t buffer_size);
+
+/**
+ * @brief Fetch several URLs concurrently
+ * 
+ * Transfers are multiplexed as HTTP/2 streams over a shared connection when
+ * the server supports it, so N requests do not open N sockets.
+ * 
+ * @param requests Requests to perform (url set by caller, other fields filled in)
+ * @param count Number of requests
+ * @param max_in_flight Maximum concurrent transfers (<= 0 uses API_DEFAULT_MAX_IN_FLIGHT)
+ * @return int 0 if every request succeeded, -1 if any failed (check each result)
+ */
+int api_fetch_parallel(api_request_t *requests, int count, int max_in_flight);
+
+/**
+ * @brief Create an incremental fetcher
+ * 
+ * Same transport as api_fetch_parallel() (multiplexed HTTP/2 streams), but
+ * requests can be added while others are still running, which lets
+ * pipelines keep a fixed number of transfers in flight.
+ * 
+ * @param max_in_flight Maximum requests running or completed-but-uncollected
+ * @return api_async_t* Fetcher, or NULL on error
+ */
+api_async_t *api_async_new(int max_in_flight);
+
+/**
+ * @brief Start a request (the request must stay valid until returned by api_async_next())
+ * 
+ * @return int 0 on success, -1 if the fetcher is full or the request could not start
+ */
+int api_async_add(api_async_t *async, api_request_t *request);
+
+/**
+ * @brief Check whether another request can be added
+ * 
+ * @return int 1 if api_async_add() would accept a request, 0 otherwise
+ */
+int api_async_has_capacity(const api_async_t *async);
+
+/**
+ * @brief Number of requests added but not yet returned by api_async_next()
+ */
+int api_async_pending(const api_async_t *async);
+
+/**
+ * @brief Drive transfers and return one completed request
+ * 
+ * @param timeout_ms Maximum time to wait (0 = do not wait, < 0 = up to 1s)
+ * @return api_request_t* A completed request (check its result), or NULL if none finished
+ */
+api_request_t *api_async_next(api_async_t *async, int timeout_ms);
+
+/**
+ * @brief Cancel outstanding transfers and free the fetcher
+ */
+void api_async_free(api_async_t *async);
+
+#endif /* API_H */
+
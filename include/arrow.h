@@ -0,0 +1,122 @@
+#ifndef ARROW_H
+#define ARROW_H
+
+/**
+ * @file arrow.h
+ * @brief Minimal Apache Arrow IPC writer (stream and file format)
+ *
+ * Writes record batches of flat columns (utf8, float64, int64, timestamp)
+ * straight from the caller's memory, with no dependency on the Arrow
+ * libraries. Columns are described by a base pointer and a stride, so
+ * arrays of structs (markets_data_t) and plain arrays (snapshot columns,
+ * series) are both written without being copied into a table first.
+ *
+ *     stream:  schema message, record batches, end-of-stream marker
+ *     file:    "ARROW1", the stream, a footer indexing the batches, "ARROW1"
+ *
+ * The file format is what Feather V2 is; readers can mmap it and use the
+ * buffers in place. NaN doubles and NULL strings are written as nulls.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Column types
+ */
+typedef enum {
+    ARROW_UTF8 = 0,      // Source: const char * per row
+    ARROW_FLOAT64,       // Source: double per row
+    ARROW_INT64,         // Source: signed integer per row (see arrow_column_t.width)
+    ARROW_TIMESTAMP_S,   // Like ARROW_INT64, seconds since the epoch, UTC
+    ARROW_TIMESTAMP_MS   // Like ARROW_INT64, milliseconds since the epoch, UTC
+} arrow_type_t;
+
+/**
+ * @brief One field of the schema
+ */
+typedef struct {
+    const char *name;
+    arrow_type_t type;
+} arrow_field_t;
+
+/**
+ * @brief Where a column's values are in memory
+ *
+ * Row i is at (const char *)base + i * stride.
+ */
+typedef struct {
+    const void *base;
+    size_t stride;
+    size_t width;    // Integer columns: size of the source integer (4 or 8)
+} arrow_column_t;
+
+/**
+ * @brief Record batch location, for the file footer
+ */
+typedef struct {
+    int64_t offset;
+    int32_t metadata_length;
+    int64_t body_length;
+} arrow_block_t;
+
+/**
+ * @brief Writer state
+ */
+typedef struct {
+    FILE *fp;
+    int file_format;              // Non-zero: file format (with footer)
+    const arrow_field_t *fields;  // Must outlive the writer
+    int field_count;
+    int64_t offset;               // Bytes written so far
+    arrow_block_t *blocks;        // Record batches written (file format)
+    int block_count;
+    int block_capacity;
+    unsigned char *stage;         // Staging buffer for strided columns
+    size_t staged;
+    int failed;
+} arrow_writer_t;
+
+/**
+ * @brief Start a stream or file and write the schema
+ *
+ * @param writer Writer to initialise
+ * @param fp Destination (written sequentially; need not be seekable)
+ * @param file_format Non-zero for the file format, 0 for the stream format
+ * @param fields Schema fields
+ * @param field_count Number of fields
+ * @return int 0 on success, -1 on error
+ */
+int arrow_begin(arrow_writer_t *writer, FILE *fp, int file_format,
+                const arrow_field_t *fields, int field_count);
+
+/**
+ * @brief Write one record batch
+ *
+ * @param writer Started writer
+ * @param columns One source per schema field
+ * @param rows Number of rows
+ * @return int 0 on success, -1 on error
+ */
+int arrow_write_batch(arrow_writer_t *writer, const arrow_column_t *columns, int64_t rows);
+
+/**
+ * @brief Finish the stream (and the footer for files), flush and free
+ *
+ * @return int 0 if everything was written, -1 if any write failed
+ */
+int arrow_end(arrow_writer_t *writer);
+
+/**
+ * @brief Column over a contiguous array
+ */
+#define ARROW_ARRAY(ptr) ((arrow_column_t){ (ptr), sizeof(*(ptr)), sizeof(*(ptr)) })
+
+/**
+ * @brief Column over one member of an array of structs
+ */
+#define ARROW_MEMBER(array, member) \
+    ((arrow_column_t){ &(array)[0].member, sizeof((array)[0]), sizeof((array)[0].member) })
+
+#endif /* ARROW_H */
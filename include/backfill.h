@@ -0,0 +1,26 @@
+#ifndef BACKFILL_H
+#define BACKFILL_H
+
+/**
+ * @file backfill.h
+ * @brief Bulk download of price history ("crypto backfill")
+ *
+ * Fetches the market_chart series of many coins and stores each in its own
+ * column file, DIR/<id>.hist (see histfile.h). Requests are paced by one
+ * token bucket and a cap on requests in flight. Every finished coin is
+ * appended to DIR/journal, so a run that is interrupted picks up where it
+ * stopped when started again with the same range and currency:
+ *
+ *     <id> TAB <currency> TAB <days> TAB <samples> NEWLINE
+ */
+
+/**
+ * @brief Entry point for "crypto backfill --ids-from SOURCE [--days D] [--out DIR] [...]"
+ *
+ * @param argc Argument count (argv[0] is "backfill")
+ * @param argv Arguments
+ * @return int Process exit code
+ */
+int backfill_command(int argc, char *argv[]);
+
+#endif /* BACKFILL_H */
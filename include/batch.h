@@ -0,0 +1,33 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+/**
+ * @file batch.h
+ * @brief Streaming batch quotes from stdin ("crypto batch")
+ *
+ * Symbols read from stdin flow through four stages, each on its own thread
+ * and connected by bounded SPSC queues:
+ *
+ *     resolve (stdin -> id chunks) -> fetch (multi-id simple/price, several
+ *     in flight, rate limited) -> parse -> emit (stdout, input order)
+ *
+ * Memory is bounded by the queue capacities and the in-flight window, not
+ * by the size of the input.
+ *
+ * --fields narrows both the request (include_* flags) and the output
+ * columns.
+ */
+
+#include "options.h"
+
+/**
+ * @brief Entry point for "crypto batch [options] < symbols.txt"
+ *
+ * @param argc Argument count (argv[0] is "batch")
+ * @param argv Arguments
+ * @param options Global options (--fields)
+ * @return int Process exit code
+ */
+int batch_command(int argc, char *argv[], const cli_options_t *options);
+
+#endif /* BATCH_H */
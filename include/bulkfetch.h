@@ -0,0 +1,70 @@
+#ifndef BULKFETCH_H
+#define BULKFETCH_H
+
+/**
+ * @file bulkfetch.h
+ * @brief Many requests against a rate-limited API ("corr", "backfill", "matrix --top")
+ *
+ * bulk_fetch_top() reads the first N coins of the markets listing, one
+ * request per page. bulk_fetch() works through a list of URLs with a cap
+ * on requests in flight, starting each only when the token bucket has a
+ * token; a retryable failure puts the URL back at the end of the queue.
+ * Neither starts a request once the --deadline has run out.
+ */
+
+#include <stddef.h>
+#include "api.h"
+#include "parser.h"
+#include "ratelimit.h"
+
+#define BULK_MARKETS_PAGE 250      // Largest page the markets endpoint returns
+
+/**
+ * @brief Pacing and retries of bulk_fetch()
+ */
+typedef struct {
+    int concurrency;           // Requests in flight
+    ratelimit_t *limiter;      // One token per request started
+    int max_attempts;          // Tries per URL
+    int retry_errors;          // Retry 5xx and transport errors as well as 429
+    int cooldown_ms;           // No new requests for this long after a 429 (0 = none)
+} bulk_options_t;
+
+/**
+ * @brief Called exactly once per URL when bulk_fetch() is done with it
+ *
+ * response is the successful attempt (result 0, data set) or the last
+ * failed one; its data is freed when the callback returns. attempts is 0
+ * for a URL never started because the deadline ran out.
+ */
+typedef void (*bulk_done_fn)(void *ctx, int index, const api_request_t *response, int attempts);
+
+/**
+ * @brief The first limit coins of the markets listing, in rank order
+ *
+ * Pages of up to BULK_MARKETS_PAGE coins are fetched in parallel, each
+ * after taking a token from limiter. Coins of pages that fail are missing
+ * from the result.
+ *
+ * @param limit Number of coins
+ * @param limiter Token bucket shared with the rest of the run (NULL = unpaced)
+ * @param complete Output: 1 if every page arrived (may be NULL)
+ * @return markets_data_t Coins with an id (free with free_markets_data()); success 0 if none
+ */
+markets_data_t bulk_fetch_top(int limit, ratelimit_t *limiter, int *complete);
+
+/**
+ * @brief Fetch count URLs, reporting each one through done
+ *
+ * @param first_url Address of the first URL pointer (a NULL URL fails at once)
+ * @param stride Bytes from one URL pointer to the next
+ * @param count Number of URLs
+ * @param options Concurrency, pacing and retries
+ * @param done Completion callback
+ * @param ctx Passed to done
+ * @return int 0 on success, -1 on allocation failure (done not called)
+ */
+int bulk_fetch(const void *first_url, size_t stride, int count, const bulk_options_t *options,
+               bulk_done_fn done, void *ctx);
+
+#endif /* BULKFETCH_H */
@@ -0,0 +1,104 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+/**
+ * @file client.h
+ * @brief Embeddable client context (libcryptocli)
+ *
+ * A crypto_client_t owns everything a request needs: a connection pool, a
+ * quote cache, the allocator used for returned data and a rate limiter.
+ * One client can be shared by any number of threads; link against
+ * libcryptocli.a or libcryptocli.so (see "make lib").
+ *
+ *     crypto_client_t *client = crypto_client_new(NULL);
+ *     crypto_data_t quote;
+ *     if (crypto_client_get_quote(client, "btc", "eur", &quote) == 0) {
+ *         printf("%f\n", quote.current_price);
+ *         crypto_client_release_quote(client, &quote);
+ *     }
+ *     crypto_client_free(client);
+ */
+
+#include <stddef.h>
+#include "parser.h"
+
+/** Default lifetime of a cached quote */
+#define CRYPTO_CLIENT_DEFAULT_TTL 30
+
+/** Default number of cached quotes */
+#define CRYPTO_CLIENT_DEFAULT_CACHE_SIZE 256
+
+/**
+ * @brief Client settings (start from crypto_client_config_default())
+ */
+typedef struct {
+    void *(*malloc_fn)(size_t size);  // Allocator for returned data (NULL = malloc)
+    void (*free_fn)(void *ptr);       // Matching free, must accept NULL (NULL = free)
+    int cache_ttl_seconds;            // Quote lifetime (0 disables the cache)
+    int cache_size;                   // Cache slots
+    double requests_per_minute;       // Sustained request rate (<= 0 = unlimited)
+    double burst;                     // Requests allowed back-to-back
+    long timeout_ms;                  // Whole-request timeout
+} crypto_client_config_t;
+
+/**
+ * @brief Opaque client context
+ */
+typedef struct crypto_client crypto_client_t;
+
+/**
+ * @brief Fill a config with the defaults
+ *
+ * @param config Config to initialise
+ */
+void crypto_client_config_default(crypto_client_config_t *config);
+
+/**
+ * @brief Create a client
+ *
+ * @param config Settings (copied; NULL uses the defaults)
+ * @return crypto_client_t* Client, or NULL on error
+ */
+crypto_client_t *crypto_client_new(const crypto_client_config_t *config);
+
+/**
+ * @brief Close connections and free the client
+ *
+ * No other thread may be using the client.
+ */
+void crypto_client_free(crypto_client_t *client);
+
+/**
+ * @brief Get a quote (price, 24h change, market cap, volume)
+ *
+ * Served from the cache while younger than the configured TTL.
+ *
+ * @param client Client
+ * @param symbol Symbol or CoinGecko ID (e.g., "btc", "bitcoin")
+ * @param currency Currency code (e.g., "eur"). If NULL, defaults to "usd"
+ * @param out Output quote, released with crypto_client_release_quote()
+ * @return int 0 on success, -1 on error
+ */
+int crypto_client_get_quote(crypto_client_t *client, const char *symbol, const char *currency, crypto_data_t *out);
+
+/**
+ * @brief Free a quote returned by crypto_client_get_quote()
+ */
+void crypto_client_release_quote(crypto_client_t *client, crypto_data_t *quote);
+
+/**
+ * @brief Get the top coins by market cap (USD)
+ *
+ * @param client Client
+ * @param limit Number of coins
+ * @param out Output list, released with crypto_client_release_markets()
+ * @return int 0 on success, -1 on error
+ */
+int crypto_client_get_markets(crypto_client_t *client, int limit, markets_data_t *out);
+
+/**
+ * @brief Free a list returned by crypto_client_get_markets()
+ */
+void crypto_client_release_markets(crypto_client_t *client, markets_data_t *markets);
+
+#endif /* CLIENT_H */
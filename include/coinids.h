@@ -0,0 +1,50 @@
+#ifndef COINIDS_H
+#define COINIDS_H
+
+/**
+ * @file coinids.h
+ * @brief Coin id lists: resolving, matching and joining them for requests
+ *
+ * Resolved ids are interned (intern.h), like the ids of quotes parsed with
+ * interning on, so a quote belongs to a coin exactly when the two id
+ * pointers are equal. Functions that walk ids take the address of the
+ * first id pointer and the distance between ids, so they work on the id
+ * member of any array of structs as well as on a plain array of ids.
+ */
+
+#include <stddef.h>
+
+/**
+ * @brief Resolve "btc,eth,..." to unique interned CoinGecko ids
+ *
+ * Symbols are mapped with symbol_to_id(); repeats are dropped and the
+ * first occurrence keeps its place.
+ *
+ * @param list Comma- or space-separated symbols and ids
+ * @param ids Output: array of count ids (free() it; the ids stay interned)
+ * @return int Number of ids (0 if the list names none), -1 on allocation failure
+ */
+int coin_ids_resolve(const char *list, const char ***ids);
+
+/**
+ * @brief Find an interned id among count ids
+ *
+ * @param first Address of the first id pointer
+ * @param stride Bytes from one id pointer to the next
+ * @param count Number of ids
+ * @param id Interned id to look for
+ * @return int Index of the id, or -1 if it is not there
+ */
+int coin_ids_find(const void *first, size_t stride, int count, const char *id);
+
+/**
+ * @brief Join count ids with commas, as the ids= parameter of a request
+ *
+ * @param first Address of the first id pointer
+ * @param stride Bytes from one id pointer to the next
+ * @param count Number of ids
+ * @return char* "id,id,..." (caller frees), or NULL on allocation failure
+ */
+char *join_ids(const void *first, size_t stride, int count);
+
+#endif /* COINIDS_H */
@@ -0,0 +1,103 @@
+#ifndef COININDEX_H
+#define COININDEX_H
+
+/**
+ * @file coinindex.h
+ * @brief On-disk trigram index over the coin list, loaded by mmap
+ *
+ * The id, symbol and name of every coin are folded to lowercase
+ * alphanumerics, padded with a space at each end and cut into trigrams
+ * ("btc" -> " bt", "btc", "tc "), so the padding also indexes prefixes of
+ * every word. Each trigram maps to the sorted list of coins containing it:
+ *
+ *     header | coins (id, symbol, name offsets + trigram count per coin)
+ *            | trigram table (key, first posting, posting count; sorted)
+ *            | postings (coin indices) | string table (NUL-terminated)
+ *
+ * A search looks up the query's trigrams by binary search and scores the
+ * coins that share them, so its cost depends on the query, not on the
+ * number of coins.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "parser.h"
+
+/**
+ * @brief A mapped index (all pointers point into the mapping)
+ */
+typedef struct {
+    void *base;
+    size_t size;
+    uint32_t count;               // Number of coins
+    int64_t created_at;           // When the index was written (Unix time)
+    const uint32_t *coins;        // 4 x uint32 per coin: id, symbol, name, trigrams
+    const uint32_t *trigrams;     // 3 x uint32 per trigram: key, first, count
+    uint32_t trigram_count;
+    const uint32_t *postings;
+    uint32_t posting_count;
+    const char *string_table;
+    uint32_t string_table_size;
+} coin_index_t;
+
+/**
+ * @brief One search result
+ */
+typedef struct {
+    uint32_t coin;    // Coin index (see coin_index_string())
+    double score;     // Trigram similarity (0..1) plus exact/prefix bonuses
+} coin_match_t;
+
+/** Score from which a match counts as a plausible "did you mean" */
+#define COIN_INDEX_SUGGEST_SCORE 0.3
+
+/**
+ * @brief Build an index from a coin list and write it atomically
+ *
+ * @param path Destination file
+ * @param coins Coins (id, symbol, name used; entries without success skipped)
+ * @return int 0 on success, -1 on error
+ */
+int coin_index_write(const char *path, const markets_data_t *coins);
+
+/**
+ * @brief Map an index and validate its layout
+ *
+ * @param path Index file
+ * @param index Output view (release with coin_index_close())
+ * @return int 0 on success, -1 if missing, truncated or incompatible
+ */
+int coin_index_open(const char *path, coin_index_t *index);
+
+/**
+ * @brief Unmap an index
+ */
+void coin_index_close(coin_index_t *index);
+
+/**
+ * @brief Find the coins that best match a query
+ *
+ * @param index Mapped index
+ * @param query Free text (id, symbol or name, possibly misspelt)
+ * @param matches Output, best match first
+ * @param max Capacity of matches
+ * @return int Number of matches (0 .. max), or -1 on allocation failure
+ */
+int coin_index_search(const coin_index_t *index, const char *query, coin_match_t *matches,
+                      int max);
+
+/**
+ * @brief String of a coin ("" if out of range)
+ *
+ * @param index Mapped index
+ * @param coin Coin index
+ * @param field COIN_INDEX_ID, COIN_INDEX_SYMBOL or COIN_INDEX_NAME
+ */
+const char *coin_index_string(const coin_index_t *index, uint32_t coin, int field);
+
+/** String fields for coin_index_string() */
+#define COIN_INDEX_ID 0
+#define COIN_INDEX_SYMBOL 1
+#define COIN_INDEX_NAME 2
+
+#endif /* COININDEX_H */
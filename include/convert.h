@@ -0,0 +1,37 @@
+#ifndef CONVERT_H
+#define CONVERT_H
+
+/**
+ * @file convert.h
+ * @brief Cross rates between coins and fiat currencies ("crypto convert",
+ * "crypto matrix")
+ *
+ * Every asset is priced by a single batched simple/price request (coins in
+ * USD plus each fiat code involved), and all pair rates are derived from
+ * that price vector. Matrices are computed a block of rows at a time and
+ * written as they are produced in the format chosen with --format.
+ */
+
+#include "options.h"
+
+/**
+ * @brief Entry point for "crypto convert AMOUNT FROM TO [TO...]"
+ *
+ * @param argc Argument count (argv[0] is "convert")
+ * @param argv Arguments
+ * @param options Global options (output format)
+ * @return int Process exit code
+ */
+int convert_command(int argc, char *argv[], const cli_options_t *options);
+
+/**
+ * @brief Entry point for "crypto matrix ASSET... | --top N [--vs CODES]"
+ *
+ * @param argc Argument count (argv[0] is "matrix")
+ * @param argv Arguments
+ * @param options Global options (output format)
+ * @return int Process exit code
+ */
+int matrix_command(int argc, char *argv[], const cli_options_t *options);
+
+#endif /* CONVERT_H */
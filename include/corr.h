@@ -0,0 +1,29 @@
+#ifndef CORR_H
+#define CORR_H
+
+/**
+ * @file corr.h
+ * @brief Return correlations and volatility across coins ("crypto corr")
+ *
+ * Fetches the market_chart price series of every coin (rate limited, a few
+ * requests in flight), puts them on a common time grid, takes log returns
+ * and writes the Pearson correlation matrix with each coin's annualised
+ * volatility in the format chosen with --format. The matrix is computed
+ * by the blocked, multi-threaded kernel in corrmat.h.
+ *
+ *     coin, <coin 1>, ..., <coin N>, volatility
+ */
+
+#include "options.h"
+
+/**
+ * @brief Entry point for "crypto corr (--top N | SYMBOL...) [--days D] [...]"
+ *
+ * @param argc Argument count (argv[0] is "corr")
+ * @param argv Arguments
+ * @param options Global options (output format)
+ * @return int Process exit code
+ */
+int corr_command(int argc, char *argv[], const cli_options_t *options);
+
+#endif /* CORR_H */
@@ -0,0 +1,60 @@
+#ifndef CORRMAT_H
+#define CORRMAT_H
+
+/**
+ * @file corrmat.h
+ * @brief Pearson correlation kernel over many return series
+ *
+ * Each series is standardised once (mean removed, scaled to unit length),
+ * after which every correlation is a plain dot product: the N x N matrix
+ * is Z * Z^T. Only tiles on and above the diagonal are computed, each by
+ * one thread, in chunks of CORR_TILE_LEN returns so both tiles' rows stay
+ * in cache; the inner kernel works on 2 x 4 pairs of rows four returns at
+ * a time. The lower triangle is mirrored at the end.
+ *
+ * Rows are stored `stride` doubles apart; stride is a multiple of
+ * CORR_ALIGN and the slots past the last return hold zeros.
+ */
+
+#include <stddef.h>
+
+/** Row stride granularity, in doubles (one vector) */
+#define CORR_ALIGN 4
+
+/** Rows per tile of the matrix */
+#define CORR_TILE_ROWS 32
+
+/** Returns per chunk of a tile (512 doubles = 4 KB per row) */
+#define CORR_TILE_LEN 512
+
+/**
+ * @brief Row stride for series of len returns
+ */
+size_t corr_stride(int len);
+
+/**
+ * @brief Standardise rows in place so that dot products are correlations
+ *
+ * Rows with fewer than two returns, no variance or non-finite values become
+ * NaN, so their correlations come out NaN.
+ *
+ * @param rows_data rows x stride doubles (padding zeroed)
+ * @param rows Number of series
+ * @param len Returns per series
+ * @param stride Row stride from corr_stride()
+ * @param stdev Output per row: sample standard deviation of the returns
+ */
+void corr_standardize(double *rows_data, int rows, int len, size_t stride, double *stdev);
+
+/**
+ * @brief Correlation matrix of standardised rows
+ *
+ * @param z Standardised rows from corr_standardize()
+ * @param rows Number of series
+ * @param stride Row stride
+ * @param threads Worker threads (1 computes on the calling thread)
+ * @param out Output, rows x rows, row-major
+ */
+void corr_matrix(const double *z, int rows, size_t stride, int threads, double *out);
+
+#endif /* CORRMAT_H */
@@ -0,0 +1,23 @@
+#ifndef DASH_H
+#define DASH_H
+
+/**
+ * @file dash.h
+ * @brief Live full-screen dashboard ("crypto dash")
+ *
+ * Shows the top coins table plus pinned watchlist coins. A background thread
+ * refreshes the data; the UI thread redraws through the double-buffered
+ * screen so only changed cells reach the terminal, re-sorts on keypress
+ * without refetching, and follows terminal resizes.
+ */
+
+/**
+ * @brief Entry point for "crypto dash [N] [--watch IDS] [--interval SECONDS]"
+ *
+ * @param argc Argument count (argv[0] is "dash")
+ * @param argv Arguments
+ * @return int Process exit code
+ */
+int dash_command(int argc, char *argv[]);
+
+#endif /* DASH_H */
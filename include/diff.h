@@ -0,0 +1,113 @@
+#ifndef DIFF_H
+#define DIFF_H
+
+/**
+ * @file diff.h
+ * @brief Compare two market listings ("crypto diff", "crypto top --since")
+ *
+ * The two sides are joined by coin id through a hash table built on the
+ * earlier one, so a comparison is linear in the number of coins. Within
+ * the top `limit` ranks, a coin that is only in the later listing is an
+ * entrant ("new"), one only in the earlier listing a drop-out ("out");
+ * coins in both get their rank move and the relative change of price,
+ * market cap and volume. Rows are sorted as an index and then streamed
+ * through the output writer:
+ *
+ *     rank, previous_rank, rank_change, status, id, symbol, price,
+ *     price_change_pct, market_cap, market_cap_change_pct, volume_24h,
+ *     volume_change_pct
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "options.h"
+#include "parser.h"
+#include "snapshot.h"
+
+/**
+ * @brief One listing, as columns in rank order
+ *
+ * The numeric columns point into the source (a mapped snapshot) or into
+ * arrays owned by the side; release with diff_side_free().
+ */
+typedef struct {
+    int count;
+    int64_t created_at;       // Unix time of the listing (0 if unknown)
+    const char **id;
+    const char **symbol;
+    const double *price;
+    const double *market_cap;
+    const double *volume;
+    void *owned;              // Single allocation behind the arrays
+} diff_side_t;
+
+/**
+ * @brief Row orders for diff_write()
+ */
+typedef enum {
+    DIFF_SORT_RANK = 0,       // Current rank; drop-outs last, by previous rank
+    DIFF_SORT_MOVE,           // Biggest climbers first
+    DIFF_SORT_PRICE,          // Largest price change first
+    DIFF_SORT_MARKET_CAP,
+    DIFF_SORT_VOLUME
+} diff_sort_t;
+
+/**
+ * @brief View a mapped snapshot as a side (the snapshot must outlive it)
+ *
+ * @return int 0 on success, -1 on allocation failure
+ */
+int diff_side_from_snapshot(const markets_snapshot_t *snapshot, diff_side_t *side);
+
+/**
+ * @brief View parsed market data as a side (the data must outlive it)
+ *
+ * Coins without success are skipped; ranks follow the array order.
+ *
+ * @return int 0 on success, -1 on allocation failure
+ */
+int diff_side_from_markets(const markets_data_t *markets, int64_t created_at, diff_side_t *side);
+
+/**
+ * @brief Release what a side allocated
+ */
+void diff_side_free(diff_side_t *side);
+
+/**
+ * @brief Join two sides and write the differences
+ *
+ * @param fp Destination stream
+ * @param format Output format
+ * @param before Earlier listing
+ * @param after Later listing
+ * @param limit Ranks compared (0 = as many as both sides have)
+ * @param sort Row order
+ * @return int 0 on success, -1 on error
+ */
+int diff_write(FILE *fp, output_format_t format, const diff_side_t *before,
+               const diff_side_t *after, int limit, diff_sort_t sort);
+
+/**
+ * @brief Parse an age such as 90s, 15m, 1h or 2d
+ *
+ * @param text Age (a plain number is seconds)
+ * @param seconds Output
+ * @return int 0 on success, -1 if malformed or not positive
+ */
+int diff_parse_age(const char *text, long *seconds);
+
+/**
+ * @brief Entry point for "crypto diff BEFORE AFTER [--limit N] [--sort KEY]"
+ *
+ * BEFORE and AFTER are snapshot files, CoinGecko /coins/markets JSON files,
+ * "latest" (the last top snapshot) or an age such as 1h (the archived
+ * snapshot from that long ago).
+ *
+ * @param argc Argument count (argv[0] is "diff")
+ * @param argv Arguments
+ * @param options Global options (output format)
+ * @return int Process exit code
+ */
+int diff_command(int argc, char *argv[], const cli_options_t *options);
+
+#endif /* DIFF_H */
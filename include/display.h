@@ -1,40 +1,100 @@
-#ifndef DISPLAY_H
-#define DISPLAY_H
-
-/**
- * @file display.h
- * @brief Display formatting for cryptocurrency data
- */
-
-#include "parser.h"
-
-/**
- * @brief Display full cryptocurrency information
- * 
- * @param data Cryptocurrency data structure
- */
-void display_full_info(const crypto_data_t *data);
-
-/**
- * @brief Display only the price
- * 
- * @param data Cryptocurrency data structure
- */
-void display_price_only(const crypto_data_t *data);
-
-/**
- * @brief Display error message
- * 
- * @param message Error message to display
- */
-void display_error(const char *message);
-
-/**
- * @brief Display top cryptocurrencies table
- * 
- * @param markets Markets data structure containing array of coins
- */
-void display_top_coins(const markets_data_t *markets);
-
-#endif /* DISPLAY_H */
-
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
+/**
+ * @file display.h
+ * @brief Display formatting for cryptocurrency data
+ */
+
+#include <stddef.h>
+#include "parser.h"
+#include "snapshot.h"
+
+/**
+ * @brief Display full cryptocurrency information
+ * 
+ * @param data Cryptocurrency data structure
+ */
+void display_full_info(const crypto_data_t *data);
+
+/**
+ * @brief Display the full information box, limited to some fields
+ * 
+ * Without PLAN_NAME the header shows the coin id instead of the name.
+ * 
+ * @param data Cryptocurrency data structure
+ * @param fields PLAN_* mask from planner.h
+ */
+void display_selected_info(const crypto_data_t *data, unsigned fields);
+
+/**
+ * @brief Display only the price
+ * 
+ * @param data Cryptocurrency data structure
+ */
+void display_price_only(const crypto_data_t *data);
+
+/**
+ * @brief Display error message
+ * 
+ * @param message Error message to display
+ */
+void display_error(const char *message);
+
+/**
+ * @brief Mark output as served from an expired stored quote (on stderr)
+ * 
+ * @param age_seconds Age of the data
+ */
+void display_stale_notice(long age_seconds);
+
+/**
+ * @brief Display top cryptocurrencies table
+ * 
+ * Rank is always shown; without PLAN_NAME the coin id replaces the symbol
+ * and name columns.
+ * 
+ * @param markets Markets data structure containing array of coins
+ * @param fields PLAN_* mask from planner.h (0 for symbol, name, price,
+ *               market cap, volume and 24h change)
+ */
+void display_top_coins(const markets_data_t *markets, unsigned fields);
+
+/**
+ * @brief Display top cryptocurrencies table from a mapped snapshot
+ * 
+ * @param snapshot Snapshot of a markets response
+ * @param limit Number of coins to show (<= 0 or more than stored shows all)
+ * @param fields PLAN_* mask, as for display_top_coins()
+ */
+void display_top_snapshot(const markets_snapshot_t *snapshot, int limit, unsigned fields);
+
+/**
+ * @brief Format a price the way the top coins table shows it ("$0.0123")
+ * 
+ * @param price Price in USD
+ * @param out Output buffer
+ * @param size Size of the output buffer
+ */
+void format_table_price(double price, char *out, size_t size);
+
+/**
+ * @brief Format a market cap or volume with T/B/M suffix ("$1.23B")
+ * 
+ * @param amount Amount in USD
+ * @param out Output buffer
+ * @param size Size of the output buffer
+ */
+void format_table_amount(double amount, char *out, size_t size);
+
+/**
+ * @brief Format a 24h change percentage with arrow ("↑+1.25%")
+ * 
+ * @param change_percentage Change in percent
+ * @param out Output buffer
+ * @param size Size of the output buffer
+ */
+void format_table_change(double change_percentage, char *out, size_t size);
+
+#endif /* DISPLAY_H */
+
@@ -0,0 +1,69 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+/**
+ * @file export.h
+ * @brief Market tables and history series in the --format output formats
+ *
+ * The Arrow formats are written column by column straight from the parsed
+ * structures (or the mapped snapshot); the text formats go through the
+ * row writer in output.h. Times are timestamp columns in Arrow and
+ * ISO 8601 UTC strings in text.
+ *
+ *     markets:  rank, id, symbol, name, currency, price, change_24h,
+ *               change_percentage_24h, market_cap, volume_24h, high_24h,
+ *               low_24h, last_updated
+ *     ohlc:     time, open, high, low, close
+ *     chart:    time, price, market_cap, volume
+ *
+ * The markets functions take a PLAN_* mask (planner.h, 0 for all) from
+ * --fields; columns outside it are left out. rank, id and currency are
+ * always written.
+ */
+
+#include <stdio.h>
+#include "output.h"
+#include "parser.h"
+#include "snapshot.h"
+
+/** Rows per Arrow record batch */
+#define EXPORT_BATCH_ROWS 65536
+
+/**
+ * @brief Write a parsed markets response
+ *
+ * @return int 0 on success, -1 if writing failed
+ */
+int export_markets(FILE *fp, output_format_t format, const markets_data_t *markets,
+                   unsigned fields);
+
+/**
+ * @brief Write one quote as a single markets row, without the rank column
+ *
+ * @return int 0 on success, -1 if writing failed
+ */
+int export_quote(FILE *fp, output_format_t format, const crypto_data_t *data, unsigned fields);
+
+/**
+ * @brief Write the first limit coins of a mapped markets snapshot
+ *
+ * @return int 0 on success, -1 if writing failed
+ */
+int export_markets_snapshot(FILE *fp, output_format_t format, const markets_snapshot_t *snapshot,
+                            int limit, unsigned fields);
+
+/**
+ * @brief Write OHLC candles
+ *
+ * @return int 0 on success, -1 if writing failed
+ */
+int export_ohlc(FILE *fp, output_format_t format, const ohlc_series_t *series);
+
+/**
+ * @brief Write market_chart history
+ *
+ * @return int 0 on success, -1 if writing failed
+ */
+int export_chart(FILE *fp, output_format_t format, const chart_series_t *series);
+
+#endif /* EXPORT_H */
@@ -0,0 +1,22 @@
+#ifndef FEED_H
+#define FEED_H
+
+/**
+ * @file feed.h
+ * @brief Shared-memory quote publisher ("crypto feed")
+ *
+ * Refreshes a fixed coin set on an interval and publishes every changed
+ * quote into a shared-memory segment (see quotefeed.h), so local processes
+ * read current prices without polling the API or a socket.
+ */
+
+/**
+ * @brief Entry point for "crypto feed --shm NAME [--coins IDS] [--currency CODE] [--interval SECONDS]"
+ *
+ * @param argc Argument count (argv[0] is "feed")
+ * @param argv Arguments
+ * @return int Process exit code
+ */
+int feed_command(int argc, char *argv[]);
+
+#endif /* FEED_H */
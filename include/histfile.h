@@ -0,0 +1,74 @@
+#ifndef HISTFILE_H
+#define HISTFILE_H
+
+/**
+ * @file histfile.h
+ * @brief Binary column files of one coin's price history
+ *
+ * One file per coin holds a market_chart series column by column, so a
+ * reader can map it and use the arrays in place:
+ *
+ *     header | time_ms (int64) | price | market cap | volume (double)
+ *
+ * Columns follow each other without gaps (32 bytes per sample in all).
+ * Missing market cap or volume samples are NaN. Files are written in
+ * native byte order; files from a machine with another byte order are
+ * rejected on open.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "parser.h"
+
+/** Longest coin id stored in a header, including the NUL */
+#define HISTFILE_ID_SIZE 128
+
+/**
+ * @brief A mapped history file (all pointers point into the mapping)
+ */
+typedef struct {
+    void *base;               // Start of the mapping
+    size_t size;              // Size of the mapping
+    uint64_t count;           // Number of samples
+    int64_t written_at;       // When the file was written (Unix time)
+    const char *id;           // CoinGecko ID
+    const char *currency;     // Currency of price and market cap
+    const char *days;         // Range requested ("max" or a number of days)
+    const int64_t *time_ms;
+    const double *price;
+    const double *market_cap;
+    const double *volume;
+} histfile_t;
+
+/**
+ * @brief Write a series to a file atomically (temp file + rename)
+ *
+ * Each column is streamed from the series arrays into the file, so no
+ * image of the file is built in memory. The data is synced before the
+ * rename, so a file that exists is complete.
+ *
+ * @param path Destination file
+ * @param id Coin ID (shorter than HISTFILE_ID_SIZE)
+ * @param currency Currency of the series (e.g., "usd")
+ * @param days Requested range (e.g., "max")
+ * @param series Parsed market_chart series
+ * @return int 0 on success, -1 on error
+ */
+int histfile_write(const char *path, const char *id, const char *currency, const char *days,
+                   const chart_series_t *series);
+
+/**
+ * @brief Map a history file and validate its layout
+ *
+ * @param path History file
+ * @param file Output view (release with histfile_close())
+ * @return int 0 on success, -1 if missing, truncated or incompatible
+ */
+int histfile_open(const char *path, histfile_t *file);
+
+/**
+ * @brief Unmap a history file
+ */
+void histfile_close(histfile_t *file);
+
+#endif /* HISTFILE_H */
@@ -0,0 +1,26 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+/**
+ * @file history.h
+ * @brief Price history of one coin ("crypto history")
+ *
+ * Fetches the market_chart series (price, market cap, volume) or, with
+ * --ohlc, the OHLC candles of a coin and writes them in the format chosen
+ * with --format; the Arrow formats are written straight from the parsed
+ * columns (see export.h).
+ */
+
+#include "options.h"
+
+/**
+ * @brief Entry point for "crypto history SYMBOL [DAYS] [--ohlc] [--currency CODE]"
+ *
+ * @param argc Argument count (argv[0] is "history")
+ * @param argv Arguments
+ * @param options Global options (output format)
+ * @return int Process exit code
+ */
+int history_command(int argc, char *argv[], const cli_options_t *options);
+
+#endif /* HISTORY_H */
@@ -0,0 +1,61 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+/**
+ * @file intern.h
+ * @brief Process-wide string interning
+ *
+ * Interning returns one canonical, immutable copy per distinct string, kept
+ * until the process exits. Two interned strings are equal exactly when
+ * their pointers are equal, so the pointer serves as a handle. Copies are
+ * packed into 64 KB blocks, so interning a string that is already known
+ * allocates nothing; memory grows only with the number of distinct strings.
+ *
+ * Safe to call from any thread.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Starting value of intern_hash() */
+#define INTERN_HASH_SEED 2166136261u
+
+/**
+ * @brief Intern a NUL-terminated string
+ *
+ * @param s String (NULL returns NULL)
+ * @return const char* Canonical copy, or NULL on allocation failure
+ */
+const char *intern(const char *s);
+
+/**
+ * @brief Intern the first len bytes of s
+ *
+ * @param s Bytes (need not be NUL-terminated)
+ * @param len Number of bytes
+ * @return const char* Canonical NUL-terminated copy, or NULL on allocation failure
+ */
+const char *intern_n(const char *s, size_t len);
+
+/**
+ * @brief Number of distinct strings and bytes held by the table
+ *
+ * @param count Output: distinct strings (may be NULL)
+ * @param bytes Output: bytes of string storage, including block slack (may be NULL)
+ */
+void intern_stats(size_t *count, size_t *bytes);
+
+/**
+ * @brief 32-bit FNV-1a of len bytes, the hash of the intern table
+ *
+ * Shared by the other hash tables keyed by coin ids. Pieces hash in a row
+ * by passing the previous result as hash.
+ *
+ * @param hash INTERN_HASH_SEED, or the hash of the bytes before s
+ * @param s Bytes
+ * @param len Number of bytes
+ * @return uint32_t Hash
+ */
+uint32_t intern_hash(uint32_t hash, const char *s, size_t len);
+
+#endif /* INTERN_H */
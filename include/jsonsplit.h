@@ -0,0 +1,98 @@
+#ifndef JSONSPLIT_H
+#define JSONSPLIT_H
+
+/**
+ * @file jsonsplit.h
+ * @brief Parallel parsing of large JSON arrays, one element at a time
+ *
+ * A structural pass over the text (strings, brackets and top-level commas
+ * only; no values are decoded) records where every element of an array
+ * starts and ends. Worker threads then parse the elements with cJSON and
+ * hand each one to a callback together with its index, so results can go
+ * straight into preallocated slots and keep the order of the array.
+ *
+ *     split:  [ {...} , {...} , ... ]   ->  spans[0], spans[1], ...
+ *     parse:  threads take blocks of spans, callback(element, index)
+ *
+ * Only the current element's tree is alive per thread, so memory stays
+ * small next to parsing the whole document into one tree.
+ */
+
+#include <stddef.h>
+#include <cjson/cJSON.h>
+
+/**
+ * @brief Byte range of one array element, relative to json_split_t.base
+ */
+typedef struct {
+    size_t offset;
+    size_t length;
+} json_span_t;
+
+/**
+ * @brief Elements of one array
+ */
+typedef struct {
+    const char *base;    // Text the spans point into
+    json_span_t *spans;  // One per element, in array order
+    int count;
+    size_t end;          // Offset just past the closing ']'
+} json_split_t;
+
+/**
+ * @brief Called once per element, from any worker thread
+ *
+ * @param element Parsed element (freed after the call)
+ * @param index Position of the element in the array
+ * @param context Caller's context
+ */
+typedef void (*json_element_fn)(const cJSON *element, int index, void *context);
+
+/**
+ * @brief Find the elements of the array at the start of text
+ *
+ * Leading whitespace is skipped. Stops recording after max_elements
+ * elements but still finds the end of the array.
+ *
+ * @param text JSON text (need not be NUL-terminated)
+ * @param length Bytes of text
+ * @param max_elements Most elements to record (<= 0 for all)
+ * @param split Output (free with json_split_free())
+ * @return int 0 on success, -1 if text does not start with a complete array
+ */
+int json_split_array(const char *text, size_t length, int max_elements, json_split_t *split);
+
+/**
+ * @brief Split the arrays stored under some keys of a top-level object
+ *
+ * One pass over the object; other members are skipped. A key that is
+ * missing, or not an array, leaves its split with count -1.
+ *
+ * @param text JSON text (need not be NUL-terminated)
+ * @param length Bytes of text
+ * @param keys Member names (matched byte for byte)
+ * @param key_count Number of keys
+ * @param splits Output, one per key (free each with json_split_free())
+ * @return int 0 on success, -1 if text is not a complete object
+ */
+int json_split_members(const char *text, size_t length, const char *const *keys, int key_count,
+                       json_split_t *splits);
+
+/**
+ * @brief Parse every element on up to threads threads
+ *
+ * @param split Elements from json_split_array() or json_split_members()
+ * @param threads Worker threads (1 parses on the calling thread)
+ * @param callback Receives each element and its index
+ * @param context Passed to callback
+ * @return int 0 if every element parsed, -1 otherwise
+ */
+int json_parse_elements(const json_split_t *split, int threads, json_element_fn callback,
+                        void *context);
+
+/**
+ * @brief Free the spans of a split
+ */
+void json_split_free(json_split_t *split);
+
+#endif /* JSONSPLIT_H */
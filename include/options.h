@@ -0,0 +1,73 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+/**
+ * @file options.h
+ * @brief Global options accepted before or after any command
+ *
+ * main() pre-scans argv for these and removes them, so command parsers only
+ * see their own arguments.
+ */
+
+#include <stddef.h>
+#include "output.h"
+
+/** Seconds a stored quote counts as fresh (judged against last_updated_at) */
+#define OPTIONS_DEFAULT_MAX_AGE 60
+
+/** Seconds past max-age a stored quote may still be served while it refreshes */
+#define OPTIONS_DEFAULT_STALE_GRACE 900
+
+/**
+ * @brief Parsed global options
+ */
+typedef struct {
+    int use_store;        // Serve quotes from the local store (--no-cache and replay clear)
+    long max_age;         // --max-age SECONDS
+    long stale_grace;     // --stale SECONDS (0 = always block on expired data)
+    const char *provider; // --provider NAME (NULL = pick by live statistics)
+    int race;             // --race: ask every provider at once, first quote wins
+    output_format_t format; // --format table|csv|json|arrow|feather (commands that stream rows)
+    long deadline_ms;     // --deadline DURATION: overall time budget (0 = none)
+    int profile;          // --profile: stage timings and allocations as JSON on stderr
+    unsigned fields;      // --fields LIST as a PLAN_* mask (0 = the command's default)
+    int parse_threads;    // --parse-threads N for large responses (0 = one per CPU)
+} cli_options_t;
+
+/**
+ * @brief Fill options with the defaults
+ */
+void options_defaults(cli_options_t *options);
+
+/**
+ * @brief Extract global options from argv
+ *
+ * Recognised options (and their values) are removed from argv and *argc is
+ * updated; everything else is left in order.
+ *
+ * @param argc Argument count (updated)
+ * @param argv Arguments (compacted in place)
+ * @param options Output options (defaults for anything not given)
+ * @return int 0 on success, -1 on a missing or invalid value (error printed)
+ */
+int options_extract(int *argc, char *argv[], cli_options_t *options);
+
+/**
+ * @brief Check a command's --currency CODE and store it in lowercase
+ *
+ * @param code Currency code as given (letters only)
+ * @param out Output buffer
+ * @param size Size of out; the code must be shorter
+ * @return int 0 on success, -1 if invalid (error printed)
+ */
+int options_parse_currency(const char *code, char *out, size_t size);
+
+/**
+ * @brief Whether a history range is a positive whole number of days or "max"
+ *
+ * @param days Range as given
+ * @return int 1 if valid, 0 otherwise
+ */
+int options_valid_days(const char *days);
+
+#endif /* OPTIONS_H */
@@ -0,0 +1,103 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+/**
+ * @file output.h
+ * @brief Row-by-row output in table, CSV or JSON form
+ *
+ * Rows are written as they are produced, so commands with large results
+ * (e.g. a 500 x 500 rate matrix) never hold the whole text in memory.
+ *
+ *     table:  fixed-width columns under a header line
+ *     csv:    header row, then one line per row (RFC 4180 quoting)
+ *     json:   an array with one object per row, keyed by column name
+ *     arrow:  Arrow IPC stream of record batches (see arrow.h)
+ *     feather: Arrow IPC file (Feather V2), the same batches plus a footer
+ *
+ * For the Arrow formats rows are buffered column by column and written a
+ * batch at a time; a column's type (double or string) is that of its
+ * first cell.
+ */
+
+#include <stdio.h>
+
+/**
+ * @brief Output formats (--format)
+ */
+typedef enum {
+    OUTPUT_TABLE = 0,
+    OUTPUT_CSV,
+    OUTPUT_JSON,
+    OUTPUT_ARROW,
+    OUTPUT_FEATHER
+} output_format_t;
+
+/**
+ * @brief Non-zero for the binary (Arrow) formats
+ */
+#define OUTPUT_IS_BINARY(format) ((format) == OUTPUT_ARROW || (format) == OUTPUT_FEATHER)
+
+struct output_columns;
+
+/**
+ * @brief Streaming writer state
+ */
+typedef struct {
+    FILE *fp;
+    output_format_t format;
+    const char *const *columns;   // Column names (must outlive the writer)
+    int column_count;
+    int width;                    // Table column width
+    int column;                   // Next column of the current row
+    long rows;                    // Rows written so far
+    struct output_columns *batch; // Buffered rows (Arrow formats)
+} output_t;
+
+/**
+ * @brief Parse a format name ("table", "csv", "json", "arrow" or "feather")
+ *
+ * @return int 0 on success, -1 if the name is unknown
+ */
+int output_parse_format(const char *name, output_format_t *format);
+
+/**
+ * @brief Start output and write the header
+ *
+ * @param out Writer to initialise
+ * @param fp Destination stream
+ * @param format Output format
+ * @param columns Column names
+ * @param column_count Number of columns
+ * @param width Table column width (ignored for CSV and JSON)
+ */
+void output_begin(output_t *out, FILE *fp, output_format_t format,
+                  const char *const *columns, int column_count, int width);
+
+/**
+ * @brief Start a row
+ */
+void output_row_begin(output_t *out);
+
+/**
+ * @brief Write the next cell as a string
+ */
+void output_string(output_t *out, const char *value);
+
+/**
+ * @brief Write the next cell as a number (NaN prints as empty / null)
+ */
+void output_number(output_t *out, double value);
+
+/**
+ * @brief Finish a row
+ */
+void output_row_end(output_t *out);
+
+/**
+ * @brief Finish output (closes the JSON array, writes the last batch) and flush
+ *
+ * @return int 0 on success, -1 if writing failed
+ */
+int output_end(output_t *out);
+
+#endif /* OUTPUT_H */
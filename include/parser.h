@@ -1,95 +1,264 @@
-#ifndef PARSER_H
-#define PARSER_H
-
-/**
- * @file parser.h
- * @brief JSON parser for cryptocurrency data
- */
-
-/**
- * @brief Cryptocurrency data structure
- */
-typedef struct {
-    char *id;
-    char *symbol;
-    char *name;
-    char *currency;  // Currency code (usd, eur, gbp, etc.)
-    double current_price;
-    double price_change_24h;
-    double price_change_percentage_24h;
-    double market_cap;
-    double volume_24h;
-    double high_24h;
-    double low_24h;
-    long last_updated_at;
-    int success;
-} crypto_data_t;
-
-/**
- * @brief Parse JSON response from CoinGecko API
- * 
- * @param json_string JSON response string
- * @param currency Currency code used (e.g., "usd", "eur", "gbp"). If NULL, defaults to "usd"
- * @return crypto_data_t Parsed cryptocurrency data structure
- */
-crypto_data_t parse_crypto_json_with_currency(const char *json_string, const char *currency);
-
-/**
- * @brief Parse JSON response from CoinGecko API (backward compatibility - uses USD)
- * 
- * @param json_string JSON response string
- * @return crypto_data_t Parsed cryptocurrency data structure
- */
-crypto_data_t parse_crypto_json(const char *json_string);
-
-/**
- * @brief Free memory allocated for crypto_data_t structure
- * 
- * @param data Pointer to crypto_data_t structure to free
- */
-void free_crypto_data(crypto_data_t *data);
-
-/**
- * @brief Convert symbol to CoinGecko ID (lowercase)
- * 
- * @param symbol Cryptocurrency symbol (e.g., "BTC")
- * @return char* Allocated lowercase string (must be freed by caller)
- */
-char *symbol_to_id(const char *symbol);
-
-/**
- * @brief Parse OHLC JSON response and update high/low 24h values
- * 
- * @param json_string OHLC JSON response string (array of [timestamp, open, high, low, close])
- * @param data Pointer to crypto_data_t structure to update with high/low values
- * @return int 0 on success, -1 on error
- */
-int parse_ohlc_json(const char *json_string, crypto_data_t *data);
-
-/**
- * @brief Markets data structure (array of cryptocurrencies)
- */
-typedef struct {
-    crypto_data_t *coins;
-    int count;
-    int success;
-} markets_data_t;
-
-/**
- * @brief Parse markets JSON response (array of coin objects)
- * 
- * @param json_string Markets JSON response string
- * @param limit Maximum number of coins to parse
- * @return markets_data_t Parsed markets data structure
- */
-markets_data_t parse_markets_json(const char *json_string, int limit);
-
-/**
- * @brief Free memory allocated for markets_data_t structure
- * 
- * @param data Pointer to markets_data_t structure to free
- */
-void free_markets_data(markets_data_t *data);
-
-#endif /* PARSER_H */
-
+#ifndef PARSER_H
+#define PARSER_H
+
+/**
+ * @file parser.h
+ * @brief JSON parser for cryptocurrency data
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief Cryptocurrency data structure
+ */
+typedef struct {
+    char *id;
+    char *symbol;
+    char *name;
+    char *currency;  // Currency code (usd, eur, gbp, etc.)
+    double current_price;
+    double price_change_24h;
+    double price_change_percentage_24h;
+    double market_cap;
+    double volume_24h;
+    double high_24h;
+    double low_24h;
+    long last_updated_at;
+    int success;
+    int interned;    // Strings are interned (see parser_set_interning()); never freed or modified
+} crypto_data_t;
+
+/**
+ * @brief Make the parsers intern id, symbol, name and currency
+ * 
+ * Meant for long-running modes that parse the same coins over and over:
+ * repeated snapshots then allocate no strings, and two quotes of the same
+ * coin share pointers, so coins can be matched with ==. free_crypto_data()
+ * leaves interned strings alone. Call before starting threads that parse.
+ * 
+ * @param enabled Non-zero to intern, 0 for private malloc'd copies (default)
+ */
+void parser_set_interning(int enabled);
+
+/** Responses at least this large are parsed on several threads */
+#define PARSER_PARALLEL_MIN_BYTES (1024 * 1024)
+
+/**
+ * @brief Set how many threads parse large array responses
+ * 
+ * Applies to markets responses, OHLC candles and market_chart series of at
+ * least PARSER_PARALLEL_MIN_BYTES: the top-level array is split at element
+ * boundaries (see jsonsplit.h) and the elements are parsed into their
+ * slots in parallel, keeping their order. Smaller responses are always
+ * parsed on the calling thread.
+ * 
+ * @param threads Thread count; 0 for one per online CPU (default), 1 to never split
+ */
+void parser_set_threads(int threads);
+
+/**
+ * @brief Parse JSON response from CoinGecko API
+ * 
+ * @param json_string JSON response string
+ * @param currency Currency code used (e.g., "usd", "eur", "gbp"). If NULL, defaults to "usd"
+ * @return crypto_data_t Parsed cryptocurrency data structure
+ */
+crypto_data_t parse_crypto_json_with_currency(const char *json_string, const char *currency);
+
+/**
+ * @brief Parse JSON response from CoinGecko API (backward compatibility - uses USD)
+ * 
+ * @param json_string JSON response string
+ * @return crypto_data_t Parsed cryptocurrency data structure
+ */
+crypto_data_t parse_crypto_json(const char *json_string);
+
+/**
+ * @brief Free memory allocated for crypto_data_t structure
+ * 
+ * @param data Pointer to crypto_data_t structure to free
+ */
+void free_crypto_data(crypto_data_t *data);
+
+/**
+ * @brief Convert symbol to CoinGecko ID (lowercase)
+ * 
+ * @param symbol Cryptocurrency symbol (e.g., "BTC")
+ * @return char* Allocated lowercase string (must be freed by caller)
+ */
+char *symbol_to_id(const char *symbol);
+
+/**
+ * @brief Convert a symbol or CoinGecko ID to an exchange ticker
+ * 
+ * @param symbol Symbol or CoinGecko ID (e.g., "btc", "bitcoin")
+ * @return char* Allocated uppercase ticker, e.g. "BTC" (must be freed by caller)
+ */
+char *symbol_to_ticker(const char *symbol);
+
+/**
+ * @brief Parse a CryptoCompare pricemultifull response
+ * 
+ * @param json_string JSON response string ({"RAW": {TICKER: {CURRENCY: {...}}}})
+ * @param id CoinGecko ID to store in the result
+ * @param ticker Ticker used in the request (e.g., "BTC")
+ * @param currency Currency code used (e.g., "usd"). If NULL, defaults to "usd"
+ * @return crypto_data_t Parsed data (success is 0 if the pair is missing)
+ */
+crypto_data_t parse_cryptocompare_json(const char *json_string, const char *id, const char *ticker,
+                                       const char *currency);
+
+/**
+ * @brief Parse OHLC JSON response and update high/low 24h values
+ * 
+ * @param json_string OHLC JSON response string (array of [timestamp, open, high, low, close])
+ * @param data Pointer to crypto_data_t structure to update with high/low values
+ * @return int 0 on success, -1 on error
+ */
+int parse_ohlc_json(const char *json_string, crypto_data_t *data);
+
+/**
+ * @brief OHLC candles, one array per column
+ *
+ * The arrays share one allocation owned by time_ms (see free_ohlc_series()).
+ */
+typedef struct {
+    int64_t *time_ms;   // Candle close time, milliseconds since the epoch
+    double *open;
+    double *high;
+    double *low;
+    double *close;
+    int count;
+    int success;
+} ohlc_series_t;
+
+/**
+ * @brief Parse an OHLC response into columns
+ * 
+ * @param json_string OHLC JSON response string (array of [timestamp, open, high, low, close])
+ * @return ohlc_series_t Candles in response order (malformed rows are skipped)
+ */
+ohlc_series_t parse_ohlc_series(const char *json_string);
+
+/**
+ * @brief Free memory allocated for an ohlc_series_t
+ */
+void free_ohlc_series(ohlc_series_t *series);
+
+/**
+ * @brief market_chart history, one array per column
+ *
+ * The arrays share one allocation owned by time_ms (see free_chart_series()).
+ */
+typedef struct {
+    int64_t *time_ms;     // Sample time, milliseconds since the epoch
+    double *price;
+    double *market_cap;   // NaN where the response has no matching sample
+    double *volume;       // NaN where the response has no matching sample
+    int count;
+    int success;
+} chart_series_t;
+
+/**
+ * @brief Parse a market_chart response into columns
+ * 
+ * @param json_string JSON response ({"prices": [[t, v], ...], "market_caps": ..., "total_volumes": ...})
+ * @return chart_series_t One row per price sample
+ */
+chart_series_t parse_market_chart_json(const char *json_string);
+
+/**
+ * @brief Free memory allocated for a chart_series_t
+ */
+void free_chart_series(chart_series_t *series);
+
+/**
+ * @brief Markets data structure (array of cryptocurrencies)
+ */
+typedef struct {
+    crypto_data_t *coins;
+    int count;
+    int success;
+} markets_data_t;
+
+/**
+ * @brief Parse markets JSON response (array of coin objects)
+ * 
+ * @param json_string Markets JSON response string
+ * @param limit Maximum number of coins to parse
+ * @return markets_data_t Parsed markets data structure
+ */
+markets_data_t parse_markets_json(const char *json_string, int limit);
+
+/**
+ * @brief Parse a markets response requested with vs_currency=currency
+ * 
+ * @param json_string Markets JSON response string
+ * @param limit Maximum number of coins to parse
+ * @param currency Currency code used in the request. If NULL, defaults to "usd"
+ * @return markets_data_t Parsed markets data structure
+ */
+markets_data_t parse_markets_json_with_currency(const char *json_string, int limit,
+                                                const char *currency);
+
+/**
+ * @brief Parse a markets response, filling only some fields
+ * 
+ * Unrequested keys are skipped and their strings never copied; the id and
+ * currency are always filled.
+ * 
+ * @param json_string Markets JSON response string
+ * @param limit Maximum number of coins to parse
+ * @param currency Currency code used in the request. If NULL, defaults to "usd"
+ * @param fields PLAN_* mask from planner.h (0 for every field)
+ * @return markets_data_t Parsed markets data structure
+ */
+markets_data_t parse_markets_json_fields(const char *json_string, int limit, const char *currency,
+                                         unsigned fields);
+
+/**
+ * @brief Parse a simple/price response that holds several coins
+ *
+ * @param json_string JSON response string (object keyed by coin id)
+ * @param currency Currency code used in the request. If NULL, defaults to "usd"
+ * @return markets_data_t One entry per coin, in response order
+ */
+markets_data_t parse_simple_price_batch_json(const char *json_string, const char *currency);
+
+/**
+ * @brief Parse a simple/price batch, filling only some fields
+ *
+ * Keys of unrequested fields are not looked up; the derived symbol and
+ * name are only built for PLAN_NAME.
+ *
+ * @param json_string JSON response string (object keyed by coin id)
+ * @param currency Currency code used in the request. If NULL, defaults to "usd"
+ * @param fields PLAN_* mask from planner.h (0 for every field)
+ * @return markets_data_t One entry per coin, in response order
+ */
+markets_data_t parse_simple_price_batch_json_fields(const char *json_string, const char *currency,
+                                                    unsigned fields);
+
+/**
+ * @brief Read prices of several coins in several currencies from simple/price
+ *
+ * @param json_string JSON response string (object keyed by coin id)
+ * @param ids Coin ids to look up
+ * @param id_count Number of ids
+ * @param currencies Lowercase currency codes to look up
+ * @param currency_count Number of currencies
+ * @param prices Output grid, prices[id * currency_count + currency] (NaN if missing)
+ * @return int Number of prices found, or -1 if the response is not a JSON object
+ */
+int parse_price_grid_json(const char *json_string, const char *const *ids, int id_count,
+                          const char *const *currencies, int currency_count, double *prices);
+
+/**
+ * @brief Free memory allocated for markets_data_t structure
+ * 
+ * @param data Pointer to markets_data_t structure to free
+ */
+void free_markets_data(markets_data_t *data);
+
+#endif /* PARSER_H */
+
@@ -0,0 +1,54 @@
+#ifndef PATHS_H
+#define PATHS_H
+
+/**
+ * @file paths.h
+ * @brief Location of on-disk state (quote store and other caches)
+ *
+ * The cache directory is $CRYPTO_CLI_CACHE_DIR if set, otherwise
+ * $XDG_CACHE_HOME/crypto-cli, otherwise ~/.cache/crypto-cli.
+ */
+
+#include <stddef.h>
+
+/**
+ * @brief Get the cache directory, creating it if needed
+ *
+ * @param out Output buffer for the path
+ * @param size Size of the output buffer
+ * @return int 0 on success, -1 if no directory could be determined or created
+ */
+int paths_cache_dir(char *out, size_t size);
+
+/**
+ * @brief Get a subdirectory of the cache directory, creating it if needed
+ *
+ * @param subdir Subdirectory (e.g., "snapshots/archive")
+ * @param out Output buffer for the path
+ * @param size Size of the output buffer
+ * @return int 0 on success, -1 on error or truncation
+ */
+int paths_cache_subdir(const char *subdir, char *out, size_t size);
+
+/**
+ * @brief Build the path of a file inside a cache subdirectory
+ *
+ * The subdirectory is created if needed; the file itself is not.
+ *
+ * @param subdir Subdirectory of the cache directory (e.g., "quotes")
+ * @param name File name
+ * @param out Output buffer for the path
+ * @param size Size of the output buffer
+ * @return int 0 on success, -1 on error or truncation
+ */
+int paths_cache_file(const char *subdir, const char *name, char *out, size_t size);
+
+/**
+ * @brief Create a directory and any missing parents (mkdir -p)
+ *
+ * @param path Directory to create
+ * @return int 0 if the directory exists afterwards, -1 on error
+ */
+int paths_make_dir(const char *path);
+
+#endif /* PATHS_H */
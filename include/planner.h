@@ -0,0 +1,86 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+/**
+ * @file planner.h
+ * @brief Maps the fields a command needs onto the fewest CoinGecko requests
+ *
+ * Each endpoint is described by the fields its response carries and a
+ * relative cost (response size). A plan is the smallest set of endpoints
+ * whose fields cover the request, cheapest first among equally small sets.
+ * Both endpoints take a list of ids and any vs currency, so every plan for
+ * the current field set is a single round trip.
+ */
+
+#include "parser.h"
+
+/** Fields of a quote (bit mask) */
+#define PLAN_PRICE         0x01u
+#define PLAN_CHANGE_24H    0x02u
+#define PLAN_MARKET_CAP    0x04u
+#define PLAN_VOLUME_24H    0x08u
+#define PLAN_HIGH_LOW_24H  0x10u
+#define PLAN_LAST_UPDATED  0x20u
+#define PLAN_NAME          0x40u   // Listed name and symbol (otherwise derived from the id)
+#define PLAN_ALL           0x7Fu
+
+/** Maximum number of endpoints in one plan */
+#define PLAN_MAX_ENDPOINTS 4
+
+/**
+ * @brief An endpoint the planner can choose
+ */
+typedef struct {
+    const char *name;
+    unsigned provides;        // PLAN_* fields in the response
+    int cost;                 // Relative response size per coin
+    /** Build the request URL for comma-separated ids, asking only for fields where the API allows (caller frees) */
+    char *(*url)(const char *ids, const char *currency, unsigned fields);
+    /** Parse the response into one entry per coin, filling only fields */
+    markets_data_t (*parse)(const char *json, const char *currency, unsigned fields);
+} plan_endpoint_t;
+
+/**
+ * @brief Endpoints to request, in no particular order
+ */
+typedef struct {
+    const plan_endpoint_t *endpoints[PLAN_MAX_ENDPOINTS];
+    int count;
+    unsigned fields;          // Fields the plan delivers (a superset of the request)
+} query_plan_t;
+
+/**
+ * @brief Plan the requests for a set of fields
+ *
+ * @param fields PLAN_* mask (0 means PLAN_ALL)
+ * @param plan Output plan
+ * @return int 0 on success, -1 if no combination of endpoints covers the fields
+ */
+int planner_plan(unsigned fields, query_plan_t *plan);
+
+/**
+ * @brief Fetch the quote of one coin with a single-endpoint plan
+ *
+ * @param endpoint Endpoint from a plan
+ * @param json Response of endpoint->url()
+ * @param id CoinGecko ID that was requested
+ * @param currency Currency that was requested
+ * @param fields PLAN_* fields to fill (0 means PLAN_ALL)
+ * @return crypto_data_t Quote (success is 0 if the response has no entry for id)
+ */
+crypto_data_t planner_parse_quote(const plan_endpoint_t *endpoint, const char *json,
+                                  const char *id, const char *currency, unsigned fields);
+
+/**
+ * @brief Parse a --fields list such as "price,change_24h"
+ *
+ * Names: price, change_24h (or change_percentage_24h), market_cap,
+ * volume_24h, high_24h / low_24h, last_updated, name / symbol, all.
+ *
+ * @param list Comma-separated field names
+ * @param fields Output PLAN_* mask
+ * @return int 0 on success, -1 on an unknown or empty name
+ */
+int planner_parse_fields(const char *list, unsigned *fields);
+
+#endif /* PLANNER_H */
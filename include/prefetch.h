@@ -0,0 +1,35 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+/**
+ * @file prefetch.h
+ * @brief Predictive warm-up of the quote store from the usage log
+ *
+ * The hot pairs of the usage log (see usage.h) whose stored quotes are
+ * missing or past half their max-age are fetched with one batched request
+ * per currency and saved to the quote store, so the next interactive
+ * lookup of a hot coin is served locally.
+ */
+
+/** Hot pairs considered per warm-up */
+#define PREFETCH_MAX_PAIRS 20
+
+/** Ids per batched request */
+#define PREFETCH_CHUNK 100
+
+/**
+ * @brief Seconds between warm-ups for a given max-age
+ */
+long prefetch_interval(long max_age);
+
+/**
+ * @brief Run a warm-up (meant for a detached child process)
+ *
+ * Returns at once if another warm-up holds the lock.
+ *
+ * @param max_age Seconds a stored quote counts as fresh
+ * @return int Number of quotes saved, or -1 if nothing was attempted
+ */
+int prefetch_run(long max_age);
+
+#endif /* PREFETCH_H */
@@ -0,0 +1,68 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+/**
+ * @file profile.h
+ * @brief Per-stage CPU time and allocation counters (--profile)
+ *
+ * Stages are opened and closed around the work of one command; they do not
+ * nest. Each stage accumulates wall time on the monotonic clock, elapsed
+ * CPU cycles (time stamp counter where the CPU has one) and the allocations
+ * made while it was open, counted by the allocator hook in allochook.c.
+ * The report is written to stderr as one JSON object when the process exits.
+ *
+ * All calls are no-ops until profile_enable() is called.
+ */
+
+#include <stddef.h>
+
+/**
+ * @brief Stages of a command
+ */
+typedef enum {
+    PROFILE_RESOLVE,    // Symbol to id
+    PROFILE_URL,        // Request URL build
+    PROFILE_FETCH,      // Network transfer (or replay)
+    PROFILE_PARSE,      // JSON parsing
+    PROFILE_STORE,      // Local quote store and snapshots
+    PROFILE_RENDER,     // Output
+    PROFILE_STAGE_COUNT
+} profile_stage_t;
+
+/**
+ * @brief Start profiling and register the report for exit
+ *
+ * Call early in main(), before any thread starts.
+ */
+void profile_enable(void);
+
+/**
+ * @brief Non-zero once profile_enable() has been called
+ */
+int profile_enabled(void);
+
+/**
+ * @brief Open a stage
+ */
+void profile_begin(profile_stage_t stage);
+
+/**
+ * @brief Close a stage opened by profile_begin()
+ */
+void profile_end(profile_stage_t stage);
+
+/**
+ * @brief Count an allocation (called by the allocator hook)
+ *
+ * @param size Usable size of the block
+ */
+void profile_note_alloc(size_t size);
+
+/**
+ * @brief Count a release (called by the allocator hook)
+ *
+ * @param size Usable size of the block
+ */
+void profile_note_free(size_t size);
+
+#endif /* PROFILE_H */
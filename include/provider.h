@@ -0,0 +1,103 @@
+#ifndef PROVIDER_H
+#define PROVIDER_H
+
+/**
+ * @file provider.h
+ * @brief Pluggable quote providers (CoinGecko, CryptoCompare)
+ *
+ * A provider turns a quote query into a request URL and parses the
+ * response into a crypto_data_t. Every request updates per-provider latency
+ * and error statistics, persisted in the cache directory, which order the
+ * providers for the next lookup.
+ *
+ * Base URLs can be overridden for testing against local fixture servers:
+ * CRYPTO_CLI_COINGECKO_URL and CRYPTO_CLI_CRYPTOCOMPARE_URL.
+ */
+
+#include "parser.h"
+
+/** Maximum number of registered providers */
+#define PROVIDER_MAX 8
+
+/** Latency charged per unit of error rate when ranking providers */
+#define PROVIDER_ERROR_PENALTY_MS 5000.0
+
+/**
+ * @brief What to quote
+ */
+typedef struct {
+    const char *id;         // CoinGecko ID (e.g., "bitcoin")
+    const char *symbol;     // Symbol as given by the user (e.g., "btc")
+    const char *currency;   // Lowercase currency code (e.g., "usd")
+    unsigned fields;        // PLAN_* fields needed (0 for all); see planner.h
+} quote_query_t;
+
+/**
+ * @brief A quote provider
+ */
+typedef struct {
+    const char *name;
+    /** Build the request URL (caller frees), or NULL if the query is unsupported */
+    char *(*quote_url)(const quote_query_t *query);
+    /** Parse a response; success is 0 if it holds no quote for the query */
+    crypto_data_t (*parse_quote)(const char *json, const quote_query_t *query);
+} provider_t;
+
+/**
+ * @brief Live statistics of one provider
+ */
+typedef struct {
+    double latency_ms;      // Exponentially weighted mean latency of answered requests
+    double error_rate;      // Exponentially weighted failure rate (0..1)
+    unsigned long requests;
+    unsigned long errors;
+} provider_stats_t;
+
+/**
+ * @brief Result codes of provider_fetch_quote()
+ */
+typedef enum {
+    PROVIDER_OK = 0,
+    PROVIDER_ERR_NETWORK = -1,     // No provider answered
+    PROVIDER_ERR_NOT_FOUND = -2    // Providers answered but had no quote
+} provider_result_t;
+
+/**
+ * @brief Number of registered providers
+ */
+int provider_count(void);
+
+/**
+ * @brief Provider by index (0 .. provider_count() - 1)
+ */
+const provider_t *provider_at(int index);
+
+/**
+ * @brief Provider by name (case-insensitive), or NULL
+ */
+const provider_t *provider_find(const char *name);
+
+/**
+ * @brief Statistics of a provider (loaded from disk on first use)
+ */
+provider_stats_t provider_get_stats(const provider_t *provider);
+
+/**
+ * @brief Fetch a quote
+ *
+ * With a provider name only that provider is asked. Otherwise providers
+ * are tried in order of their statistics (lowest latency plus error
+ * penalty first) until one returns a quote, or, with race set, all are
+ * asked in parallel and the first valid quote wins.
+ *
+ * @param query What to quote
+ * @param provider_name Provider to use, or NULL for automatic selection
+ * @param race Query all providers in parallel
+ * @param out Output quote (free with free_crypto_data())
+ * @param used Output: name of the provider that answered (may be NULL)
+ * @return int PROVIDER_OK or a negative provider_result_t
+ */
+int provider_fetch_quote(const quote_query_t *query, const char *provider_name, int race,
+                         crypto_data_t *out, const char **used);
+
+#endif /* PROVIDER_H */
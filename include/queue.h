@@ -0,0 +1,71 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+/**
+ * @file queue.h
+ * @brief Bounded lock-free single-producer/single-consumer queue
+ *
+ * Used to connect pipeline stages that each run on their own thread. Only
+ * one thread may push and only one thread may pop a given queue.
+ */
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+/**
+ * @brief Ring buffer of pointers
+ */
+typedef struct {
+    void **slots;
+    size_t mask;               // capacity - 1 (capacity is a power of two)
+    _Atomic size_t head;       // Next slot to pop (written by consumer)
+    _Atomic size_t tail;       // Next slot to push (written by producer)
+    atomic_int closed;         // Producer finished; no more pushes
+} spsc_queue_t;
+
+/**
+ * @brief Initialise a queue
+ *
+ * @param q Queue
+ * @param capacity Minimum capacity (rounded up to a power of two)
+ * @return int 0 on success, -1 on allocation failure
+ */
+int spsc_queue_init(spsc_queue_t *q, size_t capacity);
+
+/**
+ * @brief Push without blocking
+ *
+ * @return int 1 if pushed, 0 if the queue is full
+ */
+int spsc_queue_try_push(spsc_queue_t *q, void *item);
+
+/**
+ * @brief Pop without blocking
+ *
+ * @return int 1 if an item was popped into *item, 0 if the queue is empty
+ */
+int spsc_queue_try_pop(spsc_queue_t *q, void **item);
+
+/**
+ * @brief Push, backing off while the queue is full
+ */
+void spsc_queue_push(spsc_queue_t *q, void *item);
+
+/**
+ * @brief Pop, backing off while the queue is empty
+ *
+ * @return int 1 if an item was popped, 0 if the queue is closed and drained
+ */
+int spsc_queue_pop(spsc_queue_t *q, void **item);
+
+/**
+ * @brief Mark the end of the stream (producer side)
+ */
+void spsc_queue_close(spsc_queue_t *q);
+
+/**
+ * @brief Free the ring (items still queued are not freed)
+ */
+void spsc_queue_destroy(spsc_queue_t *q);
+
+#endif /* QUEUE_H */
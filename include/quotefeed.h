@@ -0,0 +1,202 @@
+#ifndef QUOTEFEED_H
+#define QUOTEFEED_H
+
+/**
+ * @file quotefeed.h
+ * @brief Shared-memory quote feed ("crypto feed --shm NAME") and its reader API
+ *
+ * One writer process publishes the latest quote of a fixed set of coins
+ * into a POSIX shared-memory object; any number of reader processes map
+ * it read-only:
+ *
+ *     header | slots (one quote_slot_t per coin, 64-byte aligned)
+ *            | ring (QUOTE_FEED_RING quote_update_t entries)
+ *
+ * Each slot is guarded by a seqlock: the writer makes the sequence odd,
+ * writes the record and makes it even again. A reader copies the record
+ * between two reads of the sequence and keeps the copy if both are the
+ * same even number. Every publish also appends the slot number to a
+ * single-writer ring, so readers can follow changes in order instead of
+ * scanning all slots. Reading needs no syscalls and no locks, and a reader
+ * never blocks the writer or other readers.
+ *
+ * The reader functions only need this file and quotefeed.c, not libcurl.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <sys/types.h>
+#include "parser.h"
+
+/** File magic and layout version */
+#define QUOTE_FEED_MAGIC "CCFEED01"
+#define QUOTE_FEED_VERSION 1
+
+/** Entries in the update ring (a power of two) */
+#define QUOTE_FEED_RING 4096
+
+/** Copy attempts of quote_feed_read() before it reports a busy slot */
+#define QUOTE_FEED_READ_RETRIES 64
+
+/** Refresh intervals without a heartbeat after which a writer counts as stopped */
+#define QUOTE_FEED_STALE_INTERVALS 3
+
+/** Seconds an unlocked, half-built segment is left to its creator before it counts as abandoned */
+#define QUOTE_FEED_CREATE_GRACE 2
+
+/**
+ * @brief A quote as stored in the segment (no pointers)
+ */
+typedef struct {
+    char id[64];
+    char symbol[16];
+    char name[64];
+    char currency[8];
+    double current_price;
+    double price_change_24h;
+    double price_change_percentage_24h;
+    double market_cap;
+    double volume_24h;
+    double high_24h;
+    double low_24h;
+    int64_t last_updated_at;   // Unix time reported by the API
+    int64_t published_ns;      // CLOCK_REALTIME of the publish
+} quote_record_t;
+
+/**
+ * @brief One coin: seqlock sequence plus record
+ */
+typedef struct {
+    _Alignas(64) _Atomic uint64_t seq;   // Odd while the writer is updating the record
+    quote_record_t record;               // 0 seq: never published
+} quote_slot_t;
+
+/**
+ * @brief One entry of the update ring
+ */
+typedef struct {
+    _Atomic uint64_t stamp;      // Ring position + 1 once the entry is complete
+    _Atomic uint32_t slot;       // Slot that was updated
+    uint32_t reserved;
+    _Atomic uint64_t slot_seq;   // Slot sequence after the update
+} quote_update_t;
+
+/**
+ * @brief Segment header
+ */
+typedef struct {
+    char magic[8];                     // Written last: a reader never sees a half-built segment
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t ring_size;
+    uint32_t interval;                 // Seconds between refreshes
+    uint64_t slots_offset;
+    uint64_t ring_offset;
+    int64_t writer_pid;
+    _Atomic uint64_t head;             // Updates published so far
+    _Atomic int64_t heartbeat_ns;      // CLOCK_REALTIME of the writer's last refresh
+} quote_feed_header_t;
+
+/**
+ * @brief A mapped feed
+ */
+typedef struct {
+    void *base;
+    size_t size;
+    quote_feed_header_t *header;
+    quote_slot_t *slots;
+    quote_update_t *ring;
+    int writer;
+    int lock_fd;                 // Writer: segment descriptor holding its flock
+    dev_t dev;                   // Identity of the writer's segment, so close
+    ino_t ino;                   // only unlinks the name while it is still ours
+    char name[256];
+} quote_feed_t;
+
+/**
+ * @brief Create a feed segment and map it for writing
+ *
+ * The writer holds an exclusive flock on the segment until it closes the
+ * feed or exits. An existing segment of the same name is only replaced
+ * when its writer has stopped: nobody holds its lock (and it is complete,
+ * or older than QUOTE_FEED_CREATE_GRACE seconds), or its heartbeat is more
+ * than QUOTE_FEED_STALE_INTERVALS intervals old. Otherwise this fails
+ * with EEXIST.
+ *
+ * @param name Shared-memory object name (e.g. "/crypto-quotes")
+ * @param ids Coin ids, one slot each, in slot order
+ * @param count Number of ids
+ * @param interval Seconds between refreshes (lets readers judge liveness)
+ * @param feed Output feed
+ * @return int 0 on success, -1 on error (errno set)
+ */
+int quote_feed_create(const char *name, const char *const *ids, int count, int interval,
+                      quote_feed_t *feed);
+
+/**
+ * @brief Publish the latest quote of a slot and append it to the ring
+ *
+ * Only the process that created the feed may call this.
+ */
+void quote_feed_publish(quote_feed_t *feed, int slot, const crypto_data_t *quote);
+
+/**
+ * @brief Mark the writer alive (call after every refresh)
+ */
+void quote_feed_heartbeat(quote_feed_t *feed);
+
+/**
+ * @brief Unmap a feed; the writer also removes the segment unless the name
+ * has since been taken over by another writer
+ */
+void quote_feed_close(quote_feed_t *feed);
+
+/**
+ * @brief Map an existing feed read-only and validate its layout
+ *
+ * @return int 0 on success, -1 if missing, incomplete or incompatible
+ */
+int quote_feed_open(const char *name, quote_feed_t *feed);
+
+/**
+ * @brief Slot of a coin id, or -1
+ */
+int quote_feed_find(const quote_feed_t *feed, const char *id);
+
+/**
+ * @brief Consistent copy of a slot's record
+ *
+ * Bounded: gives up after QUOTE_FEED_READ_RETRIES torn copies.
+ *
+ * @return int 0 on success, 1 if never published, -1 if out of range or busy
+ */
+int quote_feed_read(const quote_feed_t *feed, int slot, quote_record_t *out);
+
+/**
+ * @brief Next update after a cursor
+ *
+ * Start with *cursor = quote_feed_head() to see only new updates, or 0 to
+ * replay what the ring still holds. A reader that falls more than a ring
+ * behind skips to the oldest entry still held and adds the skipped updates
+ * to *lost.
+ *
+ * @param feed Mapped feed
+ * @param cursor Ring position to read next (advanced)
+ * @param slot Output: slot that was updated
+ * @param lost Output: updates skipped (added to; may be NULL)
+ * @return int 1 if an update was returned, 0 if the reader is up to date
+ */
+int quote_feed_next(const quote_feed_t *feed, uint64_t *cursor, uint32_t *slot, uint64_t *lost);
+
+/**
+ * @brief Number of updates published so far
+ */
+uint64_t quote_feed_head(const quote_feed_t *feed);
+
+/**
+ * @brief Age of the writer's last heartbeat in milliseconds (-1 if none yet)
+ */
+long quote_feed_heartbeat_age_ms(const quote_feed_t *feed);
+
+#endif /* QUOTEFEED_H */
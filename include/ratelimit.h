@@ -0,0 +1,53 @@
+#ifndef RATELIMIT_H
+#define RATELIMIT_H
+
+/**
+ * @file ratelimit.h
+ * @brief Thread-safe token bucket for pacing API requests
+ */
+
+#include <pthread.h>
+
+/**
+ * @brief Token bucket state
+ */
+typedef struct {
+    double rate;          // Tokens added per second
+    double burst;         // Bucket capacity
+    double tokens;        // Tokens currently available
+    double last;          // Monotonic time of the last refill (seconds)
+    pthread_mutex_t lock;
+} ratelimit_t;
+
+/**
+ * @brief Initialise a token bucket (starts full)
+ *
+ * @param rl Bucket to initialise
+ * @param per_minute Sustained requests per minute (<= 0 disables limiting)
+ * @param burst Requests allowed back-to-back before pacing kicks in
+ */
+void ratelimit_init(ratelimit_t *rl, double per_minute, double burst);
+
+/**
+ * @brief Take one token, sleeping until one is available
+ *
+ * @param rl Bucket
+ */
+void ratelimit_acquire(ratelimit_t *rl);
+
+/**
+ * @brief Take one token if available without sleeping
+ *
+ * @param rl Bucket
+ * @return int 1 if a token was taken, 0 otherwise
+ */
+int ratelimit_try_acquire(ratelimit_t *rl);
+
+/**
+ * @brief Release resources held by a bucket
+ *
+ * @param rl Bucket
+ */
+void ratelimit_destroy(ratelimit_t *rl);
+
+#endif /* RATELIMIT_H */
@@ -0,0 +1,41 @@
+#ifndef RATES_H
+#define RATES_H
+
+/**
+ * @file rates.h
+ * @brief Cross-rate kernel: rate[i][j] = value[i] / value[j]
+ *
+ * Every asset is first reduced to its value in one reference currency, so
+ * an N x M matrix needs N + M prices rather than N x M quotes. The kernel
+ * multiplies by precomputed reciprocals and works in tiles of columns so a
+ * block of rows reuses the same reciprocals while they are in L1.
+ */
+
+/** Rows produced per rates_block() call by callers that stream the matrix */
+#define RATES_BLOCK_ROWS 16
+
+/** Columns per tile (512 doubles = 4 KB of reciprocals) */
+#define RATES_BLOCK_COLS 512
+
+/**
+ * @brief Reciprocals of the column values
+ *
+ * @param values Column values in the reference currency
+ * @param count Number of columns
+ * @param inverse Output, 1 / values[j] (NaN for missing or non-positive values)
+ */
+void rates_prepare(const double *values, int count, double *inverse);
+
+/**
+ * @brief Compute a block of matrix rows
+ *
+ * @param row_values Values of the rows in the reference currency
+ * @param rows Number of rows in the block
+ * @param inverse Column reciprocals from rates_prepare()
+ * @param cols Number of columns
+ * @param out Output, rows x cols, row-major
+ */
+void rates_block(const double *row_values, int rows, const double *inverse, int cols,
+                 double *out);
+
+#endif /* RATES_H */
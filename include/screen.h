@@ -0,0 +1,92 @@
+#ifndef SCREEN_H
+#define SCREEN_H
+
+/**
+ * @file screen.h
+ * @brief Double-buffered terminal screen with incremental redraw
+ *
+ * Frames are drawn into a back buffer of cells; screen_flush() compares it
+ * with what is already on the terminal and emits cursor moves, attribute
+ * changes and glyphs only for the cells that differ.
+ */
+
+#include <stddef.h>
+
+/** Cell attributes (bitmask) */
+#define SCREEN_ATTR_NONE    0x00
+#define SCREEN_ATTR_BOLD    0x01
+#define SCREEN_ATTR_DIM     0x02
+#define SCREEN_ATTR_REVERSE 0x04
+#define SCREEN_ATTR_GREEN   0x08
+#define SCREEN_ATTR_RED     0x10
+
+/**
+ * @brief One terminal cell: a single UTF-8 encoded glyph plus attributes
+ */
+typedef struct {
+    char glyph[5];        // NUL-terminated UTF-8 sequence (1-4 bytes)
+    unsigned char attr;
+} screen_cell_t;
+
+/**
+ * @brief Screen state
+ */
+typedef struct {
+    int rows;
+    int cols;
+    screen_cell_t *front;  // What the terminal currently shows
+    screen_cell_t *back;   // Frame being drawn
+    int full_redraw;       // Next flush repaints everything
+    char *out;             // Output staging buffer (one write per frame)
+    size_t out_len;
+    size_t out_cap;
+} screen_t;
+
+/**
+ * @brief Allocate buffers for a rows x cols screen
+ *
+ * @return int 0 on success, -1 on allocation failure
+ */
+int screen_init(screen_t *screen, int rows, int cols);
+
+/**
+ * @brief Resize the buffers (after SIGWINCH); forces a full repaint
+ *
+ * @return int 0 on success, -1 on allocation failure
+ */
+int screen_resize(screen_t *screen, int rows, int cols);
+
+/**
+ * @brief Blank the back buffer before drawing a new frame
+ */
+void screen_clear(screen_t *screen);
+
+/**
+ * @brief Draw UTF-8 text into the back buffer, clipped to the screen
+ *
+ * Every code point occupies one column (true for the box drawing
+ * characters, arrows and ASCII the dashboard uses).
+ *
+ * @param row Row (0-based)
+ * @param col Column (0-based)
+ * @param text UTF-8 text
+ * @param attr Attributes for all cells written
+ * @return int Number of columns written
+ */
+int screen_put(screen_t *screen, int row, int col, const char *text, unsigned char attr);
+
+/**
+ * @brief Emit the difference between back and front buffers to fd
+ *
+ * @param screen Screen
+ * @param fd Output file descriptor (usually STDOUT_FILENO)
+ * @return int Number of bytes written, -1 on error
+ */
+int screen_flush(screen_t *screen, int fd);
+
+/**
+ * @brief Free screen buffers
+ */
+void screen_free(screen_t *screen);
+
+#endif /* SCREEN_H */
@@ -0,0 +1,38 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+/**
+ * @file search.h
+ * @brief Fuzzy coin search ("crypto search") and "did you mean" hints
+ *
+ * Searches the trigram index (coinindex.h) built from CoinGecko's
+ * /coins/list. The index lives in the cache directory and is rebuilt by
+ * "crypto search" when it is missing, older than a week or --refresh is
+ * given. Suggestions only read an existing index, never the network.
+ */
+
+#include "options.h"
+
+/** Age after which "crypto search" rebuilds the index (seconds) */
+#define SEARCH_INDEX_MAX_AGE (7L * 24 * 3600)
+
+/**
+ * @brief Entry point for "crypto search TEXT... [--limit N] [--refresh]"
+ *
+ * @param argc Argument count (argv[0] is "search")
+ * @param argv Arguments
+ * @param options Global options (output format)
+ * @return int Process exit code
+ */
+int search_command(int argc, char *argv[], const cli_options_t *options);
+
+/**
+ * @brief Print "did you mean" candidates for an unknown coin to stderr
+ *
+ * Uses the index on disk if there is one; prints nothing otherwise.
+ *
+ * @param query What the user typed
+ */
+void search_suggest(const char *query);
+
+#endif /* SEARCH_H */
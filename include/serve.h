@@ -0,0 +1,23 @@
+#ifndef SERVE_H
+#define SERVE_H
+
+/**
+ * @file serve.h
+ * @brief Prometheus/OpenMetrics exporter ("crypto serve")
+ *
+ * A refresher thread fetches quotes for a fixed coin set on an interval and
+ * renders the complete /metrics HTTP response into a new buffer, which is
+ * handed to the server thread with an atomic exchange. Scrapes only write
+ * out the current buffer: no upstream calls and no formatting per request.
+ */
+
+/**
+ * @brief Entry point for "crypto serve [--listen HOST:PORT] [--coins IDS] ..."
+ *
+ * @param argc Argument count (argv[0] is "serve")
+ * @param argv Arguments
+ * @return int Process exit code
+ */
+int serve_command(int argc, char *argv[]);
+
+#endif /* SERVE_H */
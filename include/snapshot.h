@@ -0,0 +1,128 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/**
+ * @file snapshot.h
+ * @brief Binary snapshots of parsed market data, loaded by mmap
+ *
+ * A snapshot stores a markets_data_t (top coins or a quote set) column by
+ * column so it can be used straight from the mapped file without parsing:
+ *
+ *     header | price | change | change % | market cap | volume | high | low
+ *            | last updated | string index (id, symbol, name per coin)
+ *            | string table (NUL-terminated)
+ *
+ * Every column starts on an 8-byte boundary. Files are written in native
+ * byte order; snapshots from a machine with another byte order are
+ * rejected on load.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "parser.h"
+
+/**
+ * @brief A mapped snapshot (all pointers point into the mapping)
+ */
+typedef struct {
+    void *base;                  // Start of the mapping
+    size_t size;                 // Size of the mapping
+    uint32_t count;              // Number of coins
+    int64_t created_at;          // When the snapshot was written (Unix time)
+    const char *currency;        // Currency of the numeric columns
+    const double *price;
+    const double *change_24h;
+    const double *change_percentage_24h;
+    const double *market_cap;
+    const double *volume_24h;
+    const double *high_24h;
+    const double *low_24h;
+    const int64_t *last_updated_at;
+    const uint32_t *strings;     // 3 string table offsets per coin: id, symbol, name
+    const char *string_table;
+    uint32_t string_table_size;
+} markets_snapshot_t;
+
+/**
+ * @brief Write a snapshot atomically (temp file + rename)
+ *
+ * @param path Destination file
+ * @param markets Parsed data (coins without success are skipped)
+ * @param currency Currency of the data (e.g., "usd")
+ * @return int 0 on success, -1 on error
+ */
+int snapshot_write(const char *path, const markets_data_t *markets, const char *currency);
+
+/**
+ * @brief Map a snapshot and validate its layout
+ *
+ * Only the header is checked, so opening costs the same for any number of
+ * coins.
+ *
+ * @param path Snapshot file
+ * @param snapshot Output view (release with snapshot_close())
+ * @return int 0 on success, -1 if missing, truncated or incompatible
+ */
+int snapshot_open(const char *path, markets_snapshot_t *snapshot);
+
+/**
+ * @brief Unmap a snapshot
+ */
+void snapshot_close(markets_snapshot_t *snapshot);
+
+/**
+ * @brief String of a coin ("" if the offset is out of range)
+ *
+ * @param snapshot Snapshot
+ * @param index Coin index
+ * @param field 0 = id, 1 = symbol, 2 = name
+ */
+const char *snapshot_string(const markets_snapshot_t *snapshot, uint32_t index, int field);
+
+/** String fields for snapshot_string() */
+#define SNAPSHOT_ID 0
+#define SNAPSHOT_SYMBOL 1
+#define SNAPSHOT_NAME 2
+
+/** Cache subdirectory of the snapshots, and the latest top coins in it */
+#define SNAPSHOT_DIR "snapshots"
+#define SNAPSHOT_MARKETS "markets.usd.snap"
+
+/** Cache subdirectory of older snapshots kept for comparisons */
+#define SNAPSHOT_ARCHIVE_DIR "snapshots/archive"
+
+/** At most one archived snapshot per this many seconds */
+#define SNAPSHOT_ARCHIVE_INTERVAL 300
+
+/** Archived snapshots older than this (seconds) are deleted */
+#define SNAPSHOT_ARCHIVE_KEEP (7 * 24 * 3600)
+
+/**
+ * @brief Keep a copy of a snapshot in an archive directory
+ *
+ * The archived name is <name>.<created_at>, a hard link to the snapshot,
+ * so archiving copies no data; a later snapshot_write() to path replaces
+ * the directory entry and leaves the archived file as it was. Nothing is
+ * archived if the newest copy is less than SNAPSHOT_ARCHIVE_INTERVAL
+ * older; copies older than SNAPSHOT_ARCHIVE_KEEP are removed.
+ *
+ * @param path Snapshot file
+ * @param dir Archive directory (must exist)
+ * @param name File name of the snapshot (e.g., SNAPSHOT_MARKETS)
+ * @return int 0 on success (including when nothing was due), -1 on error
+ */
+int snapshot_archive(const char *path, const char *dir, const char *name);
+
+/**
+ * @brief Find the newest archived snapshot created at or before a time
+ *
+ * @param dir Archive directory
+ * @param name File name the snapshot was archived under
+ * @param at Unix time
+ * @param out Output buffer for the path
+ * @param size Size of the output buffer
+ * @return int 0 if one was found, -1 otherwise
+ */
+int snapshot_archive_find(const char *dir, const char *name, int64_t at, char *out, size_t size);
+
+#endif /* SNAPSHOT_H */
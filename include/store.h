@@ -0,0 +1,52 @@
+#ifndef STORE_H
+#define STORE_H
+
+/**
+ * @file store.h
+ * @brief Local store of recently fetched quotes
+ *
+ * One small fixed-size record per coin and currency under the cache
+ * directory (see paths.h). Records are replaced atomically, so a reader
+ * never sees a half-written quote while a background refresh saves one.
+ */
+
+#include "parser.h"
+
+/**
+ * @brief Save a quote (keyed by data->id and data->currency)
+ *
+ * @param data Successfully fetched quote
+ * @return int 0 on success, -1 on error
+ */
+int store_save_quote(const crypto_data_t *data);
+
+/**
+ * @brief Load a stored quote
+ *
+ * @param id CoinGecko ID (e.g., "bitcoin")
+ * @param currency Currency code (e.g., "usd")
+ * @param data Output quote (free with free_crypto_data())
+ * @param fetched_at Output: when the quote was saved (Unix time, may be NULL)
+ * @return int 0 if found, -1 if missing or unreadable
+ */
+int store_load_quote(const char *id, const char *currency, crypto_data_t *data, long *fetched_at);
+
+/**
+ * @brief Age of a quote in seconds, judged against last_updated_at
+ *
+ * Falls back to fetched_at when the API did not report an update time.
+ */
+long store_quote_age(const crypto_data_t *data, long fetched_at);
+
+/**
+ * @brief Claim the right to refresh a quote
+ *
+ * Takes an advisory lock so that repeated invocations do not start
+ * several refreshes of the same coin. The lock is released when the
+ * returned descriptor is closed or the process exits.
+ *
+ * @return int Lock descriptor, or -1 if another refresh holds the lock
+ */
+int store_lock_refresh(const char *id, const char *currency);
+
+#endif /* STORE_H */
@@ -0,0 +1,81 @@
+#ifndef USAGE_H
+#define USAGE_H
+
+/**
+ * @file usage.h
+ * @brief Frequency/recency log of quoted coins, for predictive prefetch
+ *
+ * Each (id, currency) pair that is quoted gets a score that grows by one
+ * per use and halves every USAGE_HALF_LIFE seconds, so it reflects both
+ * how often and how recently the pair was asked for. The log keeps the
+ * USAGE_MAX_ENTRIES best pairs in a small text file in the cache directory
+ * ("usage"), replaced atomically on every save.
+ */
+
+/** Pairs kept in the log */
+#define USAGE_MAX_ENTRIES 64
+
+/** Seconds for an unused score to halve */
+#define USAGE_HALF_LIFE (3L * 24 * 3600)
+
+/** Score from which a pair counts as hot (about two recent uses) */
+#define USAGE_HOT_SCORE 1.5
+
+/**
+ * @brief One tracked pair
+ */
+typedef struct {
+    char id[64];
+    char currency[16];
+    double score;       // Decayed use count as of last_used
+    long last_used;     // Unix time
+} usage_entry_t;
+
+/**
+ * @brief The whole log
+ */
+typedef struct {
+    usage_entry_t entries[USAGE_MAX_ENTRIES];
+    int count;
+    long last_prefetch;   // When the last warm-up was started (Unix time)
+} usage_log_t;
+
+/**
+ * @brief Load the log (an empty log if there is none yet)
+ */
+void usage_load(usage_log_t *log);
+
+/**
+ * @brief Save the log atomically
+ *
+ * @return int 0 on success, -1 on error
+ */
+int usage_save(const usage_log_t *log);
+
+/**
+ * @brief Count one use of a pair
+ *
+ * A new pair replaces the entry with the lowest current score when the
+ * log is full.
+ */
+void usage_touch(usage_log_t *log, const char *id, const char *currency, long now);
+
+/**
+ * @brief Hot pairs, highest current score first
+ *
+ * @param log Loaded log
+ * @param now Current Unix time
+ * @param out Output entries (score decayed to now)
+ * @param max Capacity of out
+ * @return int Number of entries written
+ */
+int usage_hot(const usage_log_t *log, long now, usage_entry_t *out, int max);
+
+/**
+ * @brief Claim the right to run a warm-up
+ *
+ * @return int Lock descriptor (released on close or exit), or -1 if a warm-up is running
+ */
+int usage_lock_prefetch(void);
+
+#endif /* USAGE_H */
@@ -0,0 +1,36 @@
+#!/bin/sh
+# Measure startup + exit time of crypto-cli for commands that never hit the
+# network. Usage: scripts/bench-startup.sh [BINARY] [RUNS]
+
+BIN=${1:-bin/crypto}
+RUNS=${2:-1000}
+
+if [ ! -x "$BIN" ]; then
+    echo "Binary not found: $BIN (run make first)" >&2
+    exit 1
+fi
+
+now_ns() {
+    date +%s%N
+}
+
+bench() {
+    label=$1
+    shift
+    # Warm the page cache so the first run does not skew the mean
+    "$BIN" "$@" > /dev/null 2>&1
+    start=$(now_ns)
+    i=0
+    while [ $i -lt "$RUNS" ]; do
+        "$BIN" "$@" > /dev/null 2>&1
+        i=$((i + 1))
+    done
+    end=$(now_ns)
+    total_us=$(( (end - start) / 1000 ))
+    printf "  %-12s %8d us/run  (%d runs)\n" "$label" $((total_us / RUNS)) "$RUNS"
+}
+
+echo "Startup + exit time for $BIN:"
+bench "--version" --version
+bench "--help" --help
+bench "no args"
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""Serve recorded API responses over HTTP for testing providers offline.
+
+Every request is answered with <dir>/<last path segment>.json, the same
+naming as CRYPTO_CLI_REPLAY_DIR. Point the CLI at it with the base URL
+overrides, e.g.:
+
+    scripts/fixture-server.py --port 8701 --delay 0.2 &
+    CRYPTO_CLI_COINGECKO_URL=http://127.0.0.1:8701 bin/crypto btc --no-cache
+
+Usage: fixture-server.py [--dir fixtures] [--port 8701] [--delay S] [--status CODE]
+"""
+
+import argparse
+import http.server
+import os
+import time
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--dir", default="fixtures")
+    parser.add_argument("--port", type=int, default=8701)
+    parser.add_argument("--delay", type=float, default=0.0, help="seconds to wait before answering")
+    parser.add_argument("--status", type=int, default=200, help="status code to answer with")
+    args = parser.parse_args()
+
+    class Handler(http.server.BaseHTTPRequestHandler):
+        def do_GET(self):
+            name = self.path.split("?", 1)[0].rstrip("/").rsplit("/", 1)[-1]
+            path = os.path.join(args.dir, name + ".json")
+            time.sleep(args.delay)
+            if args.status != 200 or not os.path.isfile(path):
+                self.send_response(args.status if args.status != 200 else 404)
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+                return
+            with open(path, "rb") as f:
+                body = f.read()
+            self.send_response(200)
+            self.send_header("Content-Type", "application/json")
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def log_message(self, format, *args):
+            pass
+
+    http.server.ThreadingHTTPServer(("127.0.0.1", args.port), Handler).serve_forever()
+
+
+if __name__ == "__main__":
+    main()
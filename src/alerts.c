@@ -0,0 +1,667 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "../include/alerts.h"
+#include "../include/api.h"
+#include "../include/display.h"
+#include "../include/coinids.h"
+#include "../include/intern.h"
+#include "../include/options.h"
+
+#define ALERTS_IDS_PER_REQUEST 100
+#define ALERTS_DEFAULT_INTERVAL 60
+
+static const char *metric_names[ALERT_METRIC_COUNT] = {
+    "price", "change_24h", "market_cap", "volume_24h"
+};
+
+static const char *op_names[] = { ">", ">=", "<", "<=" };
+
+static unsigned long hash_id(const char *s) {
+    return intern_hash(INTERN_HASH_SEED, s, strlen(s));
+}
+
+static int find_coin(const alert_set_t *set, const char *id) {
+    if (!set->coin_table || !id) {
+        return -1;
+    }
+
+    unsigned long mask = (unsigned long)set->table_size - 1;
+    unsigned long slot = hash_id(id) & mask;
+    while (set->coin_table[slot] >= 0) {
+        if (strcmp(set->coins[set->coin_table[slot]].id, id) == 0) {
+            return set->coin_table[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+static int grow_coin_table(alert_set_t *set) {
+    int size = set->table_size ? set->table_size * 2 : 64;
+    int *table = malloc(sizeof(int) * (size_t)size);
+    if (!table) {
+        return -1;
+    }
+
+    for (int i = 0; i < size; i++) {
+        table[i] = -1;
+    }
+
+    unsigned long mask = (unsigned long)size - 1;
+    for (int i = 0; i < set->coin_count; i++) {
+        unsigned long slot = hash_id(set->coins[i].id) & mask;
+        while (table[slot] >= 0) {
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = i;
+    }
+
+    free(set->coin_table);
+    set->coin_table = table;
+    set->table_size = size;
+    return 0;
+}
+
+// Return the coin index for id, adding it if needed (takes ownership of id)
+static int intern_coin(alert_set_t *set, char *id, int *capacity) {
+    int index = find_coin(set, id);
+    if (index >= 0) {
+        free(id);
+        return index;
+    }
+
+    if (set->coin_count + 1 > set->table_size / 2 && grow_coin_table(set) != 0) {
+        free(id);
+        return -1;
+    }
+
+    if (set->coin_count == *capacity) {
+        int new_capacity = *capacity ? *capacity * 2 : 16;
+        alert_coin_t *coins = realloc(set->coins, sizeof(alert_coin_t) * (size_t)new_capacity);
+        if (!coins) {
+            free(id);
+            return -1;
+        }
+        set->coins = coins;
+        *capacity = new_capacity;
+    }
+
+    index = set->coin_count++;
+    set->coins[index] = (alert_coin_t){0};
+    set->coins[index].id = id;
+
+    unsigned long mask = (unsigned long)set->table_size - 1;
+    unsigned long slot = hash_id(id) & mask;
+    while (set->coin_table[slot] >= 0) {
+        slot = (slot + 1) & mask;
+    }
+    set->coin_table[slot] = index;
+
+    return index;
+}
+
+static char *trim(char *s) {
+    while (isspace((unsigned char)*s)) {
+        s++;
+    }
+
+    size_t len = strlen(s);
+    while (len > 0 && isspace((unsigned char)s[len - 1])) {
+        s[--len] = '\0';
+    }
+    return s;
+}
+
+static alert_metric_t parse_metric(const char *words, int percent) {
+    if (strstr(words, "change")) {
+        return ALERT_METRIC_CHANGE_24H;
+    }
+    if (strstr(words, "cap")) {
+        return ALERT_METRIC_MARKET_CAP;
+    }
+    if (strstr(words, "vol")) {
+        return ALERT_METRIC_VOLUME_24H;
+    }
+    // "BTC < -5%" is shorthand for the 24h change
+    if (words[0] == '\0' && percent) {
+        return ALERT_METRIC_CHANGE_24H;
+    }
+    return ALERT_METRIC_PRICE;
+}
+
+// Parse "SYMBOL [metric words] OP VALUE[K|M|B|T|%]" into rule (coin left unset)
+static int parse_rule_line(char *line, char **coin_out, alert_rule_t *rule) {
+    char *op = strpbrk(line, "<>");
+    if (!op || op == line) {
+        return -1;
+    }
+
+    if (op[0] == '>') {
+        rule->op = (op[1] == '=') ? ALERT_OP_GE : ALERT_OP_GT;
+    } else {
+        rule->op = (op[1] == '=') ? ALERT_OP_LE : ALERT_OP_LT;
+    }
+
+    char *value_str = op + ((op[1] == '=') ? 2 : 1);
+    *op = '\0';
+
+    // Left side: coin token followed by optional metric words
+    char *left = trim(line);
+    char *coin_end = left;
+    while (*coin_end && !isspace((unsigned char)*coin_end)) {
+        coin_end++;
+    }
+    char *words = coin_end;
+    if (*coin_end) {
+        *coin_end = '\0';
+        words = coin_end + 1;
+    }
+    words = trim(words);
+    for (char *p = words; *p; p++) {
+        *p = tolower((unsigned char)*p);
+    }
+
+    // Right side: number with optional magnitude suffix or percent sign
+    value_str = trim(value_str);
+    char *end = NULL;
+    double value = strtod(value_str, &end);
+    if (end == value_str) {
+        return -1;
+    }
+
+    int percent = 0;
+    switch (toupper((unsigned char)*end)) {
+        case 'K': value *= 1e3; end++; break;
+        case 'M': value *= 1e6; end++; break;
+        case 'B': value *= 1e9; end++; break;
+        case 'T': value *= 1e12; end++; break;
+        case '%': percent = 1; end++; break;
+        default: break;
+    }
+    if (*trim(end) != '\0' || left[0] == '\0') {
+        return -1;
+    }
+
+    rule->metric = parse_metric(words, percent);
+    rule->threshold = value;
+    *coin_out = left;
+    return 0;
+}
+
+typedef struct {
+    double threshold;
+    int rule;
+} threshold_entry_t;
+
+static int compare_entries(const void *a, const void *b) {
+    double x = ((const threshold_entry_t *)a)->threshold;
+    double y = ((const threshold_entry_t *)b)->threshold;
+    return (x > y) - (x < y);
+}
+
+// Build the sorted per-(coin, metric, direction) threshold arrays
+static int build_index(alert_set_t *set) {
+    int slots = set->coin_count * ALERT_METRIC_COUNT * 2;
+    int *counts = calloc((size_t)slots + 1, sizeof(int));
+    threshold_entry_t *entries = malloc(sizeof(threshold_entry_t) * (size_t)(set->rule_count + 1));
+    if (!counts || !entries) {
+        free(counts);
+        free(entries);
+        return -1;
+    }
+
+    // Counting sort by slot, then sort thresholds within each slot
+    for (int i = 0; i < set->rule_count; i++) {
+        const alert_rule_t *r = &set->rules[i];
+        int falling = (r->op == ALERT_OP_LT || r->op == ALERT_OP_LE);
+        counts[(r->coin * ALERT_METRIC_COUNT + r->metric) * 2 + falling + 1]++;
+    }
+    for (int s = 0; s < slots; s++) {
+        counts[s + 1] += counts[s];
+    }
+
+    int *fill = malloc(sizeof(int) * (size_t)(slots + 1));
+    if (!fill) {
+        free(counts);
+        free(entries);
+        return -1;
+    }
+    memcpy(fill, counts, sizeof(int) * (size_t)(slots + 1));
+
+    for (int i = 0; i < set->rule_count; i++) {
+        const alert_rule_t *r = &set->rules[i];
+        int falling = (r->op == ALERT_OP_LT || r->op == ALERT_OP_LE);
+        int slot = (r->coin * ALERT_METRIC_COUNT + r->metric) * 2 + falling;
+        entries[fill[slot]++] = (threshold_entry_t){ r->threshold, i };
+    }
+    free(fill);
+
+    int rc = 0;
+    for (int s = 0; s < slots && rc == 0; s++) {
+        int start = counts[s];
+        int count = counts[s + 1] - start;
+        if (count == 0) {
+            continue;
+        }
+
+        qsort(entries + start, (size_t)count, sizeof(threshold_entry_t), compare_entries);
+
+        alert_coin_t *coin = &set->coins[s / (ALERT_METRIC_COUNT * 2)];
+        int metric = (s / 2) % ALERT_METRIC_COUNT;
+        alert_index_t *index = (s % 2) ? &coin->falling[metric] : &coin->rising[metric];
+
+        index->thresholds = malloc(sizeof(double) * (size_t)count);
+        index->rules = malloc(sizeof(int) * (size_t)count);
+        if (!index->thresholds || !index->rules) {
+            rc = -1;
+            break;
+        }
+        for (int k = 0; k < count; k++) {
+            index->thresholds[k] = entries[start + k].threshold;
+            index->rules[k] = entries[start + k].rule;
+        }
+        index->count = count;
+    }
+
+    free(counts);
+    free(entries);
+    return rc;
+}
+
+int alerts_load(const char *path, alert_set_t *set) {
+    if (!path || !set) {
+        return -1;
+    }
+
+    *set = (alert_set_t){0};
+
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return -1;
+    }
+
+    int rule_capacity = 0;
+    int coin_capacity = 0;
+    int line_no = 0;
+    char line[512];
+
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
+
+        char *text = trim(line);
+        if (text[0] == '\0' || text[0] == '#') {
+            continue;
+        }
+
+        char *copy = malloc(strlen(text) + 1);
+        if (!copy) {
+            break;
+        }
+        strcpy(copy, text);
+
+        alert_rule_t rule = {0};
+        char *coin_token = NULL;
+        if (parse_rule_line(text, &coin_token, &rule) != 0) {
+            fprintf(stderr, "Warning: %s:%d: cannot parse rule \"%s\"\n", path, line_no, copy);
+            free(copy);
+            continue;
+        }
+
+        char *id = symbol_to_id(coin_token);
+        if (!id) {
+            free(copy);
+            continue;
+        }
+
+        rule.coin = intern_coin(set, id, &coin_capacity);
+        if (rule.coin < 0) {
+            free(copy);
+            break;
+        }
+        rule.line = line_no;
+        rule.text = copy;
+
+        if (set->rule_count == rule_capacity) {
+            int new_capacity = rule_capacity ? rule_capacity * 2 : 64;
+            alert_rule_t *rules = realloc(set->rules, sizeof(alert_rule_t) * (size_t)new_capacity);
+            if (!rules) {
+                free(copy);
+                break;
+            }
+            set->rules = rules;
+            rule_capacity = new_capacity;
+        }
+        set->rules[set->rule_count++] = rule;
+    }
+
+    fclose(fp);
+
+    if (set->rule_count == 0 || build_index(set) != 0) {
+        alerts_free(set);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int condition_holds(alert_op_t op, double value, double threshold) {
+    switch (op) {
+        case ALERT_OP_GT: return value > threshold;
+        case ALERT_OP_GE: return value >= threshold;
+        case ALERT_OP_LT: return value < threshold;
+        case ALERT_OP_LE: return value <= threshold;
+    }
+    return 0;
+}
+
+// First index with thresholds[i] >= value
+static int lower_bound(const double *thresholds, int count, double value) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (thresholds[mid] < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// First index with thresholds[i] > value
+static int upper_bound(const double *thresholds, int count, double value) {
+    int lo = 0, hi = count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (thresholds[mid] <= value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Fire rules in [from, to) of index whose condition became true
+static int fire_range(const alert_set_t *set, const alert_coin_t *coin, const alert_index_t *index,
+                      int from, int to, int has_old, double old_value, double new_value,
+                      alert_fire_fn fire, void *ctx) {
+    int fired = 0;
+    for (int k = from; k < to; k++) {
+        const alert_rule_t *rule = &set->rules[index->rules[k]];
+        if (!condition_holds(rule->op, new_value, rule->threshold)) {
+            continue;
+        }
+        if (has_old && condition_holds(rule->op, old_value, rule->threshold)) {
+            continue;
+        }
+        if (fire) {
+            fire(rule, coin, new_value, ctx);
+        }
+        fired++;
+    }
+    return fired;
+}
+
+int alerts_evaluate(alert_set_t *set, const markets_data_t *quotes, alert_fire_fn fire, void *ctx) {
+    if (!set || !quotes || !quotes->success) {
+        return 0;
+    }
+
+    int fired = 0;
+
+    for (int q = 0; q < quotes->count; q++) {
+        const crypto_data_t *quote = &quotes->coins[q];
+        if (!quote->success) {
+            continue;
+        }
+
+        int c = find_coin(set, quote->id);
+        if (c < 0) {
+            continue;
+        }
+        alert_coin_t *coin = &set->coins[c];
+
+        double values[ALERT_METRIC_COUNT];
+        values[ALERT_METRIC_PRICE] = quote->current_price;
+        values[ALERT_METRIC_CHANGE_24H] = quote->price_change_percentage_24h;
+        values[ALERT_METRIC_MARKET_CAP] = quote->market_cap;
+        values[ALERT_METRIC_VOLUME_24H] = quote->volume_24h;
+
+        for (int m = 0; m < ALERT_METRIC_COUNT; m++) {
+            double now = values[m];
+            double old = coin->last[m];
+            const alert_index_t *up = &coin->rising[m];
+            const alert_index_t *down = &coin->falling[m];
+
+            if (!coin->has_last) {
+                // Baseline tick: everything that already holds
+                fired += fire_range(set, coin, up, 0, upper_bound(up->thresholds, up->count, now),
+                                    0, 0.0, now, fire, ctx);
+                fired += fire_range(set, coin, down, lower_bound(down->thresholds, down->count, now), down->count,
+                                    0, 0.0, now, fire, ctx);
+            } else if (now > old) {
+                // Only thresholds inside [old, now] can have been crossed upwards
+                fired += fire_range(set, coin, up,
+                                    lower_bound(up->thresholds, up->count, old),
+                                    upper_bound(up->thresholds, up->count, now),
+                                    1, old, now, fire, ctx);
+            } else if (now < old) {
+                fired += fire_range(set, coin, down,
+                                    lower_bound(down->thresholds, down->count, now),
+                                    upper_bound(down->thresholds, down->count, old),
+                                    1, old, now, fire, ctx);
+            }
+
+            coin->last[m] = now;
+        }
+        coin->has_last = 1;
+    }
+
+    return fired;
+}
+
+void alerts_free(alert_set_t *set) {
+    if (!set) {
+        return;
+    }
+
+    for (int i = 0; i < set->rule_count; i++) {
+        free(set->rules[i].text);
+    }
+    free(set->rules);
+
+    for (int i = 0; i < set->coin_count; i++) {
+        alert_coin_t *coin = &set->coins[i];
+        for (int m = 0; m < ALERT_METRIC_COUNT; m++) {
+            free(coin->rising[m].thresholds);
+            free(coin->rising[m].rules);
+            free(coin->falling[m].thresholds);
+            free(coin->falling[m].rules);
+        }
+        free(coin->id);
+    }
+    free(set->coins);
+    free(set->coin_table);
+
+    *set = (alert_set_t){0};
+}
+
+typedef struct {
+    const char *exec;
+    const char *currency;
+} alerts_ctx_t;
+
+static void run_hook(const char *command, const alert_rule_t *rule, const alert_coin_t *coin, double value) {
+    char value_str[64];
+    char threshold_str[64];
+    char line_str[16];
+    snprintf(value_str, sizeof(value_str), "%.10g", value);
+    snprintf(threshold_str, sizeof(threshold_str), "%.10g", rule->threshold);
+    snprintf(line_str, sizeof(line_str), "%d", rule->line);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        setenv("CRYPTO_ALERT_RULE", rule->text, 1);
+        setenv("CRYPTO_ALERT_COIN", coin->id, 1);
+        setenv("CRYPTO_ALERT_METRIC", metric_names[rule->metric], 1);
+        setenv("CRYPTO_ALERT_OP", op_names[rule->op], 1);
+        setenv("CRYPTO_ALERT_THRESHOLD", threshold_str, 1);
+        setenv("CRYPTO_ALERT_VALUE", value_str, 1);
+        setenv("CRYPTO_ALERT_LINE", line_str, 1);
+        execl("/bin/sh", "sh", "-c", command, (char *)NULL);
+        _exit(127);
+    } else if (pid > 0) {
+        int status;
+        waitpid(pid, &status, 0);
+    } else {
+        fprintf(stderr, "Warning: cannot run hook for rule on line %d\n", rule->line);
+    }
+}
+
+static void on_fire(const alert_rule_t *rule, const alert_coin_t *coin, double value, void *ctx) {
+    const alerts_ctx_t *actx = (const alerts_ctx_t *)ctx;
+
+    if (actx->exec) {
+        run_hook(actx->exec, rule, coin, value);
+        return;
+    }
+
+    time_t now = time(NULL);
+    char time_str[32];
+    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", localtime(&now));
+    printf("[%s] %s (line %d): %s %s = %.10g\n",
+           time_str, rule->text, rule->line, coin->id, metric_names[rule->metric], value);
+}
+
+// Fetch every coin of the set in concurrent batches and evaluate each batch
+static int run_tick(alert_set_t *set, const alerts_ctx_t *ctx) {
+    int batches = (set->coin_count + ALERTS_IDS_PER_REQUEST - 1) / ALERTS_IDS_PER_REQUEST;
+    api_request_t *requests = calloc((size_t)batches, sizeof(api_request_t));
+    char **urls = calloc((size_t)batches, sizeof(char *));
+    if (!requests || !urls) {
+        free(requests);
+        free(urls);
+        return -1;
+    }
+
+    int failures = 0;
+    for (int b = 0; b < batches; b++) {
+        int start = b * ALERTS_IDS_PER_REQUEST;
+        int end = start + ALERTS_IDS_PER_REQUEST;
+        if (end > set->coin_count) {
+            end = set->coin_count;
+        }
+
+        char *csv = join_ids(&set->coins[start].id, sizeof(set->coins[0]), end - start);
+        urls[b] = csv ? get_api_url_with_currency(csv, ctx->currency) : NULL;
+        free(csv);
+        if (!urls[b]) {
+            failures = 1;
+            break;
+        }
+        requests[b].url = urls[b];
+    }
+
+    int fired = 0;
+    if (!failures) {
+        if (api_fetch_parallel(requests, batches, API_DEFAULT_MAX_IN_FLIGHT) != 0) {
+            failures = 1;
+        }
+
+        for (int b = 0; b < batches; b++) {
+            if (requests[b].result != 0) {
+                continue;
+            }
+            markets_data_t quotes = parse_simple_price_batch_json(requests[b].data, ctx->currency);
+            fired += alerts_evaluate(set, &quotes, on_fire, (void *)ctx);
+            free_markets_data(&quotes);
+            free(requests[b].data);
+        }
+    }
+
+    for (int b = 0; b < batches; b++) {
+        free(urls[b]);
+    }
+    free(urls);
+    free(requests);
+
+    fflush(stdout);
+    return failures ? -1 : fired;
+}
+
+static void print_alerts_usage(void) {
+    printf("Usage: crypto alerts RULES_FILE [--once] [--interval SECONDS] [--currency CUR] [--exec COMMAND]\n");
+}
+
+int alerts_command(int argc, char *argv[]) {
+    // Every tick parses quotes of the same rule coins; interning spares
+    // copying their ids and names again each time
+    parser_set_interning(1);
+
+    const char *rules_path = NULL;
+    int once = 0;
+    int interval = ALERTS_DEFAULT_INTERVAL;
+    alerts_ctx_t ctx = { NULL, "usd" };
+    char currency[16] = "usd";
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--once") == 0) {
+            once = 1;
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            interval = atoi(argv[++i]);
+            if (interval <= 0) {
+                display_error("Interval must be a positive number of seconds");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--currency") == 0 && i + 1 < argc) {
+            if (options_parse_currency(argv[++i], currency, sizeof(currency)) != 0) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--exec") == 0 && i + 1 < argc) {
+            ctx.exec = argv[++i];
+        } else if (!rules_path && argv[i][0] != '-') {
+            rules_path = argv[i];
+        } else {
+            print_alerts_usage();
+            return 1;
+        }
+    }
+    ctx.currency = currency;
+
+    if (!rules_path) {
+        print_alerts_usage();
+        return 1;
+    }
+
+    alert_set_t set;
+    if (alerts_load(rules_path, &set) != 0) {
+        display_error("Failed to load alert rules");
+        return 1;
+    }
+
+    int status = 0;
+    for (;;) {
+        if (run_tick(&set, &ctx) < 0) {
+            display_error("Failed to fetch some quotes from API; their rules were not evaluated this tick");
+            status = 1;
+        }
+
+        if (once) {
+            break;
+        }
+        sleep((unsigned int)interval);
+    }
+
+    alerts_free(&set);
+    return status;
+}
@@ -0,0 +1,77 @@
+#define _GNU_SOURCE
+
+#include <stddef.h>
+#include <errno.h>
+#include "../include/profile.h"
+
+/*
+ * Interposes the allocator of the crypto binary so that --profile can count
+ * allocations, including those made inside libcurl and cJSON. glibc
+ * exports its implementation as __libc_*, and both the program and shared
+ * libraries resolve malloc to these definitions. Not part of libcryptocli
+ * (a library must not replace its host's allocator), and left out of static
+ * builds, where glibc's malloc object cannot be linked twice.
+ */
+#if defined(__GLIBC__) && !defined(CRYPTO_CLI_NO_ALLOC_HOOK)
+
+#include <malloc.h>
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *ptr);
+
+static void *counted(void *ptr) {
+    if (ptr && profile_enabled()) {
+        profile_note_alloc(malloc_usable_size(ptr));
+    }
+    return ptr;
+}
+
+void *malloc(size_t size) {
+    return counted(__libc_malloc(size));
+}
+
+void *calloc(size_t count, size_t size) {
+    return counted(__libc_calloc(count, size));
+}
+
+void *realloc(void *ptr, size_t size) {
+    size_t old_size = ptr && profile_enabled() ? malloc_usable_size(ptr) : 0;
+    void *moved = __libc_realloc(ptr, size);
+    // A failed realloc keeps the old block; realloc(p, 0) frees it
+    if (ptr && (moved || size == 0)) {
+        profile_note_free(old_size);
+    }
+    return counted(moved);
+}
+
+void free(void *ptr) {
+    if (ptr && profile_enabled()) {
+        profile_note_free(malloc_usable_size(ptr));
+    }
+    __libc_free(ptr);
+}
+
+void *memalign(size_t alignment, size_t size) {
+    return counted(__libc_memalign(alignment, size));
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    return counted(__libc_memalign(alignment, size));
+}
+
+int posix_memalign(void **out, size_t alignment, size_t size) {
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void *ptr = counted(__libc_memalign(alignment, size));
+    if (!ptr) {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
+
+#endif
@@ -1,271 +1,900 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <curl/curl.h>
-#include "../include/api.h"
-
-#define COINGECKO_API_BASE "https://api.coingecko.com/api/v3/simple/price"
-#define COINGECKO_API_OHLC_BASE "https://api.coingecko.com/api/v3/coins"
-#define COINGECKO_API_MARKETS_BASE "https://api.coingecko.com/api/v3/coins/markets"
-
-/**
- * @brief Write callback for libcurl
- */
-struct write_result {
-    char *data;
-    size_t size;
-};
-
-static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
-    size_t total_size = size * nmemb;
-    struct write_result *result = (struct write_result *)userp;
-    
-    char *ptr = realloc(result->data, result->size + total_size + 1);
-    if (!ptr) {
-        fprintf(stderr, "Error: Memory allocation failed\n");
-        return 0;
-    }
-    
-    result->data = ptr;
-    memcpy(&(result->data[result->size]), contents, total_size);
-    result->size += total_size;
-    result->data[result->size] = 0;
-    
-    return total_size;
-}
-
-char *get_api_url_with_currency(const char *symbol, const char *currency) {
-    if (!symbol) {
-        return NULL;
-    }
-    
-    const char *curr = currency ? currency : "usd";
-    
-    size_t url_len = strlen(COINGECKO_API_BASE) + strlen(symbol) + strlen(curr) + 60;
-    char *url = malloc(url_len);
-    if (!url) {
-        return NULL;
-    }
-    
-    snprintf(url, url_len, "%s?ids=%s&vs_currencies=%s&include_24hr_change=true&include_market_cap=true&include_24hr_vol=true&include_last_updated_at=true", 
-             COINGECKO_API_BASE, symbol, curr);
-    
-    return url;
-}
-
-char *get_api_url(const char *symbol) {
-    return get_api_url_with_currency(symbol, "usd");
-}
-
-int fetch_crypto_data_with_currency(const char *symbol, const char *currency, char *buffer, size_t buffer_size) {
-    if (!symbol || !buffer || buffer_size == 0) {
-        return -1;
-    }
-    
-    CURL *curl;
-    CURLcode res;
-    struct write_result result;
-    
-    result.data = malloc(1);
-    result.size = 0;
-    
-    if (!result.data) {
-        return -1;
-    }
-    
-    curl = curl_easy_init();
-    if (!curl) {
-        free(result.data);
-        return -1;
-    }
-    
-    char *url = get_api_url_with_currency(symbol, currency);
-    if (!url) {
-        curl_easy_cleanup(curl);
-        free(result.data);
-        return -1;
-    }
-    
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&result);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "crypto-cli/1.0");
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    
-    res = curl_easy_perform(curl);
-    
-    long response_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-    
-    curl_easy_cleanup(curl);
-    free(url);
-    
-    if (res != CURLE_OK) {
-        free(result.data);
-        return -1;
-    }
-    
-    if (response_code != 200) {
-        free(result.data);
-        return -1;
-    }
-    
-    if (result.size >= buffer_size) {
-        free(result.data);
-        return -1;
-    }
-    
-    strncpy(buffer, result.data, buffer_size - 1);
-    buffer[buffer_size - 1] = '\0';
-    free(result.data);
-    
-    return 0;
-}
-
-int fetch_crypto_data(const char *symbol, char *buffer, size_t buffer_size) {
-    return fetch_crypto_data_with_currency(symbol, "usd", buffer, buffer_size);
-}
-
-int fetch_ohlc_data(const char *symbol, char *buffer, size_t buffer_size) {
-    if (!symbol || !buffer || buffer_size == 0) {
-        return -1;
-    }
-    
-    CURL *curl;
-    CURLcode res;
-    struct write_result result;
-    
-    result.data = malloc(1);
-    result.size = 0;
-    
-    if (!result.data) {
-        return -1;
-    }
-    
-    curl = curl_easy_init();
-    if (!curl) {
-        free(result.data);
-        return -1;
-    }
-    
-    // Build OHLC URL: /coins/{id}/ohlc?vs_currency=usd&days=1
-    size_t url_len = strlen(COINGECKO_API_OHLC_BASE) + strlen(symbol) + 50;
-    char *url = malloc(url_len);
-    if (!url) {
-        curl_easy_cleanup(curl);
-        free(result.data);
-        return -1;
-    }
-    
-    snprintf(url, url_len, "%s/%s/ohlc?vs_currency=usd&days=1", 
-             COINGECKO_API_OHLC_BASE, symbol);
-    
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&result);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "crypto-cli/1.0");
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    
-    res = curl_easy_perform(curl);
-    
-    long response_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-    
-    curl_easy_cleanup(curl);
-    free(url);
-    
-    if (res != CURLE_OK) {
-        free(result.data);
-        return -1;
-    }
-    
-    if (response_code != 200) {
-        free(result.data);
-        return -1;
-    }
-    
-    if (result.size >= buffer_size) {
-        free(result.data);
-        return -1;
-    }
-    
-    strncpy(buffer, result.data, buffer_size - 1);
-    buffer[buffer_size - 1] = '\0';
-    free(result.data);
-    
-    return 0;
-}
-
-int fetch_markets_data(int limit, char *buffer, size_t buffer_size) {
-    if (!buffer || buffer_size == 0 || limit <= 0) {
-        return -1;
-    }
-    
-    CURL *curl;
-    CURLcode res;
-    struct write_result result;
-    
-    result.data = malloc(1);
-    result.size = 0;
-    
-    if (!result.data) {
-        return -1;
-    }
-    
-    curl = curl_easy_init();
-    if (!curl) {
-        free(result.data);
-        return -1;
-    }
-    
-    // Build markets URL: /coins/markets?vs_currency=usd&order=market_cap_desc&per_page={limit}&page=1
-    size_t url_len = strlen(COINGECKO_API_MARKETS_BASE) + 150; // Increased buffer size
-    char *url = malloc(url_len);
-    if (!url) {
-        curl_easy_cleanup(curl);
-        free(result.data);
-        return -1;
-    }
-    
-    snprintf(url, url_len, "%s?vs_currency=usd&order=market_cap_desc&per_page=%d&page=1&sparkline=false&price_change_percentage=24h", 
-             COINGECKO_API_MARKETS_BASE, limit);
-    
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&result);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "crypto-cli/1.0");
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    
-    res = curl_easy_perform(curl);
-    
-    long response_code;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-    
-    curl_easy_cleanup(curl);
-    free(url);
-    
-    if (res != CURLE_OK) {
-        free(result.data);
-        return -1;
-    }
-    
-    if (response_code != 200) {
-        free(result.data);
-        return -1;
-    }
-    
-    if (result.size >= buffer_size) {
-        free(result.data);
-        return -1;
-    }
-    
-    strncpy(buffer, result.data, buffer_size - 1);
-    buffer[buffer_size - 1] = '\0';
-    free(result.data);
-    
-    return 0;
-}
-
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include <curl/curl.h>
+#include "../include/api.h"
+#include "../include/planner.h"
+
+#define COINGECKO_API_ROOT "https://api.coingecko.com/api/v3"
+
+/**
+ * @brief Write callback for libcurl
+ *
+ * Bodies arrive already decompressed (gzip/deflate/br/zstd are decoded by
+ * libcurl chunk by chunk), so the buffer grows geometrically instead of
+ * being reallocated for every chunk.
+ */
+struct write_result {
+    char *data;
+    size_t size;
+    size_t capacity;
+};
+
+static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t total_size = size * nmemb;
+    struct write_result *result = (struct write_result *)userp;
+    
+    if (result->size + total_size + 1 > result->capacity) {
+        size_t capacity = result->capacity ? result->capacity : 4096;
+        while (capacity < result->size + total_size + 1) {
+            capacity *= 2;
+        }
+        
+        char *ptr = realloc(result->data, capacity);
+        if (!ptr) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            return 0;
+        }
+        result->data = ptr;
+        result->capacity = capacity;
+    }
+    
+    memcpy(&(result->data[result->size]), contents, total_size);
+    result->size += total_size;
+    result->data[result->size] = 0;
+    
+    return total_size;
+}
+
+/*
+ * A pool keeps idle easy handles (each with its live connections) for reuse
+ * and a share handle for the DNS cache and TLS sessions, so back-to-back
+ * requests (batched alert and batch chunks, serve and feed refreshes,
+ * provider fallbacks, markets pages) reuse one HTTP/2 connection instead
+ * of doing a fresh handshake each time. Handles are
+ * checked out by one thread at a time, which keeps a pool safe to use from
+ * several threads; the share handle is protected by per-data mutexes.
+ *
+ * libcurl itself (and with it the TLS library) is initialised on the first
+ * request rather than at startup.
+ */
+struct api_pool {
+    CURLSH *share;
+    pthread_mutex_t share_locks[CURL_LOCK_DATA_LAST];
+    pthread_mutex_t idle_lock;
+    CURL *idle[API_POOL_MAX_IDLE];
+    int idle_count;
+    long timeout_ms;
+};
+
+static api_pool_t default_pool;
+static pthread_once_t api_once = PTHREAD_ONCE_INIT;
+static int api_initialized = 0;
+
+static void share_lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *userp) {
+    (void)handle;
+    (void)access;
+    api_pool_t *pool = (api_pool_t *)userp;
+    pthread_mutex_lock(&pool->share_locks[data]);
+}
+
+static void share_unlock(CURL *handle, curl_lock_data data, void *userp) {
+    (void)handle;
+    api_pool_t *pool = (api_pool_t *)userp;
+    pthread_mutex_unlock(&pool->share_locks[data]);
+}
+
+static void pool_setup(api_pool_t *pool, long timeout_ms) {
+    memset(pool, 0, sizeof(*pool));
+    pool->timeout_ms = timeout_ms > 0 ? timeout_ms : API_DEFAULT_TIMEOUT_MS;
+    pthread_mutex_init(&pool->idle_lock, NULL);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_init(&pool->share_locks[i], NULL);
+    }
+    
+    pool->share = curl_share_init();
+    if (!pool->share) {
+        return;
+    }
+    
+    curl_share_setopt(pool->share, CURLSHOPT_LOCKFUNC, share_lock);
+    curl_share_setopt(pool->share, CURLSHOPT_UNLOCKFUNC, share_unlock);
+    curl_share_setopt(pool->share, CURLSHOPT_USERDATA, (void *)pool);
+    curl_share_setopt(pool->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(pool->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+static void pool_teardown(api_pool_t *pool) {
+    for (int i = 0; i < pool->idle_count; i++) {
+        curl_easy_cleanup(pool->idle[i]);
+    }
+    pool->idle_count = 0;
+    
+    if (pool->share) {
+        curl_share_cleanup(pool->share);
+        pool->share = NULL;
+    }
+    
+    pthread_mutex_destroy(&pool->idle_lock);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        pthread_mutex_destroy(&pool->share_locks[i]);
+    }
+}
+
+static void api_init(void) {
+    if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK) {
+        return;
+    }
+    api_initialized = 1;
+    pool_setup(&default_pool, API_DEFAULT_TIMEOUT_MS);
+}
+
+void api_cleanup(void) {
+    if (!api_initialized) {
+        return;
+    }
+    
+    pool_teardown(&default_pool);
+    curl_global_cleanup();
+    api_initialized = 0;
+}
+
+void api_after_fork(void) {
+    if (!api_initialized) {
+        return;
+    }
+    
+    // Forget the inherited handles and share handle; the locks are set up
+    // afresh too, as a parent thread may have held one at the fork
+    pool_setup(&default_pool, API_DEFAULT_TIMEOUT_MS);
+}
+
+api_pool_t *api_pool_new(long timeout_ms) {
+    pthread_once(&api_once, api_init);
+    if (!api_initialized) {
+        return NULL;
+    }
+    
+    api_pool_t *pool = malloc(sizeof(api_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+    
+    pool_setup(pool, timeout_ms);
+    return pool;
+}
+
+void api_pool_free(api_pool_t *pool) {
+    if (!pool || pool == &default_pool) {
+        return;
+    }
+    
+    pool_teardown(pool);
+    free(pool);
+}
+
+// Take an idle handle (keeping its connections) or make a new one
+static CURL *pool_checkout(api_pool_t *pool) {
+    CURL *curl = NULL;
+    
+    pthread_mutex_lock(&pool->idle_lock);
+    if (pool->idle_count > 0) {
+        curl = pool->idle[--pool->idle_count];
+    }
+    pthread_mutex_unlock(&pool->idle_lock);
+    
+    if (curl) {
+        // Clears options but keeps the connection cache and TLS sessions
+        curl_easy_reset(curl);
+        return curl;
+    }
+    
+    return curl_easy_init();
+}
+
+static void pool_checkin(api_pool_t *pool, CURL *curl) {
+    pthread_mutex_lock(&pool->idle_lock);
+    if (pool->idle_count < API_POOL_MAX_IDLE) {
+        pool->idle[pool->idle_count++] = curl;
+        curl = NULL;
+    }
+    pthread_mutex_unlock(&pool->idle_lock);
+    
+    if (curl) {
+        curl_easy_cleanup(curl);
+    }
+}
+
+/*
+ * Replay mode: with CRYPTO_CLI_REPLAY_DIR set, responses are read from
+ * recorded files instead of the network (price.json, ohlc.json,
+ * markets.json, named after the last path segment of the endpoint). Used to
+ * train the PGO build and to run the code paths offline.
+ */
+static int replay_load(const char *url, struct write_result *result) {
+    const char *dir = getenv("CRYPTO_CLI_REPLAY_DIR");
+    if (!dir || !*dir) {
+        return -1;
+    }
+    
+    const char *path_end = strchr(url, '?');
+    if (!path_end) {
+        path_end = url + strlen(url);
+    }
+    const char *name = path_end;
+    while (name > url && name[-1] != '/') {
+        name--;
+    }
+    
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%.*s.json", dir, (int)(path_end - name), name);
+    
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return -1;
+    }
+    
+    char chunk[16384];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        if (write_callback(chunk, 1, n, result) != n) {
+            fclose(fp);
+            return -1;
+        }
+    }
+    fclose(fp);
+    
+    return result->data ? 0 : -1;
+}
+
+int api_replay_enabled(void) {
+    const char *dir = getenv("CRYPTO_CLI_REPLAY_DIR");
+    return dir && *dir;
+}
+
+static long long deadline_ms = 0;   // Monotonic milliseconds; 0 = no deadline
+
+long long api_monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+long long api_monotonic_ms(void) {
+    return api_monotonic_ns() / 1000000;
+}
+
+void api_set_deadline(long budget_ms) {
+    deadline_ms = budget_ms > 0 ? api_monotonic_ms() + budget_ms : 0;
+}
+
+long api_remaining_ms(void) {
+    if (deadline_ms == 0) {
+        return LONG_MAX;
+    }
+    long long remaining = deadline_ms - api_monotonic_ms();
+    return remaining > 0 ? (long)remaining : 0;
+}
+
+/**
+ * @brief Apply the options every request uses
+ */
+static void setup_handle(CURL *curl, const char *url, struct write_result *result, const api_pool_t *pool) {
+    // The request may not outlive the deadline (0 would mean no timeout at all)
+    long timeout_ms = pool->timeout_ms;
+    long remaining = api_remaining_ms();
+    if (remaining < timeout_ms) {
+        timeout_ms = remaining > 0 ? remaining : 1;
+    }
+    
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)result);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, "crypto-cli/1.0");
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    
+    // Empty string = advertise every encoding this libcurl can decode
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+    
+    if (pool->share) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, pool->share);
+    }
+}
+
+#ifdef DEBUG
+static void log_transfer(CURL *curl, const char *url, size_t decoded) {
+    curl_off_t wire = 0;
+    long version = 0;
+    long connects = 0;
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &wire);
+    curl_easy_getinfo(curl, CURLINFO_HTTP_VERSION, &version);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+    fprintf(stderr, "[api] %s: %lld bytes on wire, %zu decoded, http version %ld, %ld new connection(s)\n",
+            url, (long long)wire, decoded, version, connects);
+}
+#endif
+
+int api_fetch_url(api_pool_t *pool, const char *url, char **data, size_t *size) {
+    struct write_result result = { NULL, 0, 0 };
+    
+    if (!url || !data) {
+        return -1;
+    }
+    *data = NULL;
+    
+    if (api_remaining_ms() == 0) {
+        return -1;
+    }
+    
+    if (api_replay_enabled()) {
+        if (replay_load(url, &result) != 0) {
+            free(result.data);
+            return -1;
+        }
+    } else {
+        pthread_once(&api_once, api_init);
+        if (!api_initialized) {
+            return -1;
+        }
+        if (!pool) {
+            pool = &default_pool;
+        }
+        
+        CURL *curl = pool_checkout(pool);
+        if (!curl) {
+            return -1;
+        }
+        
+        setup_handle(curl, url, &result, pool);
+        
+        CURLcode res = curl_easy_perform(curl);
+        
+        long response_code = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+        
+#ifdef DEBUG
+        log_transfer(curl, url, result.size);
+#endif
+        
+        pool_checkin(pool, curl);
+        
+        if (res != CURLE_OK || response_code != 200 || !result.data) {
+            free(result.data);
+            return -1;
+        }
+    }
+    
+    *data = result.data;
+    if (size) {
+        *size = result.size;
+    }
+    return 0;
+}
+
+/**
+ * @brief Perform a GET request and copy the body into a caller buffer
+ *
+ * @return int 0 on success, -1 on transport error, non-200 status or overflow
+ */
+static int perform_request(const char *url, char *buffer, size_t buffer_size) {
+    char *data = NULL;
+    size_t size = 0;
+    
+    if (api_fetch_url(NULL, url, &data, &size) != 0) {
+        return -1;
+    }
+    
+    int rc = -1;
+    if (size < buffer_size) {
+        memcpy(buffer, data, size + 1);
+        rc = 0;
+    }
+    free(data);
+    
+    return rc;
+}
+
+/**
+ * @brief Asynchronous fetcher state
+ */
+struct api_async {
+    CURLM *multi;               // NULL in replay mode
+    int max_in_flight;
+    int in_flight;
+    api_request_t **done;       // Completed requests not yet returned
+    int done_head;
+    int done_count;
+    struct transfer *active;    // Transfers still running (for cancellation)
+};
+
+/**
+ * @brief Per-transfer bookkeeping attached to an easy handle
+ */
+struct transfer {
+    api_request_t *request;
+    struct write_result result;
+    CURL *curl;
+    struct transfer *prev;
+    struct transfer *next;
+};
+
+static void unlink_transfer(api_async_t *async, struct transfer *transfer) {
+    if (transfer->prev) {
+        transfer->prev->next = transfer->next;
+    } else {
+        async->active = transfer->next;
+    }
+    if (transfer->next) {
+        transfer->next->prev = transfer->prev;
+    }
+}
+
+api_async_t *api_async_new(int max_in_flight) {
+    if (max_in_flight <= 0) {
+        max_in_flight = API_DEFAULT_MAX_IN_FLIGHT;
+    }
+    
+    api_async_t *async = calloc(1, sizeof(api_async_t));
+    if (!async) {
+        return NULL;
+    }
+    
+    async->max_in_flight = max_in_flight;
+    async->done = calloc((size_t)max_in_flight, sizeof(api_request_t *));
+    if (!async->done) {
+        free(async);
+        return NULL;
+    }
+    
+    if (!api_replay_enabled()) {
+        pthread_once(&api_once, api_init);
+        async->multi = api_initialized ? curl_multi_init() : NULL;
+        if (!async->multi) {
+            free(async->done);
+            free(async);
+            return NULL;
+        }
+        
+        // Concurrent transfers to the same host become streams on one connection
+        curl_multi_setopt(async->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        curl_multi_setopt(async->multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)max_in_flight);
+    }
+    
+    return async;
+}
+
+static void push_done(api_async_t *async, api_request_t *request) {
+    int slot = (async->done_head + async->done_count) % async->max_in_flight;
+    async->done[slot] = request;
+    async->done_count++;
+}
+
+int api_async_add(api_async_t *async, api_request_t *request) {
+    if (!async || !request || !request->url) {
+        return -1;
+    }
+    
+    if (async->in_flight + async->done_count >= async->max_in_flight) {
+        return -1;
+    }
+    
+    request->data = NULL;
+    request->size = 0;
+    request->status = 0;
+    request->result = -1;
+    
+    // Past the deadline: completes at once as failed
+    if (api_remaining_ms() == 0) {
+        push_done(async, request);
+        return 0;
+    }
+    
+    if (!async->multi) {
+        struct write_result result = { NULL, 0, 0 };
+        if (replay_load(request->url, &result) == 0) {
+            request->data = result.data;
+            request->size = result.size;
+            request->status = 200;
+            request->result = 0;
+        } else {
+            free(result.data);
+        }
+        push_done(async, request);
+        return 0;
+    }
+    
+    struct transfer *transfer = calloc(1, sizeof(struct transfer));
+    CURL *curl = transfer ? curl_easy_init() : NULL;
+    if (!curl) {
+        free(transfer);
+        return -1;
+    }
+    transfer->request = request;
+    
+    // The multi handle keeps its own connection cache for multiplexing
+    setup_handle(curl, request->url, &transfer->result, &default_pool);
+    // Wait for an existing HTTP/2 connection rather than opening a new one
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, (void *)transfer);
+    
+    if (curl_multi_add_handle(async->multi, curl) != CURLM_OK) {
+        curl_easy_cleanup(curl);
+        free(transfer);
+        return -1;
+    }
+    
+    transfer->curl = curl;
+    transfer->next = async->active;
+    if (async->active) {
+        async->active->prev = transfer;
+    }
+    async->active = transfer;
+    async->in_flight++;
+    return 0;
+}
+
+int api_async_pending(const api_async_t *async) {
+    return async ? async->in_flight + async->done_count : 0;
+}
+
+int api_async_has_capacity(const api_async_t *async) {
+    return async && api_async_pending(async) < async->max_in_flight;
+}
+
+// Move finished transfers from the multi handle to the done queue
+static void collect_finished(api_async_t *async) {
+    CURLMsg *msg;
+    int queued;
+    while ((msg = curl_multi_info_read(async->multi, &queued)) != NULL) {
+        if (msg->msg != CURLMSG_DONE) {
+            continue;
+        }
+        
+        CURL *curl = msg->easy_handle;
+        struct transfer *transfer = NULL;
+        curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char **)&transfer);
+        api_request_t *request = transfer->request;
+        
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &request->status);
+        
+#ifdef DEBUG
+        log_transfer(curl, request->url, transfer->result.size);
+#endif
+        
+        if (msg->data.result == CURLE_OK && request->status == 200 && transfer->result.data) {
+            request->data = transfer->result.data;
+            request->size = transfer->result.size;
+            request->result = 0;
+        } else {
+            free(transfer->result.data);
+        }
+        
+        curl_multi_remove_handle(async->multi, curl);
+        curl_easy_cleanup(curl);
+        unlink_transfer(async, transfer);
+        free(transfer);
+        async->in_flight--;
+        push_done(async, request);
+    }
+}
+
+// Abort every running transfer; each completes with result -1
+static void cancel_active(api_async_t *async) {
+    while (async->active) {
+        struct transfer *transfer = async->active;
+        api_request_t *request = transfer->request;
+        unlink_transfer(async, transfer);
+        curl_multi_remove_handle(async->multi, transfer->curl);
+        curl_easy_cleanup(transfer->curl);
+        free(transfer->result.data);
+        free(transfer);
+        async->in_flight--;
+        push_done(async, request);
+    }
+}
+
+api_request_t *api_async_next(api_async_t *async, int timeout_ms) {
+    if (!async) {
+        return NULL;
+    }
+    
+    if (async->done_count == 0 && async->in_flight > 0) {
+        int running = 0;
+        curl_multi_perform(async->multi, &running);
+        collect_finished(async);
+        
+        if (async->done_count == 0 && timeout_ms != 0) {
+            long wait_ms = timeout_ms < 0 ? 1000 : timeout_ms;
+            long remaining = api_remaining_ms();
+            if (remaining < wait_ms) {
+                wait_ms = remaining;
+            }
+            curl_multi_poll(async->multi, NULL, 0, (int)wait_ms, NULL);
+            curl_multi_perform(async->multi, &running);
+            collect_finished(async);
+        }
+        
+        // Whatever has not finished by the deadline is given up on
+        if (async->done_count == 0 && api_remaining_ms() == 0) {
+            cancel_active(async);
+        }
+    }
+    
+    if (async->done_count == 0) {
+        return NULL;
+    }
+    
+    api_request_t *request = async->done[async->done_head];
+    async->done_head = (async->done_head + 1) % async->max_in_flight;
+    async->done_count--;
+    return request;
+}
+
+void api_async_free(api_async_t *async) {
+    if (!async) {
+        return;
+    }
+    
+    if (async->multi) {
+        // Cancel whatever is still running; its request keeps result -1
+        while (async->active) {
+            struct transfer *transfer = async->active;
+            async->active = transfer->next;
+            curl_multi_remove_handle(async->multi, transfer->curl);
+            curl_easy_cleanup(transfer->curl);
+            free(transfer->result.data);
+            free(transfer);
+        }
+        curl_multi_cleanup(async->multi);
+    }
+    
+    free(async->done);
+    free(async);
+}
+
+int api_fetch_parallel(api_request_t *requests, int count, int max_in_flight) {
+    if (!requests || count <= 0) {
+        return -1;
+    }
+    
+    api_async_t *async = api_async_new(max_in_flight);
+    if (!async) {
+        return -1;
+    }
+    
+    int next = 0;
+    int failures = 0;
+    int completed = 0;
+    
+    while (completed < count) {
+        // Top up the window
+        while (next < count && api_async_has_capacity(async)) {
+            if (api_async_add(async, &requests[next]) != 0) {
+                requests[next].result = -1;
+                failures++;
+                completed++;
+            }
+            next++;
+        }
+        
+        api_request_t *done = api_async_next(async, 1000);
+        if (done) {
+            if (done->result != 0) {
+                failures++;
+            }
+            completed++;
+        }
+    }
+    
+    api_async_free(async);
+    
+    return failures ? -1 : 0;
+}
+
+const char *api_base_url(const char *env_name, const char *fallback) {
+    const char *base = env_name ? getenv(env_name) : NULL;
+    return base && *base ? base : fallback;
+}
+
+const char *api_coingecko_base(void) {
+    return api_base_url("CRYPTO_CLI_COINGECKO_URL", COINGECKO_API_ROOT);
+}
+
+char *get_simple_price_url(const char *ids, const char *currency, unsigned fields) {
+    if (!ids) {
+        return NULL;
+    }
+    
+    const char *curr = currency ? currency : "usd";
+    if (fields == 0) {
+        fields = PLAN_ALL;
+    }
+    
+    // Each include_* flag adds a key per coin to the response
+    const char *change = fields & PLAN_CHANGE_24H ? "&include_24hr_change=true" : "";
+    const char *market_cap = fields & PLAN_MARKET_CAP ? "&include_market_cap=true" : "";
+    const char *volume = fields & PLAN_VOLUME_24H ? "&include_24hr_vol=true" : "";
+    const char *last_updated = fields & PLAN_LAST_UPDATED ? "&include_last_updated_at=true" : "";
+    
+    const char *base = api_coingecko_base();
+    const char *format = "%s/simple/price?ids=%s&vs_currencies=%s%s%s%s%s";
+    
+    // Size from the format itself: batched requests can carry hundreds of ids
+    int needed = snprintf(NULL, 0, format, base, ids, curr, change, market_cap, volume, last_updated);
+    if (needed < 0) {
+        return NULL;
+    }
+    
+    size_t url_len = (size_t)needed + 1;
+    char *url = malloc(url_len);
+    if (!url) {
+        return NULL;
+    }
+    
+    snprintf(url, url_len, format, base, ids, curr, change, market_cap, volume, last_updated);
+    
+    return url;
+}
+
+char *get_api_url_with_currency(const char *symbol, const char *currency) {
+    return get_simple_price_url(symbol, currency, PLAN_ALL);
+}
+
+char *get_api_url(const char *symbol) {
+    return get_api_url_with_currency(symbol, "usd");
+}
+
+int fetch_crypto_data_with_currency(const char *symbol, const char *currency, char *buffer, size_t buffer_size) {
+    if (!symbol || !buffer || buffer_size == 0) {
+        return -1;
+    }
+    
+    char *url = get_api_url_with_currency(symbol, currency);
+    if (!url) {
+        return -1;
+    }
+    
+    int rc = perform_request(url, buffer, buffer_size);
+    free(url);
+    
+    return rc;
+}
+
+int fetch_crypto_data(const char *symbol, char *buffer, size_t buffer_size) {
+    return fetch_crypto_data_with_currency(symbol, "usd", buffer, buffer_size);
+}
+
+int fetch_simple_price_batch(const char *ids_csv, const char *currency, char *buffer, size_t buffer_size) {
+    // simple/price accepts a comma-separated id list in the same ids= parameter
+    return fetch_crypto_data_with_currency(ids_csv, currency, buffer, buffer_size);
+}
+
+int fetch_ohlc_data(const char *symbol, char *buffer, size_t buffer_size) {
+    if (!symbol || !buffer || buffer_size == 0) {
+        return -1;
+    }
+    
+    // Build OHLC URL: /coins/{id}/ohlc?vs_currency=usd&days=1
+    const char *base = api_coingecko_base();
+    size_t url_len = strlen(base) + strlen(symbol) + 50;
+    char *url = malloc(url_len);
+    if (!url) {
+        return -1;
+    }
+    
+    snprintf(url, url_len, "%s/coins/%s/ohlc?vs_currency=usd&days=1", 
+             base, symbol);
+    
+    int rc = perform_request(url, buffer, buffer_size);
+    free(url);
+    
+    return rc;
+}
+
+char *get_coin_list_url(void) {
+    const char *base = api_coingecko_base();
+    size_t url_len = strlen(base) + sizeof("/coins/list");
+    char *url = malloc(url_len);
+    if (url) {
+        snprintf(url, url_len, "%s/coins/list", base);
+    }
+    return url;
+}
+
+char *get_markets_url(int limit) {
+    return get_markets_url_page(limit, 1);
+}
+
+char *get_markets_url_page(int per_page, int page) {
+    if (per_page <= 0 || page <= 0) {
+        return NULL;
+    }
+    
+    // Build markets URL: /coins/markets?vs_currency=usd&order=market_cap_desc&per_page={per_page}&page={page}
+    const char *base = api_coingecko_base();
+    size_t url_len = strlen(base) + 150;
+    char *url = malloc(url_len);
+    if (!url) {
+        return NULL;
+    }
+    
+    snprintf(url, url_len, "%s/coins/markets?vs_currency=usd&order=market_cap_desc&per_page=%d&page=%d&sparkline=false&price_change_percentage=24h", 
+             base, per_page, page);
+    
+    return url;
+}
+
+char *get_markets_url_for_ids(const char *ids, const char *currency) {
+    if (!ids) {
+        return NULL;
+    }
+    
+    const char *curr = currency ? currency : "usd";
+    const char *base = api_coingecko_base();
+    const char *format = "%s/coins/markets?vs_currency=%s&ids=%s&sparkline=false&price_change_percentage=24h";
+    
+    int needed = snprintf(NULL, 0, format, base, curr, ids);
+    if (needed < 0) {
+        return NULL;
+    }
+    
+    char *url = malloc((size_t)needed + 1);
+    if (url) {
+        snprintf(url, (size_t)needed + 1, format, base, curr, ids);
+    }
+    return url;
+}
+
+// {base}/coins/{id}/{path}?vs_currency={currency}&days={days}
+static char *coin_series_url(const char *id, const char *path, const char *currency, const char *days) {
+    if (!id || !days) {
+        return NULL;
+    }
+    
+    const char *curr = currency ? currency : "usd";
+    const char *base = api_coingecko_base();
+    const char *format = "%s/coins/%s/%s?vs_currency=%s&days=%s";
+    
+    int needed = snprintf(NULL, 0, format, base, id, path, curr, days);
+    if (needed < 0) {
+        return NULL;
+    }
+    
+    char *url = malloc((size_t)needed + 1);
+    if (url) {
+        snprintf(url, (size_t)needed + 1, format, base, id, path, curr, days);
+    }
+    return url;
+}
+
+char *get_ohlc_url(const char *id, const char *currency, const char *days) {
+    return coin_series_url(id, "ohlc", currency, days);
+}
+
+char *get_market_chart_url(const char *id, const char *currency, const char *days) {
+    return coin_series_url(id, "market_chart", currency, days);
+}
+
+int fetch_markets_data(int limit, char *buffer, size_t buffer_size) {
+    if (!buffer || buffer_size == 0 || limit <= 0) {
+        return -1;
+    }
+    
+    char *url = get_markets_url(limit);
+    if (!url) {
+        return -1;
+    }
+    
+    int rc = perform_request(url, buffer, buffer_size);
+    free(url);
+    
+    return rc;
+}
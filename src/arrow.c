@@ -0,0 +1,557 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../include/arrow.h"
+
+#define ARROW_STAGE_SIZE (64 * 1024)
+#define ARROW_MAGIC "ARROW1"
+
+// Format constants from Schema.fbs / Message.fbs
+#define METADATA_V5 4
+#define HEADER_SCHEMA 1
+#define HEADER_RECORD_BATCH 3
+#define TYPE_INT 2
+#define TYPE_FLOATING_POINT 3
+#define TYPE_UTF8 5
+#define TYPE_TIMESTAMP 10
+#define PRECISION_DOUBLE 2
+#define UNIT_SECOND 0
+#define UNIT_MILLISECOND 1
+
+/*
+ * Flatbuffer builder
+ *
+ * The metadata is a handful of small tables, so the buffer is laid out
+ * front to back: the root offset, then each table followed by the objects
+ * it refers to. Offsets to strings, vectors and sub-tables (uoffset) must
+ * point forward, which this order gives for free; each table's vtable is
+ * placed right before it. Everything is little-endian, as flatbuffers are.
+ */
+
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+    int failed;
+} fb_t;
+
+/** Size of a reference field; its value is set later with fb_ref() */
+#define FB_REF 4
+
+typedef struct {
+    size_t size;       // 0 = field absent, 1/2/4/8 = scalar, FB_REF = offset
+    uint64_t value;
+} fb_field_t;
+
+static size_t align_up(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+// Reserve size bytes at the given alignment (zero-filled); returns the position
+static size_t fb_alloc(fb_t *b, size_t size, size_t align) {
+    size_t pos = align_up(b->size, align);
+    if (pos + size > b->capacity) {
+        size_t capacity = b->capacity ? b->capacity : 512;
+        while (capacity < pos + size) {
+            capacity *= 2;
+        }
+        unsigned char *data = realloc(b->data, capacity);
+        if (!data) {
+            b->failed = 1;
+            return 0;
+        }
+        b->data = data;
+        b->capacity = capacity;
+    }
+    memset(b->data + b->size, 0, pos + size - b->size);
+    b->size = pos + size;
+    return pos;
+}
+
+static void put_le(unsigned char *p, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        p[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static void fb_put(fb_t *b, size_t pos, uint64_t value, size_t size) {
+    if (!b->failed) {
+        put_le(b->data + pos, value, size);
+    }
+}
+
+// Point the reference field at pos to target (which lies after it)
+static void fb_ref(fb_t *b, size_t field, size_t target) {
+    fb_put(b, field, (uint64_t)(target - field), 4);
+}
+
+// Table with the given fields (in schema order); field positions go to pos
+static size_t fb_table(fb_t *b, const fb_field_t *fields, int count, size_t *pos) {
+    size_t offsets[8] = {0};
+    size_t inline_size = 4;   // soffset to the vtable
+    size_t table_align = 4;
+
+    // Widest fields first keeps every field naturally aligned
+    for (size_t size = 8; size >= 1; size /= 2) {
+        for (int i = 0; i < count; i++) {
+            if (fields[i].size == size) {
+                inline_size = align_up(inline_size, size);
+                offsets[i] = inline_size;
+                inline_size += size;
+                if (size > table_align) {
+                    table_align = size;
+                }
+            }
+        }
+    }
+
+    size_t vtable = fb_alloc(b, 4 + 2 * (size_t)count, 2);
+    fb_put(b, vtable, 4 + 2 * (uint64_t)count, 2);
+    fb_put(b, vtable + 2, inline_size, 2);
+    for (int i = 0; i < count; i++) {
+        fb_put(b, vtable + 4 + 2 * (size_t)i, offsets[i], 2);
+    }
+
+    size_t table = fb_alloc(b, inline_size, table_align);
+    fb_put(b, table, table - vtable, 4);
+    for (int i = 0; i < count; i++) {
+        if (fields[i].size > 0) {
+            if (fields[i].size != FB_REF || fields[i].value != 0) {
+                fb_put(b, table + offsets[i], fields[i].value, fields[i].size);
+            }
+            if (pos) {
+                pos[i] = table + offsets[i];
+            }
+        }
+    }
+    return table;
+}
+
+static size_t fb_string(fb_t *b, const char *s) {
+    size_t len = strlen(s);
+    size_t pos = fb_alloc(b, 4 + len + 1, 4);
+    fb_put(b, pos, len, 4);
+    if (!b->failed) {
+        memcpy(b->data + pos + 4, s, len);
+    }
+    return pos;
+}
+
+// Vector of count elements; element i starts at pos + 4 + i * elem_size
+static size_t fb_vector(fb_t *b, size_t count, size_t elem_size, size_t elem_align) {
+    size_t align = elem_align > 4 ? elem_align : 4;
+    size_t start = align_up(b->size + 4, align);
+    // Padding goes before the length so the elements come out aligned
+    fb_alloc(b, start - b->size + count * elem_size, 1);
+    size_t pos = start - 4;
+    fb_put(b, pos, count, 4);
+    return pos;
+}
+
+static size_t fb_type(fb_t *b, arrow_type_t type, int *type_id) {
+    switch (type) {
+    case ARROW_FLOAT64: {
+        fb_field_t f[] = { { 2, PRECISION_DOUBLE } };
+        *type_id = TYPE_FLOATING_POINT;
+        return fb_table(b, f, 1, NULL);
+    }
+    case ARROW_INT64: {
+        fb_field_t f[] = { { 4, 64 }, { 1, 1 } };
+        *type_id = TYPE_INT;
+        return fb_table(b, f, 2, NULL);
+    }
+    case ARROW_TIMESTAMP_S:
+    case ARROW_TIMESTAMP_MS: {
+        fb_field_t f[] = { { 2, type == ARROW_TIMESTAMP_S ? UNIT_SECOND : UNIT_MILLISECOND },
+                           { FB_REF, 0 } };
+        size_t pos[2];
+        size_t table = fb_table(b, f, 2, pos);
+        fb_ref(b, pos[1], fb_string(b, "UTC"));
+        *type_id = TYPE_TIMESTAMP;
+        return table;
+    }
+    case ARROW_UTF8:
+    default:
+        *type_id = TYPE_UTF8;
+        return fb_table(b, NULL, 0, NULL);
+    }
+}
+
+static size_t fb_schema(fb_t *b, const arrow_field_t *fields, int count) {
+    fb_field_t schema_fields[] = { { 2, 0 /* little-endian */ }, { FB_REF, 0 } };
+    size_t schema_pos[2];
+    size_t schema = fb_table(b, schema_fields, 2, schema_pos);
+
+    size_t vector = fb_vector(b, (size_t)count, 4, 4);
+    fb_ref(b, schema_pos[1], vector);
+
+    for (int i = 0; i < count; i++) {
+        // name, nullable, type_type, type, dictionary (absent), children
+        int type_id = 0;
+        fb_field_t f[] = { { FB_REF, 0 }, { 1, 1 }, { 1, 0 }, { FB_REF, 0 }, { 0, 0 }, { FB_REF, 0 } };
+        size_t pos[6];
+        size_t field = fb_table(b, f, 6, pos);
+        fb_ref(b, vector + 4 + 4 * (size_t)i, field);
+
+        fb_ref(b, pos[0], fb_string(b, fields[i].name));
+        fb_ref(b, pos[3], fb_type(b, fields[i].type, &type_id));
+        fb_put(b, pos[2], (uint64_t)type_id, 1);
+        // Readers expect a children vector even for flat types
+        fb_ref(b, pos[5], fb_vector(b, 0, 4, 4));
+    }
+    return schema;
+}
+
+// Message table; returns the position of its header reference field
+static size_t fb_message(fb_t *b, int header_type, int64_t body_length) {
+    size_t root = fb_alloc(b, 4, 4);
+    fb_field_t f[] = { { 2, METADATA_V5 }, { 1, (uint64_t)header_type }, { FB_REF, 0 },
+                       { 8, (uint64_t)body_length } };
+    size_t pos[4];
+    fb_ref(b, root, fb_table(b, f, 4, pos));
+    return pos[2];
+}
+
+/*
+ * Output
+ */
+
+static void stage_flush(arrow_writer_t *w) {
+    if (w->staged > 0 && fwrite(w->stage, 1, w->staged, w->fp) != w->staged) {
+        w->failed = 1;
+    }
+    w->offset += (int64_t)w->staged;
+    w->staged = 0;
+}
+
+static void emit(arrow_writer_t *w, const void *data, size_t size) {
+    if (size >= ARROW_STAGE_SIZE / 2) {
+        // Large contiguous buffers go straight to the stream
+        stage_flush(w);
+        if (fwrite(data, 1, size, w->fp) != size) {
+            w->failed = 1;
+        }
+        w->offset += (int64_t)size;
+        return;
+    }
+    if (w->staged + size > ARROW_STAGE_SIZE) {
+        stage_flush(w);
+    }
+    memcpy(w->stage + w->staged, data, size);
+    w->staged += size;
+}
+
+// Slot of `size` bytes in the staging buffer
+static unsigned char *emit_slot(arrow_writer_t *w, size_t size) {
+    if (w->staged + size > ARROW_STAGE_SIZE) {
+        stage_flush(w);
+    }
+    unsigned char *slot = w->stage + w->staged;
+    w->staged += size;
+    return slot;
+}
+
+static void emit_padding(arrow_writer_t *w, size_t written) {
+    static const unsigned char zeros[8] = {0};
+    emit(w, zeros, align_up(written, 8) - written);
+}
+
+// Continuation marker, metadata length, flatbuffer, padding; returns the prefixed length
+static int32_t emit_metadata(arrow_writer_t *w, const fb_t *b) {
+    uint32_t length = (uint32_t)align_up(b->size, 8);
+    unsigned char prefix[8];
+    put_le(prefix, 0xFFFFFFFFu, 4);
+    put_le(prefix + 4, length, 4);
+    emit(w, prefix, sizeof(prefix));
+    emit(w, b->data, b->size);
+    emit_padding(w, b->size);
+    return (int32_t)(8 + length);
+}
+
+int arrow_begin(arrow_writer_t *writer, FILE *fp, int file_format,
+                const arrow_field_t *fields, int field_count) {
+    memset(writer, 0, sizeof(*writer));
+    writer->fp = fp;
+    writer->file_format = file_format;
+    writer->fields = fields;
+    writer->field_count = field_count;
+    writer->stage = malloc(ARROW_STAGE_SIZE);
+    if (!writer->stage) {
+        return -1;
+    }
+
+    if (file_format) {
+        static const unsigned char magic[8] = ARROW_MAGIC;
+        emit(writer, magic, sizeof(magic));
+    }
+
+    fb_t b = {0};
+    size_t header = fb_message(&b, HEADER_SCHEMA, 0);
+    fb_ref(&b, header, fb_schema(&b, fields, field_count));
+    if (b.failed) {
+        free(b.data);
+        free(writer->stage);
+        writer->stage = NULL;
+        return -1;
+    }
+    emit_metadata(writer, &b);
+    free(b.data);
+    return writer->failed ? -1 : 0;
+}
+
+static int is_integer(arrow_type_t type) {
+    return type == ARROW_INT64 || type == ARROW_TIMESTAMP_S || type == ARROW_TIMESTAMP_MS;
+}
+
+static const void *row_at(const arrow_column_t *column, int64_t row) {
+    return (const char *)column->base + (size_t)row * column->stride;
+}
+
+static int64_t read_integer(const arrow_column_t *column, int64_t row) {
+    const void *p = row_at(column, row);
+    if (column->width == 4) {
+        int32_t v;
+        memcpy(&v, p, 4);
+        return v;
+    }
+    int64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static int is_null(const arrow_field_t *field, const arrow_column_t *column, int64_t row) {
+    if (field->type == ARROW_FLOAT64) {
+        double v;
+        memcpy(&v, row_at(column, row), sizeof(v));
+        return isnan(v);
+    }
+    if (field->type == ARROW_UTF8) {
+        const char *s;
+        memcpy(&s, row_at(column, row), sizeof(s));
+        return s == NULL;
+    }
+    return 0;
+}
+
+/**
+ * @brief Per-column layout of one batch
+ */
+typedef struct {
+    int64_t null_count;
+    int32_t *offsets;     // Utf8: rows + 1 offsets into the character data
+    size_t validity_size;
+    size_t offsets_size;
+    size_t values_size;
+} batch_column_t;
+
+int arrow_write_batch(arrow_writer_t *w, const arrow_column_t *columns, int64_t rows) {
+    if (!w->stage || rows < 0 || rows > INT32_MAX) {
+        return -1;
+    }
+    int count = w->field_count;
+    batch_column_t *layout = calloc((size_t)(count > 0 ? count : 1), sizeof(batch_column_t));
+    if (!layout) {
+        return -1;
+    }
+
+    // Pass 1: null counts, string offsets and buffer sizes
+    int buffer_count = 0;
+    int64_t body_length = 0;
+    int ok = 1;
+    for (int c = 0; c < count && ok; c++) {
+        const arrow_field_t *field = &w->fields[c];
+        batch_column_t *col = &layout[c];
+        for (int64_t r = 0; r < rows; r++) {
+            col->null_count += is_null(field, &columns[c], r);
+        }
+        col->validity_size = col->null_count > 0 ? align_up((size_t)(rows + 7) / 8, 8) : 0;
+
+        if (field->type == ARROW_UTF8) {
+            col->offsets = malloc(((size_t)rows + 1) * sizeof(int32_t));
+            if (!col->offsets) {
+                ok = 0;
+                break;
+            }
+            int64_t total = 0;
+            col->offsets[0] = 0;
+            for (int64_t r = 0; r < rows; r++) {
+                const char *s;
+                memcpy(&s, row_at(&columns[c], r), sizeof(s));
+                total += s ? (int64_t)strlen(s) : 0;
+                if (total > INT32_MAX) {
+                    ok = 0;
+                    break;
+                }
+                col->offsets[r + 1] = (int32_t)total;
+            }
+            col->offsets_size = align_up(((size_t)rows + 1) * sizeof(int32_t), 8);
+            col->values_size = align_up((size_t)total, 8);
+            buffer_count += 3;
+        } else {
+            col->values_size = (size_t)rows * 8;
+            buffer_count += 2;
+        }
+        body_length += (int64_t)(col->validity_size + col->offsets_size + col->values_size);
+    }
+
+    // Metadata: length, one node per field, validity/offsets/values buffers
+    fb_t b = {0};
+    if (ok) {
+        size_t header = fb_message(&b, HEADER_RECORD_BATCH, body_length);
+        fb_field_t f[] = { { 8, (uint64_t)rows }, { FB_REF, 0 }, { FB_REF, 0 } };
+        size_t pos[3];
+        fb_ref(&b, header, fb_table(&b, f, 3, pos));
+
+        size_t nodes = fb_vector(&b, (size_t)count, 16, 8);
+        fb_ref(&b, pos[1], nodes);
+        for (int c = 0; c < count; c++) {
+            fb_put(&b, nodes + 4 + 16 * (size_t)c, (uint64_t)rows, 8);
+            fb_put(&b, nodes + 4 + 16 * (size_t)c + 8, (uint64_t)layout[c].null_count, 8);
+        }
+
+        size_t buffers = fb_vector(&b, (size_t)buffer_count, 16, 8);
+        fb_ref(&b, pos[2], buffers);
+        size_t slot = buffers + 4;
+        uint64_t body_offset = 0;
+        for (int c = 0; c < count; c++) {
+            size_t sizes[3] = { layout[c].validity_size, layout[c].offsets_size, layout[c].values_size };
+            for (int k = 0; k < 3; k++) {
+                if (k == 1 && w->fields[c].type != ARROW_UTF8) {
+                    continue;
+                }
+                fb_put(&b, slot, body_offset, 8);
+                fb_put(&b, slot + 8, sizes[k], 8);
+                body_offset += sizes[k];
+                slot += 16;
+            }
+        }
+        ok = !b.failed;
+    }
+
+    if (ok) {
+        arrow_block_t block = { w->offset + (int64_t)w->staged, 0, body_length };
+        block.metadata_length = emit_metadata(w, &b);
+
+        // Pass 2: the body, buffer by buffer
+        for (int c = 0; c < count; c++) {
+            const arrow_field_t *field = &w->fields[c];
+            const arrow_column_t *column = &columns[c];
+            batch_column_t *col = &layout[c];
+
+            if (col->validity_size > 0) {
+                for (int64_t r = 0; r < rows; r += 8) {
+                    unsigned char bits = 0;
+                    for (int64_t k = r; k < r + 8 && k < rows; k++) {
+                        bits |= (unsigned char)(!is_null(field, column, k) << (k - r));
+                    }
+                    emit(w, &bits, 1);
+                }
+                emit_padding(w, (size_t)(rows + 7) / 8);
+            }
+
+            if (field->type == ARROW_UTF8) {
+                size_t offsets_bytes = ((size_t)rows + 1) * sizeof(int32_t);
+                emit(w, col->offsets, offsets_bytes);
+                emit_padding(w, offsets_bytes);
+                for (int64_t r = 0; r < rows; r++) {
+                    const char *s;
+                    memcpy(&s, row_at(column, r), sizeof(s));
+                    if (s) {
+                        emit(w, s, (size_t)(col->offsets[r + 1] - col->offsets[r]));
+                    }
+                }
+                emit_padding(w, (size_t)col->offsets[rows]);
+            } else if (field->type == ARROW_FLOAT64 && column->stride == 8) {
+                emit(w, column->base, (size_t)rows * 8);
+            } else {
+                for (int64_t r = 0; r < rows; r++) {
+                    unsigned char *slot = emit_slot(w, 8);
+                    if (is_integer(field->type)) {
+                        put_le(slot, (uint64_t)read_integer(column, r), 8);
+                    } else {
+                        memcpy(slot, row_at(column, r), 8);
+                    }
+                }
+            }
+        }
+
+        if (w->file_format) {
+            if (w->block_count == w->block_capacity) {
+                int capacity = w->block_capacity ? w->block_capacity * 2 : 16;
+                arrow_block_t *blocks = realloc(w->blocks, (size_t)capacity * sizeof(arrow_block_t));
+                if (blocks) {
+                    w->blocks = blocks;
+                    w->block_capacity = capacity;
+                }
+            }
+            if (w->block_count < w->block_capacity) {
+                w->blocks[w->block_count++] = block;
+            } else {
+                w->failed = 1;
+            }
+        }
+    }
+
+    for (int c = 0; c < count; c++) {
+        free(layout[c].offsets);
+    }
+    free(layout);
+    free(b.data);
+    if (!ok) {
+        w->failed = 1;
+    }
+    return ok && !w->failed ? 0 : -1;
+}
+
+int arrow_end(arrow_writer_t *w) {
+    if (!w->stage) {
+        return -1;
+    }
+
+    // End-of-stream marker
+    unsigned char eos[8];
+    put_le(eos, 0xFFFFFFFFu, 4);
+    put_le(eos + 4, 0, 4);
+    emit(w, eos, sizeof(eos));
+
+    if (w->file_format) {
+        // Footer: version, schema, dictionaries (none), record batch blocks
+        fb_t b = {0};
+        size_t root = fb_alloc(&b, 4, 4);
+        fb_field_t f[] = { { 2, METADATA_V5 }, { FB_REF, 0 }, { 0, 0 }, { FB_REF, 0 } };
+        size_t pos[4];
+        fb_ref(&b, root, fb_table(&b, f, 4, pos));
+        fb_ref(&b, pos[1], fb_schema(&b, w->fields, w->field_count));
+
+        size_t blocks = fb_vector(&b, (size_t)w->block_count, 24, 8);
+        fb_ref(&b, pos[3], blocks);
+        for (int i = 0; i < w->block_count; i++) {
+            size_t slot = blocks + 4 + 24 * (size_t)i;
+            fb_put(&b, slot, (uint64_t)w->blocks[i].offset, 8);
+            fb_put(&b, slot + 8, (uint64_t)(uint32_t)w->blocks[i].metadata_length, 4);
+            fb_put(&b, slot + 16, (uint64_t)w->blocks[i].body_length, 8);
+        }
+
+        if (b.failed) {
+            w->failed = 1;
+        } else {
+            unsigned char trailer[10];
+            put_le(trailer, (uint32_t)b.size, 4);
+            memcpy(trailer + 4, ARROW_MAGIC, 6);
+            emit(w, b.data, b.size);
+            emit(w, trailer, sizeof(trailer));
+        }
+        free(b.data);
+    }
+
+    stage_flush(w);
+    if (fflush(w->fp) != 0) {
+        w->failed = 1;
+    }
+    free(w->stage);
+    free(w->blocks);
+    w->stage = NULL;
+    w->blocks = NULL;
+    return w->failed ? -1 : 0;
+}
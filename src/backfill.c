@@ -0,0 +1,563 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../include/backfill.h"
+#include "../include/api.h"
+#include "../include/parser.h"
+#include "../include/display.h"
+#include "../include/ratelimit.h"
+#include "../include/bulkfetch.h"
+#include "../include/options.h"
+#include "../include/histfile.h"
+#include "../include/paths.h"
+
+#define BACKFILL_DEFAULT_DAYS "max"
+#define BACKFILL_MAX_COINS 20000
+#define BACKFILL_DEFAULT_CONCURRENCY 4
+#define BACKFILL_DEFAULT_RATE 30       // Requests per minute (CoinGecko free tier)
+#define BACKFILL_MAX_ATTEMPTS 5        // Tries per coin on 429, 5xx or transport errors
+#define BACKFILL_COOLDOWN_MS 30000     // No new requests for this long after a 429
+#define BACKFILL_JOURNAL "journal"
+#define BACKFILL_SUFFIX ".hist"
+
+/**
+ * @brief One coin still to download
+ */
+typedef struct {
+    char *id;
+    char *url;
+} backfill_coin_t;
+
+/**
+ * @brief List of ids; id_set_sort() orders it for id_set_contains()
+ */
+typedef struct {
+    char **ids;
+    int count;
+    int capacity;
+} id_set_t;
+
+/**
+ * @brief State of one run
+ */
+typedef struct {
+    const char *dir;
+    const char *currency;
+    const char *days;
+    int journal_fd;
+    backfill_coin_t *coins; // Coins being downloaded
+    int total;             // Coins asked for
+    int finished;          // Coins with a file, including those already done
+    int failed;
+    long long samples;
+    long long bytes;
+} backfill_run_t;
+
+static void print_backfill_usage(void) {
+    printf("Usage: crypto backfill (--ids-from SOURCE | SYMBOL...) [--days D] [--out DIR]\n");
+    printf("                       [--currency CODE] [--concurrency K] [--rate PER_MINUTE]\n");
+    printf("  --ids-from     top:N (largest N coins by market cap) or file:PATH\n");
+    printf("                 (one id or symbol per line, - for stdin)\n");
+    printf("  --days D       Days of history, or max (default: %s)\n", BACKFILL_DEFAULT_DAYS);
+    printf("  --out DIR      Output directory (default: history/ in the cache directory)\n");
+    printf("  --currency     Quote currency of the prices (default: usd)\n");
+    printf("  --concurrency  Requests in flight (default: %d)\n", BACKFILL_DEFAULT_CONCURRENCY);
+    printf("  --rate         Requests per minute (default: %d)\n", BACKFILL_DEFAULT_RATE);
+    printf("Writes DIR/<id>%s per coin and records finished coins in DIR/%s;\n",
+           BACKFILL_SUFFIX, BACKFILL_JOURNAL);
+    printf("run the same command again to resume an interrupted backfill.\n");
+}
+
+static int compare_ids(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static int id_set_contains(const id_set_t *set, const char *id) {
+    return set->count > 0 &&
+           bsearch(&id, set->ids, (size_t)set->count, sizeof(char *), compare_ids) != NULL;
+}
+
+// Append an id (copied); call id_set_sort() before lookups
+static int id_set_add(id_set_t *set, const char *id) {
+    if (set->count == set->capacity) {
+        int grown = set->capacity > 0 ? set->capacity * 2 : 256;
+        char **ids = realloc(set->ids, (size_t)grown * sizeof(char *));
+        if (!ids) {
+            return -1;
+        }
+        set->ids = ids;
+        set->capacity = grown;
+    }
+    set->ids[set->count] = strdup(id);
+    return set->ids[set->count] ? (set->count++, 0) : -1;
+}
+
+static void id_set_sort(id_set_t *set) {
+    if (set->count > 1) {
+        qsort(set->ids, (size_t)set->count, sizeof(char *), compare_ids);
+    }
+}
+
+static void id_set_free(id_set_t *set) {
+    for (int i = 0; i < set->count; i++) {
+        free(set->ids[i]);
+    }
+    free(set->ids);
+    memset(set, 0, sizeof(*set));
+}
+
+typedef struct {
+    const char *id;
+    int index;
+} id_ref_t;
+
+static int compare_refs(const void *a, const void *b) {
+    const id_ref_t *x = (const id_ref_t *)a, *y = (const id_ref_t *)b;
+    int order = strcmp(x->id, y->id);
+    return order != 0 ? order : (x->index > y->index) - (x->index < y->index);
+}
+
+// Flags every id (of an unsorted set) that already appeared earlier in it
+static unsigned char *find_repeats(const id_set_t *ids) {
+    unsigned char *repeats = calloc((size_t)ids->count + 1, 1);
+    id_ref_t *refs = malloc(((size_t)ids->count + 1) * sizeof(id_ref_t));
+    if (!repeats || !refs) {
+        free(repeats);
+        free(refs);
+        return NULL;
+    }
+    for (int i = 0; i < ids->count; i++) {
+        refs[i].id = ids->ids[i];
+        refs[i].index = i;
+    }
+    qsort(refs, (size_t)ids->count, sizeof(id_ref_t), compare_refs);
+    for (int i = 1; i < ids->count; i++) {
+        if (strcmp(refs[i].id, refs[i - 1].id) == 0) {
+            repeats[refs[i].index] = 1;
+        }
+    }
+    free(refs);
+    return repeats;
+}
+
+// CoinGecko ids are lowercase words joined by '-'; anything else could
+// escape the output directory
+static int valid_id(const char *id) {
+    size_t len = strlen(id);
+    if (len == 0 || len >= HISTFILE_ID_SIZE || id[0] == '.') {
+        return 0;
+    }
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)id[i];
+        if (!islower(c) && !isdigit(c) && c != '-' && c != '_' && c != '.') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int coin_path(const backfill_run_t *run, const char *id, char *out, size_t size) {
+    int n = snprintf(out, size, "%s/%s%s", run->dir, id, BACKFILL_SUFFIX);
+    return n > 0 && (size_t)n < size ? 0 : -1;
+}
+
+// Ids of the first limit coins of the markets listing; pages count against the limiter
+static int ids_from_top(int limit, ratelimit_t *limiter, id_set_t *ids) {
+    int complete = 0;
+    markets_data_t markets = bulk_fetch_top(limit, limiter, &complete);
+    int ok = complete;
+    for (int i = 0; ok && i < markets.count; i++) {
+        ok = id_set_add(ids, markets.coins[i].id) == 0;
+    }
+    free_markets_data(&markets);
+
+    return ok && ids->count > 0 ? 0 : -1;
+}
+
+// One id or symbol per line; blank lines and # comments are skipped
+static int ids_from_file(const char *path, id_set_t *ids) {
+    FILE *fp = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!fp) {
+        return -1;
+    }
+
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t len;
+    int rc = 0;
+    while (rc == 0 && (len = getline(&line, &capacity, fp)) >= 0) {
+        char *start = line;
+        while (isspace((unsigned char)*start)) {
+            start++;
+        }
+        char *end = start + strlen(start);
+        while (end > start && isspace((unsigned char)end[-1])) {
+            *--end = '\0';
+        }
+        if (*start == '\0' || *start == '#') {
+            continue;
+        }
+        char *id = symbol_to_id(start);
+        rc = id && id_set_add(ids, id) == 0 ? 0 : -1;
+        free(id);
+    }
+    free(line);
+    if (fp != stdin) {
+        fclose(fp);
+    }
+    return rc;
+}
+
+/**
+ * @brief Ids already finished by an earlier run with the same range and currency
+ *
+ * A journal line only counts if it is complete and its file still opens
+ * with the recorded number of samples, so a torn last line or a damaged
+ * file means that coin is fetched again.
+ */
+static int load_journal(const backfill_run_t *run, id_set_t *done) {
+    // Read through the locked descriptor: closing any other descriptor of
+    // the journal would drop the lock
+    off_t size = lseek(run->journal_fd, 0, SEEK_END);
+    if (size < 0) {
+        return -1;
+    }
+    char *text = malloc((size_t)size + 1);
+    if (!text) {
+        return -1;
+    }
+    size_t used = 0;
+    while (used < (size_t)size) {
+        ssize_t n = pread(run->journal_fd, text + used, (size_t)size - used, (off_t)used);
+        if (n <= 0) {
+            free(text);
+            return -1;
+        }
+        used += (size_t)n;
+    }
+    text[used] = '\0';
+
+    char *line = text;
+    char *newline;
+    while ((newline = strchr(line, '\n')) != NULL) {
+        *newline = '\0';
+        char *fields[4];
+        char *cursor = line;
+        int n = 0;
+        for (; n < 4 && cursor; n++) {
+            fields[n] = cursor;
+            cursor = strchr(cursor, '\t');
+            if (cursor) {
+                *cursor++ = '\0';
+            }
+        }
+        line = newline + 1;
+        if (n != 4 || cursor || strcmp(fields[1], run->currency) != 0 ||
+            strcmp(fields[2], run->days) != 0 || !valid_id(fields[0])) {
+            continue;
+        }
+
+        char file_path[1100];
+        histfile_t file;
+        if (coin_path(run, fields[0], file_path, sizeof(file_path)) == 0 &&
+            histfile_open(file_path, &file) == 0) {
+            int intact = file.count == strtoull(fields[3], NULL, 10) &&
+                         strcmp(file.currency, run->currency) == 0 &&
+                         strcmp(file.days, run->days) == 0;
+            histfile_close(&file);
+            if (intact && id_set_add(done, fields[0]) != 0) {
+                break;
+            }
+        }
+    }
+    free(text);
+    id_set_sort(done);
+    return 0;
+}
+
+// The journal is locked for the whole run so two backfills never share a
+// directory; a line torn by a crash is ended so the next one starts clean
+static int open_journal(const char *dir) {
+    char path[1100];
+    snprintf(path, sizeof(path), "%s/%s", dir, BACKFILL_JOURNAL);
+    int fd = open(path, O_RDWR | O_APPEND | O_CREAT, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct flock lock;
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    if (fcntl(fd, F_SETLK, &lock) != 0) {
+        close(fd);
+        return -2;
+    }
+
+    off_t size = lseek(fd, 0, SEEK_END);
+    char last = '\n';
+    if (size > 0 && (pread(fd, &last, 1, size - 1) != 1 || (last != '\n' && write(fd, "\n", 1) != 1))) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// One write() per line: with O_APPEND a crash leaves at most a torn last line
+static int journal_append(const backfill_run_t *run, const char *id, int samples) {
+    char line[HISTFILE_ID_SIZE + 96];
+    int n = snprintf(line, sizeof(line), "%s\t%s\t%s\t%d\n", id, run->currency, run->days, samples);
+    if (n <= 0 || (size_t)n >= sizeof(line)) {
+        return -1;
+    }
+    return write(run->journal_fd, line, (size_t)n) == n ? 0 : -1;
+}
+
+// Parse a response, write the coin's file and record it
+static void finish_coin(backfill_run_t *run, const backfill_coin_t *coin, const char *data) {
+    chart_series_t series = parse_market_chart_json(data);
+
+    char path[1100];
+    int ok = series.success && coin_path(run, coin->id, path, sizeof(path)) == 0 &&
+             histfile_write(path, coin->id, run->currency, run->days, &series) == 0 &&
+             journal_append(run, coin->id, series.count) == 0;
+    if (ok) {
+        run->finished++;
+        run->samples += series.count;
+        run->bytes += (long long)series.count * 32;
+        fprintf(stderr, "[%d/%d] %s: %d samples\n", run->finished, run->total, coin->id,
+                series.count);
+    } else {
+        run->failed++;
+        fprintf(stderr, "Warning: %s: %s\n", coin->id,
+                series.success ? "could not write history file" : "unreadable response");
+    }
+    free_chart_series(&series);
+}
+
+static void coin_done(void *ctx, int index, const api_request_t *response, int attempts) {
+    backfill_run_t *run = ctx;
+    const backfill_coin_t *coin = &run->coins[index];
+    if (response->result == 0 && response->data) {
+        finish_coin(run, coin, response->data);
+        return;
+    }
+    run->failed++;
+    if (attempts == 0) {
+        // Never started: the deadline ran out
+        return;
+    }
+    if (response->status != 0) {
+        fprintf(stderr, "Warning: %s: HTTP %ld after %d attempt%s\n", coin->id, response->status,
+                attempts, attempts == 1 ? "" : "s");
+    } else {
+        fprintf(stderr, "Warning: %s: request failed after %d attempt%s\n", coin->id, attempts,
+                attempts == 1 ? "" : "s");
+    }
+}
+
+/**
+ * @brief Download every coin in the queue
+ *
+ * Keeps up to concurrency requests in flight, each started only when the
+ * shared limiter has a token. A 429 pauses new requests for
+ * BACKFILL_COOLDOWN_MS; 429s, server errors and transport errors put the
+ * coin back at the end of the queue, up to BACKFILL_MAX_ATTEMPTS times.
+ */
+static void download(backfill_run_t *run, backfill_coin_t *coins, int count, int concurrency,
+                     ratelimit_t *limiter) {
+    for (int i = 0; i < count; i++) {
+        coins[i].url = get_market_chart_url(coins[i].id, run->currency, run->days);
+    }
+
+    bulk_options_t options = { concurrency, limiter, BACKFILL_MAX_ATTEMPTS, 1, BACKFILL_COOLDOWN_MS };
+    run->coins = coins;
+    if (bulk_fetch(&coins[0].url, sizeof(coins[0]), count, &options, coin_done, run) != 0) {
+        run->failed += count;
+        display_error("Memory allocation failed");
+    }
+    run->coins = NULL;
+}
+
+int backfill_command(int argc, char *argv[]) {
+    const char *source = NULL;
+    const char *days = BACKFILL_DEFAULT_DAYS;
+    const char *out = NULL;
+    char currency[8] = "usd";
+    int concurrency = BACKFILL_DEFAULT_CONCURRENCY;
+    double rate = BACKFILL_DEFAULT_RATE;
+    int listed = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ids-from") == 0 && i + 1 < argc) {
+            source = argv[++i];
+        } else if (strcmp(argv[i], "--days") == 0 && i + 1 < argc) {
+            days = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out = argv[++i];
+        } else if (strcmp(argv[i], "--currency") == 0 && i + 1 < argc) {
+            if (options_parse_currency(argv[++i], currency, sizeof(currency)) != 0) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--concurrency") == 0 && i + 1 < argc) {
+            concurrency = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            rate = atof(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            print_backfill_usage();
+            return 1;
+        } else {
+            listed++;
+        }
+    }
+    if ((source != NULL) == (listed > 0)) {
+        print_backfill_usage();
+        return 1;
+    }
+    if (!options_valid_days(days)) {
+        display_error("--days must be a positive number of days or max");
+        return 1;
+    }
+    if (concurrency <= 0 || concurrency > 64) {
+        display_error("Concurrency must be between 1 and 64");
+        return 1;
+    }
+
+    int top = 0;
+    if (source && strncmp(source, "top:", 4) == 0) {
+        top = atoi(source + 4);
+        if (top <= 0 || top > BACKFILL_MAX_COINS) {
+            char message[64];
+            snprintf(message, sizeof(message), "top:N must be between 1 and %d", BACKFILL_MAX_COINS);
+            display_error(message);
+            return 1;
+        }
+    } else if (source && strncmp(source, "file:", 5) != 0) {
+        display_error("--ids-from expects top:N or file:PATH");
+        return 1;
+    }
+
+    // Short enough that DIR/<id>.hist always fits a path buffer
+    char dir[896];
+    int n = -1;
+    if (out) {
+        n = snprintf(dir, sizeof(dir), "%s", out);
+    } else if (paths_cache_dir(dir, sizeof(dir)) == 0) {
+        size_t len = strlen(dir);
+        n = snprintf(dir + len, sizeof(dir) - len, "/history");
+        n = n < 0 ? n : n + (int)len;
+    }
+    if (n <= 0 || (size_t)n >= sizeof(dir) || paths_make_dir(dir) != 0) {
+        display_error("Cannot create the output directory");
+        return 1;
+    }
+
+    backfill_run_t run;
+    memset(&run, 0, sizeof(run));
+    run.dir = dir;
+    run.currency = currency;
+    run.days = days;
+    run.journal_fd = open_journal(dir);
+    if (run.journal_fd < 0) {
+        display_error(run.journal_fd == -2 ? "Another backfill is writing to this directory"
+                                           : "Cannot open the backfill journal");
+        return 1;
+    }
+
+    // One bucket for every request of the run, the markets pages included
+    ratelimit_t limiter;
+    ratelimit_init(&limiter, rate, concurrency);
+
+    id_set_t ids = { 0 };
+    int rc = 0;
+    if (top > 0) {
+        rc = ids_from_top(top, &limiter, &ids);
+        if (rc != 0) {
+            display_error("Failed to fetch markets data from API. Please check your internet connection and try again.");
+        }
+    } else if (source) {
+        rc = ids_from_file(source + 5, &ids);
+        if (rc != 0) {
+            display_error("Cannot read the id list");
+        }
+    } else {
+        for (int i = 1; i < argc && rc == 0; i++) {
+            if (argv[i][0] == '-') {
+                i++;
+                continue;
+            }
+            char *id = symbol_to_id(argv[i]);
+            rc = id && id_set_add(&ids, id) == 0 ? 0 : -1;
+            free(id);
+        }
+        if (rc != 0) {
+            display_error("Invalid symbol");
+        }
+    }
+
+    id_set_t done = { 0 };
+    backfill_coin_t *coins = NULL;
+    unsigned char *repeats = NULL;
+    int count = 0;
+    if (rc == 0 && load_journal(&run, &done) != 0) {
+        display_error("Cannot read the backfill journal");
+        rc = -1;
+    }
+    if (rc == 0) {
+        coins = calloc((size_t)ids.count + 1, sizeof(backfill_coin_t));
+        repeats = find_repeats(&ids);
+        rc = coins && repeats ? 0 : -1;
+    }
+
+    // Keep the listing's order; drop repeats, bad ids and coins already done
+    for (int i = 0; rc == 0 && i < ids.count; i++) {
+        const char *id = ids.ids[i];
+        if (repeats[i]) {
+            continue;
+        }
+        run.total++;
+        if (!valid_id(id)) {
+            fprintf(stderr, "Warning: skipping invalid id \"%s\"\n", id);
+            run.failed++;
+        } else if (id_set_contains(&done, id)) {
+            run.finished++;
+        } else {
+            coins[count].id = strdup(id);
+            count += coins[count].id != NULL;
+        }
+    }
+
+    if (rc == 0) {
+        if (run.finished > 0) {
+            fprintf(stderr, "Resuming: %d of %d coins already in %s\n", run.finished, run.total, dir);
+        }
+        if (count > 0) {
+            download(&run, coins, count, concurrency, &limiter);
+        }
+        printf("%d of %d coins in %s (%lld samples, %.1f MB written this run)", run.finished,
+               run.total, dir, run.samples, (double)run.bytes / (1024.0 * 1024.0));
+        if (run.failed > 0) {
+            printf("; %d failed, run again to retry\n", run.failed);
+        } else {
+            putchar('\n');
+        }
+        rc = run.failed > 0 ? -1 : 0;
+    }
+
+    for (int i = 0; coins && i < count; i++) {
+        free(coins[i].id);
+        free(coins[i].url);
+    }
+    free(coins);
+    free(repeats);
+    id_set_free(&ids);
+    id_set_free(&done);
+    ratelimit_destroy(&limiter);
+    close(run.journal_fd);
+    return rc == 0 ? 0 : 1;
+}
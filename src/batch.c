@@ -0,0 +1,487 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stddef.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include "../include/batch.h"
+#include "../include/api.h"
+#include "../include/parser.h"
+#include "../include/display.h"
+#include "../include/queue.h"
+#include "../include/ratelimit.h"
+#include "../include/planner.h"
+#include "../include/coinids.h"
+#include "../include/options.h"
+
+#define BATCH_DEFAULT_CHUNK 100
+#define BATCH_MAX_CHUNK 250
+#define BATCH_DEFAULT_CONCURRENCY 4
+#define BATCH_DEFAULT_RATE 30          // Requests per minute (CoinGecko free tier)
+#define BATCH_QUEUE_CAPACITY 16
+#define BATCH_IDLE_FLUSH_MS 50         // Send a partial chunk after this much input silence
+#define BATCH_LINE_MAX 256
+
+// Columns when --fields is not given
+#define BATCH_DEFAULT_FIELDS (PLAN_PRICE | PLAN_CHANGE_24H | PLAN_MARKET_CAP | PLAN_VOLUME_24H)
+
+/**
+ * @brief Unit of work passed between stages: one simple/price request
+ */
+typedef struct {
+    long seq;
+    int count;
+    char **inputs;                  // Symbols as read from stdin
+    char **ids;                     // Resolved CoinGecko ids
+    char *url;
+    api_request_t request;
+    markets_data_t quotes;
+    const crypto_data_t **matches;  // Quote for each input, NULL if not found
+} batch_chunk_t;
+
+typedef struct {
+    int chunk_size;
+    int concurrency;
+    int window;                     // Max chunks between oldest unemitted and newest fetched
+    char currency[16];
+    unsigned fields;                // PLAN_* mask: requested, parsed and printed
+    ratelimit_t limiter;
+    spsc_queue_t resolved;          // resolve -> fetch
+    spsc_queue_t fetched;           // fetch -> parse
+    spsc_queue_t parsed;            // parse -> emit
+    atomic_long emitted;            // Next sequence number the emitter waits for
+} batch_pipeline_t;
+
+static batch_chunk_t *chunk_new(long seq, int capacity) {
+    batch_chunk_t *chunk = calloc(1, sizeof(batch_chunk_t));
+    if (!chunk) {
+        return NULL;
+    }
+
+    chunk->seq = seq;
+    chunk->inputs = calloc((size_t)capacity, sizeof(char *));
+    chunk->ids = calloc((size_t)capacity, sizeof(char *));
+    chunk->matches = calloc((size_t)capacity, sizeof(crypto_data_t *));
+    if (!chunk->inputs || !chunk->ids || !chunk->matches) {
+        free(chunk->inputs);
+        free(chunk->ids);
+        free(chunk->matches);
+        free(chunk);
+        return NULL;
+    }
+    return chunk;
+}
+
+static void chunk_free(batch_chunk_t *chunk) {
+    if (!chunk) {
+        return;
+    }
+
+    for (int i = 0; i < chunk->count; i++) {
+        free(chunk->inputs[i]);
+        free(chunk->ids[i]);
+    }
+    free(chunk->inputs);
+    free(chunk->ids);
+    free(chunk->matches);
+    free(chunk->url);
+    free(chunk->request.data);
+    free_markets_data(&chunk->quotes);
+    free(chunk);
+}
+
+static int chunk_add(batch_chunk_t *chunk, const char *symbol) {
+    char *input = malloc(strlen(symbol) + 1);
+    char *id = symbol_to_id(symbol);
+    if (!input || !id) {
+        free(input);
+        free(id);
+        return -1;
+    }
+
+    strcpy(input, symbol);
+    chunk->inputs[chunk->count] = input;
+    chunk->ids[chunk->count] = id;
+    chunk->count++;
+    return 0;
+}
+
+// Stage 1: read symbols from stdin and group them into chunks
+static void *resolve_stage(void *arg) {
+    batch_pipeline_t *pipeline = (batch_pipeline_t *)arg;
+    char buffer[4096];
+    char line[BATCH_LINE_MAX];
+    size_t line_len = 0;
+    long seq = 0;
+    batch_chunk_t *chunk = NULL;
+    int eof = 0;
+    int in_comment = 0;
+
+    while (!eof) {
+        // Wait briefly for input; on silence, ship the partial chunk so
+        // results keep streaming while a slow producer is still writing
+        struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+        int ready = poll(&pfd, 1, (chunk && chunk->count > 0) ? BATCH_IDLE_FLUSH_MS : -1);
+        if (ready == 0) {
+            spsc_queue_push(&pipeline->resolved, chunk);
+            chunk = NULL;
+            continue;
+        }
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+
+        ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            eof = 1;
+            n = 0;
+            // Treat a final unterminated line like a terminated one
+            if (line_len > 0) {
+                buffer[n++] = '\n';
+            }
+        }
+
+        for (ssize_t i = 0; i < n; i++) {
+            char c = buffer[i];
+            // Symbols are separated by newlines, commas or spaces; '#' comments to end of line
+            if (in_comment) {
+                in_comment = (c != '\n');
+                continue;
+            }
+            if (c == '#' && line_len == 0) {
+                in_comment = 1;
+                continue;
+            }
+            if (c != '\n' && c != '\r' && c != ',' && !isspace((unsigned char)c)) {
+                if (line_len < sizeof(line) - 1) {
+                    line[line_len++] = c;
+                }
+                continue;
+            }
+            if (line_len == 0) {
+                continue;
+            }
+            line[line_len] = '\0';
+            line_len = 0;
+
+            if (!chunk) {
+                chunk = chunk_new(seq++, pipeline->chunk_size);
+                if (!chunk) {
+                    eof = 1;
+                    break;
+                }
+            }
+            if (chunk_add(chunk, line) != 0) {
+                continue;
+            }
+            if (chunk->count == pipeline->chunk_size) {
+                spsc_queue_push(&pipeline->resolved, chunk);
+                chunk = NULL;
+            }
+        }
+    }
+
+    if (chunk && chunk->count > 0) {
+        spsc_queue_push(&pipeline->resolved, chunk);
+    } else {
+        chunk_free(chunk);
+    }
+    spsc_queue_close(&pipeline->resolved);
+    return NULL;
+}
+
+static char *build_chunk_url(const batch_chunk_t *chunk, const char *currency, unsigned fields) {
+    char *csv = join_ids(chunk->ids, sizeof(chunk->ids[0]), chunk->count);
+    if (!csv) {
+        return NULL;
+    }
+
+    char *url = get_simple_price_url(csv, currency, fields);
+    free(csv);
+    return url;
+}
+
+// Stage 2: keep up to `concurrency` requests in flight, paced by the limiter
+static void *fetch_stage(void *arg) {
+    batch_pipeline_t *pipeline = (batch_pipeline_t *)arg;
+    api_async_t *async = api_async_new(pipeline->concurrency);
+    batch_chunk_t *staged = NULL;
+    int input_done = 0;
+
+    if (!async) {
+        // No transport: pass every chunk on as failed
+        void *item = NULL;
+        while (spsc_queue_pop(&pipeline->resolved, &item)) {
+            ((batch_chunk_t *)item)->request.result = -1;
+            spsc_queue_push(&pipeline->fetched, item);
+        }
+    }
+
+    while (async && (!input_done || staged || api_async_pending(async) > 0)) {
+        // Admit new work while there is room, budget and reorder window
+        while (api_async_has_capacity(async)) {
+            if (!staged) {
+                void *item = NULL;
+                int got;
+                if (api_async_pending(async) == 0) {
+                    got = spsc_queue_pop(&pipeline->resolved, &item);
+                    if (!got) {
+                        input_done = 1;
+                    }
+                } else {
+                    got = spsc_queue_try_pop(&pipeline->resolved, &item);
+                }
+                if (!got) {
+                    break;
+                }
+                staged = (batch_chunk_t *)item;
+            }
+
+            long emitted = atomic_load(&pipeline->emitted);
+            if (staged->seq >= emitted + pipeline->window) {
+                break;
+            }
+            if (!ratelimit_try_acquire(&pipeline->limiter)) {
+                break;
+            }
+
+            staged->url = build_chunk_url(staged, pipeline->currency, pipeline->fields);
+            staged->request.url = staged->url;
+            if (!staged->url || api_async_add(async, &staged->request) != 0) {
+                // Hand it on as failed so its lines still come out
+                staged->request.result = -1;
+                spsc_queue_push(&pipeline->fetched, staged);
+            }
+            staged = NULL;
+        }
+
+        if (api_async_pending(async) == 0) {
+            if (staged) {
+                // Waiting on the limiter or the emitter
+                struct timespec ts = { 0, 20 * 1000000L };
+                nanosleep(&ts, NULL);
+            }
+            continue;
+        }
+
+        api_request_t *done = api_async_next(async, 50);
+        if (done) {
+            batch_chunk_t *chunk = (batch_chunk_t *)((char *)done - offsetof(batch_chunk_t, request));
+            spsc_queue_push(&pipeline->fetched, chunk);
+        }
+    }
+
+    api_async_free(async);
+    spsc_queue_close(&pipeline->fetched);
+    return NULL;
+}
+
+// Stage 3: parse responses and match quotes back to inputs
+static void *parse_stage(void *arg) {
+    batch_pipeline_t *pipeline = (batch_pipeline_t *)arg;
+    void *item = NULL;
+
+    while (spsc_queue_pop(&pipeline->fetched, &item)) {
+        batch_chunk_t *chunk = (batch_chunk_t *)item;
+
+        if (chunk->request.result == 0) {
+            chunk->quotes = parse_simple_price_batch_json_fields(chunk->request.data,
+                                                                 pipeline->currency, pipeline->fields);
+            for (int i = 0; i < chunk->count; i++) {
+                for (int q = 0; q < chunk->quotes.count; q++) {
+                    const crypto_data_t *quote = &chunk->quotes.coins[q];
+                    if (quote->success && quote->id && strcmp(quote->id, chunk->ids[i]) == 0) {
+                        chunk->matches[i] = quote;
+                        break;
+                    }
+                }
+            }
+        }
+        free(chunk->request.data);
+        chunk->request.data = NULL;
+
+        spsc_queue_push(&pipeline->parsed, chunk);
+    }
+
+    spsc_queue_close(&pipeline->parsed);
+    return NULL;
+}
+
+static void emit_chunk(const batch_chunk_t *chunk, unsigned fields) {
+    for (int i = 0; i < chunk->count; i++) {
+        const crypto_data_t *quote = chunk->matches[i];
+        if (chunk->request.result != 0) {
+            printf("%s\t%s\terror\n", chunk->inputs[i], chunk->ids[i]);
+        } else if (!quote) {
+            printf("%s\t%s\tnot_found\n", chunk->inputs[i], chunk->ids[i]);
+        } else {
+            // Columns in a fixed order, each present only if requested
+            printf("%s\t%s", chunk->inputs[i], chunk->ids[i]);
+            if (fields & PLAN_PRICE) {
+                printf("\t%.10g", quote->current_price);
+            }
+            if (fields & PLAN_CHANGE_24H) {
+                printf("\t%.4f", quote->price_change_percentage_24h);
+            }
+            if (fields & PLAN_MARKET_CAP) {
+                printf("\t%.0f", quote->market_cap);
+            }
+            if (fields & PLAN_VOLUME_24H) {
+                printf("\t%.0f", quote->volume_24h);
+            }
+            if (fields & PLAN_LAST_UPDATED) {
+                printf("\t%ld", quote->last_updated_at);
+            }
+            putchar('\n');
+        }
+    }
+    fflush(stdout);
+}
+
+// Queues never initialised are still zeroed, so this is safe on every exit path
+static void pipeline_free(batch_pipeline_t *pipeline) {
+    spsc_queue_destroy(&pipeline->resolved);
+    spsc_queue_destroy(&pipeline->fetched);
+    spsc_queue_destroy(&pipeline->parsed);
+    ratelimit_destroy(&pipeline->limiter);
+}
+
+static void print_batch_usage(void) {
+    printf("Usage: crypto batch [--currency CUR] [--chunk N] [--concurrency N] [--rate PER_MINUTE] < symbols.txt\n");
+    printf("Output: input<TAB>id<TAB>price<TAB>change_24h_pct<TAB>market_cap<TAB>volume_24h\n");
+    printf("        (--fields price,change_24h,market_cap,volume_24h,last_updated picks columns)\n");
+}
+
+int batch_command(int argc, char *argv[], const cli_options_t *options) {
+    batch_pipeline_t pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.chunk_size = BATCH_DEFAULT_CHUNK;
+    pipeline.concurrency = BATCH_DEFAULT_CONCURRENCY;
+    strcpy(pipeline.currency, "usd");
+    pipeline.fields = options->fields ? options->fields : BATCH_DEFAULT_FIELDS;
+    double rate = BATCH_DEFAULT_RATE;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--currency") == 0 && i + 1 < argc) {
+            if (options_parse_currency(argv[++i], pipeline.currency, sizeof(pipeline.currency)) != 0) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+            pipeline.chunk_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--concurrency") == 0 && i + 1 < argc) {
+            pipeline.concurrency = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            rate = atof(argv[++i]);
+        } else {
+            print_batch_usage();
+            return 1;
+        }
+    }
+
+    // simple/price has no high/low or names to ask for
+    if (pipeline.fields & (PLAN_HIGH_LOW_24H | PLAN_NAME)) {
+        if (options->fields != PLAN_ALL) {
+            display_error("batch --fields supports price, change_24h, market_cap, volume_24h and last_updated");
+            return 1;
+        }
+        pipeline.fields &= ~(unsigned)(PLAN_HIGH_LOW_24H | PLAN_NAME);
+    }
+
+    if (pipeline.chunk_size <= 0 || pipeline.chunk_size > BATCH_MAX_CHUNK) {
+        display_error("Chunk size must be between 1 and 250");
+        return 1;
+    }
+    if (pipeline.concurrency <= 0 || pipeline.concurrency > 64) {
+        display_error("Concurrency must be between 1 and 64");
+        return 1;
+    }
+
+    pipeline.window = pipeline.concurrency * 4;
+    atomic_init(&pipeline.emitted, 0);
+    ratelimit_init(&pipeline.limiter, rate, pipeline.concurrency);
+
+    int queues = spsc_queue_init(&pipeline.resolved, BATCH_QUEUE_CAPACITY) == 0 &&
+                 spsc_queue_init(&pipeline.fetched, BATCH_QUEUE_CAPACITY) == 0 &&
+                 spsc_queue_init(&pipeline.parsed, BATCH_QUEUE_CAPACITY) == 0;
+
+    // Stage 4 (this thread) emits in input order. Chunks can finish out of
+    // order; the fetch window bounds how many wait here.
+    batch_chunk_t **pending = queues ? calloc((size_t)pipeline.window, sizeof(batch_chunk_t *)) : NULL;
+    if (!pending) {
+        display_error("Memory allocation failed");
+        pipeline_free(&pipeline);
+        return 1;
+    }
+
+    // Started from the last stage back. A stage that cannot start has its
+    // output closed instead, so the stages after it see an empty stream and
+    // finish; the ones before it are never started.
+    pthread_t resolver, fetcher, parser;
+    int parser_started = pthread_create(&parser, NULL, parse_stage, &pipeline) == 0;
+    if (!parser_started) {
+        spsc_queue_close(&pipeline.parsed);
+    }
+    int fetcher_started = parser_started && pthread_create(&fetcher, NULL, fetch_stage, &pipeline) == 0;
+    if (!fetcher_started) {
+        spsc_queue_close(&pipeline.fetched);
+    }
+    int resolver_started = fetcher_started &&
+                           pthread_create(&resolver, NULL, resolve_stage, &pipeline) == 0;
+    if (!resolver_started) {
+        spsc_queue_close(&pipeline.resolved);
+    }
+
+    long next_seq = 0;
+    int failures = 0;
+    void *item = NULL;
+
+    while (spsc_queue_pop(&pipeline.parsed, &item)) {
+        batch_chunk_t *chunk = (batch_chunk_t *)item;
+        pending[chunk->seq % pipeline.window] = chunk;
+
+        while (pending[next_seq % pipeline.window] &&
+               pending[next_seq % pipeline.window]->seq == next_seq) {
+            batch_chunk_t *ready = pending[next_seq % pipeline.window];
+            pending[next_seq % pipeline.window] = NULL;
+            if (ready->request.result != 0) {
+                failures++;
+            }
+            emit_chunk(ready, pipeline.fields);
+            chunk_free(ready);
+            next_seq++;
+            atomic_store(&pipeline.emitted, next_seq);
+        }
+    }
+
+    if (resolver_started) {
+        pthread_join(resolver, NULL);
+    }
+    if (fetcher_started) {
+        pthread_join(fetcher, NULL);
+    }
+    if (parser_started) {
+        pthread_join(parser, NULL);
+    }
+
+    free(pending);
+    pipeline_free(&pipeline);
+
+    if (!resolver_started) {
+        display_error("Cannot start the batch pipeline threads");
+        return 1;
+    }
+    if (failures) {
+        display_error("Some requests failed; affected symbols are marked \"error\"");
+        return 1;
+    }
+    return 0;
+}
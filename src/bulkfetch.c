@@ -0,0 +1,169 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stddef.h>
+#include "../include/bulkfetch.h"
+
+/**
+ * @brief One URL of a bulk_fetch() and its current request
+ */
+typedef struct {
+    api_request_t request;
+    int attempts;
+} bulk_entry_t;
+
+markets_data_t bulk_fetch_top(int limit, ratelimit_t *limiter, int *complete) {
+    markets_data_t top;
+    memset(&top, 0, sizeof(top));
+    if (complete) {
+        *complete = 0;
+    }
+    if (limit <= 0) {
+        return top;
+    }
+
+    int per_page = limit < BULK_MARKETS_PAGE ? limit : BULK_MARKETS_PAGE;
+    int pages = (limit + per_page - 1) / per_page;
+
+    api_request_t *requests = calloc((size_t)pages, sizeof(api_request_t));
+    top.coins = calloc((size_t)limit, sizeof(crypto_data_t));
+    if (!requests || !top.coins) {
+        free(requests);
+        free(top.coins);
+        top.coins = NULL;
+        return top;
+    }
+
+    int ok = 1;
+    for (int p = 0; p < pages && ok; p++) {
+        requests[p].url = get_markets_url_page(per_page, p + 1);
+        ok = requests[p].url != NULL;
+        if (limiter) {
+            ratelimit_acquire(limiter);
+        }
+    }
+    if (ok) {
+        api_fetch_parallel(requests, pages, 0);
+    }
+
+    // Pages are read in order, so coins keep their market-cap rank
+    int all = ok;
+    for (int p = 0; p < pages; p++) {
+        markets_data_t page;
+        memset(&page, 0, sizeof(page));
+        if (ok && requests[p].result == 0 && requests[p].data) {
+            page = parse_markets_json(requests[p].data, per_page);
+        }
+        all = all && page.success;
+        for (int i = 0; page.success && i < page.count && top.count < limit; i++) {
+            if (page.coins[i].success && page.coins[i].id) {
+                // Move the coin over; the page then frees an empty entry
+                top.coins[top.count++] = page.coins[i];
+                memset(&page.coins[i], 0, sizeof(page.coins[i]));
+            }
+        }
+        free_markets_data(&page);
+        free(requests[p].data);
+        free((char *)requests[p].url);
+    }
+    free(requests);
+
+    if (top.count == 0) {
+        free(top.coins);
+        top.coins = NULL;
+        return top;
+    }
+    top.success = 1;
+    if (complete) {
+        *complete = all;
+    }
+    return top;
+}
+
+int bulk_fetch(const void *first_url, size_t stride, int count, const bulk_options_t *options,
+               bulk_done_fn done, void *ctx) {
+    if (count <= 0) {
+        return 0;
+    }
+
+    api_async_t *async = api_async_new(options->concurrency);
+    bulk_entry_t *entries = calloc((size_t)count, sizeof(bulk_entry_t));
+    int *queue = malloc((size_t)count * sizeof(int));
+    if (!async || !entries || !queue) {
+        api_async_free(async);
+        free(entries);
+        free(queue);
+        return -1;
+    }
+
+    // Ring of indexes waiting for a request; each URL is queued at most once
+    const char *base = (const char *)first_url;
+    long head = 0, tail = 0;
+    for (int i = 0; i < count; i++) {
+        queue[tail++ % count] = i;
+    }
+
+    long long cooldown_until = 0;
+    while ((head < tail && api_remaining_ms() > 0) || api_async_pending(async) > 0) {
+        while (head < tail && api_remaining_ms() > 0 && api_monotonic_ms() >= cooldown_until &&
+               api_async_has_capacity(async) &&
+               (!options->limiter || ratelimit_try_acquire(options->limiter))) {
+            int index = queue[head++ % count];
+            bulk_entry_t *entry = &entries[index];
+            memset(&entry->request, 0, sizeof(entry->request));
+            entry->request.url = *(const char *const *)(base + (size_t)index * stride);
+            entry->attempts++;
+            if (!entry->request.url || api_async_add(async, &entry->request) != 0) {
+                entry->request.result = -1;
+                done(ctx, index, &entry->request, entry->attempts);
+            }
+        }
+
+        if (api_async_pending(async) == 0) {
+            if (head < tail) {
+                // Waiting on the limiter or a cooldown
+                struct timespec ts = { 0, 20 * 1000000L };
+                nanosleep(&ts, NULL);
+            }
+            continue;
+        }
+
+        api_request_t *response = api_async_next(async, 50);
+        if (!response) {
+            continue;
+        }
+        bulk_entry_t *entry = (bulk_entry_t *)((char *)response - offsetof(bulk_entry_t, request));
+        int index = (int)(entry - entries);
+        int retry = response->status == 429 ||
+                    (options->retry_errors && (response->status >= 500 || response->status == 0));
+        if ((response->result != 0 || !response->data) && retry &&
+            entry->attempts < options->max_attempts && api_remaining_ms() > 0) {
+            if (response->status == 429 && options->cooldown_ms > 0) {
+                cooldown_until = api_monotonic_ms() + options->cooldown_ms;
+                fprintf(stderr, "Rate limited; pausing for %d s\n", options->cooldown_ms / 1000);
+            }
+            queue[tail++ % count] = index;
+        } else {
+            done(ctx, index, response, entry->attempts);
+        }
+        free(response->data);
+        response->data = NULL;
+    }
+
+    // URLs still queued when the deadline ran out; retries keep their last response
+    while (head < tail) {
+        int index = queue[head++ % count];
+        if (entries[index].attempts == 0) {
+            entries[index].request.result = -1;
+        }
+        done(ctx, index, &entries[index].request, entries[index].attempts);
+    }
+
+    api_async_free(async);
+    free(entries);
+    free(queue);
+    return 0;
+}
@@ -0,0 +1,348 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "../include/client.h"
+#include "../include/api.h"
+#include "../include/ratelimit.h"
+#include "../include/intern.h"
+
+/**
+ * @brief One cache slot (quote strings use the client allocator)
+ */
+struct cache_entry {
+    uint32_t hash;
+    char *id;
+    char *currency;
+    crypto_data_t quote;
+    double fetched_at;
+    int used;
+};
+
+struct crypto_client {
+    crypto_client_config_t config;
+    api_pool_t *pool;
+    ratelimit_t limiter;
+    pthread_mutex_t cache_lock;
+    struct cache_entry *cache;   // Direct-mapped: a new quote replaces whatever shares its slot
+};
+
+// Hash of "id/currency"
+static uint32_t quote_hash(const char *id, const char *currency) {
+    uint32_t h = intern_hash(INTERN_HASH_SEED, id, strlen(id));
+    h = intern_hash(h, "/", 1);
+    return intern_hash(h, currency, strlen(currency));
+}
+
+static char *client_strdup(crypto_client_t *client, const char *s) {
+    if (!s) {
+        return NULL;
+    }
+    size_t len = strlen(s);
+    char *copy = client->config.malloc_fn(len + 1);
+    if (copy) {
+        memcpy(copy, s, len + 1);
+    }
+    return copy;
+}
+
+static void client_free_quote(crypto_client_t *client, crypto_data_t *quote) {
+    client->config.free_fn(quote->id);
+    client->config.free_fn(quote->symbol);
+    client->config.free_fn(quote->name);
+    client->config.free_fn(quote->currency);
+    memset(quote, 0, sizeof(*quote));
+}
+
+// Deep copy into client-allocated strings
+static int client_copy_quote(crypto_client_t *client, crypto_data_t *dst, const crypto_data_t *src) {
+    *dst = *src;
+    dst->interned = 0;
+    dst->id = client_strdup(client, src->id);
+    dst->symbol = client_strdup(client, src->symbol);
+    dst->name = client_strdup(client, src->name);
+    dst->currency = client_strdup(client, src->currency);
+
+    if ((src->id && !dst->id) || (src->symbol && !dst->symbol) ||
+        (src->name && !dst->name) || (src->currency && !dst->currency)) {
+        client_free_quote(client, dst);
+        return -1;
+    }
+    return 0;
+}
+
+static void cache_entry_clear(crypto_client_t *client, struct cache_entry *entry) {
+    if (!entry->used) {
+        return;
+    }
+    client->config.free_fn(entry->id);
+    client->config.free_fn(entry->currency);
+    client_free_quote(client, &entry->quote);
+    entry->used = 0;
+}
+
+void crypto_client_config_default(crypto_client_config_t *config) {
+    if (!config) {
+        return;
+    }
+
+    memset(config, 0, sizeof(*config));
+    config->malloc_fn = malloc;
+    config->free_fn = free;
+    config->cache_ttl_seconds = CRYPTO_CLIENT_DEFAULT_TTL;
+    config->cache_size = CRYPTO_CLIENT_DEFAULT_CACHE_SIZE;
+    config->requests_per_minute = 0;
+    config->burst = 1;
+    config->timeout_ms = API_DEFAULT_TIMEOUT_MS;
+}
+
+crypto_client_t *crypto_client_new(const crypto_client_config_t *config) {
+    crypto_client_config_t settings;
+    if (config) {
+        settings = *config;
+    } else {
+        crypto_client_config_default(&settings);
+    }
+
+    if (!settings.malloc_fn || !settings.free_fn) {
+        settings.malloc_fn = malloc;
+        settings.free_fn = free;
+    }
+    if (settings.cache_size <= 0) {
+        settings.cache_ttl_seconds = 0;
+    }
+
+    crypto_client_t *client = settings.malloc_fn(sizeof(crypto_client_t));
+    if (!client) {
+        return NULL;
+    }
+    memset(client, 0, sizeof(*client));
+    client->config = settings;
+
+    client->pool = api_pool_new(settings.timeout_ms);
+    if (!client->pool) {
+        settings.free_fn(client);
+        return NULL;
+    }
+
+    if (settings.cache_ttl_seconds > 0) {
+        size_t bytes = (size_t)settings.cache_size * sizeof(struct cache_entry);
+        client->cache = settings.malloc_fn(bytes);
+        if (!client->cache) {
+            api_pool_free(client->pool);
+            settings.free_fn(client);
+            return NULL;
+        }
+        memset(client->cache, 0, bytes);
+    }
+
+    ratelimit_init(&client->limiter, settings.requests_per_minute, settings.burst);
+    pthread_mutex_init(&client->cache_lock, NULL);
+
+    return client;
+}
+
+void crypto_client_free(crypto_client_t *client) {
+    if (!client) {
+        return;
+    }
+
+    if (client->cache) {
+        for (int i = 0; i < client->config.cache_size; i++) {
+            cache_entry_clear(client, &client->cache[i]);
+        }
+        client->config.free_fn(client->cache);
+    }
+
+    pthread_mutex_destroy(&client->cache_lock);
+    ratelimit_destroy(&client->limiter);
+    api_pool_free(client->pool);
+    client->config.free_fn(client);
+}
+
+// Copy a fresh cached quote into out; returns 0 on hit
+static int cache_lookup(crypto_client_t *client, uint32_t hash, const char *id, const char *currency,
+                        crypto_data_t *out) {
+    if (!client->cache) {
+        return -1;
+    }
+
+    int rc = -1;
+    struct cache_entry *entry = &client->cache[hash % (uint32_t)client->config.cache_size];
+
+    pthread_mutex_lock(&client->cache_lock);
+    if (entry->used && entry->hash == hash &&
+        strcmp(entry->id, id) == 0 && strcmp(entry->currency, currency) == 0 &&
+        api_monotonic_ms() / 1000.0 - entry->fetched_at < client->config.cache_ttl_seconds) {
+        rc = client_copy_quote(client, out, &entry->quote);
+    }
+    pthread_mutex_unlock(&client->cache_lock);
+
+    return rc;
+}
+
+static void cache_store(crypto_client_t *client, uint32_t hash, const char *id, const char *currency,
+                        const crypto_data_t *quote) {
+    if (!client->cache) {
+        return;
+    }
+
+    // Build the entry outside the lock, then swap it in
+    struct cache_entry fresh = { hash, NULL, NULL, {0}, api_monotonic_ms() / 1000.0, 1 };
+    fresh.id = client_strdup(client, id);
+    fresh.currency = client_strdup(client, currency);
+    if (!fresh.id || !fresh.currency || client_copy_quote(client, &fresh.quote, quote) != 0) {
+        client->config.free_fn(fresh.id);
+        client->config.free_fn(fresh.currency);
+        return;
+    }
+
+    struct cache_entry *entry = &client->cache[hash % (uint32_t)client->config.cache_size];
+    struct cache_entry old;
+
+    pthread_mutex_lock(&client->cache_lock);
+    old = *entry;
+    *entry = fresh;
+    pthread_mutex_unlock(&client->cache_lock);
+
+    cache_entry_clear(client, &old);
+}
+
+int crypto_client_get_quote(crypto_client_t *client, const char *symbol, const char *currency, crypto_data_t *out) {
+    if (!out) {
+        return -1;
+    }
+    memset(out, 0, sizeof(*out));
+
+    if (!client || !symbol) {
+        return -1;
+    }
+
+    const char *curr = currency ? currency : "usd";
+    char *id = symbol_to_id(symbol);
+    if (!id) {
+        return -1;
+    }
+
+    uint32_t hash = quote_hash(id, curr);
+    if (cache_lookup(client, hash, id, curr, out) == 0) {
+        free(id);
+        return 0;
+    }
+
+    char *url = get_api_url_with_currency(id, curr);
+    if (!url) {
+        free(id);
+        return -1;
+    }
+
+    ratelimit_acquire(&client->limiter);
+
+    char *json = NULL;
+    int rc = api_fetch_url(client->pool, url, &json, NULL);
+    free(url);
+
+    if (rc != 0) {
+        free(id);
+        return -1;
+    }
+
+    crypto_data_t parsed = parse_crypto_json_with_currency(json, curr);
+    free(json);
+
+    if (!parsed.success) {
+        free_crypto_data(&parsed);
+        free(id);
+        return -1;
+    }
+
+    rc = client_copy_quote(client, out, &parsed);
+    if (rc == 0) {
+        cache_store(client, hash, id, curr, &parsed);
+    }
+
+    free_crypto_data(&parsed);
+    free(id);
+
+    return rc;
+}
+
+void crypto_client_release_quote(crypto_client_t *client, crypto_data_t *quote) {
+    if (!client || !quote) {
+        return;
+    }
+    client_free_quote(client, quote);
+}
+
+int crypto_client_get_markets(crypto_client_t *client, int limit, markets_data_t *out) {
+    if (!out) {
+        return -1;
+    }
+    memset(out, 0, sizeof(*out));
+
+    if (!client || limit <= 0) {
+        return -1;
+    }
+
+    char *url = get_markets_url(limit);
+    if (!url) {
+        return -1;
+    }
+
+    ratelimit_acquire(&client->limiter);
+
+    char *json = NULL;
+    int rc = api_fetch_url(client->pool, url, &json, NULL);
+    free(url);
+
+    if (rc != 0) {
+        return -1;
+    }
+
+    markets_data_t parsed = parse_markets_json(json, limit);
+    free(json);
+
+    if (!parsed.success) {
+        free_markets_data(&parsed);
+        return -1;
+    }
+
+    if (parsed.count > 0) {
+        out->coins = client->config.malloc_fn((size_t)parsed.count * sizeof(crypto_data_t));
+        if (!out->coins) {
+            free_markets_data(&parsed);
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < parsed.count; i++) {
+        if (client_copy_quote(client, &out->coins[i], &parsed.coins[i]) != 0) {
+            crypto_client_release_markets(client, out);
+            free_markets_data(&parsed);
+            return -1;
+        }
+        out->count++;
+    }
+    out->success = 1;
+
+    free_markets_data(&parsed);
+    return 0;
+}
+
+void crypto_client_release_markets(crypto_client_t *client, markets_data_t *markets) {
+    if (!client || !markets) {
+        return;
+    }
+
+    for (int i = 0; i < markets->count; i++) {
+        client_free_quote(client, &markets->coins[i]);
+    }
+    client->config.free_fn(markets->coins);
+
+    markets->coins = NULL;
+    markets->count = 0;
+    markets->success = 0;
+}
@@ -0,0 +1,74 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include "../include/coinids.h"
+#include "../include/intern.h"
+#include "../include/parser.h"
+
+int coin_ids_resolve(const char *list, const char ***ids) {
+    *ids = NULL;
+    char *copy = strdup(list ? list : "");
+    int capacity = 1;
+    for (const char *p = list ? list : ""; *p; p++) {
+        capacity += *p == ',' || *p == ' ';
+    }
+    const char **out = malloc((size_t)capacity * sizeof(const char *));
+    if (!copy || !out) {
+        free(copy);
+        free(out);
+        return -1;
+    }
+
+    int count = 0;
+    char *saveptr = NULL;
+    for (char *token = strtok_r(copy, ", ", &saveptr); token; token = strtok_r(NULL, ", ", &saveptr)) {
+        char *resolved = symbol_to_id(token);
+        const char *id = intern(resolved);
+        free(resolved);
+        if (id && coin_ids_find(out, sizeof(out[0]), count, id) < 0) {
+            out[count++] = id;
+        }
+    }
+    free(copy);
+
+    *ids = out;
+    return count;
+}
+
+int coin_ids_find(const void *first, size_t stride, int count, const char *id) {
+    const char *base = (const char *)first;
+    for (int i = 0; i < count; i++) {
+        // Both interned: equal ids are the same pointer
+        if (*(const char *const *)(base + (size_t)i * stride) == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+char *join_ids(const void *first, size_t stride, int count) {
+    const char *base = (const char *)first;
+    size_t csv_len = 1;
+    for (int i = 0; i < count; i++) {
+        csv_len += strlen(*(const char *const *)(base + (size_t)i * stride)) + 1;
+    }
+
+    char *csv = malloc(csv_len);
+    if (!csv) {
+        return NULL;
+    }
+
+    size_t pos = 0;
+    for (int i = 0; i < count; i++) {
+        const char *id = *(const char *const *)(base + (size_t)i * stride);
+        size_t len = strlen(id);
+        if (pos > 0) {
+            csv[pos++] = ',';
+        }
+        memcpy(csv + pos, id, len);
+        pos += len;
+    }
+    csv[pos] = '\0';
+    return csv;
+}
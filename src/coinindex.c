@@ -0,0 +1,481 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../include/coinindex.h"
+
+#define COIN_INDEX_MAGIC "CCIDX001"
+#define COIN_INDEX_BYTE_ORDER 0x01020304u
+#define FOLD_MAX 256                 // Longest folded string indexed per field
+#define QUERY_TRIGRAMS_MAX FOLD_MAX
+
+#define EXACT_BONUS 1.0
+#define PREFIX_BONUS 0.25
+
+/**
+ * @brief On-disk header; offsets are from the start of the file
+ */
+struct coin_index_header {
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t count;
+    int64_t created_at;
+    uint32_t trigram_count;
+    uint32_t posting_count;
+    uint64_t coins;
+    uint64_t trigrams;
+    uint64_t postings;
+    uint64_t string_table;
+    uint32_t string_table_size;
+    uint32_t reserved;
+};
+
+static size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+// Lowercase alphanumeric words separated by single spaces, with a space at each end;
+// out holds FOLD_MAX bytes, so the words stop two short to leave room for the
+// closing space and the terminator
+static size_t fold(const char *s, char *out) {
+    size_t len = 0;
+    out[len++] = ' ';
+    for (; s && *s && len < FOLD_MAX - 2; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (isalnum(c)) {
+            out[len++] = (char)tolower(c);
+        } else if (out[len - 1] != ' ') {
+            out[len++] = ' ';
+        }
+    }
+    if (out[len - 1] != ' ') {
+        out[len++] = ' ';
+    }
+    out[len] = '\0';
+    return len;
+}
+
+static uint32_t trigram_key(const char *p) {
+    return ((uint32_t)(unsigned char)p[0] << 16) | ((uint32_t)(unsigned char)p[1] << 8) |
+           (uint32_t)(unsigned char)p[2];
+}
+
+// Append the trigrams of a folded string (nothing for an empty one)
+static int add_trigrams(const char *folded, size_t len, uint32_t *keys, int count) {
+    for (size_t i = 0; len >= 3 && i + 3 <= len; i++) {
+        keys[count++] = trigram_key(folded + i);
+    }
+    return count;
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Sort and drop duplicates; returns the new count
+static int unique_keys(uint32_t *keys, int count) {
+    qsort(keys, (size_t)count, sizeof(uint32_t), compare_u32);
+    int out = 0;
+    for (int i = 0; i < count; i++) {
+        if (out == 0 || keys[out - 1] != keys[i]) {
+            keys[out++] = keys[i];
+        }
+    }
+    return out;
+}
+
+static uint32_t add_string(char *table, uint32_t *used, const char *s) {
+    uint32_t offset = *used;
+    size_t len = s ? strlen(s) : 0;
+    if (len) {
+        memcpy(table + offset, s, len);
+    }
+    table[offset + len] = '\0';
+    *used += (uint32_t)len + 1;
+    return offset;
+}
+
+int coin_index_write(const char *path, const markets_data_t *coins) {
+    if (!path || !coins || !coins->success) {
+        return -1;
+    }
+
+    uint32_t count = 0;
+    size_t strings_size = 0;
+    for (int i = 0; i < coins->count; i++) {
+        const crypto_data_t *coin = &coins->coins[i];
+        if (!coin->success || !coin->id) {
+            continue;
+        }
+        count++;
+        strings_size += strlen(coin->id) + 1;
+        strings_size += (coin->symbol ? strlen(coin->symbol) : 0) + 1;
+        strings_size += (coin->name ? strlen(coin->name) : 0) + 1;
+    }
+    if (strings_size > UINT32_MAX) {
+        return -1;
+    }
+
+    // (trigram << 32 | coin) pairs, so one sort groups postings by trigram in coin order
+    size_t pair_capacity = (size_t)count * 64 + 1;
+    size_t pair_count = 0;
+    uint64_t *pairs = malloc(pair_capacity * sizeof(uint64_t));
+    uint32_t *trigram_counts = malloc(((size_t)count + 1) * sizeof(uint32_t));
+    if (!pairs || !trigram_counts) {
+        free(pairs);
+        free(trigram_counts);
+        return -1;
+    }
+
+    uint32_t keys[3 * FOLD_MAX];
+    char folded[FOLD_MAX];
+    uint32_t row = 0;
+    for (int i = 0; i < coins->count; i++) {
+        const crypto_data_t *coin = &coins->coins[i];
+        if (!coin->success || !coin->id) {
+            continue;
+        }
+        int n = 0;
+        n = add_trigrams(folded, fold(coin->id, folded), keys, n);
+        n = add_trigrams(folded, fold(coin->symbol, folded), keys, n);
+        n = add_trigrams(folded, fold(coin->name, folded), keys, n);
+        n = unique_keys(keys, n);
+
+        if (pair_count + (size_t)n > pair_capacity) {
+            pair_capacity = (pair_capacity + (size_t)n) * 2;
+            uint64_t *grown = realloc(pairs, pair_capacity * sizeof(uint64_t));
+            if (!grown) {
+                free(pairs);
+                free(trigram_counts);
+                return -1;
+            }
+            pairs = grown;
+        }
+        for (int k = 0; k < n; k++) {
+            pairs[pair_count++] = (uint64_t)keys[k] << 32 | row;
+        }
+        trigram_counts[row++] = (uint32_t)n;
+    }
+    qsort(pairs, pair_count, sizeof(uint64_t), compare_u64);
+
+    uint32_t trigram_count = 0;
+    for (size_t p = 0; p < pair_count; p++) {
+        if (p == 0 || pairs[p] >> 32 != pairs[p - 1] >> 32) {
+            trigram_count++;
+        }
+    }
+
+    // Lay out the file
+    struct coin_index_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, COIN_INDEX_MAGIC, sizeof(header.magic));
+    header.byte_order = COIN_INDEX_BYTE_ORDER;
+    header.count = count;
+    header.created_at = (int64_t)time(NULL);
+    header.trigram_count = trigram_count;
+    header.posting_count = (uint32_t)pair_count;
+
+    size_t offset = align8(sizeof(header));
+    header.coins = offset;
+    offset = align8(offset + (size_t)count * 4 * sizeof(uint32_t));
+    header.trigrams = offset;
+    offset = align8(offset + (size_t)trigram_count * 3 * sizeof(uint32_t));
+    header.postings = offset;
+    offset = align8(offset + pair_count * sizeof(uint32_t));
+    header.string_table = offset;
+    header.string_table_size = (uint32_t)strings_size;
+    size_t total = offset + strings_size;
+
+    char *file = calloc(1, total);
+    if (!file) {
+        free(pairs);
+        free(trigram_counts);
+        return -1;
+    }
+    memcpy(file, &header, sizeof(header));
+
+    uint32_t *coin_table = (uint32_t *)(file + header.coins);
+    uint32_t *trigram_table = (uint32_t *)(file + header.trigrams);
+    uint32_t *postings = (uint32_t *)(file + header.postings);
+    char *table = file + header.string_table;
+    uint32_t table_used = 0;
+
+    row = 0;
+    for (int i = 0; i < coins->count; i++) {
+        const crypto_data_t *coin = &coins->coins[i];
+        if (!coin->success || !coin->id) {
+            continue;
+        }
+        coin_table[row * 4 + COIN_INDEX_ID] = add_string(table, &table_used, coin->id);
+        coin_table[row * 4 + COIN_INDEX_SYMBOL] = add_string(table, &table_used, coin->symbol);
+        coin_table[row * 4 + COIN_INDEX_NAME] = add_string(table, &table_used, coin->name);
+        coin_table[row * 4 + 3] = trigram_counts[row];
+        row++;
+    }
+
+    uint32_t t = 0;
+    for (size_t p = 0; p < pair_count; p++) {
+        uint32_t key = (uint32_t)(pairs[p] >> 32);
+        if (p == 0 || key != (uint32_t)(pairs[p - 1] >> 32)) {
+            trigram_table[t * 3] = key;
+            trigram_table[t * 3 + 1] = (uint32_t)p;
+            trigram_table[t * 3 + 2] = 0;
+            t++;
+        }
+        trigram_table[(t - 1) * 3 + 2]++;
+        postings[p] = (uint32_t)pairs[p];
+    }
+    free(pairs);
+    free(trigram_counts);
+
+    char tmp[1100];
+    snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp) {
+        free(file);
+        return -1;
+    }
+
+    int ok = fwrite(file, 1, total, fp) == total;
+    free(file);
+    if (fclose(fp) != 0) {
+        ok = 0;
+    }
+    if (!ok || rename(tmp, path) != 0) {
+        unlink(tmp);
+        return -1;
+    }
+
+    return 0;
+}
+
+int coin_index_open(const char *path, coin_index_t *index) {
+    if (!path || !index) {
+        return -1;
+    }
+    memset(index, 0, sizeof(*index));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(struct coin_index_header)) {
+        close(fd);
+        return -1;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+
+    // Every section must lie inside the file; postings are range-checked on use
+    const struct coin_index_header *header = (const struct coin_index_header *)base;
+    uint64_t count = header->count;
+    int valid = memcmp(header->magic, COIN_INDEX_MAGIC, sizeof(header->magic)) == 0 &&
+                header->byte_order == COIN_INDEX_BYTE_ORDER;
+    valid = valid && header->coins % 4 == 0 && header->coins <= size &&
+            count * 4 * sizeof(uint32_t) <= size - header->coins;
+    valid = valid && header->trigrams % 4 == 0 && header->trigrams <= size &&
+            (uint64_t)header->trigram_count * 3 * sizeof(uint32_t) <= size - header->trigrams;
+    valid = valid && header->postings % 4 == 0 && header->postings <= size &&
+            (uint64_t)header->posting_count * sizeof(uint32_t) <= size - header->postings;
+    valid = valid && header->string_table <= size &&
+            header->string_table_size <= size - header->string_table &&
+            (header->string_table_size == 0 ||
+             ((const char *)base)[header->string_table + header->string_table_size - 1] == '\0');
+
+    if (!valid) {
+        munmap(base, size);
+        return -1;
+    }
+
+    const char *bytes = (const char *)base;
+    index->base = base;
+    index->size = size;
+    index->count = header->count;
+    index->created_at = header->created_at;
+    index->coins = (const uint32_t *)(bytes + header->coins);
+    index->trigrams = (const uint32_t *)(bytes + header->trigrams);
+    index->trigram_count = header->trigram_count;
+    index->postings = (const uint32_t *)(bytes + header->postings);
+    index->posting_count = header->posting_count;
+    index->string_table = bytes + header->string_table;
+    index->string_table_size = header->string_table_size;
+
+    return 0;
+}
+
+void coin_index_close(coin_index_t *index) {
+    if (index && index->base) {
+        munmap(index->base, index->size);
+        memset(index, 0, sizeof(*index));
+    }
+}
+
+const char *coin_index_string(const coin_index_t *index, uint32_t coin, int field) {
+    if (!index || coin >= index->count || field < 0 || field > 2) {
+        return "";
+    }
+    uint32_t offset = index->coins[coin * 4 + (uint32_t)field];
+    return offset < index->string_table_size ? index->string_table + offset : "";
+}
+
+// Binary search of the trigram table; returns the entry or NULL
+static const uint32_t *find_trigram(const coin_index_t *index, uint32_t key) {
+    uint32_t lo = 0;
+    uint32_t hi = index->trigram_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t k = index->trigrams[mid * 3];
+        if (k == key) {
+            return &index->trigrams[mid * 3];
+        }
+        if (k < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+// Exact or prefix match of the folded query against one field. The field is
+// folded on the fly and the comparison stops at the first difference, which
+// for most candidates is within a character or two.
+static double field_bonus(const char *query, size_t query_len, const char *field) {
+    const unsigned char *p = (const unsigned char *)field;
+    while (*p && !isalnum(*p)) {
+        p++;
+    }
+
+    // query[0] and query[query_len - 1] are the pads
+    for (size_t i = 1; i + 1 < query_len; i++) {
+        char c;
+        if (isalnum(*p)) {
+            c = (char)tolower(*p++);
+        } else {
+            while (*p && !isalnum(*p)) {
+                p++;
+            }
+            if (!*p) {
+                return 0.0;
+            }
+            c = ' ';
+        }
+        if (c != query[i]) {
+            return 0.0;
+        }
+    }
+
+    while (*p && !isalnum(*p)) {
+        p++;
+    }
+    return *p ? PREFIX_BONUS : EXACT_BONUS;
+}
+
+int coin_index_search(const coin_index_t *index, const char *query, coin_match_t *matches,
+                      int max) {
+    if (!index || !query || !matches || max <= 0 || index->count == 0) {
+        return 0;
+    }
+
+    char folded[FOLD_MAX];
+    size_t folded_len = fold(query, folded);
+    uint32_t keys[QUERY_TRIGRAMS_MAX];
+    int key_count = unique_keys(keys, add_trigrams(folded, folded_len, keys, 0));
+    if (key_count == 0) {
+        return 0;
+    }
+
+    const uint32_t *entries[QUERY_TRIGRAMS_MAX];
+    size_t touched_max = 0;
+    int entry_count = 0;
+    for (int k = 0; k < key_count; k++) {
+        const uint32_t *entry = find_trigram(index, keys[k]);
+        if (entry && entry[1] <= index->posting_count &&
+            entry[2] <= index->posting_count - entry[1]) {
+            entries[entry_count++] = entry;
+            touched_max += entry[2];
+        }
+    }
+    if (entry_count == 0) {
+        return 0;
+    }
+
+    uint16_t *shared = calloc(index->count, sizeof(uint16_t));
+    uint32_t *touched = malloc((touched_max < index->count ? touched_max : index->count) *
+                               sizeof(uint32_t) + sizeof(uint32_t));
+    if (!shared || !touched) {
+        free(shared);
+        free(touched);
+        return -1;
+    }
+
+    // Count shared trigrams per coin
+    size_t touched_count = 0;
+    for (int e = 0; e < entry_count; e++) {
+        const uint32_t *posting = index->postings + entries[e][1];
+        for (uint32_t p = 0; p < entries[e][2]; p++) {
+            uint32_t coin = posting[p];
+            if (coin < index->count && shared[coin]++ == 0) {
+                touched[touched_count++] = coin;
+            }
+        }
+    }
+
+    int found = 0;
+    for (size_t t = 0; t < touched_count; t++) {
+        uint32_t coin = touched[t];
+        double s = shared[coin];
+        double coin_trigrams = index->coins[coin * 4 + 3];
+        double score = s / ((double)key_count + coin_trigrams - s);   // Jaccard
+
+        // A prefix match shares every query trigram but the last
+        if (shared[coin] + 1 >= key_count) {
+            double bonus = 0.0;
+            for (int f = COIN_INDEX_ID; f <= COIN_INDEX_NAME; f++) {
+                double b = field_bonus(folded, folded_len, coin_index_string(index, coin, f));
+                if (b > bonus) {
+                    bonus = b;
+                }
+            }
+            score += bonus;
+        }
+
+        // Keep the best max matches, best first
+        if (found == max && score <= matches[max - 1].score) {
+            continue;
+        }
+        int pos = found < max ? found++ : max - 1;
+        while (pos > 0 && matches[pos - 1].score < score) {
+            matches[pos] = matches[pos - 1];
+            pos--;
+        }
+        matches[pos].coin = coin;
+        matches[pos].score = score;
+    }
+
+    free(shared);
+    free(touched);
+    return found;
+}
@@ -0,0 +1,473 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "../include/convert.h"
+#include "../include/api.h"
+#include "../include/parser.h"
+#include "../include/display.h"
+#include "../include/rates.h"
+#include "../include/output.h"
+#include "../include/bulkfetch.h"
+#include "../include/coinids.h"
+
+#define CONVERT_MAX_ASSETS 250     // Ids per simple/price request
+#define MATRIX_MAX_TOP 1000
+#define BRIDGE_ID "bitcoin"        // Prices fiat codes when no coin is involved
+#define CONVERT_WIDTH 14
+#define MATRIX_WIDTH 12
+
+// Currencies accepted by simple/price that are not coins themselves
+static const char *const fiat_codes[] = {
+    "usd", "eur", "gbp", "jpy", "cny", "krw", "inr", "cad", "aud", "chf",
+    "nzd", "hkd", "sgd", "sek", "nok", "dkk", "pln", "czk", "huf", "try",
+    "rub", "brl", "mxn", "zar", "ils", "thb", "twd", "php", "idr", "myr",
+    "vnd", "aed", "sar", "ars", "clp", "uah", "ngn", "pkr", "bdt", "kwd",
+    NULL
+};
+
+/**
+ * @brief One row or column of a rate table
+ */
+typedef struct {
+    char label[32];   // Uppercase ticker or currency code, for display
+    char *id;         // CoinGecko ID (NULL for fiat)
+    char code[16];    // Lowercase fiat code (fiat only)
+    double value;     // Value of one unit in USD (NaN until priced)
+} asset_t;
+
+static int is_fiat(const char *code) {
+    for (int i = 0; fiat_codes[i]; i++) {
+        if (strcmp(fiat_codes[i], code) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int asset_init(asset_t *asset, const char *arg) {
+    memset(asset, 0, sizeof(*asset));
+    asset->value = NAN;
+
+    size_t len = strlen(arg);
+    if (len == 0 || len >= sizeof(asset->label)) {
+        return -1;
+    }
+    for (size_t i = 0; i < len; i++) {
+        // Ends up in a URL, so only what CoinGecko IDs use
+        if (!isalnum((unsigned char)arg[i]) && arg[i] != '-') {
+            return -1;
+        }
+        asset->label[i] = (char)toupper((unsigned char)arg[i]);
+    }
+
+    char lower[32];
+    for (size_t i = 0; i <= len; i++) {
+        lower[i] = (char)tolower((unsigned char)arg[i]);
+    }
+
+    if (len < sizeof(asset->code) && is_fiat(lower)) {
+        memcpy(asset->code, lower, len + 1);
+        return 0;
+    }
+
+    asset->id = symbol_to_id(lower);
+    return asset->id ? 0 : -1;
+}
+
+static void assets_free(asset_t *assets, int count) {
+    for (int i = 0; i < count; i++) {
+        free(assets[i].id);
+    }
+    free(assets);
+}
+
+// Add a string to a small set; returns its index or -1 if the set is full
+static int set_add(const char **set, int *count, int max, const char *value) {
+    for (int i = 0; i < *count; i++) {
+        if (strcmp(set[i], value) == 0) {
+            return i;
+        }
+    }
+    if (*count >= max) {
+        return -1;
+    }
+    set[*count] = value;
+    return (*count)++;
+}
+
+/**
+ * @brief Price every unpriced asset in USD with one simple/price request
+ *
+ * Coins are quoted in USD and in every fiat code present; a fiat code's
+ * USD value comes from any coin quoted in both (bitcoin is added when the
+ * set holds no coin).
+ *
+ * @return int 0 if every asset has a value, -1 otherwise (error printed)
+ */
+static int price_assets(asset_t *assets, int count) {
+    const char *ids[CONVERT_MAX_ASSETS + 1];
+    const char *codes[CONVERT_MAX_ASSETS + 1];
+    int id_count = 0;
+    int code_count = 0;
+
+    codes[code_count++] = "usd";
+    for (int i = 0; i < count; i++) {
+        if (!isnan(assets[i].value)) {
+            continue;
+        }
+        int added = assets[i].id
+            ? set_add(ids, &id_count, CONVERT_MAX_ASSETS, assets[i].id)
+            : set_add(codes, &code_count, CONVERT_MAX_ASSETS, assets[i].code);
+        if (added < 0) {
+            display_error("Too many assets for one request");
+            return -1;
+        }
+    }
+    if (code_count > 1 && id_count == 0) {
+        ids[id_count++] = BRIDGE_ID;
+    }
+
+    if (id_count > 0) {
+        char *id_list = join_ids(ids, sizeof(ids[0]), id_count);
+        char *code_list = join_ids(codes, sizeof(codes[0]), code_count);
+        char *url = id_list && code_list ? get_api_url_with_currency(id_list, code_list) : NULL;
+        free(id_list);
+        free(code_list);
+
+        char *json = NULL;
+        int rc = url ? api_fetch_url(NULL, url, &json, NULL) : -1;
+        free(url);
+        if (rc != 0) {
+            display_error("Failed to fetch prices from API. Please check your internet connection and try again.");
+            return -1;
+        }
+
+        double *grid = malloc((size_t)id_count * (size_t)code_count * sizeof(double));
+        if (!grid || parse_price_grid_json(json, ids, id_count, codes, code_count, grid) < 0) {
+            free(grid);
+            free(json);
+            display_error("Failed to parse price data");
+            return -1;
+        }
+        free(json);
+
+        for (int i = 0; i < count; i++) {
+            asset_t *asset = &assets[i];
+            if (!isnan(asset->value)) {
+                continue;
+            }
+            if (asset->id) {
+                int k = set_add(ids, &id_count, id_count, asset->id);
+                asset->value = grid[k * code_count];
+            } else if (strcmp(asset->code, "usd") == 0) {
+                asset->value = 1.0;
+            } else {
+                int c = set_add(codes, &code_count, code_count, asset->code);
+                for (int k = 0; k < id_count && isnan(asset->value); k++) {
+                    double usd = grid[k * code_count];
+                    double local = grid[k * code_count + c];
+                    if (usd > 0.0 && local > 0.0) {
+                        asset->value = usd / local;
+                    }
+                }
+            }
+        }
+        free(grid);
+    } else {
+        // Only "usd"
+        for (int i = 0; i < count; i++) {
+            if (isnan(assets[i].value)) {
+                assets[i].value = 1.0;
+            }
+        }
+    }
+
+    int missing = 0;
+    for (int i = 0; i < count; i++) {
+        if (!(assets[i].value > 0.0)) {
+            char message[96];
+            snprintf(message, sizeof(message), "No price available for '%s'", assets[i].label);
+            display_error(message);
+            missing = 1;
+        }
+    }
+    return missing ? -1 : 0;
+}
+
+static void print_convert_usage(void) {
+    printf("Usage: crypto convert AMOUNT FROM TO [TO...]\n");
+    printf("  FROM and TO are coins (btc, ethereum, ...) or fiat codes (usd, eur, ...).\n");
+    printf("  All rates come from one batched price request.\n");
+}
+
+int convert_command(int argc, char *argv[], const cli_options_t *options) {
+    if (argc < 4) {
+        print_convert_usage();
+        return 1;
+    }
+
+    char *end = NULL;
+    double amount = strtod(argv[1], &end);
+    if (end == argv[1] || *end != '\0' || !isfinite(amount)) {
+        display_error("Amount must be a number");
+        return 1;
+    }
+
+    int count = argc - 2;
+    if (count > CONVERT_MAX_ASSETS) {
+        display_error("Too many currencies");
+        return 1;
+    }
+    asset_t *assets = calloc((size_t)count, sizeof(asset_t));
+    if (!assets) {
+        display_error("Memory allocation failed");
+        return 1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (asset_init(&assets[i], argv[i + 2]) != 0) {
+            char message[128];
+            snprintf(message, sizeof(message), "Unknown coin or currency '%.64s'", argv[i + 2]);
+            display_error(message);
+            assets_free(assets, count);
+            return 1;
+        }
+    }
+
+    if (price_assets(assets, count) != 0) {
+        assets_free(assets, count);
+        return 1;
+    }
+
+    static const char *const columns[] = { "from", "to", "amount", "rate", "value" };
+    output_t out;
+    output_begin(&out, stdout, options->format, columns, 5, CONVERT_WIDTH);
+    for (int i = 1; i < count; i++) {
+        double rate = assets[0].value / assets[i].value;
+        output_row_begin(&out);
+        output_string(&out, assets[0].label);
+        output_string(&out, assets[i].label);
+        output_number(&out, amount);
+        output_number(&out, rate);
+        output_number(&out, amount * rate);
+        output_row_end(&out);
+    }
+    output_end(&out);
+
+    assets_free(assets, count);
+    return 0;
+}
+
+/**
+ * @brief Top coins by market cap, priced in USD from the markets listing
+ */
+static asset_t *fetch_top_assets(int limit, int *count) {
+    *count = 0;
+    markets_data_t markets = bulk_fetch_top(limit, NULL, NULL);
+    asset_t *assets = markets.success ? calloc((size_t)markets.count, sizeof(asset_t)) : NULL;
+    for (int i = 0; assets && i < markets.count; i++) {
+        const crypto_data_t *coin = &markets.coins[i];
+        if (!(coin->current_price > 0.0)) {
+            continue;
+        }
+        asset_t *asset = &assets[*count];
+        const char *symbol = coin->symbol ? coin->symbol : coin->id;
+        size_t len = strlen(symbol);
+        if (len >= sizeof(asset->label)) {
+            len = sizeof(asset->label) - 1;
+        }
+        for (size_t c = 0; c < len; c++) {
+            asset->label[c] = (char)toupper((unsigned char)symbol[c]);
+        }
+        asset->label[len] = '\0';
+        asset->id = strdup(coin->id);
+        asset->value = coin->current_price;
+        (*count)++;
+    }
+    free_markets_data(&markets);
+
+    if (*count == 0) {
+        free(assets);
+        return NULL;
+    }
+    return assets;
+}
+
+static void print_matrix_usage(void) {
+    printf("Usage: crypto matrix ASSET... [--vs CODES]\n");
+    printf("       crypto matrix --top N [--vs CODES]\n");
+    printf("  Row i, column j holds how many j one unit of i buys.\n");
+    printf("  --vs usd,eur   Add columns for these currencies\n");
+    printf("  --top N        Rows and columns are the top N coins by market cap (max %d)\n",
+           MATRIX_MAX_TOP);
+}
+
+// Write the matrix a block of rows at a time
+static int write_matrix(const asset_t *rows, int row_count, const asset_t *columns,
+                        int column_count, output_format_t format) {
+    const char **names = malloc(((size_t)column_count + 1) * sizeof(char *));
+    double *row_values = malloc((size_t)row_count * sizeof(double));
+    double *column_values = malloc((size_t)column_count * sizeof(double));
+    double *inverse = malloc((size_t)column_count * sizeof(double));
+    double *block = malloc((size_t)RATES_BLOCK_ROWS * (size_t)column_count * sizeof(double));
+    if (!names || !row_values || !column_values || !inverse || !block) {
+        free(names);
+        free(row_values);
+        free(column_values);
+        free(inverse);
+        free(block);
+        display_error("Memory allocation failed");
+        return -1;
+    }
+
+    names[0] = "asset";
+    for (int j = 0; j < column_count; j++) {
+        names[j + 1] = columns[j].label;
+        column_values[j] = columns[j].value;
+    }
+    for (int i = 0; i < row_count; i++) {
+        row_values[i] = rows[i].value;
+    }
+    rates_prepare(column_values, column_count, inverse);
+
+    static char buffer[1 << 16];
+    setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+
+    output_t out;
+    output_begin(&out, stdout, format, names, column_count + 1, MATRIX_WIDTH);
+    for (int r = 0; r < row_count; r += RATES_BLOCK_ROWS) {
+        int n = row_count - r < RATES_BLOCK_ROWS ? row_count - r : RATES_BLOCK_ROWS;
+        rates_block(row_values + r, n, inverse, column_count, block);
+        for (int i = 0; i < n; i++) {
+            const double *rates = block + (size_t)i * (size_t)column_count;
+            output_row_begin(&out);
+            output_string(&out, rows[r + i].label);
+            for (int j = 0; j < column_count; j++) {
+                output_number(&out, rates[j]);
+            }
+            output_row_end(&out);
+        }
+    }
+    output_end(&out);
+
+    free(names);
+    free(row_values);
+    free(column_values);
+    free(inverse);
+    free(block);
+    return 0;
+}
+
+int matrix_command(int argc, char *argv[], const cli_options_t *options) {
+    const char *vs = NULL;
+    int top = 0;
+    int listed = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--vs") == 0 && i + 1 < argc) {
+            vs = argv[++i];
+        } else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            top = atoi(argv[++i]);
+            if (top <= 0 || top > MATRIX_MAX_TOP) {
+                char message[64];
+                snprintf(message, sizeof(message), "--top must be between 1 and %d", MATRIX_MAX_TOP);
+                display_error(message);
+                return 1;
+            }
+        } else if (argv[i][0] == '-') {
+            print_matrix_usage();
+            return 1;
+        } else {
+            listed++;
+        }
+    }
+    if ((top > 0) == (listed > 0)) {
+        print_matrix_usage();
+        return 1;
+    }
+
+    // --vs codes
+    int vs_count = 0;
+    asset_t *vs_assets = NULL;
+    if (vs) {
+        char *copy = strdup(vs);
+        vs_assets = calloc(strlen(vs) / 2 + 1, sizeof(asset_t));
+        if (!copy || !vs_assets) {
+            free(copy);
+            free(vs_assets);
+            display_error("Memory allocation failed");
+            return 1;
+        }
+        char *save = NULL;
+        for (char *tok = strtok_r(copy, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+            if (asset_init(&vs_assets[vs_count], tok) != 0) {
+                char message[128];
+                snprintf(message, sizeof(message), "Unknown coin or currency '%.64s'", tok);
+                display_error(message);
+                free(copy);
+                assets_free(vs_assets, vs_count + 1);
+                return 1;
+            }
+            vs_count++;
+        }
+        free(copy);
+    }
+
+    // Rows, then the --vs columns, in one array so one request prices both
+    int row_count = 0;
+    asset_t *assets = NULL;
+    if (top > 0) {
+        asset_t *rows = fetch_top_assets(top, &row_count);
+        if (!rows) {
+            display_error("Failed to fetch markets data from API. Please check your internet connection and try again.");
+            assets_free(vs_assets, vs_count);
+            return 1;
+        }
+        assets = realloc(rows, ((size_t)row_count + (size_t)vs_count) * sizeof(asset_t));
+        if (!assets) {
+            assets_free(rows, row_count);
+        }
+    } else {
+        if (listed + vs_count > CONVERT_MAX_ASSETS) {
+            display_error("Too many assets for one request");
+            assets_free(vs_assets, vs_count);
+            return 1;
+        }
+        assets = calloc((size_t)listed + (size_t)vs_count, sizeof(asset_t));
+        for (int i = 1; assets && i < argc; i++) {
+            if (strcmp(argv[i], "--vs") == 0) {
+                i++;
+                continue;
+            }
+            if (asset_init(&assets[row_count], argv[i]) != 0) {
+                char message[128];
+                snprintf(message, sizeof(message), "Unknown coin or currency '%.64s'", argv[i]);
+                display_error(message);
+                assets_free(assets, row_count + 1);
+                assets_free(vs_assets, vs_count);
+                return 1;
+            }
+            row_count++;
+        }
+    }
+    if (!assets) {
+        display_error("Memory allocation failed");
+        assets_free(vs_assets, vs_count);
+        return 1;
+    }
+    if (vs_count > 0) {
+        memcpy(assets + row_count, vs_assets, (size_t)vs_count * sizeof(asset_t));
+    }
+    free(vs_assets);   // IDs now owned by assets
+    int total = row_count + vs_count;
+
+    // Top coins already carry USD prices; only --vs codes need the request
+    int rc = price_assets(assets, total) == 0 &&
+             write_matrix(assets, row_count, assets, total, options->format) == 0 ? 0 : 1;
+
+    assets_free(assets, total);
+    return rc;
+}
@@ -0,0 +1,428 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "../include/corr.h"
+#include "../include/api.h"
+#include "../include/parser.h"
+#include "../include/display.h"
+#include "../include/output.h"
+#include "../include/ratelimit.h"
+#include "../include/bulkfetch.h"
+#include "../include/corrmat.h"
+#include "../include/profile.h"
+
+#define CORR_DEFAULT_DAYS "90"
+#define CORR_MAX_COINS 500
+#define CORR_DEFAULT_CONCURRENCY 4
+#define CORR_DEFAULT_RATE 30           // Requests per minute (CoinGecko free tier)
+#define CORR_MAX_ATTEMPTS 3            // Tries per coin while the API answers 429
+#define CORR_COVERAGE_SLACK 10         // A coin may start or end 1/10 of the range late
+#define CORR_WIDTH 10
+#define SECONDS_PER_YEAR (365.0 * 86400.0)
+
+/**
+ * @brief One coin of the matrix and its price history
+ */
+typedef struct {
+    char label[32];          // Uppercase ticker, for display
+    char *id;                // CoinGecko ID
+    char *url;
+    chart_series_t series;
+    long first;              // First and last grid bucket with a price
+    long last;
+} corr_coin_t;
+
+static void print_corr_usage(void) {
+    printf("Usage: crypto corr (--top N | SYMBOL SYMBOL...) [--days D] [--currency CODE]\n");
+    printf("                   [--concurrency K] [--rate PER_MINUTE]\n");
+    printf("  --top N        The N largest coins by market cap (up to %d)\n", CORR_MAX_COINS);
+    printf("  --days D       Days of history, or max (default: %s)\n", CORR_DEFAULT_DAYS);
+    printf("  --currency     Quote currency of the prices (default: usd)\n");
+    printf("  --concurrency  Requests in flight (default: %d)\n", CORR_DEFAULT_CONCURRENCY);
+    printf("  --rate         Requests per minute (default: %d)\n", CORR_DEFAULT_RATE);
+    printf("Output: coin, one correlation column per coin, annualised volatility;\n");
+    printf("follows --format (table, csv, json, arrow, feather).\n");
+}
+
+static void coins_free(corr_coin_t *coins, int count) {
+    for (int i = 0; coins && i < count; i++) {
+        free(coins[i].id);
+        free(coins[i].url);
+        free_chart_series(&coins[i].series);
+    }
+    free(coins);
+}
+
+static void set_label(corr_coin_t *coin, const char *symbol) {
+    size_t len = strlen(symbol);
+    if (len >= sizeof(coin->label)) {
+        len = sizeof(coin->label) - 1;
+    }
+    for (size_t c = 0; c < len; c++) {
+        coin->label[c] = (char)toupper((unsigned char)symbol[c]);
+    }
+    coin->label[len] = '\0';
+}
+
+// The first limit coins of the markets listing; pages count against the limiter
+static corr_coin_t *fetch_top_coins(int limit, ratelimit_t *limiter, int *count) {
+    *count = 0;
+    markets_data_t markets = bulk_fetch_top(limit, limiter, NULL);
+    corr_coin_t *coins = markets.success ? calloc((size_t)markets.count, sizeof(corr_coin_t)) : NULL;
+    for (int i = 0; coins && i < markets.count; i++) {
+        const crypto_data_t *coin = &markets.coins[i];
+        corr_coin_t *out = &coins[*count];
+        set_label(out, coin->symbol ? coin->symbol : coin->id);
+        out->id = strdup(coin->id);
+        if (out->id) {
+            (*count)++;
+        }
+    }
+    free_markets_data(&markets);
+
+    if (*count == 0) {
+        free(coins);
+        return NULL;
+    }
+    return coins;
+}
+
+// Parse a coin's market_chart as it arrives, so only the price columns are held
+static void series_done(void *ctx, int index, const api_request_t *response, int attempts) {
+    corr_coin_t *coin = &((corr_coin_t *)ctx)[index];
+    (void)attempts;
+    if (response->result == 0 && response->data) {
+        coin->series = parse_market_chart_json(response->data);
+    }
+}
+
+/**
+ * @brief Fetch and parse every coin's market_chart
+ *
+ * Keeps up to concurrency requests in flight, each started only when the
+ * limiter has a token. A 429 puts the coin back at the end of the queue,
+ * up to CORR_MAX_ATTEMPTS times.
+ *
+ * @return int Number of coins with a series
+ */
+static int fetch_series(corr_coin_t *coins, int count, const char *currency, const char *days,
+                        int concurrency, ratelimit_t *limiter) {
+    for (int i = 0; i < count; i++) {
+        coins[i].url = get_market_chart_url(coins[i].id, currency, days);
+    }
+
+    bulk_options_t options = { concurrency, limiter, CORR_MAX_ATTEMPTS, 0, 0 };
+    if (bulk_fetch(&coins[0].url, sizeof(coins[0]), count, &options, series_done, coins) != 0) {
+        return 0;
+    }
+
+    int fetched = 0;
+    for (int i = 0; i < count; i++) {
+        fetched += coins[i].series.success && coins[i].series.count > 0;
+    }
+    return fetched;
+}
+
+// CoinGecko picks the granularity from the range: 5-minutely for one day,
+// hourly up to 90 days, daily beyond
+static long grid_step(const char *days) {
+    if (strcmp(days, "max") == 0) {
+        return 86400;
+    }
+    long n = atol(days);
+    return n <= 1 ? 300 : n <= 90 ? 3600 : 86400;
+}
+
+static long bucket_of(int64_t time_ms, long step) {
+    int64_t seconds = time_ms / 1000;
+    return (long)(seconds >= 0 ? seconds / step : -((-seconds + step - 1) / step));
+}
+
+/**
+ * @brief Choose the coins and the grid range they share
+ *
+ * Coins that start or end more than 1/CORR_COVERAGE_SLACK of the overall
+ * range away from the others are left out rather than let them shrink the
+ * grid for everyone.
+ *
+ * @return int Grid points (0 if fewer than three); keep[i] set per coin
+ */
+static int build_grid(corr_coin_t *coins, int count, long step, int *keep, long *start) {
+    long earliest = 0, latest = 0;
+    int any = 0;
+    for (int i = 0; i < count; i++) {
+        const chart_series_t *s = &coins[i].series;
+        keep[i] = s->success && s->count >= 3;
+        if (!keep[i]) {
+            continue;
+        }
+        coins[i].first = bucket_of(s->time_ms[0], step);
+        coins[i].last = bucket_of(s->time_ms[s->count - 1], step);
+        if (!any || coins[i].first < earliest) {
+            earliest = coins[i].first;
+        }
+        if (!any || coins[i].last > latest) {
+            latest = coins[i].last;
+        }
+        any = 1;
+    }
+    if (!any) {
+        return 0;
+    }
+
+    long slack = (latest - earliest) / CORR_COVERAGE_SLACK;
+    long first = earliest, last = latest;
+    for (int i = 0; i < count; i++) {
+        if (!keep[i]) {
+            continue;
+        }
+        keep[i] = coins[i].first <= earliest + slack && coins[i].last >= latest - slack;
+        if (keep[i]) {
+            first = coins[i].first > first ? coins[i].first : first;
+            last = coins[i].last < last ? coins[i].last : last;
+        }
+    }
+
+    *start = first;
+    long points = last - first + 1;
+    return points >= 3 && points <= INT32_MAX ? (int)points : 0;
+}
+
+// Log returns of one coin on the grid; the last price seen carries over empty buckets
+static void fill_returns(const chart_series_t *s, long step, long start, int points, double *row) {
+    int idx = 0;
+    double price = NAN, previous = NAN;
+    for (int g = 0; g < points; g++) {
+        long bucket = start + g;
+        while (idx < s->count && bucket_of(s->time_ms[idx], step) <= bucket) {
+            if (s->price[idx] > 0.0) {
+                price = s->price[idx];
+            }
+            idx++;
+        }
+        if (g > 0) {
+            row[g - 1] = log(price / previous);
+        }
+        previous = price;
+    }
+}
+
+static int write_corr(const corr_coin_t *const *rows, int count, const double *matrix,
+                      const double *volatility, output_format_t format) {
+    const char **names = malloc(((size_t)count + 2) * sizeof(const char *));
+    if (!names) {
+        return -1;
+    }
+    names[0] = "coin";
+    for (int i = 0; i < count; i++) {
+        names[i + 1] = rows[i]->label;
+    }
+    names[count + 1] = "volatility";
+
+    output_t out;
+    output_begin(&out, stdout, format, names, count + 2, CORR_WIDTH);
+    for (int i = 0; i < count; i++) {
+        output_row_begin(&out);
+        output_string(&out, rows[i]->label);
+        for (int j = 0; j < count; j++) {
+            output_number(&out, matrix[(size_t)i * (size_t)count + j]);
+        }
+        output_number(&out, volatility[i]);
+        output_row_end(&out);
+    }
+    int rc = output_end(&out);
+    free(names);
+    return rc;
+}
+
+// Log returns on the grid, standardised, through the kernel, then written out
+static int compute_and_write(corr_coin_t *coins, int count, const char *days,
+                             output_format_t format) {
+    long step = grid_step(days);
+    int *keep = calloc((size_t)count, sizeof(int));
+    const corr_coin_t **rows = calloc((size_t)count, sizeof(corr_coin_t *));
+    if (!keep || !rows) {
+        free(keep);
+        free(rows);
+        display_error("Memory allocation failed");
+        return -1;
+    }
+
+    long start = 0;
+    int points = build_grid(coins, count, step, keep, &start);
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (keep[i]) {
+            rows[kept++] = &coins[i];
+        } else {
+            fprintf(stderr, "Warning: skipping %s (no price history covering the range)\n",
+                    coins[i].label);
+        }
+    }
+    if (kept < 2 || points < 3) {
+        display_error("Not enough overlapping price history to correlate");
+        free(keep);
+        free(rows);
+        return -1;
+    }
+
+    int len = points - 1;
+    size_t stride = corr_stride(len);
+    double *returns = calloc((size_t)kept * stride, sizeof(double));
+    double *matrix = malloc((size_t)kept * (size_t)kept * sizeof(double));
+    double *volatility = malloc((size_t)kept * sizeof(double));
+    int rc = -1;
+    if (returns && matrix && volatility) {
+        for (int r = 0; r < kept; r++) {
+            fill_returns(&rows[r]->series, step, start, points, returns + (size_t)r * stride);
+        }
+
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        corr_standardize(returns, kept, len, stride, volatility);
+        corr_matrix(returns, kept, stride, cpus > 1 ? (int)cpus : 1, matrix);
+
+        // Returns are 24/7, so a year is 365 days of grid steps
+        double annualise = sqrt(SECONDS_PER_YEAR / (double)step);
+        for (int r = 0; r < kept; r++) {
+            volatility[r] *= annualise;
+        }
+
+        profile_begin(PROFILE_RENDER);
+        rc = write_corr(rows, kept, matrix, volatility, format);
+        profile_end(PROFILE_RENDER);
+        if (rc != 0) {
+            display_error("Failed to write output");
+        }
+    } else {
+        display_error("Memory allocation failed");
+    }
+
+    free(returns);
+    free(matrix);
+    free(volatility);
+    free(keep);
+    free(rows);
+    return rc;
+}
+
+int corr_command(int argc, char *argv[], const cli_options_t *options) {
+    const char *days = CORR_DEFAULT_DAYS;
+    char currency[8] = "usd";
+    int top = 0;
+    int listed = 0;
+    int concurrency = CORR_DEFAULT_CONCURRENCY;
+    double rate = CORR_DEFAULT_RATE;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            top = atoi(argv[++i]);
+            if (top < 2 || top > CORR_MAX_COINS) {
+                char message[64];
+                snprintf(message, sizeof(message), "--top must be between 2 and %d", CORR_MAX_COINS);
+                display_error(message);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--days") == 0 && i + 1 < argc) {
+            days = argv[++i];
+        } else if (strcmp(argv[i], "--currency") == 0 && i + 1 < argc) {
+            if (options_parse_currency(argv[++i], currency, sizeof(currency)) != 0) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--concurrency") == 0 && i + 1 < argc) {
+            concurrency = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            rate = atof(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            print_corr_usage();
+            return 1;
+        } else {
+            listed++;
+        }
+    }
+    if ((top > 0) == (listed > 0) || (listed > 0 && listed < 2)) {
+        print_corr_usage();
+        return 1;
+    }
+    if (listed > CORR_MAX_COINS) {
+        display_error("Too many coins");
+        return 1;
+    }
+    if (!options_valid_days(days)) {
+        display_error("--days must be a positive number of days or max");
+        return 1;
+    }
+    if (concurrency <= 0 || concurrency > 64) {
+        display_error("Concurrency must be between 1 and 64");
+        return 1;
+    }
+
+    ratelimit_t limiter;
+    ratelimit_init(&limiter, rate, concurrency);
+
+    int count = 0;
+    corr_coin_t *coins = NULL;
+    profile_begin(PROFILE_FETCH);
+    if (top > 0) {
+        coins = fetch_top_coins(top, &limiter, &count);
+        if (!coins) {
+            profile_end(PROFILE_FETCH);
+            ratelimit_destroy(&limiter);
+            display_error("Failed to fetch markets data from API. Please check your internet connection and try again.");
+            return 1;
+        }
+    } else {
+        coins = calloc((size_t)listed, sizeof(corr_coin_t));
+        for (int i = 1; coins && i < argc; i++) {
+            if (argv[i][0] == '-') {
+                i += strcmp(argv[i], "--top") == 0 || strcmp(argv[i], "--days") == 0 ||
+                     strcmp(argv[i], "--currency") == 0 || strcmp(argv[i], "--concurrency") == 0 ||
+                     strcmp(argv[i], "--rate") == 0;
+                continue;
+            }
+            corr_coin_t *coin = &coins[count];
+            char *ticker = symbol_to_ticker(argv[i]);
+            set_label(coin, ticker ? ticker : argv[i]);
+            free(ticker);
+            coin->id = symbol_to_id(argv[i]);
+            if (!coin->id) {
+                break;
+            }
+            count++;
+        }
+        if (!coins || count < listed) {
+            profile_end(PROFILE_FETCH);
+            ratelimit_destroy(&limiter);
+            coins_free(coins, count);
+            display_error("Invalid symbol");
+            return 1;
+        }
+    }
+
+    int fetched = fetch_series(coins, count, currency, days, concurrency, &limiter);
+    profile_end(PROFILE_FETCH);
+    ratelimit_destroy(&limiter);
+
+    for (int i = 0; i < count; i++) {
+        if (!coins[i].series.success) {
+            fprintf(stderr, "Warning: no history for %s (%s)\n", coins[i].label, coins[i].id);
+        }
+    }
+
+    int rc = 1;
+    if (fetched < 2) {
+        display_error(api_remaining_ms() == 0
+                      ? "Deadline reached before the histories arrived"
+                      : "Failed to fetch price history from API. Please check your internet connection and try again.");
+    } else {
+        rc = compute_and_write(coins, count, days, options->format) == 0 ? 0 : 1;
+    }
+
+    coins_free(coins, count);
+    return rc;
+}
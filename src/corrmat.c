@@ -0,0 +1,236 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../include/corrmat.h"
+
+#define CORR_MAX_THREADS 64
+
+size_t corr_stride(int len) {
+    size_t n = len > 0 ? (size_t)len : 1;
+    return (n + CORR_ALIGN - 1) / CORR_ALIGN * CORR_ALIGN;
+}
+
+void corr_standardize(double *rows_data, int rows, int len, size_t stride, double *stdev) {
+    for (int i = 0; i < rows; i++) {
+        double *row = rows_data + (size_t)i * stride;
+        double sum = 0.0;
+        for (int t = 0; t < len; t++) {
+            sum += row[t];
+        }
+        double mean = len > 0 ? sum / len : 0.0;
+        double squares = 0.0;
+        for (int t = 0; t < len; t++) {
+            double d = row[t] - mean;
+            squares += d * d;
+        }
+
+        if (len < 2 || !isfinite(squares) || squares <= 0.0) {
+            stdev[i] = len >= 2 && isfinite(squares) ? 0.0 : NAN;
+            for (size_t t = 0; t < stride; t++) {
+                row[t] = NAN;
+            }
+            continue;
+        }
+
+        stdev[i] = sqrt(squares / (len - 1));
+        double scale = 1.0 / sqrt(squares);
+        for (int t = 0; t < len; t++) {
+            row[t] = (row[t] - mean) * scale;
+        }
+    }
+}
+
+#if defined(__GNUC__)
+
+// Four lanes; GCC lowers this to AVX or to pairs of SSE2 operations
+typedef double corr_v4 __attribute__((vector_size(32)));
+
+// Unaligned load and horizontal sum; macros so no vector crosses a call (ABI)
+#define LOAD4(v, p) memcpy(&(v), (p), sizeof(v))
+#define LANES_SUM(v) (((v)[0] + (v)[1]) + ((v)[2] + (v)[3]))
+
+// Dot products of rows a0, a1 with rows b[0..3] over [t0, t1), added to out
+static void kernel_2x4(const double *a0, const double *a1, const double *const *b, size_t t0,
+                       size_t t1, double *out0, double *out1) {
+    corr_v4 s00 = { 0 }, s01 = { 0 }, s02 = { 0 }, s03 = { 0 };
+    corr_v4 s10 = { 0 }, s11 = { 0 }, s12 = { 0 }, s13 = { 0 };
+    for (size_t t = t0; t < t1; t += 4) {
+        corr_v4 x0, x1, y0, y1, y2, y3;
+        LOAD4(x0, a0 + t);
+        LOAD4(x1, a1 + t);
+        LOAD4(y0, b[0] + t);
+        LOAD4(y1, b[1] + t);
+        LOAD4(y2, b[2] + t);
+        LOAD4(y3, b[3] + t);
+        s00 += x0 * y0;
+        s01 += x0 * y1;
+        s02 += x0 * y2;
+        s03 += x0 * y3;
+        s10 += x1 * y0;
+        s11 += x1 * y1;
+        s12 += x1 * y2;
+        s13 += x1 * y3;
+    }
+    out0[0] += LANES_SUM(s00);
+    out0[1] += LANES_SUM(s01);
+    out0[2] += LANES_SUM(s02);
+    out0[3] += LANES_SUM(s03);
+    out1[0] += LANES_SUM(s10);
+    out1[1] += LANES_SUM(s11);
+    out1[2] += LANES_SUM(s12);
+    out1[3] += LANES_SUM(s13);
+}
+
+static double dot(const double *a, const double *b, size_t t0, size_t t1) {
+    corr_v4 s = { 0 };
+    for (size_t t = t0; t < t1; t += 4) {
+        corr_v4 x, y;
+        LOAD4(x, a + t);
+        LOAD4(y, b + t);
+        s += x * y;
+    }
+    return LANES_SUM(s);
+}
+
+#else
+
+static void kernel_2x4(const double *a0, const double *a1, const double *const *b, size_t t0,
+                       size_t t1, double *out0, double *out1) {
+    for (int j = 0; j < 4; j++) {
+        double s0 = 0.0, s1 = 0.0;
+        for (size_t t = t0; t < t1; t++) {
+            s0 += a0[t] * b[j][t];
+            s1 += a1[t] * b[j][t];
+        }
+        out0[j] += s0;
+        out1[j] += s1;
+    }
+}
+
+static double dot(const double *a, const double *b, size_t t0, size_t t1) {
+    double s = 0.0;
+    for (size_t t = t0; t < t1; t++) {
+        s += a[t] * b[t];
+    }
+    return s;
+}
+
+#endif
+
+typedef struct {
+    const double *z;
+    int rows;
+    size_t stride;
+    double *out;
+    int tiles;          // Tiles per side
+    int pairs;          // Tiles on and above the diagonal
+    atomic_int next;    // Next unclaimed tile pair
+} corr_job_t;
+
+// Tile pair k, counted row by row along the upper triangle
+static void tile_pair(int tiles, int k, int *ti, int *tj) {
+    int row = 0;
+    while (k >= tiles - row) {
+        k -= tiles - row;
+        row++;
+    }
+    *ti = row;
+    *tj = row + k;
+}
+
+static void compute_tile(const corr_job_t *job, int ti, int tj) {
+    int i0 = ti * CORR_TILE_ROWS, i1 = i0 + CORR_TILE_ROWS < job->rows ? i0 + CORR_TILE_ROWS : job->rows;
+    int j0 = tj * CORR_TILE_ROWS, j1 = j0 + CORR_TILE_ROWS < job->rows ? j0 + CORR_TILE_ROWS : job->rows;
+    const double *z = job->z;
+    size_t stride = job->stride;
+
+    for (int i = i0; i < i1; i++) {
+        memset(job->out + (size_t)i * (size_t)job->rows + j0, 0, (size_t)(j1 - j0) * sizeof(double));
+    }
+
+    for (size_t t0 = 0; t0 < stride; t0 += CORR_TILE_LEN) {
+        size_t t1 = t0 + CORR_TILE_LEN < stride ? t0 + CORR_TILE_LEN : stride;
+        int i = i0;
+        for (; i + 2 <= i1; i += 2) {
+            double *out0 = job->out + (size_t)i * (size_t)job->rows;
+            double *out1 = out0 + job->rows;
+            int j = j0;
+            for (; j + 4 <= j1; j += 4) {
+                const double *b[4] = { z + (size_t)j * stride, z + (size_t)(j + 1) * stride,
+                                       z + (size_t)(j + 2) * stride, z + (size_t)(j + 3) * stride };
+                kernel_2x4(z + (size_t)i * stride, z + (size_t)(i + 1) * stride, b, t0, t1,
+                           out0 + j, out1 + j);
+            }
+            for (; j < j1; j++) {
+                out0[j] += dot(z + (size_t)i * stride, z + (size_t)j * stride, t0, t1);
+                out1[j] += dot(z + (size_t)(i + 1) * stride, z + (size_t)j * stride, t0, t1);
+            }
+        }
+        for (; i < i1; i++) {
+            double *out0 = job->out + (size_t)i * (size_t)job->rows;
+            for (int j = j0; j < j1; j++) {
+                out0[j] += dot(z + (size_t)i * stride, z + (size_t)j * stride, t0, t1);
+            }
+        }
+    }
+}
+
+static void *corr_worker(void *arg) {
+    corr_job_t *job = (corr_job_t *)arg;
+    for (;;) {
+        int k = atomic_fetch_add(&job->next, 1);
+        if (k >= job->pairs) {
+            break;
+        }
+        int ti, tj;
+        tile_pair(job->tiles, k, &ti, &tj);
+        compute_tile(job, ti, tj);
+    }
+    return NULL;
+}
+
+void corr_matrix(const double *z, int rows, size_t stride, int threads, double *out) {
+    if (rows <= 0) {
+        return;
+    }
+
+    corr_job_t job;
+    job.z = z;
+    job.rows = rows;
+    job.stride = stride;
+    job.out = out;
+    job.tiles = (rows + CORR_TILE_ROWS - 1) / CORR_TILE_ROWS;
+    job.pairs = job.tiles * (job.tiles + 1) / 2;
+    atomic_init(&job.next, 0);
+
+    if (threads > job.pairs) {
+        threads = job.pairs;
+    }
+    if (threads > CORR_MAX_THREADS) {
+        threads = CORR_MAX_THREADS;
+    }
+
+    // The calling thread works too; a thread that fails to start leaves its share to the others
+    pthread_t workers[CORR_MAX_THREADS];
+    int started = 0;
+    for (int t = 1; t < threads; t++) {
+        if (pthread_create(&workers[started], NULL, corr_worker, &job) == 0) {
+            started++;
+        }
+    }
+    corr_worker(&job);
+    for (int t = 0; t < started; t++) {
+        pthread_join(workers[t], NULL);
+    }
+
+    // Diagonal tiles were computed in full; mirror the rest
+    for (int i = 0; i < rows; i++) {
+        for (int j = i + 1; j < rows; j++) {
+            out[(size_t)j * (size_t)rows + i] = out[(size_t)i * (size_t)rows + j];
+        }
+    }
+}
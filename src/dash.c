@@ -0,0 +1,496 @@
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "../include/dash.h"
+#include "../include/api.h"
+#include "../include/parser.h"
+#include "../include/display.h"
+#include "../include/screen.h"
+#include "../include/coinids.h"
+
+#define DASH_DEFAULT_LIMIT 20
+#define DASH_DEFAULT_INTERVAL 30
+#define DASH_MARKETS_BUFFER_SIZE (1024 * 1024)
+#define DASH_WATCH_BUFFER_SIZE (64 * 1024)
+#define DASH_TABLE_WIDTH 110
+#define DASH_CHANGE_COLUMN 82
+
+typedef enum {
+    SORT_RANK = 0,
+    SORT_NAME,
+    SORT_PRICE,
+    SORT_CHANGE,
+    SORT_MARKET_CAP,
+    SORT_VOLUME
+} dash_sort_t;
+
+/**
+ * @brief Data shared between the refresher thread and the UI thread
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    markets_data_t markets;
+    markets_data_t watch;
+    time_t updated_at;
+    int failed;            // Last refresh failed (data shown is older)
+    int stop;
+    int limit;
+    int interval;
+    char *watch_ids;       // Comma-separated ids, NULL if none
+    int notify_fd;         // Self-pipe write end: new data arrived
+} dash_state_t;
+
+static int signal_fd = -1;
+static volatile sig_atomic_t resized = 0;
+static volatile sig_atomic_t quit_requested = 0;
+static struct termios saved_termios;
+
+static void on_sigwinch(int sig) {
+    (void)sig;
+    resized = 1;
+    if (signal_fd >= 0) {
+        ssize_t n = write(signal_fd, "w", 1);
+        (void)n;
+    }
+}
+
+static void on_terminate(int sig) {
+    (void)sig;
+    quit_requested = 1;
+    if (signal_fd >= 0) {
+        ssize_t n = write(signal_fd, "q", 1);
+        (void)n;
+    }
+}
+
+static void *refresh_thread(void *arg) {
+    dash_state_t *state = (dash_state_t *)arg;
+    char *buffer = malloc(DASH_MARKETS_BUFFER_SIZE);
+    if (!buffer) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&state->lock);
+    while (!state->stop) {
+        pthread_mutex_unlock(&state->lock);
+
+        markets_data_t markets = {0};
+        markets_data_t watch = {0};
+        int failed = 0;
+
+        if (fetch_markets_data(state->limit, buffer, DASH_MARKETS_BUFFER_SIZE) == 0) {
+            markets = parse_markets_json(buffer, state->limit);
+        }
+        failed |= !markets.success;
+
+        if (state->watch_ids) {
+            if (fetch_simple_price_batch(state->watch_ids, "usd", buffer, DASH_WATCH_BUFFER_SIZE) == 0) {
+                watch = parse_simple_price_batch_json(buffer, "usd");
+            }
+            failed |= !watch.success;
+        }
+
+        pthread_mutex_lock(&state->lock);
+        // Keep showing the previous data for whatever failed to refresh
+        if (markets.success) {
+            free_markets_data(&state->markets);
+            state->markets = markets;
+        } else {
+            free_markets_data(&markets);
+        }
+        if (watch.success) {
+            free_markets_data(&state->watch);
+            state->watch = watch;
+        } else {
+            free_markets_data(&watch);
+        }
+        if (!failed) {
+            state->updated_at = time(NULL);
+        }
+        state->failed = failed;
+
+        ssize_t n = write(state->notify_fd, "d", 1);
+        (void)n;
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += state->interval;
+        while (!state->stop) {
+            if (pthread_cond_timedwait(&state->wake, &state->lock, &deadline) == ETIMEDOUT) {
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&state->lock);
+
+    free(buffer);
+    return NULL;
+}
+
+// Sorting happens on an index array so the fetched data is never reordered
+static const crypto_data_t *sort_coins;
+static dash_sort_t sort_key;
+static int sort_descending;
+
+static int compare_rows(const void *a, const void *b) {
+    int ia = *(const int *)a;
+    int ib = *(const int *)b;
+    const crypto_data_t *x = &sort_coins[ia];
+    const crypto_data_t *y = &sort_coins[ib];
+    int cmp = 0;
+
+    switch (sort_key) {
+        case SORT_RANK:
+            cmp = (ia > ib) - (ia < ib);
+            break;
+        case SORT_NAME:
+            cmp = strcmp(x->name ? x->name : "", y->name ? y->name : "");
+            break;
+        case SORT_PRICE:
+            cmp = (x->current_price > y->current_price) - (x->current_price < y->current_price);
+            break;
+        case SORT_CHANGE:
+            cmp = (x->price_change_percentage_24h > y->price_change_percentage_24h) -
+                  (x->price_change_percentage_24h < y->price_change_percentage_24h);
+            break;
+        case SORT_MARKET_CAP:
+            cmp = (x->market_cap > y->market_cap) - (x->market_cap < y->market_cap);
+            break;
+        case SORT_VOLUME:
+            cmp = (x->volume_24h > y->volume_24h) - (x->volume_24h < y->volume_24h);
+            break;
+    }
+
+    if (cmp == 0) {
+        cmp = (ia > ib) - (ia < ib);
+    }
+    return sort_descending ? -cmp : cmp;
+}
+
+static void draw_rule(screen_t *screen, int row) {
+    int width = screen->cols < DASH_TABLE_WIDTH ? screen->cols : DASH_TABLE_WIDTH;
+    for (int col = 0; col < width; col++) {
+        screen_put(screen, row, col, "━", SCREEN_ATTR_DIM);
+    }
+}
+
+static void draw_coin_row(screen_t *screen, int row, const char *rank, const crypto_data_t *coin) {
+    char price_str[32];
+    char mcap_str[32];
+    char volume_str[32];
+    char change_str[32];
+    format_table_price(coin->current_price, price_str, sizeof(price_str));
+    format_table_amount(coin->market_cap, mcap_str, sizeof(mcap_str));
+    format_table_amount(coin->volume_24h, volume_str, sizeof(volume_str));
+    format_table_change(coin->price_change_percentage_24h, change_str, sizeof(change_str));
+
+    char name_display[21];
+    const char *name = coin->name ? coin->name : "N/A";
+    if (strlen(name) > 19) {
+        snprintf(name_display, sizeof(name_display), "%.16s...", name);
+    } else {
+        snprintf(name_display, sizeof(name_display), "%s", name);
+    }
+
+    char line[160];
+    snprintf(line, sizeof(line), "  %-4s %-8s %-20s %-12s %-15s %-15s",
+             rank, coin->symbol ? coin->symbol : "N/A", name_display, price_str, mcap_str, volume_str);
+    screen_put(screen, row, 0, line, SCREEN_ATTR_NONE);
+    screen_put(screen, row, DASH_CHANGE_COLUMN, change_str,
+               coin->price_change_percentage_24h >= 0 ? SCREEN_ATTR_GREEN : SCREEN_ATTR_RED);
+}
+
+static void draw_frame(screen_t *screen, dash_state_t *state, int **order, int *order_size) {
+    screen_clear(screen);
+
+    pthread_mutex_lock(&state->lock);
+
+    const markets_data_t *markets = &state->markets;
+    char title[160];
+    char time_str[16] = "--:--:--";
+    if (state->updated_at > 0) {
+        strftime(time_str, sizeof(time_str), "%H:%M:%S", localtime(&state->updated_at));
+    }
+    snprintf(title, sizeof(title), "  Top %d Cryptocurrencies by Market Cap    updated %s%s",
+             markets->count, time_str, state->failed ? "  (refresh failed, showing last data)" : "");
+    screen_put(screen, 0, 0, title, SCREEN_ATTR_BOLD);
+    draw_rule(screen, 1);
+
+    static const char *headers[] = { "Rank", "Name", "Price", "24h Change", "Market Cap", "24h Volume" };
+    static const int header_cols[] = { 2, 16, 37, DASH_CHANGE_COLUMN, 50, 66 };
+    screen_put(screen, 2, 0, "  Rank Symbol   Name                 Price        Market Cap      24h Volume      24h Change",
+               SCREEN_ATTR_BOLD);
+    screen_put(screen, 2, header_cols[sort_key], headers[sort_key], SCREEN_ATTR_BOLD | SCREEN_ATTR_REVERSE);
+    draw_rule(screen, 3);
+
+    int row = 4;
+    int last_row = screen->rows - 2;
+
+    // Pinned watchlist coins first
+    for (int i = 0; i < state->watch.count && row < last_row; i++) {
+        if (state->watch.coins[i].success) {
+            draw_coin_row(screen, row++, "*", &state->watch.coins[i]);
+        }
+    }
+    if (state->watch.count > 0 && row < last_row) {
+        draw_rule(screen, row++);
+    }
+
+    if (*order_size < markets->count) {
+        int *grown = realloc(*order, sizeof(int) * (size_t)markets->count);
+        if (grown) {
+            *order = grown;
+            *order_size = markets->count;
+        }
+    }
+    int count = markets->count <= *order_size ? markets->count : 0;
+    for (int i = 0; i < count; i++) {
+        (*order)[i] = i;
+    }
+    sort_coins = markets->coins;
+    qsort(*order, (size_t)count, sizeof(int), compare_rows);
+
+    for (int i = 0; i < count && row < last_row; i++) {
+        const crypto_data_t *coin = &markets->coins[(*order)[i]];
+        if (!coin->success) {
+            continue;
+        }
+        char rank[12];
+        snprintf(rank, sizeof(rank), "%d", (*order)[i] + 1);
+        draw_coin_row(screen, row++, rank, coin);
+    }
+
+    pthread_mutex_unlock(&state->lock);
+
+    screen_put(screen, screen->rows - 1, 0,
+               "  r rank  n name  p price  c change  m mcap  v volume  (again: reverse)  q quit",
+               SCREEN_ATTR_DIM);
+}
+
+static void handle_key(int key) {
+    dash_sort_t key_sort;
+    switch (tolower(key)) {
+        case 'r': key_sort = SORT_RANK; break;
+        case 'n': key_sort = SORT_NAME; break;
+        case 'p': key_sort = SORT_PRICE; break;
+        case 'c': key_sort = SORT_CHANGE; break;
+        case 'm': key_sort = SORT_MARKET_CAP; break;
+        case 'v': key_sort = SORT_VOLUME; break;
+        default: return;
+    }
+
+    if (key_sort == sort_key) {
+        sort_descending = !sort_descending;
+    } else {
+        sort_key = key_sort;
+        // Rank and name read naturally ascending, numbers descending
+        sort_descending = (key_sort != SORT_RANK && key_sort != SORT_NAME);
+    }
+}
+
+static void terminal_size(int *rows, int *cols) {
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+        *rows = ws.ws_row;
+        *cols = ws.ws_col;
+    } else {
+        *rows = 24;
+        *cols = 80;
+    }
+}
+
+static void terminal_restore(void) {
+    tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+    const char *leave = "\x1b[0m\x1b[?25h\x1b[?1049l";
+    ssize_t n = write(STDOUT_FILENO, leave, strlen(leave));
+    (void)n;
+}
+
+static int terminal_enter(void) {
+    if (tcgetattr(STDIN_FILENO, &saved_termios) != 0) {
+        return -1;
+    }
+
+    struct termios raw = saved_termios;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) != 0) {
+        return -1;
+    }
+
+    // Alternate screen, hidden cursor
+    const char *enter = "\x1b[?1049h\x1b[?25l";
+    ssize_t n = write(STDOUT_FILENO, enter, strlen(enter));
+    (void)n;
+    return 0;
+}
+
+static char *resolve_watch_ids(const char *list) {
+    const char **ids = NULL;
+    int count = coin_ids_resolve(list, &ids);
+    char *csv = count > 0 ? join_ids(ids, sizeof(ids[0]), count) : NULL;
+    free(ids);
+    return csv;
+}
+
+static void print_dash_usage(void) {
+    printf("Usage: crypto dash [N] [--watch ID,ID,...] [--interval SECONDS]\n");
+}
+
+int dash_command(int argc, char *argv[]) {
+    // The top coins and the watch list barely change between refreshes, so
+    // their strings are interned instead of copied for every redraw's data
+    parser_set_interning(1);
+
+    int limit = DASH_DEFAULT_LIMIT;
+    int interval = DASH_DEFAULT_INTERVAL;
+    const char *watch = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--watch") == 0 && i + 1 < argc) {
+            watch = argv[++i];
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            interval = atoi(argv[++i]);
+            if (interval <= 0) {
+                display_error("Interval must be a positive number of seconds");
+                return 1;
+            }
+        } else if (isdigit((unsigned char)argv[i][0])) {
+            limit = atoi(argv[i]);
+            if (limit <= 0 || limit > 250) {
+                display_error("Limit must be between 1 and 250");
+                return 1;
+            }
+        } else {
+            print_dash_usage();
+            return 1;
+        }
+    }
+
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO)) {
+        display_error("dash needs an interactive terminal");
+        return 1;
+    }
+
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) {
+        display_error("Failed to create notification pipe");
+        return 1;
+    }
+    fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK);
+    fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK);
+
+    dash_state_t state = {0};
+    pthread_mutex_init(&state.lock, NULL);
+    pthread_cond_init(&state.wake, NULL);
+    state.limit = limit;
+    state.interval = interval;
+    state.notify_fd = pipe_fds[1];
+    state.watch_ids = watch ? resolve_watch_ids(watch) : NULL;
+
+    int rows, cols;
+    terminal_size(&rows, &cols);
+    screen_t screen;
+    if (screen_init(&screen, rows, cols) != 0 || terminal_enter() != 0) {
+        display_error("Failed to initialise terminal");
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        free(state.watch_ids);
+        return 1;
+    }
+
+    signal_fd = pipe_fds[1];
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigwinch;
+    sigaction(SIGWINCH, &sa, NULL);
+    sa.sa_handler = on_terminate;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    pthread_t refresher;
+    int thread_ok = pthread_create(&refresher, NULL, refresh_thread, &state) == 0;
+
+    int *order = NULL;
+    int order_size = 0;
+    int status = thread_ok ? 0 : 1;
+
+    draw_frame(&screen, &state, &order, &order_size);
+    screen_flush(&screen, STDOUT_FILENO);
+
+    while (thread_ok && !quit_requested) {
+        struct pollfd fds[2] = {
+            { STDIN_FILENO, POLLIN, 0 },
+            { pipe_fds[0], POLLIN, 0 }
+        };
+        if (poll(fds, 2, -1) < 0 && errno != EINTR) {
+            status = 1;
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            char drain[64];
+            while (read(pipe_fds[0], drain, sizeof(drain)) > 0) {
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char keys[16];
+            ssize_t n = read(STDIN_FILENO, keys, sizeof(keys));
+            for (ssize_t k = 0; k < n; k++) {
+                if (keys[k] == 'q' || keys[k] == 'Q') {
+                    quit_requested = 1;
+                }
+                handle_key((unsigned char)keys[k]);
+            }
+        }
+
+        if (resized) {
+            resized = 0;
+            terminal_size(&rows, &cols);
+            screen_resize(&screen, rows, cols);
+        }
+
+        if (!quit_requested) {
+            draw_frame(&screen, &state, &order, &order_size);
+            screen_flush(&screen, STDOUT_FILENO);
+        }
+    }
+
+    terminal_restore();
+    signal_fd = -1;
+
+    if (thread_ok) {
+        pthread_mutex_lock(&state.lock);
+        state.stop = 1;
+        pthread_cond_signal(&state.wake);
+        pthread_mutex_unlock(&state.lock);
+        pthread_join(refresher, NULL);
+    }
+
+    free(order);
+    screen_free(&screen);
+    free_markets_data(&state.markets);
+    free_markets_data(&state.watch);
+    free(state.watch_ids);
+    pthread_mutex_destroy(&state.lock);
+    pthread_cond_destroy(&state.wake);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+
+    return status;
+}
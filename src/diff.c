@@ -0,0 +1,491 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../include/diff.h"
+#include "../include/display.h"
+#include "../include/intern.h"
+#include "../include/output.h"
+#include "../include/paths.h"
+
+#define DIFF_WIDTH 14
+#define DIFF_COLUMNS 12
+#define DIFF_MAX_FILE (512L * 1024 * 1024)   // Largest markets JSON file read
+
+/**
+ * @brief One output row: a coin's index on each side (-1 if absent)
+ */
+typedef struct {
+    int before;
+    int after;
+    double key;      // Sort key; NaN sorts last
+    int order;       // Tie-break: position in rank order
+} diff_row_t;
+
+static const char *diff_columns[DIFF_COLUMNS] = {
+    "rank", "previous_rank", "rank_change", "status", "id", "symbol", "price",
+    "price_change_pct", "market_cap", "market_cap_change_pct", "volume_24h", "volume_change_pct"
+};
+
+int diff_side_from_snapshot(const markets_snapshot_t *snapshot, diff_side_t *side) {
+    memset(side, 0, sizeof(*side));
+    const char **strings = malloc(((size_t)snapshot->count * 2 + 1) * sizeof(const char *));
+    if (!strings) {
+        return -1;
+    }
+
+    side->count = (int)snapshot->count;
+    side->created_at = snapshot->created_at;
+    side->id = strings;
+    side->symbol = strings + snapshot->count;
+    for (uint32_t i = 0; i < snapshot->count; i++) {
+        side->id[i] = snapshot_string(snapshot, i, SNAPSHOT_ID);
+        side->symbol[i] = snapshot_string(snapshot, i, SNAPSHOT_SYMBOL);
+    }
+    side->price = snapshot->price;
+    side->market_cap = snapshot->market_cap;
+    side->volume = snapshot->volume_24h;
+    side->owned = strings;
+    return 0;
+}
+
+int diff_side_from_markets(const markets_data_t *markets, int64_t created_at, diff_side_t *side) {
+    memset(side, 0, sizeof(*side));
+    size_t n = markets->count > 0 ? (size_t)markets->count : 0;
+
+    // Doubles first, then pointers: one allocation, every array aligned
+    char *block = malloc(n * (3 * sizeof(double) + 2 * sizeof(const char *)) + 1);
+    if (!block) {
+        return -1;
+    }
+    double *price = (double *)block;
+    double *market_cap = price + n;
+    double *volume = market_cap + n;
+    const char **id = (const char **)(volume + n);
+    const char **symbol = id + n;
+
+    int count = 0;
+    for (int i = 0; i < markets->count; i++) {
+        const crypto_data_t *coin = &markets->coins[i];
+        if (!coin->success || !coin->id) {
+            continue;
+        }
+        id[count] = coin->id;
+        symbol[count] = coin->symbol ? coin->symbol : "";
+        price[count] = coin->current_price;
+        market_cap[count] = coin->market_cap;
+        volume[count] = coin->volume_24h;
+        count++;
+    }
+
+    side->count = count;
+    side->created_at = created_at;
+    side->id = id;
+    side->symbol = symbol;
+    side->price = price;
+    side->market_cap = market_cap;
+    side->volume = volume;
+    side->owned = block;
+    return 0;
+}
+
+void diff_side_free(diff_side_t *side) {
+    if (side) {
+        free(side->owned);
+        memset(side, 0, sizeof(*side));
+    }
+}
+
+static uint32_t hash_id(const char *s) {
+    return intern_hash(INTERN_HASH_SEED, s, strlen(s));
+}
+
+/**
+ * @brief Open-addressing table of a side's ids (indexes, -1 = empty)
+ *
+ * Sized to a power of two at least twice the count, so probes stay short.
+ */
+static int *build_index(const diff_side_t *side, uint32_t *mask) {
+    uint32_t size = 16;
+    while (size < (uint32_t)side->count * 2) {
+        size *= 2;
+    }
+    int *table = malloc(size * sizeof(int));
+    if (!table) {
+        return NULL;
+    }
+    memset(table, 0xff, size * sizeof(int));
+
+    *mask = size - 1;
+    for (int i = 0; i < side->count; i++) {
+        uint32_t slot = hash_id(side->id[i]) & *mask;
+        while (table[slot] >= 0) {
+            // A repeated id keeps its best rank
+            if (strcmp(side->id[table[slot]], side->id[i]) == 0) {
+                break;
+            }
+            slot = (slot + 1) & *mask;
+        }
+        if (table[slot] < 0) {
+            table[slot] = i;
+        }
+    }
+    return table;
+}
+
+static int find_index(const int *table, uint32_t mask, const diff_side_t *side, const char *id) {
+    uint32_t slot = hash_id(id) & mask;
+    while (table[slot] >= 0) {
+        if (strcmp(side->id[table[slot]], id) == 0) {
+            return table[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+// Relative change in percent, NaN unless both values are usable
+static double change_pct(double before, double after) {
+    if (!isfinite(before) || !isfinite(after) || before == 0.0) {
+        return NAN;
+    }
+    return (after / before - 1.0) * 100.0;
+}
+
+static int compare_rows(const void *a, const void *b) {
+    const diff_row_t *x = (const diff_row_t *)a, *y = (const diff_row_t *)b;
+    int x_nan = isnan(x->key), y_nan = isnan(y->key);
+    if (x_nan != y_nan) {
+        return x_nan - y_nan;
+    }
+    if (!x_nan && x->key != y->key) {
+        return x->key < y->key ? -1 : 1;
+    }
+    return (x->order > y->order) - (x->order < y->order);
+}
+
+static const char *row_status(const diff_row_t *row, int limit) {
+    int in_before = row->before >= 0 && row->before < limit;
+    int in_after = row->after >= 0 && row->after < limit;
+    if (!in_before) {
+        return "new";
+    }
+    if (!in_after) {
+        return "out";
+    }
+    return row->after < row->before ? "up" : row->after > row->before ? "down" : "same";
+}
+
+static void print_summary(FILE *fp, const diff_side_t *before, const diff_side_t *after, int limit,
+                          int entrants, int dropouts, int moved) {
+    char when[2][32] = { "?", "?" };
+    const diff_side_t *sides[2] = { before, after };
+    for (int s = 0; s < 2; s++) {
+        time_t t = (time_t)sides[s]->created_at;
+        struct tm tm;
+        if (t > 0 && localtime_r(&t, &tm)) {
+            strftime(when[s], sizeof(when[s]), "%Y-%m-%d %H:%M", &tm);
+        }
+    }
+    fprintf(fp, "Top %d: %s -> %s, %d new, %d out, %d moved\n\n", limit, when[0], when[1],
+            entrants, dropouts, moved);
+}
+
+int diff_write(FILE *fp, output_format_t format, const diff_side_t *before,
+               const diff_side_t *after, int limit, diff_sort_t sort) {
+    int k = before->count < after->count ? before->count : after->count;
+    if (limit > 0 && limit < k) {
+        k = limit;
+    }
+
+    uint32_t mask = 0;
+    int *table = build_index(before, &mask);
+    unsigned char *matched = calloc((size_t)before->count + 1, 1);
+    diff_row_t *rows = malloc(((size_t)k * 2 + 1) * sizeof(diff_row_t));
+    if (!table || !matched || !rows) {
+        free(table);
+        free(matched);
+        free(rows);
+        return -1;
+    }
+
+    // Probe with every later coin: the top k are rows; further down, only
+    // coins that were in the top k before (drop-outs still listed)
+    int count = 0;
+    for (int j = 0; j < after->count; j++) {
+        int i = find_index(table, mask, before, after->id[j]);
+        if (i >= 0) {
+            if (matched[i]) {
+                continue;
+            }
+            matched[i] = 1;
+        }
+        if (j < k || (i >= 0 && i < k)) {
+            rows[count].before = i;
+            rows[count].after = j;
+            count++;
+        }
+    }
+    // Drop-outs no longer listed at all
+    for (int i = 0; i < k; i++) {
+        if (!matched[i]) {
+            rows[count].before = i;
+            rows[count].after = -1;
+            count++;
+        }
+    }
+
+    int entrants = 0, dropouts = 0, moved = 0;
+    for (int r = 0; r < count; r++) {
+        diff_row_t *row = &rows[r];
+        const char *status = row_status(row, k);
+        entrants += status[0] == 'n';
+        dropouts += status[0] == 'o';
+        moved += status[0] == 'u' || status[0] == 'd';
+
+        int j = row->after, i = row->before;
+        row->order = j >= 0 && j < k ? j : k + i;
+        switch (sort) {
+        case DIFF_SORT_RANK:
+            row->key = row->order;
+            break;
+        case DIFF_SORT_MOVE:
+            row->key = i >= 0 && j >= 0 ? (double)(j - i) : NAN;
+            break;
+        case DIFF_SORT_PRICE:
+            row->key = i >= 0 && j >= 0 ? -change_pct(before->price[i], after->price[j]) : NAN;
+            break;
+        case DIFF_SORT_MARKET_CAP:
+            row->key = i >= 0 && j >= 0 ? -change_pct(before->market_cap[i], after->market_cap[j]) : NAN;
+            break;
+        case DIFF_SORT_VOLUME:
+            row->key = i >= 0 && j >= 0 ? -change_pct(before->volume[i], after->volume[j]) : NAN;
+            break;
+        }
+    }
+    qsort(rows, (size_t)count, sizeof(diff_row_t), compare_rows);
+
+    if (format == OUTPUT_TABLE) {
+        print_summary(fp, before, after, k, entrants, dropouts, moved);
+    }
+
+    output_t out;
+    output_begin(&out, fp, format, diff_columns, DIFF_COLUMNS, DIFF_WIDTH);
+    for (int r = 0; r < count; r++) {
+        const diff_row_t *row = &rows[r];
+        int i = row->before, j = row->after;
+        // Values come from the later listing when the coin is still in it
+        const diff_side_t *now = j >= 0 ? after : before;
+        int at = j >= 0 ? j : i;
+
+        output_row_begin(&out);
+        output_number(&out, j >= 0 ? j + 1 : NAN);
+        output_number(&out, i >= 0 ? i + 1 : NAN);
+        output_number(&out, i >= 0 && j >= 0 ? (double)(i - j) : NAN);
+        output_string(&out, row_status(row, k));
+        output_string(&out, now->id[at]);
+        output_string(&out, now->symbol[at]);
+        output_number(&out, now->price[at]);
+        output_number(&out, i >= 0 && j >= 0 ? change_pct(before->price[i], after->price[j]) : NAN);
+        output_number(&out, now->market_cap[at]);
+        output_number(&out, i >= 0 && j >= 0 ? change_pct(before->market_cap[i], after->market_cap[j]) : NAN);
+        output_number(&out, now->volume[at]);
+        output_number(&out, i >= 0 && j >= 0 ? change_pct(before->volume[i], after->volume[j]) : NAN);
+        output_row_end(&out);
+    }
+    int rc = output_end(&out);
+
+    free(table);
+    free(matched);
+    free(rows);
+    return rc;
+}
+
+int diff_parse_age(const char *text, long *seconds) {
+    if (!text || !*text) {
+        return -1;
+    }
+    char *end = NULL;
+    double value = strtod(text, &end);
+    double unit = 1.0;
+    if (strcmp(end, "") == 0 || strcmp(end, "s") == 0) {
+        unit = 1.0;
+    } else if (strcmp(end, "m") == 0) {
+        unit = 60.0;
+    } else if (strcmp(end, "h") == 0) {
+        unit = 3600.0;
+    } else if (strcmp(end, "d") == 0) {
+        unit = 86400.0;
+    } else {
+        return -1;
+    }
+    if (end == text || !(value > 0.0) || value * unit > 10.0 * 365 * 86400) {
+        return -1;
+    }
+    *seconds = (long)(value * unit);
+    return *seconds > 0 ? 0 : -1;
+}
+
+/**
+ * @brief A listing loaded from a snapshot or a JSON file
+ */
+typedef struct {
+    markets_snapshot_t snapshot;
+    markets_data_t markets;
+    diff_side_t side;
+} listing_t;
+
+static char *read_file(const char *path, time_t *mtime) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fileno(fp), &st) != 0 || st.st_size > DIFF_MAX_FILE) {
+        fclose(fp);
+        return NULL;
+    }
+    char *text = malloc((size_t)st.st_size + 1);
+    if (text && fread(text, 1, (size_t)st.st_size, fp) != (size_t)st.st_size) {
+        free(text);
+        text = NULL;
+    }
+    if (text) {
+        text[st.st_size] = '\0';
+        *mtime = st.st_mtime;
+    }
+    fclose(fp);
+    return text;
+}
+
+/**
+ * @brief Resolve and load one side of "crypto diff"
+ *
+ * An existing file is read as a snapshot, or else as markets JSON;
+ * "latest" is the last top snapshot; an age picks the archived snapshot
+ * from that long before now.
+ */
+static int load_listing(const char *spec, listing_t *listing) {
+    memset(listing, 0, sizeof(*listing));
+    char path[1100];
+    long age = 0;
+
+    if (access(spec, F_OK) == 0) {
+        snprintf(path, sizeof(path), "%s", spec);
+    } else if (strcmp(spec, "latest") == 0) {
+        if (paths_cache_file(SNAPSHOT_DIR, SNAPSHOT_MARKETS, path, sizeof(path)) != 0) {
+            return -1;
+        }
+    } else if (diff_parse_age(spec, &age) == 0) {
+        char dir[1024];
+        if (paths_cache_subdir(SNAPSHOT_ARCHIVE_DIR, dir, sizeof(dir)) != 0 ||
+            snapshot_archive_find(dir, SNAPSHOT_MARKETS, (int64_t)time(NULL) - age, path,
+                                  sizeof(path)) != 0) {
+            return -1;
+        }
+    } else {
+        return -1;
+    }
+
+    if (snapshot_open(path, &listing->snapshot) == 0) {
+        if (diff_side_from_snapshot(&listing->snapshot, &listing->side) != 0) {
+            snapshot_close(&listing->snapshot);
+            return -1;
+        }
+        return 0;
+    }
+
+    time_t mtime = 0;
+    char *text = read_file(path, &mtime);
+    if (!text) {
+        return -1;
+    }
+    listing->markets = parse_markets_json(text, 1 << 30);
+    free(text);
+    if (!listing->markets.success ||
+        diff_side_from_markets(&listing->markets, (int64_t)mtime, &listing->side) != 0) {
+        free_markets_data(&listing->markets);
+        return -1;
+    }
+    return 0;
+}
+
+static void free_listing(listing_t *listing) {
+    diff_side_free(&listing->side);
+    snapshot_close(&listing->snapshot);
+    if (listing->markets.success) {
+        free_markets_data(&listing->markets);
+    }
+}
+
+static void print_diff_usage(void) {
+    printf("Usage: crypto diff BEFORE AFTER [--limit N] [--sort KEY]\n");
+    printf("  BEFORE, AFTER  Snapshot or /coins/markets JSON file, latest (the last\n");
+    printf("                 'top' snapshot) or an age such as 1h or 2d (archived snapshot)\n");
+    printf("  --limit N      Compare the top N ranks (default: as many as both have)\n");
+    printf("  --sort KEY     rank (default), move, price, market_cap or volume\n");
+}
+
+int diff_command(int argc, char *argv[], const cli_options_t *options) {
+    const char *specs[2] = { NULL, NULL };
+    int given = 0;
+    int limit = 0;
+    diff_sort_t sort = DIFF_SORT_RANK;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--limit") == 0 && i + 1 < argc) {
+            limit = atoi(argv[++i]);
+            if (limit <= 0) {
+                display_error("--limit must be a positive number");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--sort") == 0 && i + 1 < argc) {
+            static const char *names[] = { "rank", "move", "price", "market_cap", "volume" };
+            const char *key = argv[++i];
+            int found = -1;
+            for (int s = 0; s < 5 && found < 0; s++) {
+                found = strcmp(key, names[s]) == 0 ? s : -1;
+            }
+            if (found < 0) {
+                display_error("--sort expects rank, move, price, market_cap or volume");
+                return 1;
+            }
+            sort = (diff_sort_t)found;
+        } else if (argv[i][0] == '-' || given == 2) {
+            print_diff_usage();
+            return 1;
+        } else {
+            specs[given++] = argv[i];
+        }
+    }
+    if (given != 2) {
+        print_diff_usage();
+        return 1;
+    }
+
+    listing_t listings[2];
+    for (int s = 0; s < 2; s++) {
+        if (load_listing(specs[s], &listings[s]) != 0) {
+            char message[256];
+            snprintf(message, sizeof(message), "Cannot load a market listing from \"%s\"", specs[s]);
+            display_error(message);
+            if (s == 1) {
+                free_listing(&listings[0]);
+            }
+            return 1;
+        }
+    }
+
+    int rc = diff_write(stdout, options->format, &listings[0].side, &listings[1].side, limit, sort);
+    if (rc != 0) {
+        display_error("Failed to write output");
+    }
+    free_listing(&listings[0]);
+    free_listing(&listings[1]);
+    return rc == 0 ? 0 : 1;
+}
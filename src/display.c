@@ -1,260 +1,419 @@
-#include <stdio.h>
-#include <string.h>
-#include <strings.h>  // For strcasecmp
-#include <time.h>
-#include "../include/display.h"
-
-// Get currency symbol for display
-static const char *get_currency_symbol(const char *currency) {
-    if (!currency) return "$";
-    
-    if (strcasecmp(currency, "eur") == 0) return "€";
-    if (strcasecmp(currency, "gbp") == 0) return "£";
-    if (strcasecmp(currency, "jpy") == 0) return "¥";
-    if (strcasecmp(currency, "cny") == 0) return "¥";
-    if (strcasecmp(currency, "krw") == 0) return "₩";
-    if (strcasecmp(currency, "inr") == 0) return "₹";
-    if (strcasecmp(currency, "btc") == 0) return "₿";
-    
-    // Default: return uppercase currency code or "$" for USD
-    if (strcasecmp(currency, "usd") == 0) return "$";
-    
-    // For other currencies, return currency code uppercase
-    return currency; // Will be formatted in display functions
-}
-
-void display_full_info(const crypto_data_t *data) {
-    if (!data || !data->success) {
-        display_error("Failed to retrieve cryptocurrency data");
-        return;
-    }
-    
-    const char *currency_symbol = get_currency_symbol(data->currency);
-    
-    printf("\n━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
-    printf("  %s (%s)\n", data->name ? data->name : "N/A", 
-           data->symbol ? data->symbol : "N/A");
-    printf("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
-    
-    // Format price with currency symbol
-    if (strcmp(currency_symbol, "$") == 0 || strcmp(currency_symbol, "€") == 0 || 
-        strcmp(currency_symbol, "£") == 0) {
-        printf("  Current Price:      %s%.2f\n", currency_symbol, data->current_price);
-    } else if (strcmp(currency_symbol, "¥") == 0 || strcmp(currency_symbol, "₩") == 0) {
-        printf("  Current Price:      %s%.0f\n", currency_symbol, data->current_price);
-    } else {
-        // For other currencies, show code before price
-        printf("  Current Price:      %.2f %s\n", data->current_price, 
-               data->currency ? data->currency : "USD");
-    }
-    
-    if (data->price_change_24h != 0.0) {
-        const char *sign = data->price_change_24h >= 0 ? "+" : "";
-        const char *color = data->price_change_24h >= 0 ? "↑" : "↓";
-        
-        // Format change with currency symbol
-        if (strcmp(currency_symbol, "$") == 0 || strcmp(currency_symbol, "€") == 0 || 
-            strcmp(currency_symbol, "£") == 0) {
-            printf("  24h Change:         %s%s%.2f (%s%.2f%%)\n", 
-                   sign, currency_symbol, data->price_change_24h, 
-                   color, data->price_change_percentage_24h);
-        } else {
-            printf("  24h Change:         %s%.2f %s (%s%.2f%%)\n", 
-                   sign, data->price_change_24h, 
-                   data->currency ? data->currency : "USD",
-                   color, data->price_change_percentage_24h);
-        }
-    }
-    
-    // Show High/Low 24h if available
-    if (data->high_24h > 0.0 && data->low_24h > 0.0) {
-        if (strcmp(currency_symbol, "$") == 0 || strcmp(currency_symbol, "€") == 0 || 
-            strcmp(currency_symbol, "£") == 0) {
-            printf("  24h High:           %s%.2f\n", currency_symbol, data->high_24h);
-            printf("  24h Low:            %s%.2f\n", currency_symbol, data->low_24h);
-        } else {
-            printf("  24h High:           %.2f %s\n", data->high_24h, 
-                   data->currency ? data->currency : "USD");
-            printf("  24h Low:            %.2f %s\n", data->low_24h, 
-                   data->currency ? data->currency : "USD");
-        }
-    }
-    
-    if (data->market_cap > 0) {
-        const char *mcap_symbol = get_currency_symbol(data->currency);
-        if (strcmp(mcap_symbol, "$") == 0 || strcmp(mcap_symbol, "€") == 0 || 
-            strcmp(mcap_symbol, "£") == 0) {
-            if (data->market_cap >= 1e12) {
-                printf("  Market Cap:         %s%.2fT\n", mcap_symbol, data->market_cap / 1e12);
-            } else if (data->market_cap >= 1e9) {
-                printf("  Market Cap:         %s%.2fB\n", mcap_symbol, data->market_cap / 1e9);
-            } else if (data->market_cap >= 1e6) {
-                printf("  Market Cap:         %s%.2fM\n", mcap_symbol, data->market_cap / 1e6);
-            } else {
-                printf("  Market Cap:         %s%.2f\n", mcap_symbol, data->market_cap);
-            }
-        } else {
-            if (data->market_cap >= 1e12) {
-                printf("  Market Cap:         %.2fT %s\n", data->market_cap / 1e12, 
-                       data->currency ? data->currency : "USD");
-            } else if (data->market_cap >= 1e9) {
-                printf("  Market Cap:         %.2fB %s\n", data->market_cap / 1e9, 
-                       data->currency ? data->currency : "USD");
-            } else if (data->market_cap >= 1e6) {
-                printf("  Market Cap:         %.2fM %s\n", data->market_cap / 1e6, 
-                       data->currency ? data->currency : "USD");
-            } else {
-                printf("  Market Cap:         %.2f %s\n", data->market_cap, 
-                       data->currency ? data->currency : "USD");
-            }
-        }
-    }
-    
-    if (data->volume_24h > 0) {
-        const char *vol_symbol = get_currency_symbol(data->currency);
-        if (strcmp(vol_symbol, "$") == 0 || strcmp(vol_symbol, "€") == 0 || 
-            strcmp(vol_symbol, "£") == 0) {
-            if (data->volume_24h >= 1e9) {
-                printf("  24h Volume:         %s%.2fB\n", vol_symbol, data->volume_24h / 1e9);
-            } else if (data->volume_24h >= 1e6) {
-                printf("  24h Volume:         %s%.2fM\n", vol_symbol, data->volume_24h / 1e6);
-            } else {
-                printf("  24h Volume:         %s%.2f\n", vol_symbol, data->volume_24h);
-            }
-        } else {
-            if (data->volume_24h >= 1e9) {
-                printf("  24h Volume:         %.2fB %s\n", data->volume_24h / 1e9, 
-                       data->currency ? data->currency : "USD");
-            } else if (data->volume_24h >= 1e6) {
-                printf("  24h Volume:         %.2fM %s\n", data->volume_24h / 1e6, 
-                       data->currency ? data->currency : "USD");
-            } else {
-                printf("  24h Volume:         %.2f %s\n", data->volume_24h, 
-                       data->currency ? data->currency : "USD");
-            }
-        }
-    }
-    
-    // Market Cap to Volume ratio (indicator of activity)
-    if (data->market_cap > 0 && data->volume_24h > 0) {
-        double mcv_ratio = data->market_cap / data->volume_24h;
-        printf("  Market Cap / Volume: %.2f\n", mcv_ratio);
-    }
-    
-    // Last updated timestamp
-    if (data->last_updated_at > 0) {
-        time_t timestamp = (time_t)data->last_updated_at;
-        struct tm *timeinfo = localtime(&timestamp);
-        char time_str[64];
-        strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", timeinfo);
-        printf("  Last Updated:        %s\n", time_str);
-    }
-    
-    printf("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n\n");
-}
-
-void display_price_only(const crypto_data_t *data) {
-    if (!data || !data->success) {
-        display_error("Failed to retrieve cryptocurrency data");
-        return;
-    }
-    
-    const char *currency_symbol = get_currency_symbol(data->currency);
-    
-    if (strcmp(currency_symbol, "$") == 0 || strcmp(currency_symbol, "€") == 0 || 
-        strcmp(currency_symbol, "£") == 0) {
-        printf("%s%.2f\n", currency_symbol, data->current_price);
-    } else if (strcmp(currency_symbol, "¥") == 0 || strcmp(currency_symbol, "₩") == 0) {
-        printf("%s%.0f\n", currency_symbol, data->current_price);
-    } else {
-        printf("%.2f %s\n", data->current_price, data->currency ? data->currency : "USD");
-    }
-}
-
-void display_error(const char *message) {
-    fprintf(stderr, "Error: %s\n", message);
-}
-
-void display_top_coins(const markets_data_t *markets) {
-    if (!markets || !markets->success || markets->count == 0) {
-        display_error("Failed to retrieve top cryptocurrencies data");
-        return;
-    }
-    
-    printf("\n━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
-    printf("  Top %d Cryptocurrencies by Market Cap\n", markets->count);
-    printf("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
-    printf("  %-4s %-8s %-20s %-12s %-15s %-15s %-10s\n", 
-           "Rank", "Symbol", "Name", "Price", "Market Cap", "24h Volume", "24h Change");
-    printf("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
-    
-    for (int i = 0; i < markets->count; i++) {
-        const crypto_data_t *coin = &markets->coins[i];
-        if (!coin->success) {
-            continue;
-        }
-        
-        int rank = i + 1;
-        const char *symbol = coin->symbol ? coin->symbol : "N/A";
-        const char *name = coin->name ? coin->name : "N/A";
-        
-        // Format price
-        char price_str[32];
-        if (coin->current_price >= 1000) {
-            snprintf(price_str, sizeof(price_str), "$%.2f", coin->current_price);
-        } else if (coin->current_price >= 1) {
-            snprintf(price_str, sizeof(price_str), "$%.2f", coin->current_price);
-        } else if (coin->current_price >= 0.01) {
-            snprintf(price_str, sizeof(price_str), "$%.4f", coin->current_price);
-        } else {
-            snprintf(price_str, sizeof(price_str), "$%.6f", coin->current_price);
-        }
-        
-        // Format market cap
-        char mcap_str[32];
-        if (coin->market_cap >= 1e12) {
-            snprintf(mcap_str, sizeof(mcap_str), "$%.2fT", coin->market_cap / 1e12);
-        } else if (coin->market_cap >= 1e9) {
-            snprintf(mcap_str, sizeof(mcap_str), "$%.2fB", coin->market_cap / 1e9);
-        } else if (coin->market_cap >= 1e6) {
-            snprintf(mcap_str, sizeof(mcap_str), "$%.2fM", coin->market_cap / 1e6);
-        } else {
-            snprintf(mcap_str, sizeof(mcap_str), "$%.2f", coin->market_cap);
-        }
-        
-        // Format volume
-        char volume_str[32];
-        if (coin->volume_24h >= 1e9) {
-            snprintf(volume_str, sizeof(volume_str), "$%.2fB", coin->volume_24h / 1e9);
-        } else if (coin->volume_24h >= 1e6) {
-            snprintf(volume_str, sizeof(volume_str), "$%.2fM", coin->volume_24h / 1e6);
-        } else {
-            snprintf(volume_str, sizeof(volume_str), "$%.2f", coin->volume_24h);
-        }
-        
-        // Format change
-        char change_str[32];
-        const char *change_sign = coin->price_change_percentage_24h >= 0 ? "+" : "";
-        const char *change_arrow = coin->price_change_percentage_24h >= 0 ? "↑" : "↓";
-        snprintf(change_str, sizeof(change_str), "%s%s%.2f%%", 
-                 change_arrow, change_sign, coin->price_change_percentage_24h);
-        
-        // Truncate name if too long
-        char name_display[21];
-        size_t name_len = strlen(name);
-        if (name_len > 19) {
-            strncpy(name_display, name, 16);
-            name_display[16] = '\0';
-            strcat(name_display, "...");
-        } else {
-            strncpy(name_display, name, 20);
-            name_display[name_len] = '\0';
-        }
-        
-        printf("  %-4d %-8s %-20s %-12s %-15s %-15s %-10s\n", 
-               rank, symbol, name_display, price_str, mcap_str, volume_str, change_str);
-    }
-    
-    printf("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n\n");
-}
-
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>  // For strcasecmp
+#include <time.h>
+#include "../include/display.h"
+#include "../include/planner.h"
+
+// Get currency symbol for display
+static const char *get_currency_symbol(const char *currency) {
+    if (!currency) return "$";
+    
+    if (strcasecmp(currency, "eur") == 0) return "€";
+    if (strcasecmp(currency, "gbp") == 0) return "£";
+    if (strcasecmp(currency, "jpy") == 0) return "¥";
+    if (strcasecmp(currency, "cny") == 0) return "¥";
+    if (strcasecmp(currency, "krw") == 0) return "₩";
+    if (strcasecmp(currency, "inr") == 0) return "₹";
+    if (strcasecmp(currency, "btc") == 0) return "₿";
+    
+    // Default: return uppercase currency code or "$" for USD
+    if (strcasecmp(currency, "usd") == 0) return "$";
+    
+    // For other currencies, return currency code uppercase
+    return currency; // Will be formatted in display functions
+}
+
+void display_full_info(const crypto_data_t *data) {
+    display_selected_info(data, PLAN_ALL);
+}
+
+void display_selected_info(const crypto_data_t *data, unsigned fields) {
+    if (!data || !data->success) {
+        display_error("Failed to retrieve cryptocurrency data");
+        return;
+    }
+    
+    const char *currency_symbol = get_currency_symbol(data->currency);
+    
+    printf("\n━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
+    if (fields & PLAN_NAME) {
+        printf("  %s (%s)\n", data->name ? data->name : "N/A", 
+               data->symbol ? data->symbol : "N/A");
+    } else {
+        printf("  %s\n", data->id ? data->id : "N/A");
+    }
+    printf("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
+    
+    // Format price with currency symbol
+    if (fields & PLAN_PRICE) {
+        if (strcmp(currency_symbol, "$") == 0 || strcmp(currency_symbol, "€") == 0 || 
+            strcmp(currency_symbol, "£") == 0) {
+            printf("  Current Price:      %s%.2f\n", currency_symbol, data->current_price);
+        } else if (strcmp(currency_symbol, "¥") == 0 || strcmp(currency_symbol, "₩") == 0) {
+            printf("  Current Price:      %s%.0f\n", currency_symbol, data->current_price);
+        } else {
+            // For other currencies, show code before price
+            printf("  Current Price:      %.2f %s\n", data->current_price, 
+                   data->currency ? data->currency : "USD");
+        }
+    }
+    
+    if (fields & PLAN_CHANGE_24H && data->price_change_24h != 0.0) {
+        const char *sign = data->price_change_24h >= 0 ? "+" : "";
+        const char *color = data->price_change_24h >= 0 ? "↑" : "↓";
+        
+        // Format change with currency symbol
+        if (strcmp(currency_symbol, "$") == 0 || strcmp(currency_symbol, "€") == 0 || 
+            strcmp(currency_symbol, "£") == 0) {
+            printf("  24h Change:         %s%s%.2f (%s%.2f%%)\n", 
+                   sign, currency_symbol, data->price_change_24h, 
+                   color, data->price_change_percentage_24h);
+        } else {
+            printf("  24h Change:         %s%.2f %s (%s%.2f%%)\n", 
+                   sign, data->price_change_24h, 
+                   data->currency ? data->currency : "USD",
+                   color, data->price_change_percentage_24h);
+        }
+    }
+    
+    // Show High/Low 24h if available
+    if (fields & PLAN_HIGH_LOW_24H && data->high_24h > 0.0 && data->low_24h > 0.0) {
+        if (strcmp(currency_symbol, "$") == 0 || strcmp(currency_symbol, "€") == 0 || 
+            strcmp(currency_symbol, "£") == 0) {
+            printf("  24h High:           %s%.2f\n", currency_symbol, data->high_24h);
+            printf("  24h Low:            %s%.2f\n", currency_symbol, data->low_24h);
+        } else {
+            printf("  24h High:           %.2f %s\n", data->high_24h, 
+                   data->currency ? data->currency : "USD");
+            printf("  24h Low:            %.2f %s\n", data->low_24h, 
+                   data->currency ? data->currency : "USD");
+        }
+    }
+    
+    if (fields & PLAN_MARKET_CAP && data->market_cap > 0) {
+        const char *mcap_symbol = get_currency_symbol(data->currency);
+        if (strcmp(mcap_symbol, "$") == 0 || strcmp(mcap_symbol, "€") == 0 || 
+            strcmp(mcap_symbol, "£") == 0) {
+            if (data->market_cap >= 1e12) {
+                printf("  Market Cap:         %s%.2fT\n", mcap_symbol, data->market_cap / 1e12);
+            } else if (data->market_cap >= 1e9) {
+                printf("  Market Cap:         %s%.2fB\n", mcap_symbol, data->market_cap / 1e9);
+            } else if (data->market_cap >= 1e6) {
+                printf("  Market Cap:         %s%.2fM\n", mcap_symbol, data->market_cap / 1e6);
+            } else {
+                printf("  Market Cap:         %s%.2f\n", mcap_symbol, data->market_cap);
+            }
+        } else {
+            if (data->market_cap >= 1e12) {
+                printf("  Market Cap:         %.2fT %s\n", data->market_cap / 1e12, 
+                       data->currency ? data->currency : "USD");
+            } else if (data->market_cap >= 1e9) {
+                printf("  Market Cap:         %.2fB %s\n", data->market_cap / 1e9, 
+                       data->currency ? data->currency : "USD");
+            } else if (data->market_cap >= 1e6) {
+                printf("  Market Cap:         %.2fM %s\n", data->market_cap / 1e6, 
+                       data->currency ? data->currency : "USD");
+            } else {
+                printf("  Market Cap:         %.2f %s\n", data->market_cap, 
+                       data->currency ? data->currency : "USD");
+            }
+        }
+    }
+    
+    if (fields & PLAN_VOLUME_24H && data->volume_24h > 0) {
+        const char *vol_symbol = get_currency_symbol(data->currency);
+        if (strcmp(vol_symbol, "$") == 0 || strcmp(vol_symbol, "€") == 0 || 
+            strcmp(vol_symbol, "£") == 0) {
+            if (data->volume_24h >= 1e9) {
+                printf("  24h Volume:         %s%.2fB\n", vol_symbol, data->volume_24h / 1e9);
+            } else if (data->volume_24h >= 1e6) {
+                printf("  24h Volume:         %s%.2fM\n", vol_symbol, data->volume_24h / 1e6);
+            } else {
+                printf("  24h Volume:         %s%.2f\n", vol_symbol, data->volume_24h);
+            }
+        } else {
+            if (data->volume_24h >= 1e9) {
+                printf("  24h Volume:         %.2fB %s\n", data->volume_24h / 1e9, 
+                       data->currency ? data->currency : "USD");
+            } else if (data->volume_24h >= 1e6) {
+                printf("  24h Volume:         %.2fM %s\n", data->volume_24h / 1e6, 
+                       data->currency ? data->currency : "USD");
+            } else {
+                printf("  24h Volume:         %.2f %s\n", data->volume_24h, 
+                       data->currency ? data->currency : "USD");
+            }
+        }
+    }
+    
+    // Market Cap to Volume ratio (indicator of activity)
+    if ((fields & (PLAN_MARKET_CAP | PLAN_VOLUME_24H)) == (PLAN_MARKET_CAP | PLAN_VOLUME_24H) &&
+        data->market_cap > 0 && data->volume_24h > 0) {
+        double mcv_ratio = data->market_cap / data->volume_24h;
+        printf("  Market Cap / Volume: %.2f\n", mcv_ratio);
+    }
+    
+    // Last updated timestamp
+    if (fields & PLAN_LAST_UPDATED && data->last_updated_at > 0) {
+        time_t timestamp = (time_t)data->last_updated_at;
+        struct tm *timeinfo = localtime(&timestamp);
+        char time_str[64];
+        strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", timeinfo);
+        printf("  Last Updated:        %s\n", time_str);
+    }
+    
+    printf("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n\n");
+}
+
+void display_price_only(const crypto_data_t *data) {
+    if (!data || !data->success) {
+        display_error("Failed to retrieve cryptocurrency data");
+        return;
+    }
+    
+    const char *currency_symbol = get_currency_symbol(data->currency);
+    
+    if (strcmp(currency_symbol, "$") == 0 || strcmp(currency_symbol, "€") == 0 || 
+        strcmp(currency_symbol, "£") == 0) {
+        printf("%s%.2f\n", currency_symbol, data->current_price);
+    } else if (strcmp(currency_symbol, "¥") == 0 || strcmp(currency_symbol, "₩") == 0) {
+        printf("%s%.0f\n", currency_symbol, data->current_price);
+    } else {
+        printf("%.2f %s\n", data->current_price, data->currency ? data->currency : "USD");
+    }
+}
+
+void display_error(const char *message) {
+    fprintf(stderr, "Error: %s\n", message);
+}
+
+void display_stale_notice(long age_seconds) {
+    char age[32];
+    if (age_seconds < 120) {
+        snprintf(age, sizeof(age), "%lds", age_seconds);
+    } else if (age_seconds < 7200) {
+        snprintf(age, sizeof(age), "%ldm", age_seconds / 60);
+    } else {
+        snprintf(age, sizeof(age), "%ldh", age_seconds / 3600);
+    }
+    fprintf(stderr, "Stale: data is %s old, refreshing in background\n", age);
+}
+
+void format_table_price(double price, char *out, size_t size) {
+    if (price >= 1) {
+        snprintf(out, size, "$%.2f", price);
+    } else if (price >= 0.01) {
+        snprintf(out, size, "$%.4f", price);
+    } else {
+        snprintf(out, size, "$%.6f", price);
+    }
+}
+
+void format_table_amount(double amount, char *out, size_t size) {
+    if (amount >= 1e12) {
+        snprintf(out, size, "$%.2fT", amount / 1e12);
+    } else if (amount >= 1e9) {
+        snprintf(out, size, "$%.2fB", amount / 1e9);
+    } else if (amount >= 1e6) {
+        snprintf(out, size, "$%.2fM", amount / 1e6);
+    } else {
+        snprintf(out, size, "$%.2f", amount);
+    }
+}
+
+void format_table_change(double change_percentage, char *out, size_t size) {
+    const char *change_sign = change_percentage >= 0 ? "+" : "";
+    const char *change_arrow = change_percentage >= 0 ? "↑" : "↓";
+    snprintf(out, size, "%s%s%.2f%%", change_arrow, change_sign, change_percentage);
+}
+
+// Columns of the top table when no --fields were given
+#define TOP_TABLE_DEFAULT (PLAN_NAME | PLAN_PRICE | PLAN_MARKET_CAP | PLAN_VOLUME_24H | PLAN_CHANGE_24H)
+
+/**
+ * @brief One row of the top table, from parsed data or a snapshot
+ */
+typedef struct {
+    const char *id;
+    const char *symbol;
+    const char *name;
+    double price;
+    double high;
+    double low;
+    double market_cap;
+    double volume;
+    double change_percentage;
+    int64_t last_updated_at;
+} top_row_t;
+
+static unsigned top_table_fields(unsigned fields) {
+    return fields ? fields : TOP_TABLE_DEFAULT;
+}
+
+static void print_rule(int width, const char *end) {
+    for (int i = 0; i < width; i++) {
+        printf("━");
+    }
+    printf("%s", end);
+}
+
+// Length of the rules: the printed width of the selected columns plus 11
+static int top_table_width(unsigned fields) {
+    int width = 2 + 5;
+    width += fields & PLAN_NAME ? 9 + 21 : 21;
+    width += fields & PLAN_PRICE ? 13 : 0;
+    width += fields & PLAN_HIGH_LOW_24H ? 2 * 13 : 0;
+    width += fields & PLAN_MARKET_CAP ? 16 : 0;
+    width += fields & PLAN_VOLUME_24H ? 16 : 0;
+    width += fields & PLAN_CHANGE_24H ? 11 : 0;
+    width += fields & PLAN_LAST_UPDATED ? 17 : 0;
+    return width + 11;
+}
+
+static void print_top_header(int count, unsigned fields) {
+    int width = top_table_width(fields);
+    printf("\n");
+    print_rule(width, "\n");
+    printf("  Top %d Cryptocurrencies by Market Cap\n", count);
+    print_rule(width, "\n");
+    printf("  %-4s", "Rank");
+    if (fields & PLAN_NAME) {
+        printf(" %-8s %-20s", "Symbol", "Name");
+    } else {
+        printf(" %-20s", "Id");
+    }
+    if (fields & PLAN_PRICE) {
+        printf(" %-12s", "Price");
+    }
+    if (fields & PLAN_HIGH_LOW_24H) {
+        printf(" %-12s %-12s", "24h High", "24h Low");
+    }
+    if (fields & PLAN_MARKET_CAP) {
+        printf(" %-15s", "Market Cap");
+    }
+    if (fields & PLAN_VOLUME_24H) {
+        printf(" %-15s", "24h Volume");
+    }
+    if (fields & PLAN_CHANGE_24H) {
+        printf(" %-10s", "24h Change");
+    }
+    if (fields & PLAN_LAST_UPDATED) {
+        printf(" %-16s", "Updated (UTC)");
+    }
+    printf("\n");
+    print_rule(width, "\n");
+}
+
+static void print_top_footer(unsigned fields) {
+    print_rule(top_table_width(fields), "\n\n");
+}
+
+// Truncate a name or id to the 20-character column
+static void fit_column(const char *text, char *out) {
+    size_t len = strlen(text);
+    if (len > 19) {
+        memcpy(out, text, 16);
+        memcpy(out + 16, "...", 4);
+    } else {
+        memcpy(out, text, len + 1);
+    }
+}
+
+static void print_top_row(int rank, const top_row_t *row, unsigned fields) {
+    char text[32];
+    char column[21];
+
+    printf("  %-4d", rank);
+    if (fields & PLAN_NAME) {
+        fit_column(row->name, column);
+        printf(" %-8s %-20s", row->symbol, column);
+    } else {
+        fit_column(row->id, column);
+        printf(" %-20s", column);
+    }
+    if (fields & PLAN_PRICE) {
+        format_table_price(row->price, text, sizeof(text));
+        printf(" %-12s", text);
+    }
+    if (fields & PLAN_HIGH_LOW_24H) {
+        format_table_price(row->high, text, sizeof(text));
+        printf(" %-12s", text);
+        format_table_price(row->low, text, sizeof(text));
+        printf(" %-12s", text);
+    }
+    if (fields & PLAN_MARKET_CAP) {
+        format_table_amount(row->market_cap, text, sizeof(text));
+        printf(" %-15s", text);
+    }
+    if (fields & PLAN_VOLUME_24H) {
+        format_table_amount(row->volume, text, sizeof(text));
+        printf(" %-15s", text);
+    }
+    if (fields & PLAN_CHANGE_24H) {
+        format_table_change(row->change_percentage, text, sizeof(text));
+        printf(" %-10s", text);
+    }
+    if (fields & PLAN_LAST_UPDATED) {
+        time_t updated = (time_t)row->last_updated_at;
+        struct tm *tm = row->last_updated_at > 0 ? gmtime(&updated) : NULL;
+        if (!tm || strftime(text, sizeof(text), "%Y-%m-%d %H:%M", tm) == 0) {
+            snprintf(text, sizeof(text), "-");
+        }
+        printf(" %-16s", text);
+    }
+    printf("\n");
+}
+
+void display_top_coins(const markets_data_t *markets, unsigned fields) {
+    if (!markets || !markets->success || markets->count == 0) {
+        display_error("Failed to retrieve top cryptocurrencies data");
+        return;
+    }
+    
+    fields = top_table_fields(fields);
+    print_top_header(markets->count, fields);
+    
+    for (int i = 0; i < markets->count; i++) {
+        const crypto_data_t *coin = &markets->coins[i];
+        if (!coin->success) {
+            continue;
+        }
+        
+        top_row_t row = {
+            coin->id ? coin->id : "N/A", coin->symbol ? coin->symbol : "N/A",
+            coin->name ? coin->name : "N/A", coin->current_price, coin->high_24h, coin->low_24h,
+            coin->market_cap, coin->volume_24h, coin->price_change_percentage_24h,
+            (int64_t)coin->last_updated_at
+        };
+        print_top_row(i + 1, &row, fields);
+    }
+    
+    print_top_footer(fields);
+}
+
+void display_top_snapshot(const markets_snapshot_t *snapshot, int limit, unsigned fields) {
+    if (!snapshot || snapshot->count == 0) {
+        display_error("Failed to retrieve top cryptocurrencies data");
+        return;
+    }
+    
+    fields = top_table_fields(fields);
+    uint32_t count = limit > 0 && (uint32_t)limit < snapshot->count ? (uint32_t)limit : snapshot->count;
+    print_top_header((int)count, fields);
+    
+    // Columns are read straight from the mapped file
+    for (uint32_t i = 0; i < count; i++) {
+        const char *id = snapshot_string(snapshot, i, SNAPSHOT_ID);
+        const char *symbol = snapshot_string(snapshot, i, SNAPSHOT_SYMBOL);
+        const char *name = snapshot_string(snapshot, i, SNAPSHOT_NAME);
+        top_row_t row = {
+            *id ? id : "N/A", *symbol ? symbol : "N/A", *name ? name : "N/A",
+            snapshot->price[i], snapshot->high_24h[i], snapshot->low_24h[i],
+            snapshot->market_cap[i], snapshot->volume_24h[i], snapshot->change_percentage_24h[i],
+            snapshot->last_updated_at[i]
+        };
+        print_top_row((int)i + 1, &row, fields);
+    }
+    
+    print_top_footer(fields);
+}
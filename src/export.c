@@ -0,0 +1,316 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/export.h"
+#include "../include/arrow.h"
+#include "../include/planner.h"
+
+#define EXPORT_TABLE_WIDTH 20
+
+static const arrow_field_t markets_fields[] = {
+    { "rank", ARROW_INT64 },
+    { "id", ARROW_UTF8 },
+    { "symbol", ARROW_UTF8 },
+    { "name", ARROW_UTF8 },
+    { "currency", ARROW_UTF8 },
+    { "price", ARROW_FLOAT64 },
+    { "change_24h", ARROW_FLOAT64 },
+    { "change_percentage_24h", ARROW_FLOAT64 },
+    { "market_cap", ARROW_FLOAT64 },
+    { "volume_24h", ARROW_FLOAT64 },
+    { "high_24h", ARROW_FLOAT64 },
+    { "low_24h", ARROW_FLOAT64 },
+    { "last_updated", ARROW_TIMESTAMP_S },
+};
+
+#define MARKETS_COLUMNS 13
+
+// PLAN_* bit each markets column belongs to; 0 = always written
+static const unsigned markets_needs[MARKETS_COLUMNS] = {
+    0, 0, PLAN_NAME, PLAN_NAME, 0, PLAN_PRICE, PLAN_CHANGE_24H, PLAN_CHANGE_24H,
+    PLAN_MARKET_CAP, PLAN_VOLUME_24H, PLAN_HIGH_LOW_24H, PLAN_HIGH_LOW_24H, PLAN_LAST_UPDATED,
+};
+
+static const arrow_field_t ohlc_fields[] = {
+    { "time", ARROW_TIMESTAMP_MS },
+    { "open", ARROW_FLOAT64 },
+    { "high", ARROW_FLOAT64 },
+    { "low", ARROW_FLOAT64 },
+    { "close", ARROW_FLOAT64 },
+};
+
+static const arrow_field_t chart_fields[] = {
+    { "time", ARROW_TIMESTAMP_MS },
+    { "price", ARROW_FLOAT64 },
+    { "market_cap", ARROW_FLOAT64 },
+    { "volume", ARROW_FLOAT64 },
+};
+
+#define FIELD_COUNT(fields) ((int)(sizeof(fields) / sizeof((fields)[0])))
+
+// Rows in record batches of EXPORT_BATCH_ROWS; each batch starts further into every column
+static int write_arrow(FILE *fp, output_format_t format, const arrow_field_t *fields, int count,
+                       const arrow_column_t *columns, int64_t rows) {
+    arrow_writer_t writer;
+    if (arrow_begin(&writer, fp, format == OUTPUT_FEATHER, fields, count) != 0) {
+        return -1;
+    }
+
+    arrow_column_t batch[16];
+    int rc = 0;
+    for (int64_t start = 0; start < rows && rc == 0; start += EXPORT_BATCH_ROWS) {
+        int64_t n = rows - start < EXPORT_BATCH_ROWS ? rows - start : EXPORT_BATCH_ROWS;
+        for (int c = 0; c < count; c++) {
+            batch[c] = columns[c];
+            batch[c].base = (const char *)columns[c].base + (size_t)start * columns[c].stride;
+        }
+        rc = arrow_write_batch(&writer, batch, n);
+    }
+
+    int ended = arrow_end(&writer);
+    return rc == 0 && ended == 0 ? 0 : -1;
+}
+
+// Names of a schema, for the row writer
+static void field_names(const arrow_field_t *fields, int count, const char **names) {
+    for (int c = 0; c < count; c++) {
+        names[c] = fields[c].name;
+    }
+}
+
+// ISO 8601 UTC, with milliseconds only when there are any
+static void output_time_ms(output_t *out, int64_t time_ms) {
+    time_t seconds = (time_t)(time_ms / 1000);
+    int ms = (int)(time_ms % 1000);
+    struct tm tm;
+    char text[40];
+    if (!gmtime_r(&seconds, &tm)) {
+        output_string(out, "");
+        return;
+    }
+    size_t len = strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &tm);
+    if (ms != 0) {
+        snprintf(text + len, sizeof(text) - len, ".%03dZ", ms < 0 ? -ms : ms);
+    } else {
+        snprintf(text + len, sizeof(text) - len, "Z");
+    }
+    output_string(out, text);
+}
+
+// Markets columns kept for a PLAN_* mask (0 = all), rank only if ranked;
+// returns how many, their indexes in selected
+static int select_market_columns(unsigned fields, int ranked, int *selected) {
+    if (fields == 0) {
+        fields = PLAN_ALL;
+    }
+    int count = 0;
+    for (int c = ranked ? 0 : 1; c < MARKETS_COLUMNS; c++) {
+        if (markets_needs[c] == 0 || fields & markets_needs[c]) {
+            selected[count++] = c;
+        }
+    }
+    return count;
+}
+
+// Arrow over the selected subset of a full set of markets columns
+static int write_market_columns(FILE *fp, output_format_t format, const arrow_column_t *columns,
+                                const int *selected, int count, int64_t rows) {
+    arrow_field_t fields[MARKETS_COLUMNS];
+    arrow_column_t picked[MARKETS_COLUMNS];
+    for (int c = 0; c < count; c++) {
+        fields[c] = markets_fields[selected[c]];
+        picked[c] = columns[selected[c]];
+    }
+    return write_arrow(fp, format, fields, count, picked, rows);
+}
+
+// names: MARKETS_COLUMNS slots, kept by the writer until output_end()
+static void begin_market_rows(output_t *out, FILE *fp, output_format_t format, const int *selected,
+                              int count, const char **names) {
+    for (int c = 0; c < count; c++) {
+        names[c] = markets_fields[selected[c]].name;
+    }
+    output_begin(out, fp, format, names, count, EXPORT_TABLE_WIDTH);
+}
+
+// strings: id, symbol, name, currency; values: price through low_24h
+static void output_market_row(output_t *out, const int *selected, int count, long rank,
+                              const char *const *strings, const double *values, long last_updated) {
+    output_row_begin(out);
+    for (int s = 0; s < count; s++) {
+        int c = selected[s];
+        if (c == 0) {
+            output_number(out, (double)rank);
+        } else if (c <= 4) {
+            output_string(out, strings[c - 1]);
+        } else if (c < MARKETS_COLUMNS - 1) {
+            output_number(out, values[c - 5]);
+        } else if (last_updated > 0) {
+            output_time_ms(out, (int64_t)last_updated * 1000);
+        } else {
+            output_string(out, "");
+        }
+    }
+    output_row_end(out);
+}
+
+static int export_coins(FILE *fp, output_format_t format, const crypto_data_t *coins, int count,
+                        unsigned fields, int ranked) {
+    int selected[MARKETS_COLUMNS];
+    int selected_count = select_market_columns(fields, ranked, selected);
+
+    if (OUTPUT_IS_BINARY(format)) {
+        int32_t *ranks = malloc((size_t)(count > 0 ? count : 1) * sizeof(int32_t));
+        if (!ranks) {
+            return -1;
+        }
+        for (int i = 0; i < count; i++) {
+            ranks[i] = i + 1;
+        }
+
+        arrow_column_t columns[] = {
+            ARROW_ARRAY(ranks),
+            ARROW_MEMBER(coins, id),
+            ARROW_MEMBER(coins, symbol),
+            ARROW_MEMBER(coins, name),
+            ARROW_MEMBER(coins, currency),
+            ARROW_MEMBER(coins, current_price),
+            ARROW_MEMBER(coins, price_change_24h),
+            ARROW_MEMBER(coins, price_change_percentage_24h),
+            ARROW_MEMBER(coins, market_cap),
+            ARROW_MEMBER(coins, volume_24h),
+            ARROW_MEMBER(coins, high_24h),
+            ARROW_MEMBER(coins, low_24h),
+            ARROW_MEMBER(coins, last_updated_at),
+        };
+        int rc = write_market_columns(fp, format, columns, selected, selected_count, count);
+        free(ranks);
+        return rc;
+    }
+
+    const char *names[MARKETS_COLUMNS];
+    output_t out;
+    begin_market_rows(&out, fp, format, selected, selected_count, names);
+    for (int i = 0; i < count; i++) {
+        const crypto_data_t *c = &coins[i];
+        const char *strings[4] = { c->id, c->symbol, c->name, c->currency };
+        double values[7] = { c->current_price, c->price_change_24h, c->price_change_percentage_24h,
+                             c->market_cap, c->volume_24h, c->high_24h, c->low_24h };
+        output_market_row(&out, selected, selected_count, i + 1, strings, values,
+                          c->last_updated_at);
+    }
+    return output_end(&out);
+}
+
+int export_markets(FILE *fp, output_format_t format, const markets_data_t *markets,
+                   unsigned fields) {
+    return export_coins(fp, format, markets->coins, markets->count, fields, 1);
+}
+
+int export_quote(FILE *fp, output_format_t format, const crypto_data_t *data, unsigned fields) {
+    return export_coins(fp, format, data, 1, fields, 0);
+}
+
+int export_markets_snapshot(FILE *fp, output_format_t format, const markets_snapshot_t *snapshot,
+                            int limit, unsigned fields) {
+    uint32_t count = limit > 0 && (uint32_t)limit < snapshot->count ? (uint32_t)limit : snapshot->count;
+    int selected[MARKETS_COLUMNS];
+    int selected_count = select_market_columns(fields, 1, selected);
+
+    if (OUTPUT_IS_BINARY(format)) {
+        // Numeric columns go out straight from the mapping; strings need pointers
+        size_t rows = count > 0 ? count : 1;
+        const char **strings = malloc(rows * 3 * sizeof(const char *));
+        int32_t *ranks = malloc(rows * sizeof(int32_t));
+        if (!strings || !ranks) {
+            free(strings);
+            free(ranks);
+            return -1;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            ranks[i] = (int32_t)i + 1;
+            for (int f = 0; f < 3; f++) {
+                strings[(size_t)f * rows + i] = snapshot_string(snapshot, i, f);
+            }
+        }
+
+        const char *currency = snapshot->currency;
+        arrow_column_t columns[] = {
+            ARROW_ARRAY(ranks),
+            ARROW_ARRAY(strings + SNAPSHOT_ID * rows),
+            ARROW_ARRAY(strings + SNAPSHOT_SYMBOL * rows),
+            ARROW_ARRAY(strings + SNAPSHOT_NAME * rows),
+            { &currency, 0, sizeof(currency) },   // Same value on every row
+            ARROW_ARRAY(snapshot->price),
+            ARROW_ARRAY(snapshot->change_24h),
+            ARROW_ARRAY(snapshot->change_percentage_24h),
+            ARROW_ARRAY(snapshot->market_cap),
+            ARROW_ARRAY(snapshot->volume_24h),
+            ARROW_ARRAY(snapshot->high_24h),
+            ARROW_ARRAY(snapshot->low_24h),
+            ARROW_ARRAY(snapshot->last_updated_at),
+        };
+        int rc = write_market_columns(fp, format, columns, selected, selected_count, count);
+        free(strings);
+        free(ranks);
+        return rc;
+    }
+
+    const char *names[MARKETS_COLUMNS];
+    output_t out;
+    begin_market_rows(&out, fp, format, selected, selected_count, names);
+    for (uint32_t i = 0; i < count; i++) {
+        const char *strings[4] = { snapshot_string(snapshot, i, SNAPSHOT_ID),
+                                   snapshot_string(snapshot, i, SNAPSHOT_SYMBOL),
+                                   snapshot_string(snapshot, i, SNAPSHOT_NAME), snapshot->currency };
+        double values[7] = { snapshot->price[i], snapshot->change_24h[i],
+                             snapshot->change_percentage_24h[i], snapshot->market_cap[i],
+                             snapshot->volume_24h[i], snapshot->high_24h[i], snapshot->low_24h[i] };
+        output_market_row(&out, selected, selected_count, (long)i + 1, strings, values,
+                          (long)snapshot->last_updated_at[i]);
+    }
+    return output_end(&out);
+}
+
+// time column plus value_count double columns, as Arrow or rows
+static int export_series(FILE *fp, output_format_t format, const arrow_field_t *fields,
+                         int field_count, const int64_t *time_ms, const double *const *values,
+                         int rows) {
+    if (OUTPUT_IS_BINARY(format)) {
+        arrow_column_t columns[8];
+        columns[0] = ARROW_ARRAY(time_ms);
+        for (int c = 1; c < field_count; c++) {
+            columns[c] = ARROW_ARRAY(values[c - 1]);
+        }
+        return write_arrow(fp, format, fields, field_count, columns, rows);
+    }
+
+    const char *names[8];
+    field_names(fields, field_count, names);
+    output_t out;
+    output_begin(&out, fp, format, names, field_count, EXPORT_TABLE_WIDTH);
+    for (int r = 0; r < rows; r++) {
+        output_row_begin(&out);
+        output_time_ms(&out, time_ms[r]);
+        for (int c = 1; c < field_count; c++) {
+            output_number(&out, values[c - 1][r]);
+        }
+        output_row_end(&out);
+    }
+    return output_end(&out);
+}
+
+int export_ohlc(FILE *fp, output_format_t format, const ohlc_series_t *series) {
+    const double *values[] = { series->open, series->high, series->low, series->close };
+    return export_series(fp, format, ohlc_fields, FIELD_COUNT(ohlc_fields), series->time_ms, values,
+                         series->count);
+}
+
+int export_chart(FILE *fp, output_format_t format, const chart_series_t *series) {
+    const double *values[] = { series->price, series->market_cap, series->volume };
+    return export_series(fp, format, chart_fields, FIELD_COUNT(chart_fields), series->time_ms, values,
+                         series->count);
+}
@@ -0,0 +1,194 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include "../include/feed.h"
+#include "../include/quotefeed.h"
+#include "../include/planner.h"
+#include "../include/api.h"
+#include "../include/parser.h"
+#include "../include/display.h"
+#include "../include/coinids.h"
+#include "../include/options.h"
+
+#define FEED_DEFAULT_COINS "bitcoin,ethereum"
+#define FEED_DEFAULT_INTERVAL 10
+#define FEED_CHUNK 100   // Ids per markets request (the API's default page size)
+
+/**
+ * @brief Last published values of one coin
+ */
+typedef struct {
+    const char *id;      // Interned, like the ids of parsed quotes
+    double price;
+    long last_updated_at;
+    int have;
+} feed_coin_t;
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_terminate(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+// Fetch every coin in chunks and publish the quotes that changed
+static int refresh(quote_feed_t *feed, feed_coin_t *coins, int count, const char *currency,
+                   const plan_endpoint_t *endpoint) {
+    int ok = 1;
+
+    for (int start = 0; start < count; start += FEED_CHUNK) {
+        int end = start + FEED_CHUNK < count ? start + FEED_CHUNK : count;
+
+        char *csv = join_ids(&coins[start].id, sizeof(coins[0]), end - start);
+        if (!csv) {
+            ok = 0;
+            continue;
+        }
+
+        char *url = endpoint->url(csv, currency, PLAN_ALL);
+        free(csv);
+        char *json = NULL;
+        int rc = url ? api_fetch_url(NULL, url, &json, NULL) : -1;
+        free(url);
+
+        markets_data_t quotes = {0};
+        if (rc == 0) {
+            quotes = endpoint->parse(json, currency, PLAN_ALL);
+        }
+        free(json);
+        if (!quotes.success) {
+            ok = 0;
+            free_markets_data(&quotes);
+            continue;
+        }
+
+        for (int q = 0; q < quotes.count; q++) {
+            const crypto_data_t *quote = &quotes.coins[q];
+            int found = coin_ids_find(&coins[start].id, sizeof(coins[0]), end - start, quote->id);
+            if (found < 0) {
+                continue;
+            }
+            int i = start + found;
+            feed_coin_t *coin = &coins[i];
+            // Unchanged quotes would only wake readers for nothing
+            if (!coin->have || coin->price != quote->current_price ||
+                coin->last_updated_at != quote->last_updated_at) {
+                quote_feed_publish(feed, i, quote);
+                coin->price = quote->current_price;
+                coin->last_updated_at = quote->last_updated_at;
+                coin->have = 1;
+            }
+        }
+        free_markets_data(&quotes);
+    }
+
+    quote_feed_heartbeat(feed);
+    return ok ? 0 : -1;
+}
+
+static void print_feed_usage(void) {
+    printf("Usage: crypto feed --shm NAME [--coins ID,ID,...] [--currency CODE] [--interval SECONDS]\n");
+    printf("  --shm       Shared-memory object to publish into (e.g. /crypto-quotes)\n");
+    printf("  --coins     Coins to publish (default: %s)\n", FEED_DEFAULT_COINS);
+    printf("  --currency  Quote currency (default: usd)\n");
+    printf("  --interval  Seconds between refreshes (default: %d)\n", FEED_DEFAULT_INTERVAL);
+}
+
+int feed_command(int argc, char *argv[]) {
+    // Quotes find their slot by interned id pointer (coin_ids_find())
+    parser_set_interning(1);
+
+    const char *shm_name = NULL;
+    const char *coin_list = FEED_DEFAULT_COINS;
+    char currency[8] = "usd";
+    int interval = FEED_DEFAULT_INTERVAL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--shm") == 0 && i + 1 < argc) {
+            shm_name = argv[++i];
+        } else if (strcmp(argv[i], "--coins") == 0 && i + 1 < argc) {
+            coin_list = argv[++i];
+        } else if (strcmp(argv[i], "--currency") == 0 && i + 1 < argc) {
+            if (options_parse_currency(argv[++i], currency, sizeof(currency)) != 0) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            interval = atoi(argv[++i]);
+            if (interval <= 0) {
+                display_error("Interval must be a positive number of seconds");
+                return 1;
+            }
+        } else {
+            print_feed_usage();
+            return 1;
+        }
+    }
+    if (!shm_name || shm_name[0] != '/' || strchr(shm_name + 1, '/')) {
+        display_error("--shm expects a name such as /crypto-quotes");
+        return 1;
+    }
+
+    const char **ids = NULL;
+    int count = coin_ids_resolve(coin_list, &ids);
+    feed_coin_t *coins = count > 0 ? calloc((size_t)count, sizeof(feed_coin_t)) : NULL;
+    if (!coins) {
+        display_error(count == 0 ? "No coins to publish" : "Memory allocation failed");
+        free(ids);
+        return 1;
+    }
+    for (int i = 0; i < count; i++) {
+        coins[i].id = ids[i];
+    }
+
+    // Records carry names and 24h high/low, so every field is planned in
+    query_plan_t plan;
+    if (planner_plan(PLAN_ALL, &plan) != 0 || plan.count != 1) {
+        display_error("No endpoint provides full quotes");
+        free(ids);
+        free(coins);
+        return 1;
+    }
+
+    quote_feed_t feed;
+    int created = quote_feed_create(shm_name, ids, count, interval, &feed);
+    free(ids);
+    if (created != 0) {
+        char message[320];
+        if (errno == EEXIST) {
+            snprintf(message, sizeof(message), "Another feed is still publishing to %s", shm_name);
+        } else {
+            snprintf(message, sizeof(message), "Cannot create shared memory %s: %s", shm_name, strerror(errno));
+        }
+        display_error(message);
+        free(coins);
+        return 1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_terminate;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    fprintf(stderr, "Publishing %d coin(s) to %s (refresh every %ds)\n", count, shm_name, interval);
+
+    while (!stop_requested) {
+        if (refresh(&feed, coins, count, currency, plan.endpoints[0]) != 0) {
+            fprintf(stderr, "Warning: refresh failed, readers keep the last quotes\n");
+        }
+
+        // Interrupted early by SIGINT/SIGTERM
+        struct timespec pause = { interval, 0 };
+        while (!stop_requested && nanosleep(&pause, &pause) != 0 && errno == EINTR) {
+        }
+    }
+
+    quote_feed_close(&feed);
+    free(coins);
+    return 0;
+}
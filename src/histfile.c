@@ -0,0 +1,142 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../include/histfile.h"
+
+#define HISTFILE_MAGIC "CCHIST01"
+#define HISTFILE_BYTE_ORDER 0x01020304u
+#define HISTFILE_COLUMNS 4   // time_ms, price, market cap, volume
+
+/**
+ * @brief On-disk header; the columns follow it, count * 8 bytes each
+ */
+struct histfile_header {
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t columns;
+    uint64_t count;
+    int64_t written_at;
+    int64_t first_ms;          // First and last sample time (0 if empty)
+    int64_t last_ms;
+    char id[HISTFILE_ID_SIZE];
+    char currency[16];
+    char days[16];
+};
+
+int histfile_write(const char *path, const char *id, const char *currency, const char *days,
+                   const chart_series_t *series) {
+    if (!path || !id || !series || !series->success || series->count < 0 ||
+        strlen(id) >= HISTFILE_ID_SIZE) {
+        return -1;
+    }
+
+    struct histfile_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HISTFILE_MAGIC, sizeof(header.magic));
+    header.byte_order = HISTFILE_BYTE_ORDER;
+    header.columns = HISTFILE_COLUMNS;
+    header.count = (uint64_t)series->count;
+    header.written_at = (int64_t)time(NULL);
+    if (series->count > 0) {
+        header.first_ms = series->time_ms[0];
+        header.last_ms = series->time_ms[series->count - 1];
+    }
+    snprintf(header.id, sizeof(header.id), "%s", id);
+    snprintf(header.currency, sizeof(header.currency), "%s", currency ? currency : "usd");
+    snprintf(header.days, sizeof(header.days), "%s", days ? days : "max");
+
+    char tmp[1100];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp) {
+        return -1;
+    }
+
+    size_t n = (size_t)series->count;
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    ok = ok && fwrite(series->time_ms, sizeof(int64_t), n, fp) == n;
+    ok = ok && fwrite(series->price, sizeof(double), n, fp) == n;
+    ok = ok && fwrite(series->market_cap, sizeof(double), n, fp) == n;
+    ok = ok && fwrite(series->volume, sizeof(double), n, fp) == n;
+    ok = ok && fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+    if (fclose(fp) != 0) {
+        ok = 0;
+    }
+    if (!ok || rename(tmp, path) != 0) {
+        unlink(tmp);
+        return -1;
+    }
+
+    return 0;
+}
+
+int histfile_open(const char *path, histfile_t *file) {
+    if (!path || !file) {
+        return -1;
+    }
+    memset(file, 0, sizeof(*file));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(struct histfile_header)) {
+        close(fd);
+        return -1;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+
+    // The columns must fill the rest of the file exactly
+    const struct histfile_header *header = (const struct histfile_header *)base;
+    size_t body = size - sizeof(*header);
+    int valid = memcmp(header->magic, HISTFILE_MAGIC, sizeof(header->magic)) == 0 &&
+                header->byte_order == HISTFILE_BYTE_ORDER &&
+                header->columns == HISTFILE_COLUMNS &&
+                header->count <= body / (HISTFILE_COLUMNS * 8) &&
+                header->count * HISTFILE_COLUMNS * 8 == body &&
+                memchr(header->id, '\0', sizeof(header->id)) != NULL &&
+                memchr(header->currency, '\0', sizeof(header->currency)) != NULL &&
+                memchr(header->days, '\0', sizeof(header->days)) != NULL;
+    if (!valid) {
+        munmap(base, size);
+        return -1;
+    }
+
+    const char *columns = (const char *)base + sizeof(*header);
+    size_t column_size = (size_t)header->count * 8;
+    file->base = base;
+    file->size = size;
+    file->count = header->count;
+    file->written_at = header->written_at;
+    file->id = header->id;
+    file->currency = header->currency;
+    file->days = header->days;
+    file->time_ms = (const int64_t *)columns;
+    file->price = (const double *)(columns + column_size);
+    file->market_cap = (const double *)(columns + 2 * column_size);
+    file->volume = (const double *)(columns + 3 * column_size);
+
+    return 0;
+}
+
+void histfile_close(histfile_t *file) {
+    if (file && file->base) {
+        munmap(file->base, file->size);
+        memset(file, 0, sizeof(*file));
+    }
+}
@@ -0,0 +1,116 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/history.h"
+#include "../include/api.h"
+#include "../include/parser.h"
+#include "../include/display.h"
+#include "../include/export.h"
+#include "../include/profile.h"
+
+#define HISTORY_DEFAULT_DAYS "30"
+
+static void print_history_usage(void) {
+    printf("Usage: crypto history SYMBOL [DAYS] [--ohlc] [--currency CODE]\n");
+    printf("  DAYS        Days of history, or max (default: %s)\n", HISTORY_DEFAULT_DAYS);
+    printf("  --ohlc      OHLC candles instead of price, market cap and volume samples\n");
+    printf("              (DAYS must then be 1, 7, 14, 30, 90, 180, 365 or max)\n");
+    printf("  --currency  Quote currency (default: usd)\n");
+    printf("Output follows --format (table, csv, json, arrow, feather).\n");
+}
+
+int history_command(int argc, char *argv[], const cli_options_t *options) {
+    const char *symbol = NULL;
+    const char *days = HISTORY_DEFAULT_DAYS;
+    char currency[8] = "usd";
+    int ohlc = 0;
+    int have_days = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ohlc") == 0) {
+            ohlc = 1;
+        } else if (strcmp(argv[i], "--currency") == 0 && i + 1 < argc) {
+            if (options_parse_currency(argv[++i], currency, sizeof(currency)) != 0) {
+                return 1;
+            }
+        } else if (!symbol && argv[i][0] != '-') {
+            symbol = argv[i];
+        } else if (symbol && !have_days && argv[i][0] != '-') {
+            days = argv[i];
+            have_days = 1;
+        } else {
+            print_history_usage();
+            return 1;
+        }
+    }
+    if (!symbol) {
+        print_history_usage();
+        return 1;
+    }
+    if (!options_valid_days(days)) {
+        display_error("DAYS must be a positive number of days or max");
+        return 1;
+    }
+
+    profile_begin(PROFILE_RESOLVE);
+    char *id = symbol_to_id(symbol);
+    profile_end(PROFILE_RESOLVE);
+    if (!id) {
+        display_error("Invalid symbol");
+        return 1;
+    }
+
+    profile_begin(PROFILE_URL);
+    char *url = ohlc ? get_ohlc_url(id, currency, days) : get_market_chart_url(id, currency, days);
+    profile_end(PROFILE_URL);
+    free(id);
+
+    char *json = NULL;
+    profile_begin(PROFILE_FETCH);
+    int rc = url ? api_fetch_url(NULL, url, &json, NULL) : -1;
+    profile_end(PROFILE_FETCH);
+    free(url);
+    if (rc != 0) {
+        display_error(api_remaining_ms() == 0
+                      ? "Deadline reached before the history arrived"
+                      : "Failed to fetch history from API. Please check the coin and your internet connection.");
+        return 1;
+    }
+
+    int written;
+    if (ohlc) {
+        profile_begin(PROFILE_PARSE);
+        ohlc_series_t series = parse_ohlc_series(json);
+        free(json);
+        profile_end(PROFILE_PARSE);
+        if (!series.success) {
+            display_error("Failed to parse OHLC API response");
+            return 1;
+        }
+        profile_begin(PROFILE_RENDER);
+        written = export_ohlc(stdout, options->format, &series);
+        profile_end(PROFILE_RENDER);
+        free_ohlc_series(&series);
+    } else {
+        profile_begin(PROFILE_PARSE);
+        chart_series_t series = parse_market_chart_json(json);
+        free(json);
+        profile_end(PROFILE_PARSE);
+        if (!series.success) {
+            display_error("Failed to parse market_chart API response");
+            return 1;
+        }
+        profile_begin(PROFILE_RENDER);
+        written = export_chart(stdout, options->format, &series);
+        profile_end(PROFILE_RENDER);
+        free_chart_series(&series);
+    }
+
+    if (written != 0) {
+        display_error("Failed to write output");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "../include/intern.h"
+
+#define INTERN_BLOCK_SIZE (64 * 1024)
+#define INTERN_INITIAL_CAPACITY 1024   // Slots; always a power of two
+
+/**
+ * @brief Arena block holding string copies back to back
+ */
+struct intern_block {
+    struct intern_block *next;
+    size_t used;
+    size_t size;
+    char data[];
+};
+
+struct intern_slot {
+    const char *str;     // NULL if empty
+    uint32_t hash;
+    uint32_t len;
+};
+
+static pthread_mutex_t intern_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct intern_slot *slots;
+static size_t capacity;
+static size_t count;
+static size_t bytes;
+static struct intern_block *blocks;
+
+uint32_t intern_hash(uint32_t hash, const char *s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)s[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int grow_table(void) {
+    size_t new_capacity = capacity ? capacity * 2 : INTERN_INITIAL_CAPACITY;
+    struct intern_slot *new_slots = calloc(new_capacity, sizeof(struct intern_slot));
+    if (!new_slots) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < capacity; i++) {
+        if (!slots[i].str) {
+            continue;
+        }
+        size_t j = slots[i].hash & (new_capacity - 1);
+        while (new_slots[j].str) {
+            j = (j + 1) & (new_capacity - 1);
+        }
+        new_slots[j] = slots[i];
+    }
+
+    free(slots);
+    slots = new_slots;
+    capacity = new_capacity;
+    return 0;
+}
+
+// Copy into the current block, starting a new one when it is full
+static const char *store_copy(const char *s, size_t len) {
+    if (!blocks || blocks->size - blocks->used < len + 1) {
+        size_t size = len + 1 > INTERN_BLOCK_SIZE ? len + 1 : INTERN_BLOCK_SIZE;
+        struct intern_block *block = malloc(sizeof(struct intern_block) + size);
+        if (!block) {
+            return NULL;
+        }
+        block->used = 0;
+        block->size = size;
+        block->next = blocks;
+        blocks = block;
+        bytes += size;
+    }
+
+    char *copy = blocks->data + blocks->used;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    blocks->used += len + 1;
+    return copy;
+}
+
+const char *intern_n(const char *s, size_t len) {
+    if (!s || len > UINT32_MAX) {
+        return NULL;
+    }
+    uint32_t hash = intern_hash(INTERN_HASH_SEED, s, len);
+
+    pthread_mutex_lock(&intern_lock);
+
+    // Keep the load factor under 3/4
+    if ((count + 1) * 4 > capacity * 3 && grow_table() != 0) {
+        pthread_mutex_unlock(&intern_lock);
+        return NULL;
+    }
+
+    size_t i = hash & (capacity - 1);
+    while (slots[i].str) {
+        if (slots[i].hash == hash && slots[i].len == len && memcmp(slots[i].str, s, len) == 0) {
+            const char *found = slots[i].str;
+            pthread_mutex_unlock(&intern_lock);
+            return found;
+        }
+        i = (i + 1) & (capacity - 1);
+    }
+
+    const char *copy = store_copy(s, len);
+    if (copy) {
+        slots[i].str = copy;
+        slots[i].hash = hash;
+        slots[i].len = (uint32_t)len;
+        count++;
+    }
+
+    pthread_mutex_unlock(&intern_lock);
+    return copy;
+}
+
+const char *intern(const char *s) {
+    return s ? intern_n(s, strlen(s)) : NULL;
+}
+
+void intern_stats(size_t *out_count, size_t *out_bytes) {
+    pthread_mutex_lock(&intern_lock);
+    if (out_count) {
+        *out_count = count;
+    }
+    if (out_bytes) {
+        *out_bytes = bytes;
+    }
+    pthread_mutex_unlock(&intern_lock);
+}
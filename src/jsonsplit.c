@@ -0,0 +1,318 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../include/jsonsplit.h"
+
+#define SCAN_ERROR ((size_t)-1)
+#define SPLIT_MIN_BLOCK 16
+#define SPLIT_MAX_BLOCK 4096
+#define SPLIT_MAX_THREADS 64
+
+static size_t skip_whitespace(const char *text, size_t length, size_t i) {
+    while (i < length && (text[i] == ' ' || text[i] == '\n' || text[i] == '\r' || text[i] == '\t')) {
+        i++;
+    }
+    return i;
+}
+
+// i is just past the opening quote; returns the offset past the closing one
+static size_t skip_string_body(const char *text, size_t length, size_t i) {
+    while (i < length) {
+        const char *quote = memchr(text + i, '"', length - i);
+        if (!quote) {
+            return SCAN_ERROR;
+        }
+        size_t q = (size_t)(quote - text);
+        // Escaped if preceded by an odd run of backslashes
+        size_t backslashes = 0;
+        while (q - backslashes > i && text[q - backslashes - 1] == '\\') {
+            backslashes++;
+        }
+        i = q + 1;
+        if (backslashes % 2 == 0) {
+            return i;
+        }
+    }
+    return SCAN_ERROR;
+}
+
+// Bytes the container scan has to look at; everything else is skipped
+static const unsigned char structural[256] = {
+    ['"'] = 1, ['['] = 1, [']'] = 1, ['{'] = 1, ['}'] = 1,
+};
+
+// i is at the opening bracket or brace; returns the offset past its match
+static size_t skip_container(const char *text, size_t length, size_t i) {
+    int depth = 0;
+    while (i < length) {
+        char c = text[i++];
+        if (!structural[(unsigned char)c]) {
+            continue;
+        }
+        if (c == '"') {
+            i = skip_string_body(text, length, i);
+            if (i == SCAN_ERROR) {
+                return SCAN_ERROR;
+            }
+        } else if (c == '[' || c == '{') {
+            depth++;
+        } else if (c == ']' || c == '}') {
+            if (--depth == 0) {
+                return i;
+            }
+        }
+    }
+    return SCAN_ERROR;
+}
+
+// i is at the first byte of a value; returns the offset past it
+static size_t skip_value(const char *text, size_t length, size_t i) {
+    if (i >= length) {
+        return SCAN_ERROR;
+    }
+    if (text[i] == '"') {
+        return skip_string_body(text, length, i + 1);
+    }
+    if (text[i] == '[' || text[i] == '{') {
+        return skip_container(text, length, i);
+    }
+    // Number, true, false or null
+    size_t start = i;
+    while (i < length && text[i] != ',' && text[i] != ']' && text[i] != '}' && text[i] != ' ' &&
+           text[i] != '\n' && text[i] != '\r' && text[i] != '\t') {
+        i++;
+    }
+    return i > start ? i : SCAN_ERROR;
+}
+
+static int add_span(json_split_t *split, int *capacity, size_t offset, size_t length) {
+    if (split->count == *capacity) {
+        int grown = *capacity > 0 ? *capacity * 2 : 1024;
+        json_span_t *spans = realloc(split->spans, (size_t)grown * sizeof(json_span_t));
+        if (!spans) {
+            return -1;
+        }
+        split->spans = spans;
+        *capacity = grown;
+    }
+    split->spans[split->count].offset = offset;
+    split->spans[split->count].length = length;
+    split->count++;
+    return 0;
+}
+
+// i is at '['; fills split (spans relative to text) and returns the offset past ']'
+static size_t scan_array(const char *text, size_t length, size_t i, int max_elements,
+                         json_split_t *split) {
+    int capacity = 0;
+    split->base = text;
+    split->spans = NULL;
+    split->count = 0;
+
+    i = skip_whitespace(text, length, i + 1);
+    if (i < length && text[i] == ']') {
+        split->end = i + 1;
+        return split->end;
+    }
+
+    while (i < length) {
+        size_t start = i;
+        i = skip_value(text, length, i);
+        if (i == SCAN_ERROR) {
+            break;
+        }
+        if ((max_elements <= 0 || split->count < max_elements) &&
+            add_span(split, &capacity, start, i - start) != 0) {
+            break;
+        }
+
+        i = skip_whitespace(text, length, i);
+        if (i < length && text[i] == ',') {
+            i = skip_whitespace(text, length, i + 1);
+        } else if (i < length && text[i] == ']') {
+            split->end = i + 1;
+            return split->end;
+        } else {
+            break;
+        }
+    }
+
+    json_split_free(split);
+    return SCAN_ERROR;
+}
+
+int json_split_array(const char *text, size_t length, int max_elements, json_split_t *split) {
+    memset(split, 0, sizeof(*split));
+    if (!text) {
+        return -1;
+    }
+    size_t i = skip_whitespace(text, length, 0);
+    if (i >= length || text[i] != '[') {
+        return -1;
+    }
+    return scan_array(text, length, i, max_elements, split) == SCAN_ERROR ? -1 : 0;
+}
+
+int json_split_members(const char *text, size_t length, const char *const *keys, int key_count,
+                       json_split_t *splits) {
+    for (int k = 0; k < key_count; k++) {
+        memset(&splits[k], 0, sizeof(splits[k]));
+        splits[k].count = -1;
+    }
+    if (!text) {
+        return -1;
+    }
+
+    size_t i = skip_whitespace(text, length, 0);
+    if (i >= length || text[i] != '{') {
+        return -1;
+    }
+    i = skip_whitespace(text, length, i + 1);
+    if (i < length && text[i] == '}') {
+        return 0;
+    }
+
+    while (i < length && text[i] == '"') {
+        size_t key_start = i + 1;
+        i = skip_string_body(text, length, key_start);
+        if (i == SCAN_ERROR) {
+            break;
+        }
+        size_t key_length = i - 1 - key_start;
+
+        i = skip_whitespace(text, length, i);
+        if (i >= length || text[i] != ':') {
+            break;
+        }
+        i = skip_whitespace(text, length, i + 1);
+
+        int wanted = -1;
+        for (int k = 0; k < key_count && wanted < 0; k++) {
+            if (strlen(keys[k]) == key_length && memcmp(keys[k], text + key_start, key_length) == 0 &&
+                splits[k].count < 0) {
+                wanted = k;
+            }
+        }
+
+        if (wanted >= 0 && i < length && text[i] == '[') {
+            i = scan_array(text, length, i, 0, &splits[wanted]);
+            if (i == SCAN_ERROR) {
+                splits[wanted].count = -1;
+                break;
+            }
+        } else {
+            i = skip_value(text, length, i);
+            if (i == SCAN_ERROR) {
+                break;
+            }
+        }
+
+        i = skip_whitespace(text, length, i);
+        if (i < length && text[i] == ',') {
+            i = skip_whitespace(text, length, i + 1);
+        } else if (i < length && text[i] == '}') {
+            return 0;
+        } else {
+            break;
+        }
+    }
+
+    for (int k = 0; k < key_count; k++) {
+        json_split_free(&splits[k]);
+        splits[k].count = -1;
+    }
+    return -1;
+}
+
+typedef struct {
+    const json_split_t *split;
+    json_element_fn callback;
+    void *context;
+    int block;
+    atomic_int next;     // First element of the next unclaimed block
+    atomic_int failed;
+} parse_job_t;
+
+// Claim blocks of elements until none are left
+static void *parse_worker(void *arg) {
+    parse_job_t *job = (parse_job_t *)arg;
+    const json_split_t *split = job->split;
+
+    for (;;) {
+        int first = atomic_fetch_add(&job->next, job->block);
+        if (first >= split->count) {
+            break;
+        }
+        int last = first + job->block < split->count ? first + job->block : split->count;
+        for (int i = first; i < last; i++) {
+            const json_span_t *span = &split->spans[i];
+            cJSON *element = cJSON_ParseWithLength(split->base + span->offset, span->length);
+            if (!element) {
+                atomic_store(&job->failed, 1);
+                continue;
+            }
+            job->callback(element, i, job->context);
+            cJSON_Delete(element);
+        }
+    }
+    return NULL;
+}
+
+int json_parse_elements(const json_split_t *split, int threads, json_element_fn callback,
+                        void *context) {
+    if (!split || split->count < 0 || !callback) {
+        return -1;
+    }
+
+    parse_job_t job;
+    job.split = split;
+    job.callback = callback;
+    job.context = context;
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > SPLIT_MAX_THREADS) {
+        threads = SPLIT_MAX_THREADS;
+    }
+    if (threads > split->count) {
+        threads = split->count > 0 ? split->count : 1;
+    }
+    // Small enough blocks to even out elements of different sizes, large
+    // enough that claiming one is rare
+    job.block = split->count / (threads * 8);
+    if (job.block < SPLIT_MIN_BLOCK) {
+        job.block = SPLIT_MIN_BLOCK;
+    }
+    if (job.block > SPLIT_MAX_BLOCK) {
+        job.block = SPLIT_MAX_BLOCK;
+    }
+    atomic_init(&job.next, 0);
+    atomic_init(&job.failed, 0);
+
+    // The calling thread is one of the workers; if a thread cannot be
+    // started, the others take its share
+    pthread_t workers[SPLIT_MAX_THREADS];
+    int started = 0;
+    for (int t = 1; t < threads; t++) {
+        if (pthread_create(&workers[started], NULL, parse_worker, &job) == 0) {
+            started++;
+        }
+    }
+    parse_worker(&job);
+    for (int t = 0; t < started; t++) {
+        pthread_join(workers[t], NULL);
+    }
+
+    return atomic_load(&job.failed) ? -1 : 0;
+}
+
+void json_split_free(json_split_t *split) {
+    if (split) {
+        free(split->spans);
+        split->spans = NULL;
+        split->count = 0;
+    }
+}
@@ -1,208 +1,734 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <ctype.h>
-#include <curl/curl.h>
-#include "../include/api.h"
-#include "../include/parser.h"
-#include "../include/display.h"
-
-#define BUFFER_SIZE 4096
-#define VERSION "1.0.0"
-
-static void print_usage(const char *program_name) {
-    printf("Usage: %s [SYMBOL] [COMMAND] | %s top [N]\n\n", program_name, program_name);
-    printf("Commands:\n");
-    printf("  [SYMBOL]              Display full cryptocurrency information\n");
-    printf("  [SYMBOL] price        Display only the current price\n");
-    printf("  [SYMBOL] [CURRENCY]   Display price in different currency (EUR, GBP, JPY, etc.)\n");
-    printf("  top [N]               Display top N cryptocurrencies by market cap (default: 10)\n");
-    printf("\n");
-    printf("Examples:\n");
-    printf("  %s bitcoin            Show full info for Bitcoin\n", program_name);
-    printf("  %s btc price          Show only the price for Bitcoin\n", program_name);
-    printf("  %s bitcoin EUR        Show Bitcoin price in EUR\n", program_name);
-    printf("  %s btc GBP            Show Bitcoin price in GBP\n", program_name);
-    printf("  %s top               Show top 10 cryptocurrencies\n", program_name);
-    printf("  %s top 20            Show top 20 cryptocurrencies\n", program_name);
-    printf("\n");
-    printf("Version: %s\n", VERSION);
-}
-
-static void print_version(void) {
-    printf("crypto-cli version %s\n", VERSION);
-}
-
-int main(int argc, char *argv[]) {
-    // Initialize libcurl
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    
-    int show_price_only = 0;
-    char *symbol = NULL;
-    
-    // Parse arguments
-    if (argc < 2) {
-        print_usage(argv[0]);
-        curl_global_cleanup();
-        return 1;
-    }
-    
-    // Check for version flag
-    if (strcmp(argv[1], "--version") == 0 || strcmp(argv[1], "-v") == 0) {
-        print_version();
-        curl_global_cleanup();
-        return 0;
-    }
-    
-    // Check for help flag
-    if (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0) {
-        print_usage(argv[0]);
-        curl_global_cleanup();
-        return 0;
-    }
-    
-    // Check if command is "top"
-    if (strcmp(argv[1], "top") == 0) {
-        int limit = 10; // default
-        
-        // Parse optional limit parameter
-        if (argc >= 3) {
-            limit = atoi(argv[2]);
-            if (limit <= 0 || limit > 250) {
-                display_error("Limit must be between 1 and 250");
-                curl_global_cleanup();
-                return 1;
-            }
-        }
-        
-        if (argc > 3) {
-            display_error("Too many arguments for 'top' command");
-            print_usage(argv[0]);
-            curl_global_cleanup();
-            return 1;
-        }
-        
-        // Fetch markets data
-        char buffer[BUFFER_SIZE * 4] = {0}; // Larger buffer for markets data
-        int result = fetch_markets_data(limit, buffer, sizeof(buffer));
-        
-        if (result != 0) {
-            display_error("Failed to fetch markets data from API. Please check your internet connection and try again.");
-            curl_global_cleanup();
-            return 1;
-        }
-        
-        // Parse markets JSON response
-        markets_data_t markets = parse_markets_json(buffer, limit);
-        
-        if (!markets.success) {
-            display_error("Failed to parse markets API response");
-            curl_global_cleanup();
-            return 1;
-        }
-        
-        // Display top coins
-        display_top_coins(&markets);
-        
-        // Cleanup
-        free_markets_data(&markets);
-        curl_global_cleanup();
-        return 0;
-    }
-    
-    symbol = argv[1];
-    
-    // Check if second argument is "price" or a currency code
-    char *currency = NULL;
-    if (argc >= 3) {
-        if (strcmp(argv[2], "price") == 0) {
-            show_price_only = 1;
-        } else {
-            // Assume it's a currency code (convert to lowercase)
-            size_t curr_len = strlen(argv[2]);
-            currency = malloc(curr_len + 1);
-            if (currency) {
-                for (size_t i = 0; i < curr_len; i++) {
-                    currency[i] = tolower((unsigned char)argv[2][i]);
-                }
-                currency[curr_len] = '\0';
-            }
-        }
-    }
-    
-    if (argc > 3 && strcmp(argv[2], "price") != 0) {
-        fprintf(stderr, "Error: Too many arguments\n");
-        print_usage(argv[0]);
-        if (currency) free(currency);
-        curl_global_cleanup();
-        return 1;
-    }
-    
-    // Convert symbol to CoinGecko ID format
-    char *coin_id = symbol_to_id(symbol);
-    if (!coin_id) {
-        display_error("Invalid symbol");
-        if (currency) free(currency);
-        curl_global_cleanup();
-        return 1;
-    }
-    
-    // Fetch data from API
-    char buffer[BUFFER_SIZE] = {0};
-    int result = fetch_crypto_data_with_currency(coin_id, currency, buffer, BUFFER_SIZE);
-    
-    if (result != 0) {
-        display_error("Failed to fetch data from API. Please check your internet connection and try again.");
-        free(coin_id);
-        if (currency) free(currency);
-        curl_global_cleanup();
-        return 1;
-    }
-    
-    // Check if response is empty or error
-    if (strlen(buffer) == 0 || strstr(buffer, "error") != NULL) {
-        display_error("Cryptocurrency not found or invalid symbol");
-        free(coin_id);
-        if (currency) free(currency);
-        curl_global_cleanup();
-        return 1;
-    }
-    
-    // Parse JSON response
-    crypto_data_t crypto_data = parse_crypto_json_with_currency(buffer, currency);
-    
-    if (!crypto_data.success) {
-        display_error("Failed to parse API response");
-        free(coin_id);
-        if (currency) free(currency);
-        curl_global_cleanup();
-        return 1;
-    }
-    
-    // Fetch OHLC data to get high/low 24h (only if currency is USD or NULL)
-    // Note: OHLC endpoint only supports USD, so we skip it for other currencies
-    if (!currency || strcmp(currency, "usd") == 0) {
-        char ohlc_buffer[BUFFER_SIZE] = {0};
-        int ohlc_result = fetch_ohlc_data(coin_id, ohlc_buffer, BUFFER_SIZE);
-        if (ohlc_result == 0) {
-            // Parse OHLC data and update high/low values
-            parse_ohlc_json(ohlc_buffer, &crypto_data);
-        }
-    }
-    
-    // Display data
-    if (show_price_only) {
-        display_price_only(&crypto_data);
-    } else {
-        display_full_info(&crypto_data);
-    }
-    
-    // Cleanup
-    free_crypto_data(&crypto_data);
-    free(coin_id);
-    if (currency) free(currency);
-    curl_global_cleanup();
-    
-    return 0;
-}
-
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "../include/api.h"
+#include "../include/parser.h"
+#include "../include/display.h"
+#include "../include/alerts.h"
+#include "../include/dash.h"
+#include "../include/batch.h"
+#include "../include/serve.h"
+#include "../include/feed.h"
+#include "../include/convert.h"
+#include "../include/search.h"
+#include "../include/history.h"
+#include "../include/corr.h"
+#include "../include/backfill.h"
+#include "../include/diff.h"
+#include "../include/export.h"
+#include "../include/options.h"
+#include "../include/store.h"
+#include "../include/provider.h"
+#include "../include/planner.h"
+#include "../include/profile.h"
+#include "../include/snapshot.h"
+#include "../include/paths.h"
+#include "../include/usage.h"
+#include "../include/prefetch.h"
+
+#define MARKETS_BUFFER_SIZE (1024 * 1024)  // ~1 KB per coin, up to 250 coins
+#define VERSION "1.0.0"
+
+static void print_usage(const char *program_name) {
+    printf("Usage: %s [SYMBOL] [COMMAND] | %s top [N]\n\n", program_name, program_name);
+    printf("Commands:\n");
+    printf("  [SYMBOL]              Display full cryptocurrency information\n");
+    printf("  [SYMBOL] price        Display only the current price\n");
+    printf("  [SYMBOL] [CURRENCY]   Display price in different currency (EUR, GBP, JPY, etc.)\n");
+    printf("  top [N]               Display top N cryptocurrencies by market cap (default: 10)\n");
+    printf("  alerts RULES [--once] Evaluate price alert rules from a file on every tick\n");
+    printf("  dash [N] [--watch IDS] Live full-screen dashboard of the top N coins\n");
+    printf("  batch < FILE          Stream quotes for symbols read from stdin (TSV output)\n");
+    printf("  serve [--listen ADDR] Export quotes as Prometheus metrics on /metrics\n");
+    printf("  feed --shm NAME       Publish quotes into shared memory for local readers\n");
+    printf("  convert N FROM TO...  Convert an amount between coins and fiat currencies\n");
+    printf("  matrix ASSET... [--vs CODES] | matrix --top N  Cross-rate matrix\n");
+    printf("  search TEXT           Find coins by id, symbol or name (fuzzy)\n");
+    printf("  history SYMBOL [DAYS] Price, market cap and volume history (--ohlc: candles)\n");
+    printf("  corr --top N [--days D] Return correlation matrix and annualised volatility\n");
+    printf("  backfill --ids-from top:N --out DIR  Resumable bulk download of history\n");
+    printf("  diff BEFORE AFTER     Rank moves, entrants, drop-outs and deltas between listings\n");
+    printf("  top [N] --since AGE   Top N compared with the archived listing from AGE ago\n");
+    printf("\n");
+    printf("Options:\n");
+    printf("  --max-age S           Serve stored quotes younger than S seconds (default: %d)\n", OPTIONS_DEFAULT_MAX_AGE);
+    printf("  --stale S             Serve expired quotes up to S seconds past max-age while\n");
+    printf("                        refreshing in the background (default: %d, 0 = never)\n", OPTIONS_DEFAULT_STALE_GRACE);
+    printf("  --no-cache            Always fetch from the API\n");
+    printf("  --provider NAME       Quote provider: auto (default), coingecko, cryptocompare\n");
+    printf("  --race                Ask every provider at once and use the first quote\n");
+    printf("  --format F            Output of quotes/top/history/corr/diff/convert/matrix/\n");
+    printf("                        search: table (default), csv, json, arrow (IPC stream)\n");
+    printf("                        or feather (IPC file)\n");
+    printf("  --fields LIST         Only request, parse and show these fields of quotes, top\n");
+    printf("                        and batch: price, change_24h, market_cap, volume_24h,\n");
+    printf("                        high_24h, low_24h, last_updated, name, symbol, all\n");
+    printf("  --deadline D          Overall time budget, e.g. 800ms or 2s; unfinished requests\n");
+    printf("                        are cancelled when it runs out\n");
+    printf("  --profile             Print per-stage time and allocations as JSON on stderr\n");
+    printf("  --parse-threads N     Threads for parsing responses of 1 MB or more\n");
+    printf("                        (default: 0 = one per CPU, 1 = single-threaded)\n");
+    printf("\n");
+    printf("Examples:\n");
+    printf("  %s bitcoin            Show full info for Bitcoin\n", program_name);
+    printf("  %s btc price          Show only the price for Bitcoin\n", program_name);
+    printf("  %s bitcoin EUR        Show Bitcoin price in EUR\n", program_name);
+    printf("  %s btc GBP            Show Bitcoin price in GBP\n", program_name);
+    printf("  %s top               Show top 10 cryptocurrencies\n", program_name);
+    printf("  %s top 20            Show top 20 cryptocurrencies\n", program_name);
+    printf("  %s alerts rules.txt  Watch alert rules (e.g. \"BTC > 70000\")\n", program_name);
+    printf("  %s dash 30 --watch btc,eth  Live dashboard with pinned coins\n", program_name);
+    printf("  cat symbols.txt | %s batch   Quote every symbol in the file\n", program_name);
+    printf("  %s serve --coins btc,eth,sol  Prometheus exporter on 127.0.0.1:9464\n", program_name);
+    printf("  %s feed --shm /crypto-quotes  Shared-memory feed of bitcoin and ethereum\n", program_name);
+    printf("  %s convert 1.5 btc eth      How much ETH 1.5 BTC buys\n", program_name);
+    printf("  %s matrix btc eth sol --vs usd,eur  Cross rates plus fiat columns\n", program_name);
+    printf("  %s search etherium       Look up the CoinGecko id of a coin\n", program_name);
+    printf("  %s top 250 --format feather > top.arrow  Market table for pandas/polars\n", program_name);
+    printf("  %s btc --fields price,market_cap --format csv  Just two fields\n", program_name);
+    printf("  %s corr --top 100 --days 90 --format csv  Correlations of the top 100\n", program_name);
+    printf("  %s backfill --ids-from top:500 --days max --out hist  Full history of 500 coins\n", program_name);
+    printf("  %s top 50 --since 1h  What moved in the top 50 over the last hour\n", program_name);
+    printf("\n");
+    printf("Version: %s\n", VERSION);
+}
+
+static void print_version(void) {
+    printf("crypto-cli version %s\n", VERSION);
+}
+
+/**
+ * @brief Fetch a quote from the providers
+ *
+ * @param error Output: message for display_error() on failure
+ * @return int PROVIDER_OK on success, otherwise a negative provider_result_t
+ */
+static int fetch_quote(const cli_options_t *options, const quote_query_t *query, crypto_data_t *out,
+                       const char **error) {
+    int result = provider_fetch_quote(query, options->provider, options->race, out, NULL);
+    
+    if (result == PROVIDER_ERR_NOT_FOUND) {
+        *error = "Cryptocurrency not found or invalid symbol";
+        return result;
+    }
+    if (result != PROVIDER_OK) {
+        *error = api_remaining_ms() == 0
+            ? "Deadline reached before a quote arrived"
+            : "Failed to fetch data from API. Please check your internet connection and try again.";
+        return result;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief Show the top coins from the last markets snapshot if it is fresh
+ *
+ * The snapshot is mapped and rendered column by column; no JSON is parsed.
+ *
+ * @return int 0 if the table was shown, 1 if writing it failed (error
+ *             printed), -1 to fetch from the API
+ */
+static int show_top_from_snapshot(const cli_options_t *options, int limit) {
+    char path[1024];
+    markets_snapshot_t snapshot;
+    
+    if (!options->use_store || paths_cache_file(SNAPSHOT_DIR, SNAPSHOT_MARKETS, path, sizeof(path)) != 0 ||
+        snapshot_open(path, &snapshot) != 0) {
+        return -1;
+    }
+    
+    long age = (long)time(NULL) - (long)snapshot.created_at;
+    int usable = snapshot.count >= (uint32_t)limit && age >= 0 && age < options->max_age;
+    int written = 0;
+    if (usable) {
+        if (options->format == OUTPUT_TABLE) {
+            display_top_snapshot(&snapshot, limit, options->fields);
+        } else {
+            written = export_markets_snapshot(stdout, options->format, &snapshot, limit, options->fields);
+        }
+    }
+    
+    snapshot_close(&snapshot);
+    if (!usable) {
+        return -1;
+    }
+    if (written != 0) {
+        display_error("Failed to write output");
+        return 1;
+    }
+    return 0;
+}
+
+// Older snapshots are archived as well, for "top --since" and "diff"
+static void save_top_snapshot(const cli_options_t *options, const markets_data_t *markets) {
+    char path[1024];
+    char archive[1024];
+    if (options->use_store && paths_cache_file(SNAPSHOT_DIR, SNAPSHOT_MARKETS, path, sizeof(path)) == 0 &&
+        snapshot_write(path, markets, "usd") == 0 &&
+        paths_cache_subdir(SNAPSHOT_ARCHIVE_DIR, archive, sizeof(archive)) == 0) {
+        snapshot_archive(path, archive, SNAPSHOT_MARKETS);
+    }
+}
+
+/**
+ * @brief Fetch and parse the top coins, saving a snapshot of full listings
+ *
+ * @return int 0 on success, -1 on error (error printed)
+ */
+static int fetch_top(const cli_options_t *options, int limit, unsigned fields, markets_data_t *markets) {
+    // Heap: a full page does not fit on the stack
+    char *buffer = malloc(MARKETS_BUFFER_SIZE);
+    if (!buffer) {
+        display_error("Memory allocation failed");
+        return -1;
+    }
+    profile_begin(PROFILE_FETCH);
+    int result = fetch_markets_data(limit, buffer, MARKETS_BUFFER_SIZE);
+    profile_end(PROFILE_FETCH);
+    
+    if (result != 0) {
+        display_error("Failed to fetch markets data from API. Please check your internet connection and try again.");
+        free(buffer);
+        return -1;
+    }
+    
+    profile_begin(PROFILE_PARSE);
+    *markets = parse_markets_json_fields(buffer, limit, "usd", fields);
+    free(buffer);
+    profile_end(PROFILE_PARSE);
+    
+    if (!markets->success) {
+        display_error("Failed to parse markets API response");
+        return -1;
+    }
+    
+    // Later runs within --max-age render from the binary snapshot
+    if (fields == PLAN_ALL) {
+        profile_begin(PROFILE_STORE);
+        save_top_snapshot(options, markets);
+        profile_end(PROFILE_STORE);
+    }
+    return 0;
+}
+
+/**
+ * @brief "top N --since AGE": the current top coins against an archived snapshot
+ *
+ * The current listing is the last snapshot if it is fresh, otherwise a
+ * new fetch (which is saved and archived); the earlier one is the newest
+ * archived snapshot at least AGE older.
+ *
+ * @return int Process exit code
+ */
+static int show_top_since(const cli_options_t *options, int limit, long since) {
+    if (!options->use_store) {
+        // Replayed listings are never archived, so there is nothing to compare with
+        display_error(api_replay_enabled()
+                      ? "--since compares with stored snapshots; it cannot be used in replay mode"
+                      : "--since compares with stored snapshots; it cannot be used with --no-cache");
+        return 1;
+    }
+    
+    char path[1024];
+    char archive[1024];
+    markets_snapshot_t current;
+    if (paths_cache_file(SNAPSHOT_DIR, SNAPSHOT_MARKETS, path, sizeof(path)) != 0 ||
+        paths_cache_subdir(SNAPSHOT_ARCHIVE_DIR, archive, sizeof(archive)) != 0) {
+        display_error("Cannot access the snapshot directory");
+        return 1;
+    }
+    
+    profile_begin(PROFILE_STORE);
+    int fresh = snapshot_open(path, &current) == 0;
+    long age = fresh ? (long)time(NULL) - (long)current.created_at : 0;
+    if (fresh && (current.count < (uint32_t)limit || age < 0 || age >= options->max_age)) {
+        snapshot_close(&current);
+        fresh = 0;
+    }
+    profile_end(PROFILE_STORE);
+    
+    if (!fresh) {
+        markets_data_t markets;
+        if (fetch_top(options, limit, PLAN_ALL, &markets) != 0) {
+            return 1;
+        }
+        free_markets_data(&markets);
+        if (snapshot_open(path, &current) != 0) {
+            display_error("Cannot read the markets snapshot");
+            return 1;
+        }
+    }
+    
+    char earlier_path[1100];
+    markets_snapshot_t earlier;
+    if (snapshot_archive_find(archive, SNAPSHOT_MARKETS, current.created_at - since, earlier_path,
+                              sizeof(earlier_path)) != 0 ||
+        snapshot_open(earlier_path, &earlier) != 0) {
+        snapshot_close(&current);
+        display_error("No snapshot that old yet; 'top' archives one every 5 minutes and keeps them for 7 days");
+        return 1;
+    }
+    
+    diff_side_t before, after;
+    int rc = -1;
+    if (diff_side_from_snapshot(&earlier, &before) == 0) {
+        if (diff_side_from_snapshot(&current, &after) == 0) {
+            profile_begin(PROFILE_RENDER);
+            rc = diff_write(stdout, options->format, &before, &after, limit, DIFF_SORT_RANK);
+            profile_end(PROFILE_RENDER);
+            diff_side_free(&after);
+        }
+        diff_side_free(&before);
+    }
+    snapshot_close(&earlier);
+    snapshot_close(&current);
+    if (rc != 0) {
+        display_error("Failed to write output");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Fork a detached worker
+ *
+ * Double fork: the intermediate child exits at once and is reaped here, so
+ * the worker outlives this process without leaving a zombie or holding
+ * the terminal.
+ *
+ * @return int 1 in the worker (which must end with _exit()), 0 in the caller
+ */
+static int detach_worker(void) {
+    fflush(stdout);
+    fflush(stderr);
+    
+    pid_t pid = fork();
+    if (pid < 0) {
+        return 0;
+    }
+    
+    if (pid == 0) {
+        if (fork() != 0) {
+            _exit(0);
+        }
+        setsid();
+        // Nobody is waiting for the worker, so the caller's deadline does not apply
+        api_set_deadline(0);
+        // A failed fetch may have set up libcurl already: leave the parent's
+        // connections to the parent
+        api_after_fork();
+        
+        int null_fd = open("/dev/null", O_RDWR);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDIN_FILENO);
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+            if (null_fd > STDERR_FILENO) {
+                close(null_fd);
+            }
+        }
+        return 1;
+    }
+    
+    waitpid(pid, NULL, 0);
+    return 0;
+}
+
+/**
+ * @brief Refresh a stored quote from a detached process
+ *
+ * Usually no request has been made yet at this point; after a failed fetch
+ * (load_expired_quote()) the worker gets a fresh connection pool from
+ * detach_worker() rather than reuse the parent's.
+ */
+static void spawn_refresh(const cli_options_t *options, const quote_query_t *query) {
+    if (!detach_worker()) {
+        return;
+    }
+    
+    // Another refresh of this coin already running: nothing to do
+    if (store_lock_refresh(query->id, query->currency) >= 0) {
+        // The store keeps whole quotes, whatever this run asked for
+        quote_query_t full = *query;
+        full.fields = PLAN_ALL;
+        crypto_data_t data;
+        const char *error = NULL;
+        if (fetch_quote(options, &full, &data, &error) == 0) {
+            store_save_quote(&data);
+            free_crypto_data(&data);
+        }
+    }
+    _exit(0);
+}
+
+/**
+ * @brief Count a quoted pair in the usage log and warm up the hot set
+ *
+ * Runs after the answer has been printed; a warm-up is started at most once
+ * per prefetch_interval() and fetches the hot pairs whose stored quotes are
+ * about to go stale (see prefetch.h).
+ */
+static void record_usage(const cli_options_t *options, const quote_query_t *query) {
+    usage_log_t log;
+    long now = (long)time(NULL);
+    
+    usage_load(&log);
+    usage_touch(&log, query->id, query->currency, now);
+    int due = now - log.last_prefetch >= prefetch_interval(options->max_age);
+    if (due) {
+        log.last_prefetch = now;
+    }
+    if (usage_save(&log) != 0 || !due) {
+        return;
+    }
+    
+    if (detach_worker()) {
+        prefetch_run(options->max_age);
+        _exit(0);
+    }
+}
+
+/**
+ * @brief Look up a quote in the local store (stale-while-revalidate)
+ *
+ * Fresh quotes are returned as-is. Quotes past max-age but within the grace
+ * window are returned with *stale_age set and a background refresh started.
+ *
+ * @return int 0 if a quote was served from the store, -1 to fetch it now
+ */
+static int load_stored_quote(const cli_options_t *options, const quote_query_t *query,
+                             crypto_data_t *out, long *stale_age) {
+    long fetched_at = 0;
+    *stale_age = -1;
+    
+    if (!options->use_store || store_load_quote(query->id, query->currency, out, &fetched_at) != 0) {
+        return -1;
+    }
+    
+    long age = store_quote_age(out, fetched_at);
+    if (age < options->max_age) {
+        return 0;
+    }
+    
+    if (age < options->max_age + options->stale_grace) {
+        *stale_age = age;
+        spawn_refresh(options, query);
+        return 0;
+    }
+    
+    free_crypto_data(out);
+    return -1;
+}
+
+/**
+ * @brief Fall back to a stored quote of any age once the deadline has passed
+ *
+ * An old answer is worth more than none to a caller with a time budget; the
+ * quote is refreshed in the background for the next call.
+ *
+ * @return int 0 if a quote was loaded (*stale_age set), -1 otherwise
+ */
+static int load_expired_quote(const cli_options_t *options, const quote_query_t *query,
+                              crypto_data_t *out, long *stale_age) {
+    long fetched_at = 0;
+    if (!options->use_store || options->deadline_ms <= 0 || api_remaining_ms() > 0 ||
+        store_load_quote(query->id, query->currency, out, &fetched_at) != 0) {
+        return -1;
+    }
+    *stale_age = store_quote_age(out, fetched_at);
+    spawn_refresh(options, query);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    // libcurl and TLS are initialised on the first request; commands that
+    // never touch the network (help, version, usage errors) skip that cost
+    atexit(api_cleanup);
+    
+    int show_price_only = 0;
+    char *symbol = NULL;
+    cli_options_t options;
+    
+    if (options_extract(&argc, argv, &options) != 0) {
+        return 1;
+    }
+    
+    if (options.profile) {
+        profile_enable();
+    }
+    parser_set_threads(options.parse_threads);
+    
+    // Parse arguments
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    // The budget covers one run; long-running commands would fail every refresh after it
+    if (options.deadline_ms > 0) {
+        if (strcmp(argv[1], "serve") == 0 || strcmp(argv[1], "dash") == 0 ||
+            strcmp(argv[1], "alerts") == 0 || strcmp(argv[1], "feed") == 0) {
+            fprintf(stderr, "Warning: --deadline is ignored by '%s'\n", argv[1]);
+        } else {
+            api_set_deadline(options.deadline_ms);
+        }
+    }
+    
+    // Check for version flag
+    if (strcmp(argv[1], "--version") == 0 || strcmp(argv[1], "-v") == 0) {
+        print_version();
+        return 0;
+    }
+    
+    // Check for help flag
+    if (strcmp(argv[1], "--help") == 0 || strcmp(argv[1], "-h") == 0) {
+        print_usage(argv[0]);
+        return 0;
+    }
+    
+    // Check if command is "alerts"
+    if (strcmp(argv[1], "alerts") == 0) {
+        int rc = alerts_command(argc - 1, argv + 1);
+        return rc;
+    }
+    
+    // Check if command is "dash"
+    if (strcmp(argv[1], "dash") == 0) {
+        return dash_command(argc - 1, argv + 1);
+    }
+    
+    // Check if command is "batch"
+    if (strcmp(argv[1], "batch") == 0) {
+        return batch_command(argc - 1, argv + 1, &options);
+    }
+    
+    // Check if command is "serve"
+    if (strcmp(argv[1], "serve") == 0) {
+        return serve_command(argc - 1, argv + 1);
+    }
+    
+    // Check if command is "feed"
+    if (strcmp(argv[1], "feed") == 0) {
+        return feed_command(argc - 1, argv + 1);
+    }
+    
+    // Check if command is "convert"
+    if (strcmp(argv[1], "convert") == 0) {
+        return convert_command(argc - 1, argv + 1, &options);
+    }
+    
+    // Check if command is "matrix"
+    if (strcmp(argv[1], "matrix") == 0) {
+        return matrix_command(argc - 1, argv + 1, &options);
+    }
+    
+    // Check if command is "search"
+    if (strcmp(argv[1], "search") == 0) {
+        return search_command(argc - 1, argv + 1, &options);
+    }
+    
+    // Check if command is "history"
+    if (strcmp(argv[1], "history") == 0) {
+        return history_command(argc - 1, argv + 1, &options);
+    }
+    
+    // Check if command is "corr"
+    if (strcmp(argv[1], "corr") == 0) {
+        return corr_command(argc - 1, argv + 1, &options);
+    }
+    
+    // Check if command is "backfill"
+    if (strcmp(argv[1], "backfill") == 0) {
+        return backfill_command(argc - 1, argv + 1);
+    }
+    
+    // Check if command is "diff"
+    if (strcmp(argv[1], "diff") == 0) {
+        return diff_command(argc - 1, argv + 1, &options);
+    }
+    
+    // Check if command is "top"
+    if (strcmp(argv[1], "top") == 0) {
+        int limit = 10; // default
+        int limit_given = 0;
+        long since = 0;
+        
+        // Parse optional limit parameter and --since AGE
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "--since") == 0) {
+                if (diff_parse_age(i + 1 < argc ? argv[i + 1] : NULL, &since) != 0) {
+                    display_error("--since expects an age such as 30m, 1h or 2d");
+                    return 1;
+                }
+                i++;
+            } else if (!limit_given) {
+                limit = atoi(argv[i]);
+                limit_given = 1;
+                if (limit <= 0 || limit > 250) {
+                    display_error("Limit must be between 1 and 250");
+                    return 1;
+                }
+            } else {
+                display_error("Too many arguments for 'top' command");
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+        
+        if (since > 0) {
+            return show_top_since(&options, limit, since);
+        }
+        
+        profile_begin(PROFILE_STORE);
+        int from_snapshot = show_top_from_snapshot(&options, limit);
+        profile_end(PROFILE_STORE);
+        if (from_snapshot >= 0) {
+            return from_snapshot;
+        }
+        
+        // Rows only need the --fields columns, in the table as in exports
+        unsigned fields = options.fields ? options.fields : PLAN_ALL;
+        markets_data_t markets;
+        if (fetch_top(&options, limit, fields, &markets) != 0) {
+            return 1;
+        }
+        
+        // Display top coins
+        profile_begin(PROFILE_RENDER);
+        int written = 0;
+        if (options.format == OUTPUT_TABLE) {
+            display_top_coins(&markets, options.fields);
+        } else {
+            written = export_markets(stdout, options.format, &markets, fields);
+        }
+        profile_end(PROFILE_RENDER);
+        
+        // Cleanup
+        free_markets_data(&markets);
+        if (written != 0) {
+            display_error("Failed to write output");
+            return 1;
+        }
+        return 0;
+    }
+    
+    symbol = argv[1];
+    
+    // Check if second argument is "price" or a currency code
+    char *currency = NULL;
+    if (argc >= 3) {
+        if (strcmp(argv[2], "price") == 0) {
+            show_price_only = 1;
+        } else {
+            // Assume it's a currency code (convert to lowercase)
+            size_t curr_len = strlen(argv[2]);
+            currency = malloc(curr_len + 1);
+            if (currency) {
+                for (size_t i = 0; i < curr_len; i++) {
+                    currency[i] = tolower((unsigned char)argv[2][i]);
+                }
+                currency[curr_len] = '\0';
+            }
+        }
+    }
+    
+    if (argc > 3 && strcmp(argv[2], "price") != 0) {
+        fprintf(stderr, "Error: Too many arguments\n");
+        print_usage(argv[0]);
+        if (currency) free(currency);
+        return 1;
+    }
+    
+    // Convert symbol to CoinGecko ID format
+    profile_begin(PROFILE_RESOLVE);
+    char *coin_id = symbol_to_id(symbol);
+    profile_end(PROFILE_RESOLVE);
+    if (!coin_id) {
+        display_error("Invalid symbol");
+        if (currency) free(currency);
+        return 1;
+    }
+    
+    // Serve from the local store when possible, otherwise fetch and store
+    // The planner picks one request that carries every field shown; stored
+    // quotes are shared by both views, so they are always fetched in full.
+    // --fields narrows the request (and the parse) to what it lists; such
+    // partial quotes are shown but not stored
+    unsigned fields = options.fields ? options.fields
+                    : show_price_only && !options.use_store ? PLAN_PRICE : PLAN_ALL;
+    quote_query_t query = { coin_id, symbol, currency ? currency : "usd", fields };
+    crypto_data_t crypto_data;
+    long stale_age = -1;
+    
+    profile_begin(PROFILE_STORE);
+    int stored = load_stored_quote(&options, &query, &crypto_data, &stale_age) == 0;
+    profile_end(PROFILE_STORE);
+    
+    if (!stored) {
+        // URL build, transfer and parsing are profiled by the providers
+        const char *error = NULL;
+        int result = fetch_quote(&options, &query, &crypto_data, &error);
+        if (result != PROVIDER_OK) {
+            profile_begin(PROFILE_STORE);
+            int expired = load_expired_quote(&options, &query, &crypto_data, &stale_age) == 0;
+            profile_end(PROFILE_STORE);
+            if (!expired) {
+                display_error(error);
+                if (result == PROVIDER_ERR_NOT_FOUND) {
+                    search_suggest(symbol);
+                }
+                free(coin_id);
+                if (currency) free(currency);
+                return 1;
+            }
+        } else if (options.use_store && fields == PLAN_ALL) {
+            profile_begin(PROFILE_STORE);
+            store_save_quote(&crypto_data);
+            profile_end(PROFILE_STORE);
+        }
+    }
+    
+    // Display data
+    profile_begin(PROFILE_RENDER);
+    int written = 0;
+    if (options.format != OUTPUT_TABLE) {
+        written = export_quote(stdout, options.format, &crypto_data,
+                               show_price_only && !options.fields ? PLAN_PRICE : fields);
+    } else if (show_price_only) {
+        display_price_only(&crypto_data);
+    } else {
+        display_selected_info(&crypto_data, fields);
+    }
+    
+    if (stale_age >= 0) {
+        display_stale_notice(stale_age);
+    }
+    fflush(stdout);
+    profile_end(PROFILE_RENDER);
+    
+    if (options.use_store) {
+        profile_begin(PROFILE_STORE);
+        record_usage(&options, &query);
+        profile_end(PROFILE_STORE);
+    }
+    
+    // Cleanup
+    free_crypto_data(&crypto_data);
+    free(coin_id);
+    if (currency) free(currency);
+    
+    if (written != 0) {
+        display_error("Failed to write output");
+        return 1;
+    }
+    return 0;
+}
+
@@ -0,0 +1,169 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include "../include/options.h"
+#include "../include/api.h"
+#include "../include/display.h"
+#include "../include/provider.h"
+#include "../include/planner.h"
+
+void options_defaults(cli_options_t *options) {
+    options->use_store = 1;
+    options->max_age = OPTIONS_DEFAULT_MAX_AGE;
+    options->stale_grace = OPTIONS_DEFAULT_STALE_GRACE;
+    options->provider = NULL;
+    options->race = 0;
+    options->format = OUTPUT_TABLE;
+    options->deadline_ms = 0;
+    options->profile = 0;
+    options->fields = 0;
+    options->parse_threads = 0;
+}
+
+// Parse a non-negative number of seconds
+static int parse_seconds(const char *name, const char *value, long *out) {
+    char *end = NULL;
+    long seconds = value ? strtol(value, &end, 10) : -1;
+    if (!value || !*value || *end != '\0' || seconds < 0) {
+        char message[128];
+        snprintf(message, sizeof(message), "%s expects a number of seconds", name);
+        display_error(message);
+        return -1;
+    }
+    *out = seconds;
+    return 0;
+}
+
+// Parse a duration: "800ms", "2s", "1.5s" or plain milliseconds
+static int parse_duration_ms(const char *name, const char *value, long *out) {
+    char *end = NULL;
+    double amount = value ? strtod(value, &end) : -1.0;
+    double scale = 1.0;
+    
+    if (value && end != value) {
+        if (strcmp(end, "s") == 0) {
+            scale = 1000.0;
+        } else if (strcmp(end, "ms") == 0 || *end == '\0') {
+            scale = 1.0;
+        } else {
+            amount = -1.0;
+        }
+    }
+    
+    double ms = amount * scale;
+    if (!value || end == value || !(ms >= 1.0) || ms > 86400000.0) {
+        char message[128];
+        snprintf(message, sizeof(message), "%s expects a duration such as 800ms or 2s", name);
+        display_error(message);
+        return -1;
+    }
+    *out = (long)ms;
+    return 0;
+}
+
+int options_extract(int *argc, char *argv[], cli_options_t *options) {
+    options_defaults(options);
+    
+    int out = 1;
+    for (int i = 1; i < *argc; i++) {
+        const char *arg = argv[i];
+        
+        if (strcmp(arg, "--no-cache") == 0) {
+            options->use_store = 0;
+        } else if (strcmp(arg, "--max-age") == 0) {
+            if (parse_seconds(arg, i + 1 < *argc ? argv[i + 1] : NULL, &options->max_age) != 0) {
+                return -1;
+            }
+            i++;
+        } else if (strcmp(arg, "--stale") == 0) {
+            if (parse_seconds(arg, i + 1 < *argc ? argv[i + 1] : NULL, &options->stale_grace) != 0) {
+                return -1;
+            }
+            i++;
+        } else if (strcmp(arg, "--race") == 0) {
+            options->race = 1;
+        } else if (strcmp(arg, "--provider") == 0) {
+            const char *name = i + 1 < *argc ? argv[i + 1] : NULL;
+            if (!name || (strcmp(name, "auto") != 0 && !provider_find(name))) {
+                display_error("--provider expects auto, coingecko or cryptocompare");
+                return -1;
+            }
+            options->provider = strcmp(name, "auto") == 0 ? NULL : name;
+            i++;
+        } else if (strcmp(arg, "--deadline") == 0) {
+            if (parse_duration_ms(arg, i + 1 < *argc ? argv[i + 1] : NULL, &options->deadline_ms) != 0) {
+                return -1;
+            }
+            i++;
+        } else if (strcmp(arg, "--profile") == 0) {
+            options->profile = 1;
+        } else if (strcmp(arg, "--format") == 0) {
+            if (output_parse_format(i + 1 < *argc ? argv[i + 1] : NULL, &options->format) != 0) {
+                display_error("--format expects table, csv, json, arrow or feather");
+                return -1;
+            }
+            // Binary output would only garble the terminal
+            if (OUTPUT_IS_BINARY(options->format) && isatty(STDOUT_FILENO)) {
+                display_error("Arrow output is binary; redirect it to a file or pipe");
+                return -1;
+            }
+            i++;
+        } else if (strcmp(arg, "--parse-threads") == 0) {
+            const char *value = i + 1 < *argc ? argv[i + 1] : NULL;
+            char *end = NULL;
+            long threads = value ? strtol(value, &end, 10) : -1;
+            if (!value || !*value || *end != '\0' || threads < 0 || threads > 64) {
+                display_error("--parse-threads expects a number from 0 (one per CPU) to 64");
+                return -1;
+            }
+            options->parse_threads = (int)threads;
+            i++;
+        } else if (strcmp(arg, "--fields") == 0) {
+            if (planner_parse_fields(i + 1 < *argc ? argv[i + 1] : NULL, &options->fields) != 0) {
+                display_error("--fields expects names such as price,change_24h,market_cap");
+                return -1;
+            }
+            i++;
+        } else {
+            argv[out++] = argv[i];
+        }
+    }
+    
+    // Recorded responses are not market data: keep them out of the cache
+    if (api_replay_enabled()) {
+        options->use_store = 0;
+    }
+    
+    argv[out] = NULL;
+    *argc = out;
+    return 0;
+}
+
+int options_parse_currency(const char *code, char *out, size_t size) {
+    size_t len = strlen(code);
+    int valid = len > 0 && len < size;
+    for (size_t c = 0; valid && c < len; c++) {
+        valid = isalpha((unsigned char)code[c]) != 0;
+    }
+    if (!valid) {
+        display_error("Invalid currency code");
+        return -1;
+    }
+    for (size_t c = 0; c <= len; c++) {
+        out[c] = (char)tolower((unsigned char)code[c]);
+    }
+    return 0;
+}
+
+int options_valid_days(const char *days) {
+    if (strcmp(days, "max") == 0) {
+        return 1;
+    }
+    char *end = NULL;
+    long value = strtol(days, &end, 10);
+    return end != days && *end == '\0' && value > 0 && value <= 100000;
+}
@@ -0,0 +1,354 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../include/output.h"
+#include "../include/arrow.h"
+
+#define OUTPUT_BATCH_CELLS (64 * 1024)   // Cells buffered per Arrow record batch
+
+/**
+ * @brief Rows buffered for the Arrow formats, column-major
+ */
+struct output_columns {
+    arrow_writer_t writer;
+    arrow_field_t *fields;
+    arrow_column_t *sources;
+    int *typed;           // Column type fixed by a first cell
+    double *numbers;      // numbers[column * capacity + row]
+    char **strings;       // strings[column * capacity + row] (owned)
+    int capacity;         // Rows per batch
+    int rows;             // Rows buffered
+    int started;          // Schema written
+    int failed;
+};
+
+int output_parse_format(const char *name, output_format_t *format) {
+    if (!name || !format) {
+        return -1;
+    }
+    if (strcmp(name, "table") == 0) {
+        *format = OUTPUT_TABLE;
+    } else if (strcmp(name, "csv") == 0) {
+        *format = OUTPUT_CSV;
+    } else if (strcmp(name, "json") == 0) {
+        *format = OUTPUT_JSON;
+    } else if (strcmp(name, "arrow") == 0) {
+        *format = OUTPUT_ARROW;
+    } else if (strcmp(name, "feather") == 0) {
+        *format = OUTPUT_FEATHER;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static void write_csv_field(FILE *fp, const char *value) {
+    if (!strpbrk(value, ",\"\r\n")) {
+        fputs(value, fp);
+        return;
+    }
+    fputc('"', fp);
+    for (const char *p = value; *p; p++) {
+        if (*p == '"') {
+            fputc('"', fp);
+        }
+        fputc(*p, fp);
+    }
+    fputc('"', fp);
+}
+
+static void write_json_string(FILE *fp, const char *value) {
+    fputc('"', fp);
+    for (const unsigned char *p = (const unsigned char *)value; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', fp);
+            fputc(*p, fp);
+        } else if (*p < 0x20) {
+            fprintf(fp, "\\u%04x", *p);
+        } else {
+            fputc(*p, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+static struct output_columns *batch_new(int column_count) {
+    struct output_columns *batch = calloc(1, sizeof(*batch));
+    if (!batch) {
+        return NULL;
+    }
+    int columns = column_count > 0 ? column_count : 1;
+    batch->capacity = OUTPUT_BATCH_CELLS / columns > 0 ? OUTPUT_BATCH_CELLS / columns : 1;
+    size_t cells = (size_t)batch->capacity * (size_t)columns;
+    batch->fields = calloc((size_t)columns, sizeof(arrow_field_t));
+    batch->sources = calloc((size_t)columns, sizeof(arrow_column_t));
+    batch->typed = calloc((size_t)columns, sizeof(int));
+    batch->numbers = malloc(cells * sizeof(double));
+    batch->strings = calloc(cells, sizeof(char *));
+    if (!batch->fields || !batch->sources || !batch->typed || !batch->numbers || !batch->strings) {
+        free(batch->fields);
+        free(batch->sources);
+        free(batch->typed);
+        free(batch->numbers);
+        free(batch->strings);
+        free(batch);
+        return NULL;
+    }
+    return batch;
+}
+
+// Write the buffered rows as one record batch (the schema first, once)
+static void batch_flush(output_t *out) {
+    struct output_columns *batch = out->batch;
+    if (!batch->started) {
+        for (int c = 0; c < out->column_count; c++) {
+            batch->fields[c].name = out->columns[c];
+            if (!batch->typed[c]) {
+                batch->fields[c].type = ARROW_UTF8;
+            }
+        }
+        batch->started = 1;
+        if (arrow_begin(&batch->writer, out->fp, out->format == OUTPUT_FEATHER,
+                        batch->fields, out->column_count) != 0) {
+            batch->failed = 1;
+        }
+    }
+    if (batch->rows == 0) {
+        return;
+    }
+
+    for (int c = 0; c < out->column_count; c++) {
+        size_t first = (size_t)c * (size_t)batch->capacity;
+        batch->sources[c] = batch->fields[c].type == ARROW_FLOAT64
+            ? ARROW_ARRAY(batch->numbers + first)
+            : ARROW_ARRAY(batch->strings + first);
+    }
+    if (!batch->failed && arrow_write_batch(&batch->writer, batch->sources, batch->rows) != 0) {
+        batch->failed = 1;
+    }
+
+    size_t cells = (size_t)batch->capacity * (size_t)out->column_count;
+    for (size_t i = 0; i < cells; i++) {
+        free(batch->strings[i]);
+        batch->strings[i] = NULL;
+    }
+    batch->rows = 0;
+}
+
+static void batch_free(struct output_columns *batch) {
+    free(batch->fields);
+    free(batch->sources);
+    free(batch->typed);
+    free(batch->numbers);
+    free(batch->strings);
+    free(batch);
+}
+
+// Cell of the current row, typing the column on first use
+static void batch_cell(output_t *out, const char *text, double number, int is_number) {
+    struct output_columns *batch = out->batch;
+    int c = out->column;
+    if (!batch || c >= out->column_count) {
+        return;
+    }
+    if (!batch->typed[c]) {
+        batch->fields[c].type = is_number ? ARROW_FLOAT64 : ARROW_UTF8;
+        batch->typed[c] = 1;
+    }
+
+    size_t cell = (size_t)c * (size_t)batch->capacity + (size_t)batch->rows;
+    if (batch->fields[c].type == ARROW_FLOAT64) {
+        batch->numbers[cell] = is_number ? number : NAN;
+        if (!is_number && text) {
+            char *end = NULL;
+            double parsed = strtod(text, &end);
+            if (end != text && *end == '\0') {
+                batch->numbers[cell] = parsed;
+            }
+        }
+    } else if (is_number) {
+        char formatted[32];
+        if (isfinite(number)) {
+            snprintf(formatted, sizeof(formatted), "%.10g", number);
+            batch->strings[cell] = strdup(formatted);
+        }
+    } else {
+        batch->strings[cell] = strdup(text);
+    }
+}
+
+void output_begin(output_t *out, FILE *fp, output_format_t format,
+                  const char *const *columns, int column_count, int width) {
+    out->fp = fp;
+    out->format = format;
+    out->columns = columns;
+    out->column_count = column_count;
+    out->width = width > 0 ? width : 14;
+    out->column = 0;
+    out->rows = 0;
+    out->batch = NULL;
+
+    switch (format) {
+    case OUTPUT_TABLE:
+        for (int c = 0; c < column_count; c++) {
+            // First column is a label, left-aligned; the rest are numbers
+            fprintf(fp, c == 0 ? "%-*s" : " %*s", out->width, columns[c]);
+        }
+        fputc('\n', fp);
+        for (int c = 0; c < column_count; c++) {
+            if (c > 0) {
+                fputc(' ', fp);
+            }
+            for (int i = 0; i < out->width; i++) {
+                fputc('-', fp);
+            }
+        }
+        fputc('\n', fp);
+        break;
+    case OUTPUT_CSV:
+        for (int c = 0; c < column_count; c++) {
+            if (c > 0) {
+                fputc(',', fp);
+            }
+            write_csv_field(fp, columns[c]);
+        }
+        fputc('\n', fp);
+        break;
+    case OUTPUT_JSON:
+        fputc('[', fp);
+        break;
+    case OUTPUT_ARROW:
+    case OUTPUT_FEATHER:
+        // The schema waits for the first row, which gives the column types
+        out->batch = batch_new(column_count);
+        break;
+    }
+}
+
+void output_row_begin(output_t *out) {
+    out->column = 0;
+    if (out->format == OUTPUT_JSON) {
+        fputs(out->rows > 0 ? ",\n  {" : "\n  {", out->fp);
+    } else if (out->batch) {
+        // Cells left unwritten are nulls
+        struct output_columns *batch = out->batch;
+        for (int c = 0; c < out->column_count; c++) {
+            batch->numbers[(size_t)c * (size_t)batch->capacity + (size_t)batch->rows] = NAN;
+        }
+    }
+}
+
+// Separator and (for JSON) key before the next cell
+static void begin_cell(output_t *out) {
+    int c = out->column;
+    switch (out->format) {
+    case OUTPUT_TABLE:
+        if (c > 0) {
+            fputc(' ', out->fp);
+        }
+        break;
+    case OUTPUT_CSV:
+        if (c > 0) {
+            fputc(',', out->fp);
+        }
+        break;
+    case OUTPUT_JSON:
+        if (c > 0) {
+            fputs(", ", out->fp);
+        }
+        write_json_string(out->fp, c < out->column_count ? out->columns[c] : "");
+        fputs(": ", out->fp);
+        break;
+    case OUTPUT_ARROW:
+    case OUTPUT_FEATHER:
+        break;
+    }
+}
+
+void output_string(output_t *out, const char *value) {
+    if (!value) {
+        value = "";
+    }
+    begin_cell(out);
+    switch (out->format) {
+    case OUTPUT_TABLE:
+        fprintf(out->fp, out->column == 0 ? "%-*s" : "%*s", out->width, value);
+        break;
+    case OUTPUT_CSV:
+        write_csv_field(out->fp, value);
+        break;
+    case OUTPUT_JSON:
+        write_json_string(out->fp, value);
+        break;
+    case OUTPUT_ARROW:
+    case OUTPUT_FEATHER:
+        batch_cell(out, value, 0.0, 0);
+        break;
+    }
+    out->column++;
+}
+
+void output_number(output_t *out, double value) {
+    begin_cell(out);
+    int finite = isfinite(value);
+    switch (out->format) {
+    case OUTPUT_TABLE:
+        if (finite) {
+            fprintf(out->fp, "%*.*g", out->width, out->width - 6, value);
+        } else {
+            fprintf(out->fp, "%*s", out->width, "-");
+        }
+        break;
+    case OUTPUT_CSV:
+        if (finite) {
+            fprintf(out->fp, "%.10g", value);
+        }
+        break;
+    case OUTPUT_JSON:
+        if (finite) {
+            fprintf(out->fp, "%.10g", value);
+        } else {
+            fputs("null", out->fp);
+        }
+        break;
+    case OUTPUT_ARROW:
+    case OUTPUT_FEATHER:
+        batch_cell(out, NULL, value, 1);
+        break;
+    }
+    out->column++;
+}
+
+void output_row_end(output_t *out) {
+    out->rows++;
+    if (OUTPUT_IS_BINARY(out->format)) {
+        if (out->batch && ++out->batch->rows == out->batch->capacity) {
+            batch_flush(out);
+        }
+        return;
+    }
+    fputs(out->format == OUTPUT_JSON ? "}" : "\n", out->fp);
+}
+
+int output_end(output_t *out) {
+    if (out->format == OUTPUT_JSON) {
+        fputs(out->rows > 0 ? "\n]\n" : "]\n", out->fp);
+    }
+    if (OUTPUT_IS_BINARY(out->format)) {
+        if (!out->batch) {
+            return -1;
+        }
+        batch_flush(out);
+        int failed = out->batch->failed;
+        if (out->batch->started && arrow_end(&out->batch->writer) != 0) {
+            failed = 1;
+        }
+        batch_free(out->batch);
+        out->batch = NULL;
+        return failed ? -1 : 0;
+    }
+    return fflush(out->fp) == 0 && !ferror(out->fp) ? 0 : -1;
+}
@@ -1,469 +1,1133 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <strings.h>  // For strcasecmp (POSIX)
-#include <ctype.h>
-#include <time.h>
-#include <cjson/cJSON.h>
-#include "../include/parser.h"
-
-// Mapping of common symbols to CoinGecko IDs
-static const struct {
-    const char *symbol;
-    const char *coingecko_id;
-} symbol_map[] = {
-    {"BTC", "bitcoin"},
-    {"ETH", "ethereum"},
-    {"BNB", "binancecoin"},
-    {"SOL", "solana"},
-    {"ADA", "cardano"},
-    {"XRP", "ripple"},
-    {"DOT", "polkadot"},
-    {"DOGE", "dogecoin"},
-    {"AVAX", "avalanche-2"},
-    {"MATIC", "matic-network"},
-    {"LINK", "chainlink"},
-    {"UNI", "uniswap"},
-    {"LTC", "litecoin"},
-    {"ATOM", "cosmos"},
-    {"ETC", "ethereum-classic"},
-    {"XLM", "stellar"},
-    {"ALGO", "algorand"},
-    {"FIL", "filecoin"},
-    {"TRX", "tron"},
-    {"VET", "vechain"},
-    {"ICP", "internet-computer"},
-    {"THETA", "theta-token"},
-    {"EOS", "eos"},
-    {"AAVE", "aave"},
-    {"MKR", "maker"},
-    {"SUSHI", "sushi"},
-    {NULL, NULL}
-};
-
-char *symbol_to_id(const char *symbol) {
-    if (!symbol) {
-        return NULL;
-    }
-    
-    // Check symbol map first
-    for (int i = 0; symbol_map[i].symbol != NULL; i++) {
-        if (strcasecmp(symbol, symbol_map[i].symbol) == 0) {
-            size_t len = strlen(symbol_map[i].coingecko_id);
-            char *id = malloc(len + 1);
-            if (id) {
-                strncpy(id, symbol_map[i].coingecko_id, len);
-                id[len] = '\0';
-            }
-            return id;
-        }
-    }
-    
-    // Convert to lowercase for direct CoinGecko ID match
-    size_t len = strlen(symbol);
-    char *id = malloc(len + 1);
-    if (!id) {
-        return NULL;
-    }
-    
-    for (size_t i = 0; i < len; i++) {
-        id[i] = tolower((unsigned char)symbol[i]);
-    }
-    id[len] = '\0';
-    
-    return id;
-}
-
-crypto_data_t parse_crypto_json(const char *json_string) {
-    return parse_crypto_json_with_currency(json_string, "usd");
-}
-
-crypto_data_t parse_crypto_json_with_currency(const char *json_string, const char *currency) {
-    crypto_data_t data = {0};
-    data.success = 0;
-    
-    if (!json_string) {
-        return data;
-    }
-    
-    const char *curr = currency ? currency : "usd";
-    
-    // Store currency code
-    size_t curr_len = strlen(curr);
-    data.currency = malloc(curr_len + 1);
-    if (data.currency) {
-        strncpy(data.currency, curr, curr_len);
-        data.currency[curr_len] = '\0';
-    }
-    
-    cJSON *json = cJSON_Parse(json_string);
-    if (!json) {
-        return data;
-    }
-    
-    // Get first (and typically only) key in the response
-    cJSON *item = json->child;
-    if (!item) {
-        cJSON_Delete(json);
-        return data;
-    }
-    
-    // Extract coin ID
-    if (item->string) {
-        size_t id_len = strlen(item->string);
-        data.id = malloc(id_len + 1);
-        if (data.id) {
-            strncpy(data.id, item->string, id_len);
-            data.id[id_len] = '\0';
-        }
-    }
-    
-    // Build currency field names dynamically
-    char price_field[32];
-    char change_field[32];
-    char mcap_field[32];
-    char volume_field[32];
-    
-    snprintf(price_field, sizeof(price_field), "%s", curr);
-    snprintf(change_field, sizeof(change_field), "%s_24h_change", curr);
-    snprintf(mcap_field, sizeof(mcap_field), "%s_market_cap", curr);
-    snprintf(volume_field, sizeof(volume_field), "%s_24h_vol", curr);
-    
-    // Parse price data
-    cJSON *price = cJSON_GetObjectItem(item, price_field);
-    if (cJSON_IsNumber(price)) {
-        data.current_price = price->valuedouble;
-    }
-    
-    // Parse price change 24h
-    cJSON *change_24h = cJSON_GetObjectItem(item, change_field);
-    if (cJSON_IsNumber(change_24h)) {
-        data.price_change_24h = change_24h->valuedouble;
-        data.price_change_percentage_24h = change_24h->valuedouble;
-    }
-    
-    // Parse market cap
-    cJSON *market_cap = cJSON_GetObjectItem(item, mcap_field);
-    if (cJSON_IsNumber(market_cap)) {
-        data.market_cap = market_cap->valuedouble;
-    }
-    
-    // Parse 24h volume
-    cJSON *volume_24h = cJSON_GetObjectItem(item, volume_field);
-    if (cJSON_IsNumber(volume_24h)) {
-        data.volume_24h = volume_24h->valuedouble;
-    }
-    
-    // Parse last updated timestamp
-    cJSON *last_updated = cJSON_GetObjectItem(item, "last_updated_at");
-    if (cJSON_IsNumber(last_updated)) {
-        data.last_updated_at = (long)last_updated->valuedouble;
-    }
-    
-    // Extract symbol and name from ID
-    if (data.id && strlen(data.id) > 0) {
-        size_t id_len = strlen(data.id);
-        
-        // Create symbol (uppercase version, but handle special cases)
-        // Check if we have a mapping for this ID
-        const char *mapped_symbol = NULL;
-        for (int i = 0; symbol_map[i].symbol != NULL; i++) {
-            if (strcmp(data.id, symbol_map[i].coingecko_id) == 0) {
-                mapped_symbol = symbol_map[i].symbol;
-                break;
-            }
-        }
-        
-        if (mapped_symbol) {
-            size_t sym_len = strlen(mapped_symbol);
-            data.symbol = malloc(sym_len + 1);
-            if (data.symbol) {
-                strncpy(data.symbol, mapped_symbol, sym_len);
-                data.symbol[sym_len] = '\0';
-            }
-        } else {
-            // Convert to uppercase
-            data.symbol = malloc(id_len + 1);
-            if (data.symbol) {
-                for (size_t i = 0; i < id_len; i++) {
-                    data.symbol[i] = toupper((unsigned char)data.id[i]);
-                }
-                data.symbol[id_len] = '\0';
-            }
-        }
-        
-        // Create name from ID (capitalize first letter and replace hyphens with spaces)
-        data.name = malloc(id_len * 2 + 1); // Extra space for potential replacements
-        if (data.name) {
-            size_t j = 0;
-            int capitalize_next = 1;
-            for (size_t i = 0; i < id_len; i++) {
-                if (data.id[i] == '-' || data.id[i] == '_') {
-                    data.name[j++] = ' ';
-                    capitalize_next = 1;
-                } else if (capitalize_next) {
-                    data.name[j++] = toupper((unsigned char)data.id[i]);
-                    capitalize_next = 0;
-                } else {
-                    data.name[j++] = data.id[i];
-                }
-            }
-            data.name[j] = '\0';
-        }
-    }
-    
-    // High/Low not available in simple/price endpoint
-    data.high_24h = 0.0;
-    data.low_24h = 0.0;
-    
-    data.success = 1;
-    cJSON_Delete(json);
-    
-    return data;
-}
-
-void free_crypto_data(crypto_data_t *data) {
-    if (!data) {
-        return;
-    }
-    
-    if (data->id) {
-        free(data->id);
-        data->id = NULL;
-    }
-    
-    if (data->symbol) {
-        free(data->symbol);
-        data->symbol = NULL;
-    }
-    
-    if (data->name) {
-        free(data->name);
-        data->name = NULL;
-    }
-    
-    if (data->currency) {
-        free(data->currency);
-        data->currency = NULL;
-    }
-}
-
-int parse_ohlc_json(const char *json_string, crypto_data_t *data) {
-    if (!json_string || !data) {
-        return -1;
-    }
-    
-    cJSON *json = cJSON_Parse(json_string);
-    if (!json) {
-        return -1;
-    }
-    
-    // OHLC response is an array of arrays: [[timestamp, open, high, low, close], ...]
-    if (!cJSON_IsArray(json)) {
-        cJSON_Delete(json);
-        return -1;
-    }
-    
-    double max_high = 0.0;
-    double min_low = 0.0;
-    int first_item = 1;
-    
-    cJSON *item = NULL;
-    cJSON_ArrayForEach(item, json) {
-        if (!cJSON_IsArray(item)) {
-            continue;
-        }
-        
-        // Each item is [timestamp, open, high, low, close]
-        // Need at least 5 elements
-        if (cJSON_GetArraySize(item) < 5) {
-            continue;
-        }
-        
-        cJSON *high_item = cJSON_GetArrayItem(item, 2); // high (index 2)
-        cJSON *low_item = cJSON_GetArrayItem(item, 3);  // low (index 3)
-        
-        if (!cJSON_IsNumber(high_item) || !cJSON_IsNumber(low_item)) {
-            continue;
-        }
-        
-        double high = high_item->valuedouble;
-        double low = low_item->valuedouble;
-        
-        if (first_item) {
-            max_high = high;
-            min_low = low;
-            first_item = 0;
-        } else {
-            if (high > max_high) {
-                max_high = high;
-            }
-            if (low < min_low) {
-                min_low = low;
-            }
-        }
-    }
-    
-    if (!first_item) {
-        data->high_24h = max_high;
-        data->low_24h = min_low;
-    }
-    
-    cJSON_Delete(json);
-    return 0;
-}
-
-markets_data_t parse_markets_json(const char *json_string, int limit) {
-    markets_data_t markets = {0};
-    markets.success = 0;
-    markets.count = 0;
-    markets.coins = NULL;
-    
-    if (!json_string || limit <= 0) {
-        return markets;
-    }
-    
-    cJSON *json = cJSON_Parse(json_string);
-    if (!json) {
-        return markets;
-    }
-    
-    // Markets response is an array of coin objects
-    if (!cJSON_IsArray(json)) {
-        cJSON_Delete(json);
-        return markets;
-    }
-    
-    int array_size = cJSON_GetArraySize(json);
-    int actual_limit = (array_size < limit) ? array_size : limit;
-    
-    markets.coins = malloc(sizeof(crypto_data_t) * actual_limit);
-    if (!markets.coins) {
-        cJSON_Delete(json);
-        return markets;
-    }
-    
-    // Initialize all coins
-    for (int i = 0; i < actual_limit; i++) {
-        markets.coins[i] = (crypto_data_t){0};
-        markets.coins[i].success = 0;
-    }
-    
-    cJSON *item = NULL;
-    int index = 0;
-    cJSON_ArrayForEach(item, json) {
-        if (index >= actual_limit) {
-            break;
-        }
-        
-        if (!cJSON_IsObject(item)) {
-            continue;
-        }
-        
-        crypto_data_t *coin = &markets.coins[index];
-        
-        // Parse id
-        cJSON *id_item = cJSON_GetObjectItem(item, "id");
-        if (cJSON_IsString(id_item)) {
-            size_t id_len = strlen(id_item->valuestring);
-            coin->id = malloc(id_len + 1);
-            if (coin->id) {
-                strncpy(coin->id, id_item->valuestring, id_len);
-                coin->id[id_len] = '\0';
-            }
-        }
-        
-        // Parse symbol
-        cJSON *symbol_item = cJSON_GetObjectItem(item, "symbol");
-        if (cJSON_IsString(symbol_item)) {
-            size_t sym_len = strlen(symbol_item->valuestring);
-            coin->symbol = malloc(sym_len + 1);
-            if (coin->symbol) {
-                strncpy(coin->symbol, symbol_item->valuestring, sym_len);
-                coin->symbol[sym_len] = '\0';
-            }
-        }
-        
-        // Parse name
-        cJSON *name_item = cJSON_GetObjectItem(item, "name");
-        if (cJSON_IsString(name_item)) {
-            size_t name_len = strlen(name_item->valuestring);
-            coin->name = malloc(name_len + 1);
-            if (coin->name) {
-                strncpy(coin->name, name_item->valuestring, name_len);
-                coin->name[name_len] = '\0';
-            }
-        }
-        
-        // Parse current_price
-        cJSON *price_item = cJSON_GetObjectItem(item, "current_price");
-        if (cJSON_IsNumber(price_item)) {
-            coin->current_price = price_item->valuedouble;
-        }
-        
-        // Parse market_cap
-        cJSON *market_cap_item = cJSON_GetObjectItem(item, "market_cap");
-        if (cJSON_IsNumber(market_cap_item)) {
-            coin->market_cap = market_cap_item->valuedouble;
-        }
-        
-        // Parse total_volume (24h volume)
-        cJSON *volume_item = cJSON_GetObjectItem(item, "total_volume");
-        if (cJSON_IsNumber(volume_item)) {
-            coin->volume_24h = volume_item->valuedouble;
-        }
-        
-        // Parse price_change_percentage_24h
-        cJSON *change_pct_item = cJSON_GetObjectItem(item, "price_change_percentage_24h");
-        if (cJSON_IsNumber(change_pct_item)) {
-            coin->price_change_percentage_24h = change_pct_item->valuedouble;
-            // Calculate absolute change from percentage
-            coin->price_change_24h = coin->current_price * (coin->price_change_percentage_24h / 100.0);
-        }
-        
-        // Parse high_24h
-        cJSON *high_item = cJSON_GetObjectItem(item, "high_24h");
-        if (cJSON_IsNumber(high_item)) {
-            coin->high_24h = high_item->valuedouble;
-        }
-        
-        // Parse low_24h
-        cJSON *low_item = cJSON_GetObjectItem(item, "low_24h");
-        if (cJSON_IsNumber(low_item)) {
-            coin->low_24h = low_item->valuedouble;
-        }
-        
-        // Parse last_updated
-        cJSON *updated_item = cJSON_GetObjectItem(item, "last_updated");
-        if (cJSON_IsString(updated_item)) {
-            // Parse ISO 8601 timestamp (simplified - just mark as updated)
-            coin->last_updated_at = time(NULL);
-        }
-        
-        coin->success = 1;
-        index++;
-    }
-    
-    markets.count = index;
-    markets.success = 1;
-    
-    cJSON_Delete(json);
-    return markets;
-}
-
-void free_markets_data(markets_data_t *data) {
-    if (!data) {
-        return;
-    }
-    
-    if (data->coins) {
-        for (int i = 0; i < data->count; i++) {
-            free_crypto_data(&data->coins[i]);
-        }
-        free(data->coins);
-        data->coins = NULL;
-    }
-    
-    data->count = 0;
-    data->success = 0;
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>  // For strcasecmp (POSIX)
+#include <ctype.h>
+#include <time.h>
+#include <math.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <cjson/cJSON.h>
+#include "../include/parser.h"
+#include "../include/intern.h"
+#include "../include/planner.h"
+#include "../include/jsonsplit.h"
+
+// Mapping of common symbols to CoinGecko IDs
+static const struct {
+    const char *symbol;
+    const char *coingecko_id;
+} symbol_map[] = {
+    {"BTC", "bitcoin"},
+    {"ETH", "ethereum"},
+    {"BNB", "binancecoin"},
+    {"SOL", "solana"},
+    {"ADA", "cardano"},
+    {"XRP", "ripple"},
+    {"DOT", "polkadot"},
+    {"DOGE", "dogecoin"},
+    {"AVAX", "avalanche-2"},
+    {"MATIC", "matic-network"},
+    {"LINK", "chainlink"},
+    {"UNI", "uniswap"},
+    {"LTC", "litecoin"},
+    {"ATOM", "cosmos"},
+    {"ETC", "ethereum-classic"},
+    {"XLM", "stellar"},
+    {"ALGO", "algorand"},
+    {"FIL", "filecoin"},
+    {"TRX", "tron"},
+    {"VET", "vechain"},
+    {"ICP", "internet-computer"},
+    {"THETA", "theta-token"},
+    {"EOS", "eos"},
+    {"AAVE", "aave"},
+    {"MKR", "maker"},
+    {"SUSHI", "sushi"},
+    {"USDT", "tether"},
+    {"USDC", "usd-coin"},
+    {NULL, NULL}
+};
+
+char *symbol_to_id(const char *symbol) {
+    if (!symbol) {
+        return NULL;
+    }
+    
+    // Check symbol map first
+    for (int i = 0; symbol_map[i].symbol != NULL; i++) {
+        if (strcasecmp(symbol, symbol_map[i].symbol) == 0) {
+            size_t len = strlen(symbol_map[i].coingecko_id);
+            char *id = malloc(len + 1);
+            if (id) {
+                strncpy(id, symbol_map[i].coingecko_id, len);
+                id[len] = '\0';
+            }
+            return id;
+        }
+    }
+    
+    // Convert to lowercase for direct CoinGecko ID match
+    size_t len = strlen(symbol);
+    char *id = malloc(len + 1);
+    if (!id) {
+        return NULL;
+    }
+    
+    for (size_t i = 0; i < len; i++) {
+        id[i] = tolower((unsigned char)symbol[i]);
+    }
+    id[len] = '\0';
+    
+    return id;
+}
+
+static int use_interning = 0;
+
+void parser_set_interning(int enabled) {
+    use_interning = enabled != 0;
+}
+
+static int parse_threads = 0;
+
+void parser_set_threads(int threads) {
+    parse_threads = threads > 0 ? threads : 0;
+}
+
+// Threads to parse a response of length bytes with; 1 = the serial parser
+static int threads_for(size_t length) {
+    if (parse_threads == 1 || length < PARSER_PARALLEL_MIN_BYTES) {
+        return 1;
+    }
+    if (parse_threads > 1) {
+        return parse_threads;
+    }
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 1 ? (int)cpus : 1;
+}
+
+// Copy a string into a field of data: the interned copy if data is interned, else malloc'd
+static char *copy_field(const crypto_data_t *data, const char *s, size_t len) {
+    if (data->interned) {
+        return (char *)intern_n(s, len);
+    }
+    char *copy = malloc(len + 1);
+    if (copy) {
+        memcpy(copy, s, len);
+        copy[len] = '\0';
+    }
+    return copy;
+}
+
+crypto_data_t parse_crypto_json(const char *json_string) {
+    return parse_crypto_json_with_currency(json_string, "usd");
+}
+
+// Fill symbol and name from the CoinGecko ID ("avalanche-2" -> "AVAX", "Avalanche 2")
+static void derive_symbol_and_name(crypto_data_t *data) {
+    if (data->id && strlen(data->id) > 0) {
+        size_t id_len = strlen(data->id);
+        
+        // Create symbol (uppercase version, but handle special cases)
+        // Check if we have a mapping for this ID
+        const char *mapped_symbol = NULL;
+        for (int i = 0; symbol_map[i].symbol != NULL; i++) {
+            if (strcmp(data->id, symbol_map[i].coingecko_id) == 0) {
+                mapped_symbol = symbol_map[i].symbol;
+                break;
+            }
+        }
+        
+        if (mapped_symbol) {
+            data->symbol = copy_field(data, mapped_symbol, strlen(mapped_symbol));
+        }
+        
+        // Built on the stack for typical IDs so interned parses allocate nothing
+        char stack_buffer[128];
+        char *buffer = id_len + 1 <= sizeof(stack_buffer) ? stack_buffer : malloc(id_len + 1);
+        if (!buffer) {
+            return;
+        }
+        
+        if (!mapped_symbol) {
+            // Convert to uppercase
+            for (size_t i = 0; i < id_len; i++) {
+                buffer[i] = toupper((unsigned char)data->id[i]);
+            }
+            data->symbol = copy_field(data, buffer, id_len);
+        }
+        
+        // Create name from ID (capitalize first letter and replace hyphens with spaces)
+        size_t j = 0;
+        int capitalize_next = 1;
+        for (size_t i = 0; i < id_len; i++) {
+            if (data->id[i] == '-' || data->id[i] == '_') {
+                buffer[j++] = ' ';
+                capitalize_next = 1;
+            } else if (capitalize_next) {
+                buffer[j++] = toupper((unsigned char)data->id[i]);
+                capitalize_next = 0;
+            } else {
+                buffer[j++] = data->id[i];
+            }
+        }
+        data->name = copy_field(data, buffer, j);
+        
+        if (buffer != stack_buffer) {
+            free(buffer);
+        }
+    }
+}
+
+// Fill the requested fields of one coin from a simple/price entry ({"bitcoin": {"usd": ..., ...}})
+static void parse_simple_price_item(const cJSON *item, const char *curr, unsigned fields,
+                                    crypto_data_t *data) {
+    data->interned = use_interning;
+    
+    // Store currency code
+    data->currency = copy_field(data, curr, strlen(curr));
+    
+    // Extract coin ID
+    if (item->string) {
+        data->id = copy_field(data, item->string, strlen(item->string));
+    }
+    
+    // Keys are "<currency>", "<currency>_24h_change", ...; unrequested ones are never looked up
+    char key[32];
+    
+    // Parse price data
+    if (fields & PLAN_PRICE) {
+        snprintf(key, sizeof(key), "%s", curr);
+        cJSON *price = cJSON_GetObjectItem(item, key);
+        if (cJSON_IsNumber(price)) {
+            data->current_price = price->valuedouble;
+        }
+    }
+    
+    // Parse price change 24h
+    if (fields & PLAN_CHANGE_24H) {
+        snprintf(key, sizeof(key), "%s_24h_change", curr);
+        cJSON *change_24h = cJSON_GetObjectItem(item, key);
+        if (cJSON_IsNumber(change_24h)) {
+            data->price_change_24h = change_24h->valuedouble;
+            data->price_change_percentage_24h = change_24h->valuedouble;
+        }
+    }
+    
+    // Parse market cap
+    if (fields & PLAN_MARKET_CAP) {
+        snprintf(key, sizeof(key), "%s_market_cap", curr);
+        cJSON *market_cap = cJSON_GetObjectItem(item, key);
+        if (cJSON_IsNumber(market_cap)) {
+            data->market_cap = market_cap->valuedouble;
+        }
+    }
+    
+    // Parse 24h volume
+    if (fields & PLAN_VOLUME_24H) {
+        snprintf(key, sizeof(key), "%s_24h_vol", curr);
+        cJSON *volume_24h = cJSON_GetObjectItem(item, key);
+        if (cJSON_IsNumber(volume_24h)) {
+            data->volume_24h = volume_24h->valuedouble;
+        }
+    }
+    
+    // Parse last updated timestamp
+    if (fields & PLAN_LAST_UPDATED) {
+        cJSON *last_updated = cJSON_GetObjectItem(item, "last_updated_at");
+        if (cJSON_IsNumber(last_updated)) {
+            data->last_updated_at = (long)last_updated->valuedouble;
+        }
+    }
+    
+    // Symbol and name cost two string allocations per coin
+    if (fields & PLAN_NAME) {
+        derive_symbol_and_name(data);
+    }
+    
+    // High/Low not available in simple/price endpoint
+    data->high_24h = 0.0;
+    data->low_24h = 0.0;
+    
+    data->success = 1;
+}
+
+char *symbol_to_ticker(const char *symbol) {
+    if (!symbol) {
+        return NULL;
+    }
+    
+    const char *ticker = symbol;
+    for (int i = 0; symbol_map[i].symbol != NULL; i++) {
+        if (strcasecmp(symbol, symbol_map[i].symbol) == 0 ||
+            strcasecmp(symbol, symbol_map[i].coingecko_id) == 0) {
+            ticker = symbol_map[i].symbol;
+            break;
+        }
+    }
+    
+    size_t len = strlen(ticker);
+    char *out = malloc(len + 1);
+    if (!out) {
+        return NULL;
+    }
+    for (size_t i = 0; i <= len; i++) {
+        out[i] = toupper((unsigned char)ticker[i]);
+    }
+    return out;
+}
+
+crypto_data_t parse_cryptocompare_json(const char *json_string, const char *id, const char *ticker,
+                                       const char *currency) {
+    crypto_data_t data = {0};
+    
+    if (!json_string || !id || !ticker) {
+        return data;
+    }
+    
+    const char *curr = currency ? currency : "usd";
+    
+    // Response keys are upper case: {"RAW": {"BTC": {"USD": {...}}}}
+    char curr_upper[16];
+    size_t curr_len = strlen(curr);
+    if (curr_len >= sizeof(curr_upper)) {
+        return data;
+    }
+    for (size_t i = 0; i <= curr_len; i++) {
+        curr_upper[i] = toupper((unsigned char)curr[i]);
+    }
+    
+    cJSON *json = cJSON_Parse(json_string);
+    if (!json) {
+        return data;
+    }
+    
+    cJSON *raw = cJSON_GetObjectItem(json, "RAW");
+    cJSON *coin = raw ? cJSON_GetObjectItem(raw, ticker) : NULL;
+    cJSON *quote = coin ? cJSON_GetObjectItem(coin, curr_upper) : NULL;
+    cJSON *price = quote ? cJSON_GetObjectItem(quote, "PRICE") : NULL;
+    if (!cJSON_IsNumber(price)) {
+        cJSON_Delete(json);
+        return data;
+    }
+    
+    data.current_price = price->valuedouble;
+    
+    cJSON *field = cJSON_GetObjectItem(quote, "CHANGE24HOUR");
+    if (cJSON_IsNumber(field)) {
+        data.price_change_24h = field->valuedouble;
+    }
+    field = cJSON_GetObjectItem(quote, "CHANGEPCT24HOUR");
+    if (cJSON_IsNumber(field)) {
+        data.price_change_percentage_24h = field->valuedouble;
+    }
+    field = cJSON_GetObjectItem(quote, "MKTCAP");
+    if (cJSON_IsNumber(field)) {
+        data.market_cap = field->valuedouble;
+    }
+    // Volume in the quote currency, like CoinGecko's *_24h_vol
+    field = cJSON_GetObjectItem(quote, "VOLUME24HOURTO");
+    if (cJSON_IsNumber(field)) {
+        data.volume_24h = field->valuedouble;
+    }
+    field = cJSON_GetObjectItem(quote, "HIGH24HOUR");
+    if (cJSON_IsNumber(field)) {
+        data.high_24h = field->valuedouble;
+    }
+    field = cJSON_GetObjectItem(quote, "LOW24HOUR");
+    if (cJSON_IsNumber(field)) {
+        data.low_24h = field->valuedouble;
+    }
+    field = cJSON_GetObjectItem(quote, "LASTUPDATE");
+    if (cJSON_IsNumber(field)) {
+        data.last_updated_at = (long)field->valuedouble;
+    }
+    
+    cJSON_Delete(json);
+    
+    // Keyed by the CoinGecko ID like every other quote
+    data.interned = use_interning;
+    data.id = copy_field(&data, id, strlen(id));
+    data.currency = copy_field(&data, curr, curr_len);
+    derive_symbol_and_name(&data);
+    
+    data.success = 1;
+    return data;
+}
+
+crypto_data_t parse_crypto_json_with_currency(const char *json_string, const char *currency) {
+    crypto_data_t data = {0};
+    data.success = 0;
+    
+    if (!json_string) {
+        return data;
+    }
+    
+    const char *curr = currency ? currency : "usd";
+    
+    cJSON *json = cJSON_Parse(json_string);
+    if (!json) {
+        return data;
+    }
+    
+    // Get first (and typically only) key in the response
+    cJSON *item = json->child;
+    if (!item) {
+        cJSON_Delete(json);
+        return data;
+    }
+    
+    parse_simple_price_item(item, curr, PLAN_ALL, &data);
+    
+    cJSON_Delete(json);
+    
+    return data;
+}
+
+int parse_price_grid_json(const char *json_string, const char *const *ids, int id_count,
+                          const char *const *currencies, int currency_count, double *prices) {
+    if (!json_string || !ids || !currencies || !prices) {
+        return -1;
+    }
+    
+    for (int i = 0; i < id_count * currency_count; i++) {
+        prices[i] = NAN;
+    }
+    
+    cJSON *json = cJSON_Parse(json_string);
+    if (!json) {
+        return -1;
+    }
+    if (!cJSON_IsObject(json)) {
+        cJSON_Delete(json);
+        return -1;
+    }
+    
+    int found = 0;
+    for (int i = 0; i < id_count; i++) {
+        cJSON *item = cJSON_GetObjectItem(json, ids[i]);
+        if (!cJSON_IsObject(item)) {
+            continue;
+        }
+        for (int c = 0; c < currency_count; c++) {
+            cJSON *price = cJSON_GetObjectItem(item, currencies[c]);
+            if (cJSON_IsNumber(price)) {
+                prices[i * currency_count + c] = price->valuedouble;
+                found++;
+            }
+        }
+    }
+    
+    cJSON_Delete(json);
+    return found;
+}
+
+markets_data_t parse_simple_price_batch_json(const char *json_string, const char *currency) {
+    return parse_simple_price_batch_json_fields(json_string, currency, PLAN_ALL);
+}
+
+markets_data_t parse_simple_price_batch_json_fields(const char *json_string, const char *currency,
+                                                    unsigned fields) {
+    markets_data_t quotes = {0};
+    
+    if (!json_string) {
+        return quotes;
+    }
+    
+    const char *curr = currency ? currency : "usd";
+    
+    cJSON *json = cJSON_Parse(json_string);
+    if (!json) {
+        return quotes;
+    }
+    
+    // simple/price answers with an object keyed by coin id
+    if (!cJSON_IsObject(json)) {
+        cJSON_Delete(json);
+        return quotes;
+    }
+    
+    int size = cJSON_GetArraySize(json);
+    if (size > 0) {
+        quotes.coins = calloc((size_t)size, sizeof(crypto_data_t));
+        if (!quotes.coins) {
+            cJSON_Delete(json);
+            return quotes;
+        }
+    }
+    
+    cJSON *item = NULL;
+    cJSON_ArrayForEach(item, json) {
+        if (!cJSON_IsObject(item) || quotes.count >= size) {
+            continue;
+        }
+        parse_simple_price_item(item, curr, fields ? fields : PLAN_ALL, &quotes.coins[quotes.count]);
+        quotes.count++;
+    }
+    
+    quotes.success = 1;
+    cJSON_Delete(json);
+    return quotes;
+}
+
+void free_crypto_data(crypto_data_t *data) {
+    if (!data) {
+        return;
+    }
+    
+    if (data->interned) {
+        data->id = NULL;
+        data->symbol = NULL;
+        data->name = NULL;
+        data->currency = NULL;
+        return;
+    }
+    
+    if (data->id) {
+        free(data->id);
+        data->id = NULL;
+    }
+    
+    if (data->symbol) {
+        free(data->symbol);
+        data->symbol = NULL;
+    }
+    
+    if (data->name) {
+        free(data->name);
+        data->name = NULL;
+    }
+    
+    if (data->currency) {
+        free(data->currency);
+        data->currency = NULL;
+    }
+}
+
+int parse_ohlc_json(const char *json_string, crypto_data_t *data) {
+    if (!json_string || !data) {
+        return -1;
+    }
+    
+    cJSON *json = cJSON_Parse(json_string);
+    if (!json) {
+        return -1;
+    }
+    
+    // OHLC response is an array of arrays: [[timestamp, open, high, low, close], ...]
+    if (!cJSON_IsArray(json)) {
+        cJSON_Delete(json);
+        return -1;
+    }
+    
+    double max_high = 0.0;
+    double min_low = 0.0;
+    int first_item = 1;
+    
+    cJSON *item = NULL;
+    cJSON_ArrayForEach(item, json) {
+        if (!cJSON_IsArray(item)) {
+            continue;
+        }
+        
+        // Each item is [timestamp, open, high, low, close]
+        // Need at least 5 elements
+        if (cJSON_GetArraySize(item) < 5) {
+            continue;
+        }
+        
+        cJSON *high_item = cJSON_GetArrayItem(item, 2); // high (index 2)
+        cJSON *low_item = cJSON_GetArrayItem(item, 3);  // low (index 3)
+        
+        if (!cJSON_IsNumber(high_item) || !cJSON_IsNumber(low_item)) {
+            continue;
+        }
+        
+        double high = high_item->valuedouble;
+        double low = low_item->valuedouble;
+        
+        if (first_item) {
+            max_high = high;
+            min_low = low;
+            first_item = 0;
+        } else {
+            if (high > max_high) {
+                max_high = high;
+            }
+            if (low < min_low) {
+                min_low = low;
+            }
+        }
+    }
+    
+    if (!first_item) {
+        data->high_24h = max_high;
+        data->low_24h = min_low;
+    }
+    
+    cJSON_Delete(json);
+    return 0;
+}
+
+// One block for count rows of an int64 column followed by `doubles` double columns
+static int64_t *alloc_series(int count, int doubles, double **columns) {
+    size_t rows = count > 0 ? (size_t)count : 1;
+    int64_t *block = malloc(rows * (sizeof(int64_t) + (size_t)doubles * sizeof(double)));
+    if (!block) {
+        return NULL;
+    }
+    double *values = (double *)(block + rows);
+    for (int c = 0; c < doubles; c++) {
+        columns[c] = values + (size_t)c * rows;
+    }
+    return block;
+}
+
+// [timestamp, open, high, low, close]; returns 0 if item is one
+static int read_candle(const cJSON *item, int64_t *time_ms, double *values) {
+    const cJSON *field = cJSON_IsArray(item) ? item->child : NULL;
+    if (!cJSON_IsNumber(field)) {
+        return -1;
+    }
+    *time_ms = (int64_t)field->valuedouble;
+    for (int c = 0; c < 4; c++) {
+        field = field->next;
+        if (!cJSON_IsNumber(field)) {
+            return -1;
+        }
+        values[c] = field->valuedouble;
+    }
+    return 0;
+}
+
+// Rows parsed in parallel that turned out invalid have this time
+#define SERIES_SKIPPED INT64_MIN
+
+// Close the gaps left by skipped rows, keeping order; returns the row count
+static int compact_series(int64_t *time_ms, double *const *columns, int column_count, int rows) {
+    int kept = 0;
+    for (int row = 0; row < rows; row++) {
+        if (time_ms[row] == SERIES_SKIPPED) {
+            continue;
+        }
+        if (kept != row) {
+            time_ms[kept] = time_ms[row];
+            for (int c = 0; c < column_count; c++) {
+                columns[c][kept] = columns[c][row];
+            }
+        }
+        kept++;
+    }
+    return kept;
+}
+
+typedef struct {
+    int64_t *time_ms;
+    double *columns[4];
+} series_job_t;
+
+static void parse_candle_element(const cJSON *element, int index, void *context) {
+    series_job_t *job = (series_job_t *)context;
+    double values[4];
+    if (read_candle(element, &job->time_ms[index], values) != 0) {
+        job->time_ms[index] = SERIES_SKIPPED;
+        return;
+    }
+    for (int c = 0; c < 4; c++) {
+        job->columns[c][index] = values[c];
+    }
+}
+
+static ohlc_series_t parse_ohlc_parallel(const char *json_string, size_t length, int threads) {
+    ohlc_series_t series = {0};
+    json_split_t split;
+    if (json_split_array(json_string, length, 0, &split) != 0) {
+        return series;
+    }
+    
+    series_job_t job;
+    job.time_ms = alloc_series(split.count, 4, job.columns);
+    if (!job.time_ms || json_parse_elements(&split, threads, parse_candle_element, &job) != 0) {
+        free(job.time_ms);
+        json_split_free(&split);
+        return series;
+    }
+    
+    series.time_ms = job.time_ms;
+    series.open = job.columns[0];
+    series.high = job.columns[1];
+    series.low = job.columns[2];
+    series.close = job.columns[3];
+    series.count = compact_series(job.time_ms, job.columns, 4, split.count);
+    series.success = 1;
+    json_split_free(&split);
+    return series;
+}
+
+ohlc_series_t parse_ohlc_series(const char *json_string) {
+    ohlc_series_t series = {0};
+    size_t length = json_string ? strlen(json_string) : 0;
+    int threads = threads_for(length);
+    if (threads > 1) {
+        return parse_ohlc_parallel(json_string, length, threads);
+    }
+    
+    cJSON *json = json_string ? cJSON_Parse(json_string) : NULL;
+    if (!cJSON_IsArray(json)) {
+        cJSON_Delete(json);
+        return series;
+    }
+    
+    double *columns[4];
+    series.time_ms = alloc_series(cJSON_GetArraySize(json), 4, columns);
+    if (!series.time_ms) {
+        cJSON_Delete(json);
+        return series;
+    }
+    series.open = columns[0];
+    series.high = columns[1];
+    series.low = columns[2];
+    series.close = columns[3];
+    
+    cJSON *item = NULL;
+    cJSON_ArrayForEach(item, json) {
+        double values[4];
+        int row = series.count;
+        if (read_candle(item, &series.time_ms[row], values) != 0) {
+            continue;
+        }
+        for (int c = 0; c < 4; c++) {
+            columns[c][row] = values[c];
+        }
+        series.count++;
+    }
+    
+    cJSON_Delete(json);
+    series.success = 1;
+    return series;
+}
+
+void free_ohlc_series(ohlc_series_t *series) {
+    if (series) {
+        free(series->time_ms);
+        memset(series, 0, sizeof(*series));
+    }
+}
+
+// [t, v] pair; returns 0 if item is one
+static int read_sample(const cJSON *item, double *t, double *v) {
+    const cJSON *time_item = cJSON_IsArray(item) ? item->child : NULL;
+    const cJSON *value_item = time_item ? time_item->next : NULL;
+    if (!cJSON_IsNumber(time_item) || !cJSON_IsNumber(value_item)) {
+        return -1;
+    }
+    *t = time_item->valuedouble;
+    *v = value_item->valuedouble;
+    return 0;
+}
+
+// Fill values[row] from a companion array whose samples normally line up with the prices
+static void match_samples(const cJSON *array, const int64_t *times, int count, double *values) {
+    const cJSON *item = cJSON_IsArray(array) ? array->child : NULL;
+    for (int row = 0; row < count; row++) {
+        values[row] = NAN;
+        double t, v;
+        // Skip samples older than this row; a gap leaves the row NaN
+        while (item && (read_sample(item, &t, &v) != 0 || (int64_t)t < times[row])) {
+            item = item->next;
+        }
+        if (item && (int64_t)t == times[row]) {
+            values[row] = v;
+            item = item->next;
+        }
+    }
+}
+
+// Companion samples parsed in parallel: time and value, NaN time if invalid
+typedef struct {
+    double *time;
+    double *value;
+} samples_job_t;
+
+static void parse_price_element(const cJSON *element, int index, void *context) {
+    series_job_t *job = (series_job_t *)context;
+    double t, v;
+    if (read_sample(element, &t, &v) != 0) {
+        job->time_ms[index] = SERIES_SKIPPED;
+        return;
+    }
+    job->time_ms[index] = (int64_t)t;
+    job->columns[0][index] = v;
+}
+
+static void parse_sample_element(const cJSON *element, int index, void *context) {
+    samples_job_t *job = (samples_job_t *)context;
+    if (read_sample(element, &job->time[index], &job->value[index]) != 0) {
+        job->time[index] = NAN;
+    }
+}
+
+// match_samples() over a companion array parsed in parallel
+static int match_split_samples(const json_split_t *split, int threads, const int64_t *times,
+                               int count, double *values) {
+    for (int row = 0; row < count; row++) {
+        values[row] = NAN;
+    }
+    if (split->count <= 0) {
+        return 0;
+    }
+    
+    samples_job_t job;
+    job.time = malloc((size_t)split->count * 2 * sizeof(double));
+    if (!job.time) {
+        return -1;
+    }
+    job.value = job.time + split->count;
+    if (json_parse_elements(split, threads, parse_sample_element, &job) != 0) {
+        free(job.time);
+        return -1;
+    }
+    
+    int sample = 0;
+    for (int row = 0; row < count; row++) {
+        while (sample < split->count && (isnan(job.time[sample]) || (int64_t)job.time[sample] < times[row])) {
+            sample++;
+        }
+        if (sample < split->count && (int64_t)job.time[sample] == times[row]) {
+            values[row] = job.value[sample++];
+        }
+    }
+    free(job.time);
+    return 0;
+}
+
+static chart_series_t parse_market_chart_parallel(const char *json_string, size_t length,
+                                                  int threads) {
+    chart_series_t series = {0};
+    static const char *const keys[] = { "prices", "market_caps", "total_volumes" };
+    json_split_t splits[3];
+    if (json_split_members(json_string, length, keys, 3, splits) != 0) {
+        return series;
+    }
+    
+    series_job_t job;
+    job.time_ms = splits[0].count >= 0 ? alloc_series(splits[0].count, 3, job.columns) : NULL;
+    int ok = job.time_ms && json_parse_elements(&splits[0], threads, parse_price_element, &job) == 0;
+    if (ok) {
+        int count = compact_series(job.time_ms, job.columns, 1, splits[0].count);
+        ok = match_split_samples(&splits[1], threads, job.time_ms, count, job.columns[1]) == 0 &&
+             match_split_samples(&splits[2], threads, job.time_ms, count, job.columns[2]) == 0;
+        series.count = count;
+    }
+    for (int k = 0; k < 3; k++) {
+        json_split_free(&splits[k]);
+    }
+    if (!ok) {
+        free(job.time_ms);
+        series.count = 0;
+        return series;
+    }
+    
+    series.time_ms = job.time_ms;
+    series.price = job.columns[0];
+    series.market_cap = job.columns[1];
+    series.volume = job.columns[2];
+    series.success = 1;
+    return series;
+}
+
+chart_series_t parse_market_chart_json(const char *json_string) {
+    chart_series_t series = {0};
+    size_t length = json_string ? strlen(json_string) : 0;
+    int threads = threads_for(length);
+    if (threads > 1) {
+        return parse_market_chart_parallel(json_string, length, threads);
+    }
+    
+    cJSON *json = json_string ? cJSON_Parse(json_string) : NULL;
+    cJSON *prices = cJSON_GetObjectItemCaseSensitive(json, "prices");
+    if (!cJSON_IsArray(prices)) {
+        cJSON_Delete(json);
+        return series;
+    }
+    
+    double *columns[3];
+    series.time_ms = alloc_series(cJSON_GetArraySize(prices), 3, columns);
+    if (!series.time_ms) {
+        cJSON_Delete(json);
+        return series;
+    }
+    series.price = columns[0];
+    series.market_cap = columns[1];
+    series.volume = columns[2];
+    
+    cJSON *item = NULL;
+    cJSON_ArrayForEach(item, prices) {
+        double t, v;
+        if (read_sample(item, &t, &v) == 0) {
+            series.time_ms[series.count] = (int64_t)t;
+            series.price[series.count] = v;
+            series.count++;
+        }
+    }
+    match_samples(cJSON_GetObjectItemCaseSensitive(json, "market_caps"), series.time_ms, series.count,
+                  series.market_cap);
+    match_samples(cJSON_GetObjectItemCaseSensitive(json, "total_volumes"), series.time_ms, series.count,
+                  series.volume);
+    
+    cJSON_Delete(json);
+    series.success = 1;
+    return series;
+}
+
+void free_chart_series(chart_series_t *series) {
+    if (series) {
+        free(series->time_ms);
+        memset(series, 0, sizeof(*series));
+    }
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date (Howard Hinnant's days_from_civil)
+static long days_from_civil(long y, long m, long d) {
+    y -= m <= 2;
+    long era = (y >= 0 ? y : y - 399) / 400;
+    long yoe = y - era * 400;
+    long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// "2025-10-19T08:00:00.000Z" -> Unix time; 0 if the string is not in that form
+static long parse_iso8601_utc(const char *s) {
+    int y, mo, d, h, mi, sec;
+    if (sscanf(s, "%4d-%2d-%2dT%2d:%2d:%2d", &y, &mo, &d, &h, &mi, &sec) != 6 ||
+        mo < 1 || mo > 12 || d < 1 || d > 31 || h > 23 || mi > 59 || sec > 60) {
+        return 0;
+    }
+    return days_from_civil(y, mo, d) * 86400L + h * 3600L + mi * 60L + sec;
+}
+
+// One coin object of a markets response
+static void parse_market_item(const cJSON *item, const char *curr, unsigned fields,
+                              crypto_data_t *coin) {
+    coin->interned = use_interning;
+    coin->currency = copy_field(coin, curr, strlen(curr));
+    
+    // One pass over the members; keys of unrequested fields are skipped
+    // without a lookup, and their strings are never copied
+    const cJSON *change_pct_item = NULL;
+    const cJSON *change_item = NULL;
+    cJSON *member = NULL;
+    cJSON_ArrayForEach(member, item) {
+        const char *key = member->string;
+        if (!key) {
+            continue;
+        }
+        
+        if (strcmp(key, "id") == 0) {
+            if (cJSON_IsString(member)) {
+                coin->id = copy_field(coin, member->valuestring, strlen(member->valuestring));
+            }
+        } else if (fields & PLAN_NAME && strcmp(key, "symbol") == 0) {
+            if (cJSON_IsString(member)) {
+                coin->symbol = copy_field(coin, member->valuestring, strlen(member->valuestring));
+            }
+        } else if (fields & PLAN_NAME && strcmp(key, "name") == 0) {
+            if (cJSON_IsString(member)) {
+                coin->name = copy_field(coin, member->valuestring, strlen(member->valuestring));
+            }
+        } else if (fields & PLAN_PRICE && strcmp(key, "current_price") == 0) {
+            if (cJSON_IsNumber(member)) {
+                coin->current_price = member->valuedouble;
+            }
+        } else if (fields & PLAN_MARKET_CAP && strcmp(key, "market_cap") == 0) {
+            if (cJSON_IsNumber(member)) {
+                coin->market_cap = member->valuedouble;
+            }
+        } else if (fields & PLAN_VOLUME_24H && strcmp(key, "total_volume") == 0) {
+            if (cJSON_IsNumber(member)) {
+                coin->volume_24h = member->valuedouble;
+            }
+        } else if (fields & PLAN_CHANGE_24H && strcmp(key, "price_change_percentage_24h") == 0) {
+            change_pct_item = member;
+        } else if (fields & PLAN_CHANGE_24H && strcmp(key, "price_change_24h") == 0) {
+            change_item = member;
+        } else if (fields & PLAN_HIGH_LOW_24H && strcmp(key, "high_24h") == 0) {
+            if (cJSON_IsNumber(member)) {
+                coin->high_24h = member->valuedouble;
+            }
+        } else if (fields & PLAN_HIGH_LOW_24H && strcmp(key, "low_24h") == 0) {
+            if (cJSON_IsNumber(member)) {
+                coin->low_24h = member->valuedouble;
+            }
+        } else if (fields & PLAN_LAST_UPDATED && strcmp(key, "last_updated") == 0) {
+            if (cJSON_IsString(member)) {
+                // ISO 8601 in UTC; the store ages quotes by it
+                coin->last_updated_at = parse_iso8601_utc(member->valuestring);
+            }
+        }
+    }
+    
+    if (cJSON_IsNumber(change_pct_item)) {
+        coin->price_change_percentage_24h = change_pct_item->valuedouble;
+        // Calculate absolute change from percentage (needs the price, which
+        // the change field is not asked to include on its own)
+        coin->price_change_24h = coin->current_price * (coin->price_change_percentage_24h / 100.0);
+    }
+    
+    // Prefer the absolute change as reported
+    if (cJSON_IsNumber(change_item)) {
+        coin->price_change_24h = change_item->valuedouble;
+    }
+    
+    coin->success = 1;
+}
+
+typedef struct {
+    const char *currency;
+    unsigned fields;
+    crypto_data_t *coins;
+} markets_job_t;
+
+static void parse_market_element(const cJSON *element, int index, void *context) {
+    markets_job_t *job = (markets_job_t *)context;
+    if (cJSON_IsObject(element)) {
+        parse_market_item(element, job->currency, job->fields, &job->coins[index]);
+    }
+}
+
+// Like the serial parse, takes the first limit objects; elements past them are not parsed at all
+static markets_data_t parse_markets_parallel(const char *json_string, size_t length, int limit,
+                                             const char *curr, unsigned fields, int threads) {
+    markets_data_t markets = {0};
+    json_split_t split;
+    if (json_split_array(json_string, length, 0, &split) != 0) {
+        return markets;
+    }
+    
+    // Spans start at the value, so an object is recognised by its first byte
+    int kept = 0;
+    for (int i = 0; i < split.count && kept < limit; i++) {
+        if (split.base[split.spans[i].offset] == '{') {
+            split.spans[kept++] = split.spans[i];
+        }
+    }
+    split.count = kept;
+    
+    markets.coins = calloc(split.count > 0 ? (size_t)split.count : 1, sizeof(crypto_data_t));
+    if (!markets.coins) {
+        json_split_free(&split);
+        return markets;
+    }
+    
+    markets_job_t job = { curr, fields, markets.coins };
+    int rc = json_parse_elements(&split, threads, parse_market_element, &job);
+    
+    markets.count = split.count;
+    json_split_free(&split);
+    
+    if (rc != 0) {
+        free_markets_data(&markets);
+        return markets;
+    }
+    markets.success = 1;
+    return markets;
+}
+
+markets_data_t parse_markets_json(const char *json_string, int limit) {
+    return parse_markets_json_with_currency(json_string, limit, "usd");
+}
+
+markets_data_t parse_markets_json_with_currency(const char *json_string, int limit,
+                                                const char *currency) {
+    return parse_markets_json_fields(json_string, limit, currency, PLAN_ALL);
+}
+
+markets_data_t parse_markets_json_fields(const char *json_string, int limit, const char *currency,
+                                         unsigned fields) {
+    markets_data_t markets = {0};
+    markets.success = 0;
+    markets.count = 0;
+    markets.coins = NULL;
+    
+    if (!json_string || limit <= 0) {
+        return markets;
+    }
+    
+    const char *curr = currency ? currency : "usd";
+    if (fields == 0) {
+        fields = PLAN_ALL;
+    }
+    
+    size_t length = strlen(json_string);
+    int threads = threads_for(length);
+    if (threads > 1) {
+        return parse_markets_parallel(json_string, length, limit, curr, fields, threads);
+    }
+    
+    cJSON *json = cJSON_Parse(json_string);
+    if (!json) {
+        return markets;
+    }
+    
+    // Markets response is an array of coin objects
+    if (!cJSON_IsArray(json)) {
+        cJSON_Delete(json);
+        return markets;
+    }
+    
+    int array_size = cJSON_GetArraySize(json);
+    int actual_limit = (array_size < limit) ? array_size : limit;
+    
+    markets.coins = malloc(sizeof(crypto_data_t) * actual_limit);
+    if (!markets.coins) {
+        cJSON_Delete(json);
+        return markets;
+    }
+    
+    // Initialize all coins
+    for (int i = 0; i < actual_limit; i++) {
+        markets.coins[i] = (crypto_data_t){0};
+        markets.coins[i].success = 0;
+    }
+    
+    cJSON *item = NULL;
+    int index = 0;
+    cJSON_ArrayForEach(item, json) {
+        if (index >= actual_limit) {
+            break;
+        }
+        
+        if (!cJSON_IsObject(item)) {
+            continue;
+        }
+        
+        parse_market_item(item, curr, fields, &markets.coins[index]);
+        index++;
+    }
+    
+    markets.count = index;
+    markets.success = 1;
+    
+    cJSON_Delete(json);
+    return markets;
+}
+
+void free_markets_data(markets_data_t *data) {
+    if (!data) {
+        return;
+    }
+    
+    if (data->coins) {
+        for (int i = 0; i < data->count; i++) {
+            free_crypto_data(&data->coins[i]);
+        }
+        free(data->coins);
+        data->coins = NULL;
+    }
+    
+    data->count = 0;
+    data->success = 0;
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "../include/paths.h"
+
+// mkdir -p (path is modified temporarily)
+static int make_dirs(char *path) {
+    for (char *p = path + 1; *p; p++) {
+        if (*p != '/') {
+            continue;
+        }
+        *p = '\0';
+        int rc = mkdir(path, 0700);
+        *p = '/';
+        if (rc != 0 && errno != EEXIST) {
+            return -1;
+        }
+    }
+    
+    if (mkdir(path, 0700) != 0 && errno != EEXIST) {
+        return -1;
+    }
+    return 0;
+}
+
+int paths_cache_dir(char *out, size_t size) {
+    const char *dir = getenv("CRYPTO_CLI_CACHE_DIR");
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    int n;
+    
+    if (dir && *dir) {
+        n = snprintf(out, size, "%s", dir);
+    } else if (xdg && *xdg) {
+        n = snprintf(out, size, "%s/crypto-cli", xdg);
+    } else if (home && *home) {
+        n = snprintf(out, size, "%s/.cache/crypto-cli", home);
+    } else {
+        return -1;
+    }
+    
+    if (n < 0 || (size_t)n >= size) {
+        return -1;
+    }
+    
+    return make_dirs(out);
+}
+
+int paths_cache_subdir(const char *subdir, char *out, size_t size) {
+    if (!subdir || paths_cache_dir(out, size) != 0) {
+        return -1;
+    }
+    
+    size_t len = strlen(out);
+    int n = snprintf(out + len, size - len, "/%s", subdir);
+    if (n < 0 || (size_t)n >= size - len) {
+        return -1;
+    }
+    return make_dirs(out);
+}
+
+int paths_cache_file(const char *subdir, const char *name, char *out, size_t size) {
+    if (!name || paths_cache_subdir(subdir, out, size) != 0) {
+        return -1;
+    }
+    
+    size_t len = strlen(out);
+    int n = snprintf(out + len, size - len, "/%s", name);
+    if (n < 0 || (size_t)n >= size - len) {
+        return -1;
+    }
+    
+    return 0;
+}
+
+int paths_make_dir(const char *path) {
+    char copy[1024];
+    int n = path ? snprintf(copy, sizeof(copy), "%s", path) : -1;
+    if (n <= 0 || (size_t)n >= sizeof(copy)) {
+        return -1;
+    }
+    return make_dirs(copy);
+}
@@ -0,0 +1,140 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "../include/planner.h"
+#include "../include/api.h"
+
+static markets_data_t parse_markets_all(const char *json, const char *currency, unsigned fields) {
+    return parse_markets_json_fields(json, INT_MAX, currency, fields);
+}
+
+// coins/markets always returns every field
+static char *markets_url(const char *ids, const char *currency, unsigned fields) {
+    (void)fields;
+    return get_markets_url_for_ids(ids, currency);
+}
+
+// simple/price has no high/low and derives names from the id, but is about
+// a third of the size of a markets entry, and less with fewer include_* flags
+static const plan_endpoint_t endpoints[] = {
+    { "simple/price",
+      PLAN_PRICE | PLAN_CHANGE_24H | PLAN_MARKET_CAP | PLAN_VOLUME_24H | PLAN_LAST_UPDATED,
+      1, get_simple_price_url, parse_simple_price_batch_json_fields },
+    { "coins/markets", PLAN_ALL, 3, markets_url, parse_markets_all },
+};
+
+static const struct {
+    const char *name;
+    unsigned fields;
+} field_names[] = {
+    { "price", PLAN_PRICE },
+    { "change_24h", PLAN_CHANGE_24H },
+    { "change_percentage_24h", PLAN_CHANGE_24H },
+    { "market_cap", PLAN_MARKET_CAP },
+    { "volume_24h", PLAN_VOLUME_24H },
+    { "high_24h", PLAN_HIGH_LOW_24H },
+    { "low_24h", PLAN_HIGH_LOW_24H },
+    { "last_updated", PLAN_LAST_UPDATED },
+    { "name", PLAN_NAME },
+    { "symbol", PLAN_NAME },
+    { "all", PLAN_ALL },
+};
+
+#define ENDPOINT_COUNT ((int)(sizeof(endpoints) / sizeof(endpoints[0])))
+
+int planner_plan(unsigned fields, query_plan_t *plan) {
+    if (!plan) {
+        return -1;
+    }
+    memset(plan, 0, sizeof(*plan));
+    if (fields == 0) {
+        fields = PLAN_ALL;
+    }
+
+    // Every subset of a handful of endpoints: fewest requests, then lowest cost
+    unsigned best = 0;
+    int best_count = INT_MAX;
+    int best_cost = INT_MAX;
+    for (unsigned subset = 1; subset < (1u << ENDPOINT_COUNT); subset++) {
+        unsigned covered = 0;
+        int count = 0;
+        int cost = 0;
+        for (int i = 0; i < ENDPOINT_COUNT; i++) {
+            if (subset & (1u << i)) {
+                covered |= endpoints[i].provides;
+                count++;
+                cost += endpoints[i].cost;
+            }
+        }
+        if ((covered & fields) != fields || count > PLAN_MAX_ENDPOINTS) {
+            continue;
+        }
+        if (count < best_count || (count == best_count && cost < best_cost)) {
+            best = subset;
+            best_count = count;
+            best_cost = cost;
+        }
+    }
+    if (!best) {
+        return -1;
+    }
+
+    for (int i = 0; i < ENDPOINT_COUNT; i++) {
+        if (best & (1u << i)) {
+            plan->endpoints[plan->count++] = &endpoints[i];
+            plan->fields |= endpoints[i].provides;
+        }
+    }
+    return 0;
+}
+
+int planner_parse_fields(const char *list, unsigned *fields) {
+    if (!list || !fields) {
+        return -1;
+    }
+
+    unsigned mask = 0;
+    const char *p = list;
+    for (;;) {
+        size_t len = strcspn(p, ",");
+        int known = 0;
+        for (size_t i = 0; i < sizeof(field_names) / sizeof(field_names[0]); i++) {
+            if (strlen(field_names[i].name) == len && strncmp(field_names[i].name, p, len) == 0) {
+                mask |= field_names[i].fields;
+                known = 1;
+                break;
+            }
+        }
+        if (!known) {
+            return -1;
+        }
+        if (p[len] == '\0') {
+            break;
+        }
+        p += len + 1;
+    }
+
+    *fields = mask;
+    return 0;
+}
+
+crypto_data_t planner_parse_quote(const plan_endpoint_t *endpoint, const char *json,
+                                  const char *id, const char *currency, unsigned fields) {
+    crypto_data_t data = {0};
+    if (!endpoint || !json || !id) {
+        return data;
+    }
+
+    // Unknown coins come back as {} or [] and rate-limit errors as {"status": ...}
+    markets_data_t coins = endpoint->parse(json, currency, fields ? fields : PLAN_ALL);
+    for (int i = 0; i < coins.count; i++) {
+        if (coins.coins[i].success && coins.coins[i].id && strcmp(coins.coins[i].id, id) == 0) {
+            data = coins.coins[i];
+            // Ownership moves to the caller
+            coins.coins[i] = (crypto_data_t){0};
+            break;
+        }
+    }
+    free_markets_data(&coins);
+    return data;
+}
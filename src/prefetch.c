@@ -0,0 +1,132 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/prefetch.h"
+#include "../include/usage.h"
+#include "../include/store.h"
+#include "../include/planner.h"
+#include "../include/api.h"
+#include "../include/parser.h"
+#include "../include/coinids.h"
+
+#define PREFETCH_MIN_INTERVAL 5
+
+long prefetch_interval(long max_age) {
+    long interval = max_age / 2;
+    return interval > PREFETCH_MIN_INTERVAL ? interval : PREFETCH_MIN_INTERVAL;
+}
+
+// Stored quote missing or past half its max-age: refresh it now rather than
+// let the next lookup find it stale
+static int needs_refresh(const usage_entry_t *pair, long max_age) {
+    crypto_data_t data;
+    long fetched_at = 0;
+    if (store_load_quote(pair->id, pair->currency, &data, &fetched_at) != 0) {
+        return 1;
+    }
+    long age = store_quote_age(&data, fetched_at);
+    free_crypto_data(&data);
+    return age * 2 >= max_age;
+}
+
+// One request for the given pairs (all in pairs[0].currency); returns quotes saved
+static int fetch_and_store(api_pool_t *pool, const plan_endpoint_t *endpoint,
+                           const usage_entry_t *const *pairs, int count) {
+    const char *ids[PREFETCH_CHUNK];
+    for (int i = 0; i < count; i++) {
+        ids[i] = pairs[i]->id;
+    }
+    char *csv = join_ids(ids, sizeof(ids[0]), count);
+    if (!csv) {
+        return 0;
+    }
+
+    const char *currency = pairs[0]->currency;
+    char *url = endpoint->url(csv, currency, PLAN_ALL);
+    free(csv);
+    char *json = NULL;
+    int rc = url ? api_fetch_url(pool, url, &json, NULL) : -1;
+    free(url);
+    if (rc != 0) {
+        return 0;
+    }
+
+    markets_data_t quotes = endpoint->parse(json, currency, PLAN_ALL);
+    free(json);
+
+    int saved = 0;
+    for (int q = 0; q < quotes.count; q++) {
+        const crypto_data_t *quote = &quotes.coins[q];
+        if (!quote->success || !quote->id) {
+            continue;
+        }
+        for (int i = 0; i < count; i++) {
+            if (strcmp(quote->id, pairs[i]->id) == 0) {
+                saved += store_save_quote(quote) == 0;
+                break;
+            }
+        }
+    }
+    free_markets_data(&quotes);
+    return saved;
+}
+
+int prefetch_run(long max_age) {
+    int lock = usage_lock_prefetch();
+    if (lock < 0) {
+        return -1;
+    }
+
+    usage_log_t log;
+    usage_load(&log);
+    usage_entry_t hot[PREFETCH_MAX_PAIRS];
+    int hot_count = usage_hot(&log, (long)time(NULL), hot, PREFETCH_MAX_PAIRS);
+
+    // Stored quotes are shown in full, so every field is planned in
+    query_plan_t plan;
+    if (hot_count == 0 || planner_plan(PLAN_ALL, &plan) != 0 || plan.count != 1) {
+        close(lock);
+        return -1;
+    }
+
+    // The process-wide pool may hold connections inherited from the parent
+    // that forked this one; they are not ours to use
+    api_pool_t *pool = api_pool_new(0);
+    if (!pool) {
+        close(lock);
+        return -1;
+    }
+
+    int due[PREFETCH_MAX_PAIRS];
+    for (int i = 0; i < hot_count; i++) {
+        due[i] = needs_refresh(&hot[i], max_age);
+    }
+
+    // One batched request per currency, hottest currency first
+    int saved = 0;
+    for (int i = 0; i < hot_count; i++) {
+        if (!due[i]) {
+            continue;
+        }
+        const usage_entry_t *group[PREFETCH_MAX_PAIRS];
+        int count = 0;
+        for (int j = i; j < hot_count; j++) {
+            if (due[j] && strcmp(hot[j].currency, hot[i].currency) == 0) {
+                group[count++] = &hot[j];
+                due[j] = 0;
+            }
+        }
+        for (int start = 0; start < count; start += PREFETCH_CHUNK) {
+            int n = count - start < PREFETCH_CHUNK ? count - start : PREFETCH_CHUNK;
+            saved += fetch_and_store(pool, plan.endpoints[0], group + start, n);
+        }
+    }
+
+    api_pool_free(pool);
+    close(lock);
+    return saved;
+}
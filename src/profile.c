@@ -0,0 +1,157 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "../include/profile.h"
+#include "../include/api.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static const char *const stage_names[PROFILE_STAGE_COUNT] = {
+    "resolve", "url", "fetch", "parse", "store", "render"
+};
+
+typedef struct {
+    unsigned long calls;
+    int64_t ns;
+    uint64_t cycles;
+    int64_t allocs;
+    int64_t frees;
+    int64_t bytes;          // Bytes allocated (usable sizes)
+    int64_t peak_heap;      // Highest live heap while open
+    // Counters when the stage was opened
+    int64_t start_ns;
+    uint64_t start_cycles;
+    int64_t start_allocs;
+    int64_t start_frees;
+    int64_t start_bytes;
+} stage_stats_t;
+
+static int enabled;
+static int64_t enabled_at_ns;
+static stage_stats_t stages[PROFILE_STAGE_COUNT];
+
+// Allocations come from every thread (libcurl's resolver, worker pools)
+static atomic_llong alloc_count;
+static atomic_llong free_count;
+static atomic_llong alloc_bytes;
+static atomic_llong live_bytes;
+static atomic_llong peak_bytes;
+static atomic_llong window_peak_bytes;   // Peak since the current stage opened
+
+// 0 where the CPU has no user-readable cycle counter
+static uint64_t now_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return 0;
+#endif
+}
+
+static void raise_peak(atomic_llong *peak, long long value) {
+    long long seen = atomic_load_explicit(peak, memory_order_relaxed);
+    while (value > seen &&
+           !atomic_compare_exchange_weak_explicit(peak, &seen, value, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+void profile_note_alloc(size_t size) {
+    if (!enabled) {
+        return;
+    }
+    atomic_fetch_add_explicit(&alloc_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&alloc_bytes, (long long)size, memory_order_relaxed);
+    long long live = atomic_fetch_add_explicit(&live_bytes, (long long)size, memory_order_relaxed) +
+                     (long long)size;
+    raise_peak(&peak_bytes, live);
+    raise_peak(&window_peak_bytes, live);
+}
+
+void profile_note_free(size_t size) {
+    if (!enabled) {
+        return;
+    }
+    // Blocks allocated before profiling started can take live below zero;
+    // peaks are relative to the heap at profile_enable()
+    atomic_fetch_add_explicit(&free_count, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&live_bytes, (long long)size, memory_order_relaxed);
+}
+
+void profile_begin(profile_stage_t stage) {
+    if (!enabled || stage < 0 || stage >= PROFILE_STAGE_COUNT) {
+        return;
+    }
+    stage_stats_t *s = &stages[stage];
+    s->start_allocs = atomic_load_explicit(&alloc_count, memory_order_relaxed);
+    s->start_frees = atomic_load_explicit(&free_count, memory_order_relaxed);
+    s->start_bytes = atomic_load_explicit(&alloc_bytes, memory_order_relaxed);
+    atomic_store_explicit(&window_peak_bytes, atomic_load_explicit(&live_bytes, memory_order_relaxed),
+                          memory_order_relaxed);
+    s->start_cycles = now_cycles();
+    s->start_ns = api_monotonic_ns();
+}
+
+void profile_end(profile_stage_t stage) {
+    if (!enabled || stage < 0 || stage >= PROFILE_STAGE_COUNT) {
+        return;
+    }
+    int64_t ns = api_monotonic_ns();
+    uint64_t cycles = now_cycles();
+    stage_stats_t *s = &stages[stage];
+
+    s->calls++;
+    s->ns += ns - s->start_ns;
+    s->cycles += cycles - s->start_cycles;
+    s->allocs += atomic_load_explicit(&alloc_count, memory_order_relaxed) - s->start_allocs;
+    s->frees += atomic_load_explicit(&free_count, memory_order_relaxed) - s->start_frees;
+    s->bytes += atomic_load_explicit(&alloc_bytes, memory_order_relaxed) - s->start_bytes;
+
+    long long peak = atomic_load_explicit(&window_peak_bytes, memory_order_relaxed);
+    if (peak > s->peak_heap) {
+        s->peak_heap = peak;
+    }
+}
+
+// One JSON object on stderr: totals plus an object per stage
+static void profile_report(void) {
+    double wall_ms = (double)(api_monotonic_ns() - enabled_at_ns) / 1e6;
+
+    fprintf(stderr, "{\"wall_ms\":%.3f,\"allocs\":%lld,\"frees\":%lld,\"bytes\":%lld,"
+            "\"peak_heap\":%lld,\"stages\":{",
+            wall_ms,
+            (long long)atomic_load(&alloc_count), (long long)atomic_load(&free_count),
+            (long long)atomic_load(&alloc_bytes), (long long)atomic_load(&peak_bytes));
+
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        const stage_stats_t *s = &stages[i];
+        fprintf(stderr, "%s\"%s\":{\"calls\":%lu,\"ms\":%.3f,\"cycles\":%llu,\"allocs\":%lld,"
+                "\"frees\":%lld,\"bytes\":%lld,\"peak_heap\":%lld}",
+                i ? "," : "", stage_names[i], s->calls, (double)s->ns / 1e6,
+                (unsigned long long)s->cycles, (long long)s->allocs, (long long)s->frees,
+                (long long)s->bytes, (long long)s->peak_heap);
+    }
+    fprintf(stderr, "}}\n");
+}
+
+void profile_enable(void) {
+    if (enabled) {
+        return;
+    }
+    enabled_at_ns = api_monotonic_ns();
+    enabled = 1;
+    atexit(profile_report);
+}
+
+int profile_enabled(void) {
+    return enabled;
+}
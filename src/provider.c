@@ -0,0 +1,383 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/provider.h"
+#include "../include/api.h"
+#include "../include/paths.h"
+#include "../include/planner.h"
+#include "../include/profile.h"
+
+#define CRYPTOCOMPARE_API_ROOT "https://min-api.cryptocompare.com"
+#define STATS_FILE "providers.stats"
+#define STATS_ALPHA 0.3   // Weight of the newest sample in the moving averages
+
+// CoinGecko: whichever endpoint the planner picks for the fields, in one request
+
+static const plan_endpoint_t *coingecko_endpoint(const quote_query_t *query) {
+    query_plan_t plan;
+    return planner_plan(query->fields, &plan) == 0 && plan.count == 1 ? plan.endpoints[0] : NULL;
+}
+
+static char *coingecko_quote_url(const quote_query_t *query) {
+    const plan_endpoint_t *endpoint = coingecko_endpoint(query);
+    return endpoint ? endpoint->url(query->id, query->currency, query->fields) : NULL;
+}
+
+static crypto_data_t coingecko_parse_quote(const char *json, const quote_query_t *query) {
+    return planner_parse_quote(coingecko_endpoint(query), json, query->id, query->currency,
+                               query->fields);
+}
+
+// CryptoCompare: pricemultifull keyed by ticker
+
+static char *cryptocompare_quote_url(const quote_query_t *query) {
+    char *ticker = symbol_to_ticker(query->symbol ? query->symbol : query->id);
+    if (!ticker) {
+        return NULL;
+    }
+
+    char currency[16];
+    size_t len = strlen(query->currency);
+    if (len >= sizeof(currency)) {
+        free(ticker);
+        return NULL;
+    }
+    for (size_t i = 0; i <= len; i++) {
+        currency[i] = (char)(query->currency[i] >= 'a' && query->currency[i] <= 'z'
+                             ? query->currency[i] - 'a' + 'A' : query->currency[i]);
+    }
+
+    const char *base = api_base_url("CRYPTO_CLI_CRYPTOCOMPARE_URL", CRYPTOCOMPARE_API_ROOT);
+    const char *format = "%s/data/pricemultifull?fsyms=%s&tsyms=%s";
+    int needed = snprintf(NULL, 0, format, base, ticker, currency);
+    char *url = needed >= 0 ? malloc((size_t)needed + 1) : NULL;
+    if (url) {
+        snprintf(url, (size_t)needed + 1, format, base, ticker, currency);
+    }
+
+    free(ticker);
+    return url;
+}
+
+static crypto_data_t cryptocompare_parse_quote(const char *json, const quote_query_t *query) {
+    crypto_data_t data = {0};
+    char *ticker = symbol_to_ticker(query->symbol ? query->symbol : query->id);
+    if (ticker) {
+        data = parse_cryptocompare_json(json, query->id, ticker, query->currency);
+        free(ticker);
+    }
+    return data;
+}
+
+static const provider_t providers[] = {
+    { "coingecko", coingecko_quote_url, coingecko_parse_quote },
+    { "cryptocompare", cryptocompare_quote_url, cryptocompare_parse_quote },
+};
+
+#define PROVIDER_COUNT ((int)(sizeof(providers) / sizeof(providers[0])))
+
+static provider_stats_t stats[PROVIDER_COUNT];
+static int stats_loaded = 0;
+
+int provider_count(void) {
+    return PROVIDER_COUNT;
+}
+
+const provider_t *provider_at(int index) {
+    return index >= 0 && index < PROVIDER_COUNT ? &providers[index] : NULL;
+}
+
+const provider_t *provider_find(const char *name) {
+    if (!name) {
+        return NULL;
+    }
+    for (int i = 0; i < PROVIDER_COUNT; i++) {
+        if (strcasecmp(providers[i].name, name) == 0) {
+            return &providers[i];
+        }
+    }
+    return NULL;
+}
+
+static int stats_path(char *out, size_t size) {
+    if (paths_cache_dir(out, size) != 0) {
+        return -1;
+    }
+    size_t len = strlen(out);
+    int n = snprintf(out + len, size - len, "/%s", STATS_FILE);
+    return n < 0 || (size_t)n >= size - len ? -1 : 0;
+}
+
+// Lines of "name latency_ms error_rate requests errors"
+static void stats_load(void) {
+    if (stats_loaded) {
+        return;
+    }
+    stats_loaded = 1;
+
+    char path[1024];
+    if (stats_path(path, sizeof(path)) != 0) {
+        return;
+    }
+
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return;
+    }
+
+    char name[64];
+    provider_stats_t entry;
+    while (fscanf(fp, "%63s %lf %lf %lu %lu", name, &entry.latency_ms, &entry.error_rate,
+                  &entry.requests, &entry.errors) == 5) {
+        const provider_t *provider = provider_find(name);
+        if (provider) {
+            stats[provider - providers] = entry;
+        }
+    }
+    fclose(fp);
+}
+
+static void stats_save(void) {
+    char path[1024];
+    if (stats_path(path, sizeof(path)) != 0) {
+        return;
+    }
+
+    char tmp[1100];
+    snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+    FILE *fp = fopen(tmp, "w");
+    if (!fp) {
+        return;
+    }
+
+    for (int i = 0; i < PROVIDER_COUNT; i++) {
+        fprintf(fp, "%s %.3f %.6f %lu %lu\n", providers[i].name, stats[i].latency_ms,
+                stats[i].error_rate, stats[i].requests, stats[i].errors);
+    }
+
+    if (fclose(fp) != 0 || rename(tmp, path) != 0) {
+        unlink(tmp);
+    }
+}
+
+static void stats_record(int index, double latency_ms, int failed) {
+    provider_stats_t *s = &stats[index];
+
+    if (s->requests == 0) {
+        s->latency_ms = latency_ms;
+        s->error_rate = failed ? 1.0 : 0.0;
+    } else {
+        // Failures often return fast; only answered requests count for latency
+        if (!failed) {
+            s->latency_ms += STATS_ALPHA * (latency_ms - s->latency_ms);
+        }
+        s->error_rate += STATS_ALPHA * ((failed ? 1.0 : 0.0) - s->error_rate);
+    }
+
+    s->requests++;
+    if (failed) {
+        s->errors++;
+    }
+}
+
+provider_stats_t provider_get_stats(const provider_t *provider) {
+    provider_stats_t empty = {0};
+    stats_load();
+    if (!provider || provider < providers || provider >= providers + PROVIDER_COUNT) {
+        return empty;
+    }
+    return stats[provider - providers];
+}
+
+// Untried providers rank first so that every provider gets measured
+static double stats_score(int index) {
+    const provider_stats_t *s = &stats[index];
+    if (s->requests == 0) {
+        return 0.0;
+    }
+    return s->latency_ms + s->error_rate * PROVIDER_ERROR_PENALTY_MS;
+}
+
+// Provider indices ordered by score (insertion sort, a handful of entries)
+static int rank_providers(int *order) {
+    for (int i = 0; i < PROVIDER_COUNT; i++) {
+        int j = i;
+        while (j > 0 && stats_score(order[j - 1]) > stats_score(i)) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+    return PROVIDER_COUNT;
+}
+
+// Ask providers one after another until one has a quote
+static int fetch_sequential(const quote_query_t *query, const int *order, int count,
+                            crypto_data_t *out, const char **used) {
+    int answered = 0;
+
+    for (int k = 0; k < count && api_remaining_ms() > 0; k++) {
+        const provider_t *provider = &providers[order[k]];
+        profile_begin(PROFILE_URL);
+        char *url = provider->quote_url(query);
+        profile_end(PROFILE_URL);
+        if (!url) {
+            continue;
+        }
+
+        char *json = NULL;
+        profile_begin(PROFILE_FETCH);
+        double started = (double)api_monotonic_ms();
+        int rc = api_fetch_url(NULL, url, &json, NULL);
+        double elapsed = api_monotonic_ms() - started;
+        free(url);
+        profile_end(PROFILE_FETCH);
+
+        crypto_data_t data = {0};
+        profile_begin(PROFILE_PARSE);
+        if (rc == 0) {
+            answered = 1;
+            data = provider->parse_quote(json, query);
+        }
+        free(json);
+        profile_end(PROFILE_PARSE);
+
+        // A request cut short by the caller's deadline says nothing about the provider
+        if (data.success || api_remaining_ms() > 0) {
+            stats_record(order[k], elapsed, !data.success);
+        }
+
+        if (data.success) {
+            *out = data;
+            if (used) {
+                *used = provider->name;
+            }
+            return PROVIDER_OK;
+        }
+        free_crypto_data(&data);
+    }
+
+    return answered ? PROVIDER_ERR_NOT_FOUND : PROVIDER_ERR_NETWORK;
+}
+
+// Ask every provider at once; the first valid quote wins and the rest are cancelled
+static int fetch_race(const quote_query_t *query, const int *order, int count,
+                      crypto_data_t *out, const char **used) {
+    api_request_t requests[PROVIDER_MAX];
+    char *urls[PROVIDER_MAX];
+    int index_of[PROVIDER_MAX];
+    int started_count = 0;
+
+    api_async_t *async = api_async_new(count);
+    if (!async) {
+        return fetch_sequential(query, order, count, out, used);
+    }
+
+    double started = (double)api_monotonic_ms();
+    for (int k = 0; k < count; k++) {
+        profile_begin(PROFILE_URL);
+        urls[started_count] = providers[order[k]].quote_url(query);
+        profile_end(PROFILE_URL);
+        if (!urls[started_count]) {
+            continue;
+        }
+        memset(&requests[started_count], 0, sizeof(api_request_t));
+        requests[started_count].url = urls[started_count];
+        if (api_async_add(async, &requests[started_count]) != 0) {
+            free(urls[started_count]);
+            continue;
+        }
+        index_of[started_count] = order[k];
+        started_count++;
+    }
+
+    int answered = 0;
+    int rc = PROVIDER_ERR_NETWORK;
+
+    while (api_async_pending(async) > 0) {
+        profile_begin(PROFILE_FETCH);
+        api_request_t *done = api_async_next(async, 1000);
+        profile_end(PROFILE_FETCH);
+        if (!done) {
+            continue;
+        }
+
+        int slot = (int)(done - requests);
+        const provider_t *provider = &providers[index_of[slot]];
+
+        crypto_data_t data = {0};
+        profile_begin(PROFILE_PARSE);
+        if (done->result == 0) {
+            answered = 1;
+            data = provider->parse_quote(done->data, query);
+        }
+        free(done->data);
+        done->data = NULL;
+        profile_end(PROFILE_PARSE);
+
+        if (data.success || api_remaining_ms() > 0) {
+            stats_record(index_of[slot], api_monotonic_ms() - started, !data.success);
+        }
+
+        if (data.success) {
+            *out = data;
+            if (used) {
+                *used = provider->name;
+            }
+            rc = PROVIDER_OK;
+            break;
+        }
+        free_crypto_data(&data);
+    }
+
+    // Cancels the losers; their latency is unknown, so they are not recorded
+    api_async_free(async);
+    for (int k = 0; k < started_count; k++) {
+        free(requests[k].data);
+        free(urls[k]);
+    }
+
+    if (rc != PROVIDER_OK && answered) {
+        rc = PROVIDER_ERR_NOT_FOUND;
+    }
+    return rc;
+}
+
+int provider_fetch_quote(const quote_query_t *query, const char *provider_name, int race,
+                         crypto_data_t *out, const char **used) {
+    if (!query || !query->id || !query->currency || !out) {
+        return PROVIDER_ERR_NETWORK;
+    }
+    memset(out, 0, sizeof(*out));
+
+    stats_load();
+
+    int order[PROVIDER_MAX];
+    int count;
+
+    if (provider_name) {
+        const provider_t *provider = provider_find(provider_name);
+        if (!provider) {
+            return PROVIDER_ERR_NETWORK;
+        }
+        order[0] = (int)(provider - providers);
+        count = 1;
+    } else {
+        count = rank_providers(order);
+    }
+
+    int rc = race && count > 1
+        ? fetch_race(query, order, count, out, used)
+        : fetch_sequential(query, order, count, out, used);
+
+    // Replayed latencies say nothing about the live providers
+    if (!api_replay_enabled()) {
+        stats_save();
+    }
+    return rc;
+}
@@ -0,0 +1,91 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <sched.h>
+#include <time.h>
+#include "../include/queue.h"
+
+int spsc_queue_init(spsc_queue_t *q, size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+
+    q->slots = calloc(size, sizeof(void *));
+    if (!q->slots) {
+        return -1;
+    }
+
+    q->mask = size - 1;
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->closed, 0);
+    return 0;
+}
+
+int spsc_queue_try_push(spsc_queue_t *q, void *item) {
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+    if (tail - head > q->mask) {
+        return 0;
+    }
+
+    q->slots[tail & q->mask] = item;
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+int spsc_queue_try_pop(spsc_queue_t *q, void **item) {
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    if (head == tail) {
+        return 0;
+    }
+
+    *item = q->slots[head & q->mask];
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return 1;
+}
+
+// Spin briefly, then yield, then sleep so an idle stage does not burn a core
+static void backoff(int *spins) {
+    if (*spins < 64) {
+        (*spins)++;
+    } else if (*spins < 128) {
+        (*spins)++;
+        sched_yield();
+    } else {
+        struct timespec ts = { 0, 200000 };
+        nanosleep(&ts, NULL);
+    }
+}
+
+void spsc_queue_push(spsc_queue_t *q, void *item) {
+    int spins = 0;
+    while (!spsc_queue_try_push(q, item)) {
+        backoff(&spins);
+    }
+}
+
+int spsc_queue_pop(spsc_queue_t *q, void **item) {
+    int spins = 0;
+    for (;;) {
+        if (spsc_queue_try_pop(q, item)) {
+            return 1;
+        }
+        if (atomic_load_explicit(&q->closed, memory_order_acquire)) {
+            // Re-check: items pushed before close must still be delivered
+            return spsc_queue_try_pop(q, item);
+        }
+        backoff(&spins);
+    }
+}
+
+void spsc_queue_close(spsc_queue_t *q) {
+    atomic_store_explicit(&q->closed, 1, memory_order_release);
+}
+
+void spsc_queue_destroy(spsc_queue_t *q) {
+    free(q->slots);
+    q->slots = NULL;
+}
@@ -0,0 +1,374 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include "../include/quotefeed.h"
+
+#define ALIGN64(n) (((n) + 63) & ~(uint64_t)63)
+
+static int64_t realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void copy_text(char *dst, size_t size, const char *src) {
+    snprintf(dst, size, "%s", src ? src : "");
+}
+
+static void bind_layout(quote_feed_t *feed) {
+    unsigned char *bytes = feed->base;
+    feed->header = feed->base;
+    feed->slots = (quote_slot_t *)(bytes + feed->header->slots_offset);
+    feed->ring = (quote_update_t *)(bytes + feed->header->ring_offset);
+}
+
+// Refresh interval and last heartbeat of the segment open on fd;
+// -1 while the segment is incomplete (no magic yet)
+static int segment_liveness(int fd, long *interval_ms, int64_t *heartbeat_ns) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(quote_feed_header_t)) {
+        return -1;
+    }
+    void *base = mmap(NULL, sizeof(quote_feed_header_t), PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+    const quote_feed_header_t *header = base;
+    int complete = memcmp(header->magic, QUOTE_FEED_MAGIC, sizeof(header->magic)) == 0;
+    atomic_thread_fence(memory_order_acquire);
+    *interval_ms = (long)header->interval * 1000L;
+    *heartbeat_ns = atomic_load_explicit(&header->heartbeat_ns, memory_order_acquire);
+    munmap(base, sizeof(quote_feed_header_t));
+    return complete ? 0 : -1;
+}
+
+/**
+ * @brief Remove the segment under name if its writer has stopped
+ *
+ * A writer holds an exclusive flock on its segment from creation until it
+ * exits, so a lock that can be taken means the writer is gone, unless the
+ * segment is still incomplete and young: its creator may not have locked
+ * it yet. A locked segment is replaced only once its heartbeat is more
+ * than QUOTE_FEED_STALE_INTERVALS intervals old. The name is unlinked only
+ * while it still refers to the segment that was judged.
+ *
+ * @return int 1 if the name is free to create again, 0 if a writer owns it
+ */
+static int remove_stopped(const char *name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return errno == ENOENT;
+    }
+
+    struct stat st;
+    int unlocked = flock(fd, LOCK_EX | LOCK_NB) == 0;
+    long interval_ms = 0;
+    int64_t heartbeat_ns = 0;
+    int complete = segment_liveness(fd, &interval_ms, &heartbeat_ns) == 0;
+    int stopped;
+    if (fstat(fd, &st) != 0) {
+        stopped = 0;
+    } else if (unlocked) {
+        stopped = complete || (long)time(NULL) - (long)st.st_ctime > QUOTE_FEED_CREATE_GRACE;
+    } else {
+        // Before its first refresh a live writer has no heartbeat yet
+        int64_t age_ms = (realtime_ns() - heartbeat_ns) / 1000000;
+        stopped = complete && heartbeat_ns > 0 && interval_ms > 0 &&
+                  age_ms > QUOTE_FEED_STALE_INTERVALS * (int64_t)interval_ms;
+    }
+
+    if (stopped) {
+        int current = shm_open(name, O_RDONLY, 0);
+        struct stat now;
+        if (current >= 0 && fstat(current, &now) == 0 &&
+            now.st_dev == st.st_dev && now.st_ino == st.st_ino) {
+            shm_unlink(name);
+        }
+        if (current >= 0) {
+            close(current);
+        }
+    }
+    close(fd);
+    return stopped;
+}
+
+int quote_feed_create(const char *name, const char *const *ids, int count, int interval,
+                      quote_feed_t *feed) {
+    memset(feed, 0, sizeof(*feed));
+    if (!name || !ids || count <= 0 || strlen(name) >= sizeof(feed->name)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    uint64_t slots_offset = ALIGN64(sizeof(quote_feed_header_t));
+    uint64_t ring_offset = ALIGN64(slots_offset + (uint64_t)count * sizeof(quote_slot_t));
+    size_t size = (size_t)(ring_offset + (uint64_t)QUOTE_FEED_RING * sizeof(quote_update_t));
+
+    // A segment left by a stopped writer is replaced; its readers keep the
+    // old mapping. A running writer keeps its name. Writers that race for
+    // a stopped segment's name retry, and only one O_EXCL create wins.
+    int fd = -1;
+    for (int attempt = 0; fd < 0 && attempt < 3; attempt++) {
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0 && errno != EEXIST) {
+            return -1;
+        }
+        if (fd < 0 && !remove_stopped(name)) {
+            errno = EEXIST;
+            return -1;
+        }
+    }
+    if (fd < 0) {
+        errno = EEXIST;
+        return -1;
+    }
+
+    // Held until this writer closes the feed or exits
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (flock(fd, LOCK_EX) == 0 && fstat(fd, &st) == 0 && ftruncate(fd, (off_t)size) == 0) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (base == MAP_FAILED) {
+        int saved = errno;
+        shm_unlink(name);
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+
+    // ftruncate zero-fills: every slot starts unpublished (seq 0)
+    feed->base = base;
+    feed->size = size;
+    feed->writer = 1;
+    feed->lock_fd = fd;
+    feed->dev = st.st_dev;
+    feed->ino = st.st_ino;
+    copy_text(feed->name, sizeof(feed->name), name);
+
+    quote_feed_header_t *header = base;
+    header->version = QUOTE_FEED_VERSION;
+    header->slot_count = (uint32_t)count;
+    header->ring_size = QUOTE_FEED_RING;
+    header->interval = interval > 0 ? (uint32_t)interval : 0;
+    header->slots_offset = slots_offset;
+    header->ring_offset = ring_offset;
+    header->writer_pid = (int64_t)getpid();
+    bind_layout(feed);
+
+    for (int i = 0; i < count; i++) {
+        copy_text(feed->slots[i].record.id, sizeof(feed->slots[i].record.id), ids[i]);
+    }
+
+    atomic_thread_fence(memory_order_release);
+    memcpy(header->magic, QUOTE_FEED_MAGIC, sizeof(header->magic));
+    return 0;
+}
+
+void quote_feed_publish(quote_feed_t *feed, int slot, const crypto_data_t *quote) {
+    if (!feed->writer || slot < 0 || (uint32_t)slot >= feed->header->slot_count || !quote) {
+        return;
+    }
+    quote_slot_t *target = &feed->slots[slot];
+
+    // Build the record first so the odd window only covers a memcpy
+    quote_record_t record;
+    memset(&record, 0, sizeof(record));
+    copy_text(record.id, sizeof(record.id), target->record.id);
+    copy_text(record.symbol, sizeof(record.symbol), quote->symbol);
+    copy_text(record.name, sizeof(record.name), quote->name);
+    copy_text(record.currency, sizeof(record.currency), quote->currency);
+    record.current_price = quote->current_price;
+    record.price_change_24h = quote->price_change_24h;
+    record.price_change_percentage_24h = quote->price_change_percentage_24h;
+    record.market_cap = quote->market_cap;
+    record.volume_24h = quote->volume_24h;
+    record.high_24h = quote->high_24h;
+    record.low_24h = quote->low_24h;
+    record.last_updated_at = quote->last_updated_at;
+    record.published_ns = realtime_ns();
+
+    uint64_t seq = atomic_load_explicit(&target->seq, memory_order_relaxed);
+    atomic_store_explicit(&target->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&target->record, &record, sizeof(record));
+    atomic_store_explicit(&target->seq, seq + 2, memory_order_release);
+
+    // Single writer: claim the next ring entry, fill it, then publish it
+    uint64_t position = atomic_load_explicit(&feed->header->head, memory_order_relaxed);
+    quote_update_t *entry = &feed->ring[position & (QUOTE_FEED_RING - 1)];
+    atomic_store_explicit(&entry->stamp, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&entry->slot, (uint32_t)slot, memory_order_relaxed);
+    atomic_store_explicit(&entry->slot_seq, seq + 2, memory_order_relaxed);
+    atomic_store_explicit(&entry->stamp, position + 1, memory_order_release);
+    atomic_store_explicit(&feed->header->head, position + 1, memory_order_release);
+}
+
+void quote_feed_heartbeat(quote_feed_t *feed) {
+    if (feed->writer) {
+        atomic_store_explicit(&feed->header->heartbeat_ns, realtime_ns(), memory_order_release);
+    }
+}
+
+void quote_feed_close(quote_feed_t *feed) {
+    if (feed->base) {
+        munmap(feed->base, feed->size);
+    }
+    if (feed->writer) {
+        // A writer that replaced this one after it stalled owns the name now
+        int fd = shm_open(feed->name, O_RDONLY, 0);
+        struct stat st;
+        if (fd >= 0) {
+            if (fstat(fd, &st) == 0 && st.st_dev == feed->dev && st.st_ino == feed->ino) {
+                shm_unlink(feed->name);
+            }
+            close(fd);
+        }
+        close(feed->lock_fd);
+    }
+    memset(feed, 0, sizeof(*feed));
+}
+
+int quote_feed_open(const char *name, quote_feed_t *feed) {
+    memset(feed, 0, sizeof(*feed));
+    if (!name || strlen(name) >= sizeof(feed->name)) {
+        return -1;
+    }
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(quote_feed_header_t)) {
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+
+    const quote_feed_header_t *header = base;
+    int valid = memcmp(header->magic, QUOTE_FEED_MAGIC, sizeof(header->magic)) == 0;
+    atomic_thread_fence(memory_order_acquire);
+    valid = valid && header->version == QUOTE_FEED_VERSION &&
+            header->ring_size == QUOTE_FEED_RING && header->slot_count > 0 &&
+            header->slots_offset >= sizeof(quote_feed_header_t) && header->slots_offset % 64 == 0 &&
+            header->ring_offset >= header->slots_offset +
+                                   (uint64_t)header->slot_count * sizeof(quote_slot_t) &&
+            header->ring_offset % 64 == 0 &&
+            header->ring_offset + (uint64_t)QUOTE_FEED_RING * sizeof(quote_update_t) <= size;
+    if (!valid) {
+        munmap(base, size);
+        return -1;
+    }
+
+    feed->base = base;
+    feed->size = size;
+    copy_text(feed->name, sizeof(feed->name), name);
+    bind_layout(feed);
+    return 0;
+}
+
+int quote_feed_find(const quote_feed_t *feed, const char *id) {
+    if (!feed->base || !id) {
+        return -1;
+    }
+    // Slot ids are fixed when the segment is created
+    for (uint32_t i = 0; i < feed->header->slot_count; i++) {
+        if (strncmp(feed->slots[i].record.id, id, sizeof(feed->slots[i].record.id)) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+int quote_feed_read(const quote_feed_t *feed, int slot, quote_record_t *out) {
+    if (!feed->base || slot < 0 || (uint32_t)slot >= feed->header->slot_count || !out) {
+        return -1;
+    }
+    const quote_slot_t *source = &feed->slots[slot];
+
+    for (int attempt = 0; attempt < QUOTE_FEED_READ_RETRIES; attempt++) {
+        uint64_t before = atomic_load_explicit(&source->seq, memory_order_acquire);
+        if (before == 0) {
+            return 1;
+        }
+        if (before & 1) {
+            continue;
+        }
+        memcpy(out, &source->record, sizeof(*out));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&source->seq, memory_order_relaxed) == before) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int quote_feed_next(const quote_feed_t *feed, uint64_t *cursor, uint32_t *slot, uint64_t *lost) {
+    if (!feed->base || !cursor || !slot) {
+        return 0;
+    }
+
+    for (;;) {
+        uint64_t head = atomic_load_explicit(&feed->header->head, memory_order_acquire);
+        if (*cursor >= head) {
+            return 0;
+        }
+        // Lapped by the writer: the oldest entry still held is head - ring size
+        if (head - *cursor > QUOTE_FEED_RING) {
+            if (lost) {
+                *lost += head - QUOTE_FEED_RING - *cursor;
+            }
+            *cursor = head - QUOTE_FEED_RING;
+        }
+
+        const quote_update_t *entry = &feed->ring[*cursor & (QUOTE_FEED_RING - 1)];
+        uint64_t stamp = atomic_load_explicit(&entry->stamp, memory_order_acquire);
+        if (stamp == *cursor + 1) {
+            uint32_t value = atomic_load_explicit(&entry->slot, memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&entry->stamp, memory_order_relaxed) == stamp &&
+                value < feed->header->slot_count) {
+                *slot = value;
+                (*cursor)++;
+                return 1;
+            }
+        }
+
+        // Overwritten while being read: skip it and look again
+        if (lost) {
+            (*lost)++;
+        }
+        (*cursor)++;
+    }
+}
+
+uint64_t quote_feed_head(const quote_feed_t *feed) {
+    return feed->base ? atomic_load_explicit(&feed->header->head, memory_order_acquire) : 0;
+}
+
+long quote_feed_heartbeat_age_ms(const quote_feed_t *feed) {
+    if (!feed->base) {
+        return -1;
+    }
+    int64_t beat = atomic_load_explicit(&feed->header->heartbeat_ns, memory_order_acquire);
+    if (beat == 0) {
+        return -1;
+    }
+    return (long)((realtime_ns() - beat) / 1000000);
+}
@@ -0,0 +1,63 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <time.h>
+#include "../include/ratelimit.h"
+#include "../include/api.h"
+
+static void refill(ratelimit_t *rl, double now) {
+    rl->tokens += (now - rl->last) * rl->rate;
+    if (rl->tokens > rl->burst) {
+        rl->tokens = rl->burst;
+    }
+    rl->last = now;
+}
+
+void ratelimit_init(ratelimit_t *rl, double per_minute, double burst) {
+    rl->rate = per_minute > 0 ? per_minute / 60.0 : 0.0;
+    rl->burst = burst >= 1.0 ? burst : 1.0;
+    rl->tokens = rl->burst;
+    rl->last = api_monotonic_ms() / 1000.0;
+    pthread_mutex_init(&rl->lock, NULL);
+}
+
+void ratelimit_acquire(ratelimit_t *rl) {
+    if (rl->rate <= 0) {
+        return;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&rl->lock);
+        refill(rl, api_monotonic_ms() / 1000.0);
+        if (rl->tokens >= 1.0) {
+            rl->tokens -= 1.0;
+            pthread_mutex_unlock(&rl->lock);
+            return;
+        }
+        double wait = (1.0 - rl->tokens) / rl->rate;
+        pthread_mutex_unlock(&rl->lock);
+
+        struct timespec ts;
+        ts.tv_sec = (time_t)wait;
+        ts.tv_nsec = (long)((wait - (double)ts.tv_sec) * 1e9);
+        nanosleep(&ts, NULL);
+    }
+}
+
+int ratelimit_try_acquire(ratelimit_t *rl) {
+    if (rl->rate <= 0) {
+        return 1;
+    }
+
+    pthread_mutex_lock(&rl->lock);
+    refill(rl, api_monotonic_ms() / 1000.0);
+    int ok = rl->tokens >= 1.0;
+    if (ok) {
+        rl->tokens -= 1.0;
+    }
+    pthread_mutex_unlock(&rl->lock);
+    return ok;
+}
+
+void ratelimit_destroy(ratelimit_t *rl) {
+    pthread_mutex_destroy(&rl->lock);
+}
@@ -0,0 +1,48 @@
+#include <string.h>
+#include <math.h>
+#include "../include/rates.h"
+
+void rates_prepare(const double *values, int count, double *inverse) {
+    for (int j = 0; j < count; j++) {
+        inverse[j] = values[j] > 0.0 ? 1.0 / values[j] : NAN;
+    }
+}
+
+#if defined(__GNUC__)
+
+// Four lanes; GCC lowers this to AVX or to pairs of SSE2 operations
+typedef double rates_v4 __attribute__((vector_size(32)));
+
+static void scale_row(double *restrict out, const double *restrict inverse, int n, double value) {
+    rates_v4 scale = { value, value, value, value };
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        rates_v4 v;
+        memcpy(&v, inverse + j, sizeof(v));   // Unaligned load
+        v *= scale;
+        memcpy(out + j, &v, sizeof(v));
+    }
+    for (; j < n; j++) {
+        out[j] = value * inverse[j];
+    }
+}
+
+#else
+
+static void scale_row(double *restrict out, const double *restrict inverse, int n, double value) {
+    for (int j = 0; j < n; j++) {
+        out[j] = value * inverse[j];
+    }
+}
+
+#endif
+
+void rates_block(const double *row_values, int rows, const double *inverse, int cols,
+                 double *out) {
+    for (int tile = 0; tile < cols; tile += RATES_BLOCK_COLS) {
+        int n = cols - tile < RATES_BLOCK_COLS ? cols - tile : RATES_BLOCK_COLS;
+        for (int i = 0; i < rows; i++) {
+            scale_row(out + (size_t)i * (size_t)cols + tile, inverse + tile, n, row_values[i]);
+        }
+    }
+}
@@ -0,0 +1,204 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "../include/screen.h"
+
+static void blank_cells(screen_cell_t *cells, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        cells[i].glyph[0] = ' ';
+        cells[i].glyph[1] = '\0';
+        cells[i].attr = SCREEN_ATTR_NONE;
+    }
+}
+
+int screen_init(screen_t *screen, int rows, int cols) {
+    if (!screen || rows <= 0 || cols <= 0) {
+        return -1;
+    }
+
+    *screen = (screen_t){0};
+    return screen_resize(screen, rows, cols);
+}
+
+int screen_resize(screen_t *screen, int rows, int cols) {
+    if (!screen || rows <= 0 || cols <= 0) {
+        return -1;
+    }
+
+    size_t count = (size_t)rows * (size_t)cols;
+    screen_cell_t *front = malloc(sizeof(screen_cell_t) * count);
+    screen_cell_t *back = malloc(sizeof(screen_cell_t) * count);
+    if (!front || !back) {
+        free(front);
+        free(back);
+        return -1;
+    }
+
+    blank_cells(front, count);
+    blank_cells(back, count);
+
+    free(screen->front);
+    free(screen->back);
+    screen->front = front;
+    screen->back = back;
+    screen->rows = rows;
+    screen->cols = cols;
+    screen->full_redraw = 1;
+    return 0;
+}
+
+void screen_clear(screen_t *screen) {
+    if (screen && screen->back) {
+        blank_cells(screen->back, (size_t)screen->rows * (size_t)screen->cols);
+    }
+}
+
+// Length of the UTF-8 sequence starting with byte c
+static int utf8_length(unsigned char c) {
+    if (c < 0x80) return 1;
+    if ((c & 0xE0) == 0xC0) return 2;
+    if ((c & 0xF0) == 0xE0) return 3;
+    if ((c & 0xF8) == 0xF0) return 4;
+    return 1;
+}
+
+int screen_put(screen_t *screen, int row, int col, const char *text, unsigned char attr) {
+    if (!screen || !text || row < 0 || row >= screen->rows || col < 0) {
+        return 0;
+    }
+
+    int written = 0;
+    const unsigned char *p = (const unsigned char *)text;
+    while (*p && col < screen->cols) {
+        int len = utf8_length(*p);
+        screen_cell_t *cell = &screen->back[row * screen->cols + col];
+
+        int k = 0;
+        for (; k < len && p[k]; k++) {
+            cell->glyph[k] = (char)p[k];
+        }
+        cell->glyph[k] = '\0';
+        cell->attr = attr;
+
+        p += k;
+        col++;
+        written++;
+    }
+    return written;
+}
+
+static int out_append(screen_t *screen, const char *data, size_t len) {
+    if (screen->out_len + len > screen->out_cap) {
+        size_t cap = screen->out_cap ? screen->out_cap : 8192;
+        while (cap < screen->out_len + len) {
+            cap *= 2;
+        }
+        char *out = realloc(screen->out, cap);
+        if (!out) {
+            return -1;
+        }
+        screen->out = out;
+        screen->out_cap = cap;
+    }
+
+    memcpy(screen->out + screen->out_len, data, len);
+    screen->out_len += len;
+    return 0;
+}
+
+static int emit_attr(screen_t *screen, unsigned char attr) {
+    char sgr[32] = "\x1b[0";
+    size_t len = 3;
+    if (attr & SCREEN_ATTR_BOLD) { memcpy(sgr + len, ";1", 2); len += 2; }
+    if (attr & SCREEN_ATTR_DIM) { memcpy(sgr + len, ";2", 2); len += 2; }
+    if (attr & SCREEN_ATTR_REVERSE) { memcpy(sgr + len, ";7", 2); len += 2; }
+    if (attr & SCREEN_ATTR_GREEN) { memcpy(sgr + len, ";32", 3); len += 3; }
+    if (attr & SCREEN_ATTR_RED) { memcpy(sgr + len, ";31", 3); len += 3; }
+    sgr[len++] = 'm';
+    return out_append(screen, sgr, len);
+}
+
+static int write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int screen_flush(screen_t *screen, int fd) {
+    if (!screen || !screen->back) {
+        return -1;
+    }
+
+    screen->out_len = 0;
+    if (screen->full_redraw) {
+        out_append(screen, "\x1b[0m\x1b[2J", 8);
+    }
+
+    // Cursor position / attribute the terminal is known to have; -1 = unknown
+    int cursor_row = -1;
+    int cursor_col = -1;
+    int current_attr = -1;
+
+    for (int row = 0; row < screen->rows; row++) {
+        for (int col = 0; col < screen->cols; col++) {
+            size_t i = (size_t)row * (size_t)screen->cols + (size_t)col;
+            screen_cell_t *back = &screen->back[i];
+            screen_cell_t *front = &screen->front[i];
+
+            if (!screen->full_redraw && back->attr == front->attr &&
+                strcmp(back->glyph, front->glyph) == 0) {
+                continue;
+            }
+
+            // Only move the cursor when the changed cell is not the next one
+            if (row != cursor_row || col != cursor_col) {
+                char move[24];
+                int len = snprintf(move, sizeof(move), "\x1b[%d;%dH", row + 1, col + 1);
+                out_append(screen, move, (size_t)len);
+            }
+            if (back->attr != current_attr) {
+                emit_attr(screen, back->attr);
+                current_attr = back->attr;
+            }
+            out_append(screen, back->glyph, strlen(back->glyph));
+
+            *front = *back;
+            cursor_row = row;
+            cursor_col = col + 1;
+        }
+    }
+
+    if (current_attr > 0) {
+        out_append(screen, "\x1b[0m", 4);
+    }
+    screen->full_redraw = 0;
+
+    if (screen->out_len > 0 && write_all(fd, screen->out, screen->out_len) != 0) {
+        return -1;
+    }
+    return (int)screen->out_len;
+}
+
+void screen_free(screen_t *screen) {
+    if (!screen) {
+        return;
+    }
+
+    free(screen->front);
+    free(screen->back);
+    free(screen->out);
+    *screen = (screen_t){0};
+}
@@ -0,0 +1,163 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "../include/search.h"
+#include "../include/coinindex.h"
+#include "../include/api.h"
+#include "../include/parser.h"
+#include "../include/display.h"
+#include "../include/paths.h"
+#include "../include/output.h"
+
+#define SEARCH_INDEX_FILE "coins.idx"
+#define SEARCH_DEFAULT_LIMIT 10
+#define SEARCH_MAX_LIMIT 100
+#define SEARCH_QUERY_MAX 256
+#define SUGGEST_COUNT 3
+
+static int index_path(char *out, size_t size) {
+    return paths_cache_file("index", SEARCH_INDEX_FILE, out, size);
+}
+
+// Download /coins/list and rebuild the index
+static int refresh_index(const char *path) {
+    char *url = get_coin_list_url();
+    char *json = NULL;
+    int rc = url ? api_fetch_url(NULL, url, &json, NULL) : -1;
+    free(url);
+    if (rc != 0) {
+        return -1;
+    }
+
+    markets_data_t coins = parse_markets_json(json, INT_MAX);
+    free(json);
+    rc = coins.success && coins.count > 0 ? coin_index_write(path, &coins) : -1;
+    free_markets_data(&coins);
+    return rc;
+}
+
+static void print_search_usage(void) {
+    printf("Usage: crypto search TEXT... [--limit N] [--refresh]\n");
+    printf("  Find coins by id, symbol or name (typos are tolerated).\n");
+    printf("  --limit N   Number of results (default: %d)\n", SEARCH_DEFAULT_LIMIT);
+    printf("  --refresh   Download the coin list again before searching\n");
+}
+
+int search_command(int argc, char *argv[], const cli_options_t *options) {
+    char query[SEARCH_QUERY_MAX] = "";
+    size_t query_len = 0;
+    int limit = SEARCH_DEFAULT_LIMIT;
+    int refresh = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--limit") == 0 && i + 1 < argc) {
+            limit = atoi(argv[++i]);
+            if (limit <= 0 || limit > SEARCH_MAX_LIMIT) {
+                char message[64];
+                snprintf(message, sizeof(message), "--limit must be between 1 and %d", SEARCH_MAX_LIMIT);
+                display_error(message);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--refresh") == 0) {
+            refresh = 1;
+        } else if (argv[i][0] == '-') {
+            print_search_usage();
+            return 1;
+        } else {
+            // Words are joined: "crypto search shiba inu"
+            int n = snprintf(query + query_len, sizeof(query) - query_len, "%s%s",
+                             query_len ? " " : "", argv[i]);
+            if (n < 0 || (size_t)n >= sizeof(query) - query_len) {
+                display_error("Search text is too long");
+                return 1;
+            }
+            query_len += (size_t)n;
+        }
+    }
+    if (query_len == 0) {
+        print_search_usage();
+        return 1;
+    }
+
+    char path[1024];
+    if (index_path(path, sizeof(path)) != 0) {
+        display_error("Cannot create the cache directory for the coin index");
+        return 1;
+    }
+
+    coin_index_t index;
+    int have_index = coin_index_open(path, &index) == 0;
+    if (!have_index || refresh || time(NULL) - index.created_at > SEARCH_INDEX_MAX_AGE) {
+        if (refresh_index(path) == 0) {
+            if (have_index) {
+                coin_index_close(&index);
+            }
+            have_index = coin_index_open(path, &index) == 0;
+        } else if (have_index) {
+            fprintf(stderr, "Warning: could not update the coin list, searching the old one\n");
+        }
+    }
+    if (!have_index) {
+        display_error("Failed to fetch the coin list from API. Please check your internet connection and try again.");
+        return 1;
+    }
+
+    coin_match_t matches[SEARCH_MAX_LIMIT];
+    int found = coin_index_search(&index, query, matches, limit);
+    if (found < 0) {
+        coin_index_close(&index);
+        display_error("Memory allocation failed");
+        return 1;
+    }
+    if (found == 0) {
+        coin_index_close(&index);
+        fprintf(stderr, "No coins match '%s'\n", query);
+        return 1;
+    }
+
+    static const char *const columns[] = { "id", "symbol", "name", "score" };
+    output_t out;
+    output_begin(&out, stdout, options->format, columns, 4, 20);
+    for (int i = 0; i < found; i++) {
+        output_row_begin(&out);
+        output_string(&out, coin_index_string(&index, matches[i].coin, COIN_INDEX_ID));
+        output_string(&out, coin_index_string(&index, matches[i].coin, COIN_INDEX_SYMBOL));
+        output_string(&out, coin_index_string(&index, matches[i].coin, COIN_INDEX_NAME));
+        output_number(&out, (double)(long)(matches[i].score * 1000.0 + 0.5) / 1000.0);
+        output_row_end(&out);
+    }
+    output_end(&out);
+
+    coin_index_close(&index);
+    return 0;
+}
+
+void search_suggest(const char *query) {
+    char path[1024];
+    coin_index_t index;
+    if (!query || index_path(path, sizeof(path)) != 0 || coin_index_open(path, &index) != 0) {
+        return;
+    }
+
+    coin_match_t matches[SUGGEST_COUNT];
+    int found = coin_index_search(&index, query, matches, SUGGEST_COUNT);
+    int printed = 0;
+    for (int i = 0; i < found; i++) {
+        if (matches[i].score < COIN_INDEX_SUGGEST_SCORE) {
+            break;
+        }
+        fprintf(stderr, "%s %s (%s)", printed ? "," : "Did you mean:",
+                coin_index_string(&index, matches[i].coin, COIN_INDEX_ID),
+                coin_index_string(&index, matches[i].coin, COIN_INDEX_NAME));
+        printed++;
+    }
+    if (printed) {
+        fprintf(stderr, "?\n");
+    }
+
+    coin_index_close(&index);
+}
@@ -0,0 +1,807 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include "../include/serve.h"
+#include "../include/api.h"
+#include "../include/parser.h"
+#include "../include/display.h"
+#include "../include/coinids.h"
+#include "../include/options.h"
+
+#define SERVE_DEFAULT_LISTEN "127.0.0.1:9464"
+#define SERVE_DEFAULT_COINS "bitcoin,ethereum"
+#define SERVE_DEFAULT_INTERVAL 30
+#define SERVE_CHUNK 100               // Ids per simple/price request
+#define SERVE_MAX_CONNECTIONS 256
+#define SERVE_REQUEST_MAX 8192
+
+// Upper bounds of the fetch latency histogram (seconds)
+static const double latency_buckets[] = { 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10 };
+#define LATENCY_BUCKETS (sizeof(latency_buckets) / sizeof(latency_buckets[0]))
+
+/**
+ * @brief A fully rendered HTTP response for /metrics
+ *
+ * refs is only touched by the server thread, once it has taken the
+ * snapshot out of serve_state_t.pending.
+ */
+typedef struct {
+    char *data;
+    size_t size;
+    int refs;
+} snapshot_t;
+
+/**
+ * @brief Latest values for one coin (refresher thread only)
+ */
+typedef struct {
+    const char *id;          // Interned, like the ids of parsed quotes
+    crypto_data_t quote;
+    int have;
+} coin_metrics_t;
+
+/**
+ * @brief State shared between the refresher and the server thread
+ */
+typedef struct {
+    coin_metrics_t *coins;
+    int count;
+    const char *currency;
+    int interval;
+
+    // Exporter self-metrics (refresher thread only)
+    unsigned long latency_counts[LATENCY_BUCKETS];
+    unsigned long latency_count;
+    double latency_sum;
+    unsigned long fetch_errors;
+    unsigned long refreshes;
+    int last_refresh_ok;
+    time_t last_refresh;
+
+    _Atomic(snapshot_t *) pending;   // Newest rendered snapshot not yet picked up
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    int stop;
+} serve_state_t;
+
+/**
+ * @brief One client connection (server thread only)
+ */
+typedef struct {
+    int fd;
+    char request[SERVE_REQUEST_MAX];
+    size_t request_len;
+    snapshot_t *snapshot;     // Held while its bytes are being written
+    const char *out;
+    size_t out_len;
+    size_t out_pos;
+    int close_after;
+} connection_t;
+
+static int signal_fd = -1;
+static volatile sig_atomic_t quit_requested = 0;
+
+static void on_terminate(int sig) {
+    (void)sig;
+    quit_requested = 1;
+    if (signal_fd >= 0) {
+        ssize_t n = write(signal_fd, "q", 1);
+        (void)n;
+    }
+}
+
+/**
+ * @brief Growable text buffer for rendering
+ */
+struct text {
+    char *data;
+    size_t size;
+    size_t capacity;
+    int failed;
+};
+
+static void text_printf(struct text *t, const char *format, ...) {
+    if (t->failed) {
+        return;
+    }
+
+    for (;;) {
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(t->data + t->size, t->capacity - t->size, format, args);
+        va_end(args);
+
+        if (n < 0) {
+            t->failed = 1;
+            return;
+        }
+        if ((size_t)n < t->capacity - t->size) {
+            t->size += (size_t)n;
+            return;
+        }
+
+        size_t capacity = t->capacity ? t->capacity * 2 : 4096;
+        while (capacity < t->size + (size_t)n + 1) {
+            capacity *= 2;
+        }
+        char *data = realloc(t->data, capacity);
+        if (!data) {
+            t->failed = 1;
+            return;
+        }
+        t->data = data;
+        t->capacity = capacity;
+    }
+}
+
+// One gauge family: HELP, TYPE and a sample per coin that has data
+static void render_gauge(struct text *t, const serve_state_t *state, const char *name, const char *help,
+                         size_t field_offset) {
+    text_printf(t, "# HELP %s %s\n# TYPE %s gauge\n", name, help, name);
+    for (int i = 0; i < state->count; i++) {
+        const coin_metrics_t *coin = &state->coins[i];
+        if (!coin->have) {
+            continue;
+        }
+        double value = *(const double *)((const char *)&coin->quote + field_offset);
+        // Ids are [a-z0-9-] and currencies [a-z], so labels need no escaping
+        text_printf(t, "%s{id=\"%s\",currency=\"%s\"} %.12g\n", name, coin->id, state->currency, value);
+    }
+}
+
+static snapshot_t *render_snapshot(const serve_state_t *state) {
+    struct text body = { NULL, 0, 0, 0 };
+
+    render_gauge(&body, state, "crypto_price", "Current price",
+                 offsetof(crypto_data_t, current_price));
+    render_gauge(&body, state, "crypto_market_cap", "Market capitalisation",
+                 offsetof(crypto_data_t, market_cap));
+    render_gauge(&body, state, "crypto_volume_24h", "Trading volume over the last 24 hours",
+                 offsetof(crypto_data_t, volume_24h));
+    render_gauge(&body, state, "crypto_price_change_percentage_24h", "Price change over the last 24 hours in percent",
+                 offsetof(crypto_data_t, price_change_percentage_24h));
+
+    text_printf(&body, "# HELP crypto_last_updated_timestamp_seconds When the API last updated the quote\n");
+    text_printf(&body, "# TYPE crypto_last_updated_timestamp_seconds gauge\n");
+    for (int i = 0; i < state->count; i++) {
+        const coin_metrics_t *coin = &state->coins[i];
+        if (coin->have) {
+            text_printf(&body, "crypto_last_updated_timestamp_seconds{id=\"%s\",currency=\"%s\"} %ld\n",
+                        coin->id, state->currency, coin->quote.last_updated_at);
+        }
+    }
+
+    text_printf(&body, "# HELP crypto_exporter_fetch_duration_seconds Upstream request latency\n");
+    text_printf(&body, "# TYPE crypto_exporter_fetch_duration_seconds histogram\n");
+    unsigned long cumulative = 0;
+    for (size_t b = 0; b < LATENCY_BUCKETS; b++) {
+        cumulative += state->latency_counts[b];
+        text_printf(&body, "crypto_exporter_fetch_duration_seconds_bucket{le=\"%g\"} %lu\n",
+                    latency_buckets[b], cumulative);
+    }
+    text_printf(&body, "crypto_exporter_fetch_duration_seconds_bucket{le=\"+Inf\"} %lu\n", state->latency_count);
+    text_printf(&body, "crypto_exporter_fetch_duration_seconds_sum %.6f\n", state->latency_sum);
+    text_printf(&body, "crypto_exporter_fetch_duration_seconds_count %lu\n", state->latency_count);
+
+    text_printf(&body, "# HELP crypto_exporter_fetch_errors_total Failed upstream requests\n");
+    text_printf(&body, "# TYPE crypto_exporter_fetch_errors_total counter\n");
+    text_printf(&body, "crypto_exporter_fetch_errors_total %lu\n", state->fetch_errors);
+    text_printf(&body, "# HELP crypto_exporter_refreshes_total Completed refresh cycles\n");
+    text_printf(&body, "# TYPE crypto_exporter_refreshes_total counter\n");
+    text_printf(&body, "crypto_exporter_refreshes_total %lu\n", state->refreshes);
+    text_printf(&body, "# HELP crypto_exporter_last_refresh_success Whether every request of the last refresh succeeded\n");
+    text_printf(&body, "# TYPE crypto_exporter_last_refresh_success gauge\n");
+    text_printf(&body, "crypto_exporter_last_refresh_success %d\n", state->last_refresh_ok);
+    text_printf(&body, "# HELP crypto_exporter_last_refresh_timestamp_seconds When the last refresh finished\n");
+    text_printf(&body, "# TYPE crypto_exporter_last_refresh_timestamp_seconds gauge\n");
+    text_printf(&body, "crypto_exporter_last_refresh_timestamp_seconds %ld\n", (long)state->last_refresh);
+
+    // Prepend the HTTP headers so a scrape is a single write of this buffer
+    struct text response = { NULL, 0, 0, 0 };
+    text_printf(&response,
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                "Content-Length: %zu\r\n"
+                "\r\n"
+                "%s", body.size, body.data ? body.data : "");
+    free(body.data);
+
+    snapshot_t *snapshot = malloc(sizeof(snapshot_t));
+    if (body.failed || response.failed || !snapshot) {
+        free(response.data);
+        free(snapshot);
+        return NULL;
+    }
+    snapshot->data = response.data;
+    snapshot->size = response.size;
+    snapshot->refs = 0;
+    return snapshot;
+}
+
+static void snapshot_free(snapshot_t *snapshot) {
+    if (snapshot) {
+        free(snapshot->data);
+        free(snapshot);
+    }
+}
+
+// Hand a new snapshot to the server; one it never picked up is dropped here
+static void publish_snapshot(serve_state_t *state, snapshot_t *snapshot) {
+    if (!snapshot) {
+        return;
+    }
+    snapshot_t *unused = atomic_exchange(&state->pending, snapshot);
+    snapshot_free(unused);
+}
+
+static void observe_latency(serve_state_t *state, double seconds) {
+    for (size_t b = 0; b < LATENCY_BUCKETS; b++) {
+        if (seconds <= latency_buckets[b]) {
+            state->latency_counts[b]++;
+            break;
+        }
+    }
+    state->latency_count++;
+    state->latency_sum += seconds;
+}
+
+// Fetch every coin in chunks; coins whose chunk fails keep their last values
+static void refresh(serve_state_t *state) {
+    int ok = 1;
+
+    for (int start = 0; start < state->count; start += SERVE_CHUNK) {
+        int end = start + SERVE_CHUNK < state->count ? start + SERVE_CHUNK : state->count;
+
+        char *csv = join_ids(&state->coins[start].id, sizeof(state->coins[0]), end - start);
+        if (!csv) {
+            ok = 0;
+            continue;
+        }
+
+        char *url = get_api_url_with_currency(csv, state->currency);
+        free(csv);
+        if (!url) {
+            ok = 0;
+            continue;
+        }
+
+        char *json = NULL;
+        double started = api_monotonic_ms() / 1000.0;
+        int rc = api_fetch_url(NULL, url, &json, NULL);
+        observe_latency(state, api_monotonic_ms() / 1000.0 - started);
+        free(url);
+
+        markets_data_t quotes = {0};
+        if (rc == 0) {
+            quotes = parse_simple_price_batch_json(json, state->currency);
+        }
+        free(json);
+
+        if (!quotes.success) {
+            state->fetch_errors++;
+            ok = 0;
+            free_markets_data(&quotes);
+            continue;
+        }
+
+        for (int q = 0; q < quotes.count; q++) {
+            crypto_data_t *quote = &quotes.coins[q];
+            int found = coin_ids_find(&state->coins[start].id, sizeof(state->coins[0]),
+                                      end - start, quote->id);
+            if (found >= 0) {
+                coin_metrics_t *coin = &state->coins[start + found];
+                free_crypto_data(&coin->quote);
+                coin->quote = *quote;
+                coin->have = 1;
+                memset(quote, 0, sizeof(*quote));
+            }
+        }
+        free_markets_data(&quotes);
+    }
+
+    state->refreshes++;
+    state->last_refresh_ok = ok;
+    state->last_refresh = time(NULL);
+}
+
+static void *refresh_thread(void *arg) {
+    serve_state_t *state = (serve_state_t *)arg;
+
+    pthread_mutex_lock(&state->lock);
+    while (!state->stop) {
+        pthread_mutex_unlock(&state->lock);
+
+        refresh(state);
+        publish_snapshot(state, render_snapshot(state));
+
+        pthread_mutex_lock(&state->lock);
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += state->interval;
+        while (!state->stop) {
+            if (pthread_cond_timedwait(&state->wake, &state->lock, &deadline) == ETIMEDOUT) {
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&state->lock);
+
+    return NULL;
+}
+
+// "HOST:PORT", "[V6]:PORT", ":PORT" (all interfaces) or "PORT" (loopback)
+static int open_listener(const char *spec) {
+    char host[256] = "127.0.0.1";
+    const char *port = spec;
+    int any_host = 0;
+
+    const char *colon = strrchr(spec, ':');
+    if (colon) {
+        const char *h = spec;
+        size_t len = (size_t)(colon - spec);
+        if (len >= 2 && h[0] == '[' && h[len - 1] == ']') {
+            h++;
+            len -= 2;
+        }
+        if (len >= sizeof(host)) {
+            return -1;
+        }
+        memcpy(host, h, len);
+        host[len] = '\0';
+        any_host = len == 0;
+        port = colon + 1;
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    struct addrinfo *addrs = NULL;
+    if (getaddrinfo(any_host ? NULL : host, port, &hints, &addrs) != 0) {
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct addrinfo *ai = addrs; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, 128) == 0) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addrs);
+
+    if (fd >= 0) {
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+    }
+    return fd;
+}
+
+/**
+ * @brief Server-side view of the published snapshots
+ */
+typedef struct {
+    serve_state_t *state;
+    snapshot_t *current;
+} snapshot_holder_t;
+
+static void snapshot_release(snapshot_t *snapshot) {
+    if (snapshot && --snapshot->refs == 0) {
+        snapshot_free(snapshot);
+    }
+}
+
+// Switch to the newest published snapshot, if any, and return the current one
+static snapshot_t *snapshot_acquire(snapshot_holder_t *holder) {
+    snapshot_t *next = atomic_exchange(&holder->state->pending, NULL);
+    if (next) {
+        next->refs = 1;   // The holder's own reference
+        snapshot_release(holder->current);
+        holder->current = next;
+    }
+    if (holder->current) {
+        holder->current->refs++;
+    }
+    return holder->current;
+}
+
+static const char response_not_found[] =
+    "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 10\r\n\r\nNot found\n";
+static const char response_not_allowed[] =
+    "HTTP/1.1 405 Method Not Allowed\r\nAllow: GET\r\nContent-Type: text/plain\r\nContent-Length: 19\r\n\r\nMethod not allowed\n";
+static const char response_too_large[] =
+    "HTTP/1.1 431 Request Header Fields Too Large\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+static const char response_unavailable[] =
+    "HTTP/1.1 503 Service Unavailable\r\nContent-Type: text/plain\r\nContent-Length: 21\r\n\r\nNo data rendered yet\n";
+static const char response_index[] =
+    "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 30\r\n\r\ncrypto-cli exporter: /metrics\n";
+
+static void connection_close(connection_t *conn) {
+    snapshot_release(conn->snapshot);
+    conn->snapshot = NULL;
+    close(conn->fd);
+    conn->fd = -1;
+}
+
+static void connection_set_output(connection_t *conn, const char *data, size_t size) {
+    conn->out = data;
+    conn->out_len = size;
+    conn->out_pos = 0;
+}
+
+static int header_has_token(const char *headers, size_t len, const char *name, const char *token) {
+    size_t name_len = strlen(name);
+    size_t token_len = strlen(token);
+    const char *end = headers + len;
+
+    for (const char *line = headers; line < end; ) {
+        const char *eol = memchr(line, '\n', (size_t)(end - line));
+        if (!eol) {
+            eol = end;
+        }
+        if ((size_t)(eol - line) > name_len && strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            for (const char *p = line + name_len + 1; p + token_len <= eol; p++) {
+                if (strncasecmp(p, token, token_len) == 0) {
+                    return 1;
+                }
+            }
+        }
+        line = eol + 1;
+    }
+    return 0;
+}
+
+// A complete request header is buffered: choose the response
+static void connection_respond(connection_t *conn, snapshot_holder_t *holder, size_t header_len) {
+    char method[16] = "";
+    char path[256] = "";
+    char version[16] = "";
+    sscanf(conn->request, "%15s %255s %15s", method, path, version);
+
+    int http10 = strcmp(version, "HTTP/1.0") == 0;
+    conn->close_after = http10
+        ? !header_has_token(conn->request, header_len, "Connection", "keep-alive")
+        : header_has_token(conn->request, header_len, "Connection", "close");
+
+    char *query = strchr(path, '?');
+    if (query) {
+        *query = '\0';
+    }
+
+    if (strcmp(method, "GET") != 0 && strcmp(method, "HEAD") != 0) {
+        connection_set_output(conn, response_not_allowed, sizeof(response_not_allowed) - 1);
+    } else if (strcmp(path, "/metrics") == 0) {
+        conn->snapshot = snapshot_acquire(holder);
+        if (conn->snapshot) {
+            size_t size = conn->snapshot->size;
+            if (strcmp(method, "HEAD") == 0) {
+                // Headers only
+                const char *body = strstr(conn->snapshot->data, "\r\n\r\n");
+                size = body ? (size_t)(body + 4 - conn->snapshot->data) : size;
+            }
+            connection_set_output(conn, conn->snapshot->data, size);
+        } else {
+            connection_set_output(conn, response_unavailable, sizeof(response_unavailable) - 1);
+        }
+    } else if (strcmp(path, "/") == 0) {
+        connection_set_output(conn, response_index, sizeof(response_index) - 1);
+    } else {
+        connection_set_output(conn, response_not_found, sizeof(response_not_found) - 1);
+    }
+
+    // Keep any pipelined bytes that follow this request
+    memmove(conn->request, conn->request + header_len, conn->request_len - header_len);
+    conn->request_len -= header_len;
+}
+
+// Write pending output; returns -1 once the connection should be closed
+static int connection_write(connection_t *conn) {
+    while (conn->out_pos < conn->out_len) {
+        ssize_t n = write(conn->fd, conn->out + conn->out_pos, conn->out_len - conn->out_pos);
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        }
+        conn->out_pos += (size_t)n;
+    }
+
+    conn->out = NULL;
+    conn->out_len = 0;
+    conn->out_pos = 0;
+    snapshot_release(conn->snapshot);
+    conn->snapshot = NULL;
+    return conn->close_after ? -1 : 0;
+}
+
+// Parse every complete request in the buffer, writing responses in order
+static int connection_process(connection_t *conn, snapshot_holder_t *holder) {
+    while (!conn->out) {
+        conn->request[conn->request_len] = '\0';
+        char *end = strstr(conn->request, "\r\n\r\n");
+        if (!end) {
+            if (conn->request_len >= SERVE_REQUEST_MAX - 1) {
+                conn->close_after = 1;
+                connection_set_output(conn, response_too_large, sizeof(response_too_large) - 1);
+                conn->request_len = 0;
+            } else {
+                return 0;
+            }
+        } else {
+            connection_respond(conn, holder, (size_t)(end + 4 - conn->request));
+        }
+
+        if (connection_write(conn) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int connection_read(connection_t *conn, snapshot_holder_t *holder) {
+    for (;;) {
+        size_t room = SERVE_REQUEST_MAX - 1 - conn->request_len;
+        if (room == 0) {
+            break;
+        }
+        ssize_t n = read(conn->fd, conn->request + conn->request_len, room);
+        if (n == 0) {
+            return -1;
+        }
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return -1;
+        }
+        conn->request_len += (size_t)n;
+    }
+    return connection_process(conn, holder);
+}
+
+static void accept_connections(int listen_fd, connection_t *conns) {
+    for (;;) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            return;
+        }
+
+        connection_t *slot = NULL;
+        for (int i = 0; i < SERVE_MAX_CONNECTIONS; i++) {
+            if (conns[i].fd < 0) {
+                slot = &conns[i];
+                break;
+            }
+        }
+        if (!slot) {
+            close(fd);
+            continue;
+        }
+
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        memset(slot, 0, sizeof(*slot));
+        slot->fd = fd;
+    }
+}
+
+static void run_server(int listen_fd, int wake_fd, serve_state_t *state) {
+    snapshot_holder_t holder = { state, NULL };
+    connection_t *conns = calloc(SERVE_MAX_CONNECTIONS, sizeof(connection_t));
+    struct pollfd *fds = calloc(SERVE_MAX_CONNECTIONS + 2, sizeof(struct pollfd));
+    int *slots = calloc(SERVE_MAX_CONNECTIONS + 2, sizeof(int));
+    if (!conns || !fds || !slots) {
+        free(conns);
+        free(fds);
+        free(slots);
+        display_error("Memory allocation failed");
+        return;
+    }
+    for (int i = 0; i < SERVE_MAX_CONNECTIONS; i++) {
+        conns[i].fd = -1;
+    }
+
+    while (!quit_requested) {
+        int nfds = 0;
+        fds[nfds++] = (struct pollfd){ wake_fd, POLLIN, 0 };
+        fds[nfds++] = (struct pollfd){ listen_fd, POLLIN, 0 };
+        for (int i = 0; i < SERVE_MAX_CONNECTIONS; i++) {
+            if (conns[i].fd >= 0) {
+                slots[nfds] = i;
+                fds[nfds++] = (struct pollfd){ conns[i].fd, (short)(conns[i].out ? POLLOUT : POLLIN), 0 };
+            }
+        }
+
+        if (poll(fds, (nfds_t)nfds, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        if (fds[0].revents) {
+            char drain[64];
+            while (read(wake_fd, drain, sizeof(drain)) > 0) {
+            }
+        }
+        if (fds[1].revents & POLLIN) {
+            accept_connections(listen_fd, conns);
+        }
+
+        for (int p = 2; p < nfds; p++) {
+            if (!fds[p].revents) {
+                continue;
+            }
+            connection_t *conn = &conns[slots[p]];
+            int rc;
+            if (fds[p].revents & (POLLERR | POLLNVAL)) {
+                rc = -1;
+            } else if (conn->out) {
+                rc = connection_write(conn);
+                if (rc == 0 && !conn->out) {
+                    rc = connection_process(conn, &holder);
+                }
+            } else {
+                rc = connection_read(conn, &holder);
+            }
+            if (rc != 0) {
+                connection_close(conn);
+            }
+        }
+    }
+
+    for (int i = 0; i < SERVE_MAX_CONNECTIONS; i++) {
+        if (conns[i].fd >= 0) {
+            connection_close(&conns[i]);
+        }
+    }
+    snapshot_release(holder.current);
+    free(conns);
+    free(fds);
+    free(slots);
+}
+
+static void print_serve_usage(void) {
+    printf("Usage: crypto serve [--listen HOST:PORT] [--coins ID,ID,...] [--currency CODE] [--interval SECONDS]\n");
+    printf("  --listen    Address to serve /metrics on (default: %s)\n", SERVE_DEFAULT_LISTEN);
+    printf("  --coins     Coins to export (default: %s)\n", SERVE_DEFAULT_COINS);
+    printf("  --currency  Quote currency (default: usd)\n");
+    printf("  --interval  Seconds between refreshes (default: %d)\n", SERVE_DEFAULT_INTERVAL);
+}
+
+int serve_command(int argc, char *argv[]) {
+    // refresh() pairs quotes with coins through coin_ids_find(), which
+    // compares pointers: the parsed ids must be interned like --coins
+    parser_set_interning(1);
+
+    const char *listen_spec = SERVE_DEFAULT_LISTEN;
+    const char *coins = SERVE_DEFAULT_COINS;
+    char currency[16] = "usd";
+    int interval = SERVE_DEFAULT_INTERVAL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--listen") == 0 && i + 1 < argc) {
+            listen_spec = argv[++i];
+        } else if (strcmp(argv[i], "--coins") == 0 && i + 1 < argc) {
+            coins = argv[++i];
+        } else if (strcmp(argv[i], "--currency") == 0 && i + 1 < argc) {
+            if (options_parse_currency(argv[++i], currency, sizeof(currency)) != 0) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            interval = atoi(argv[++i]);
+            if (interval <= 0) {
+                display_error("Interval must be a positive number of seconds");
+                return 1;
+            }
+        } else {
+            print_serve_usage();
+            return 1;
+        }
+    }
+
+    serve_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.currency = currency;
+    state.interval = interval;
+    atomic_init(&state.pending, NULL);
+
+    const char **ids = NULL;
+    state.count = coin_ids_resolve(coins, &ids);
+    state.coins = state.count > 0 ? calloc((size_t)state.count, sizeof(coin_metrics_t)) : NULL;
+    if (!state.coins) {
+        display_error(state.count == 0 ? "No coins to export" : "Memory allocation failed");
+        free(ids);
+        return 1;
+    }
+    for (int i = 0; i < state.count; i++) {
+        state.coins[i].id = ids[i];
+    }
+    free(ids);
+
+    int listen_fd = open_listener(listen_spec);
+    if (listen_fd < 0) {
+        char message[320];
+        snprintf(message, sizeof(message), "Cannot listen on %s", listen_spec);
+        display_error(message);
+        free(state.coins);
+        return 1;
+    }
+
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) {
+        display_error("Failed to create notification pipe");
+        close(listen_fd);
+        free(state.coins);
+        return 1;
+    }
+    fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK);
+    fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK);
+
+    signal_fd = pipe_fds[1];
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_terminate;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    sa.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &sa, NULL);
+
+    pthread_mutex_init(&state.lock, NULL);
+    pthread_cond_init(&state.wake, NULL);
+
+    // Scrapes before the first refresh see the exporter metrics only
+    publish_snapshot(&state, render_snapshot(&state));
+
+    fprintf(stderr, "Serving %d coin(s) on http://%s/metrics (refresh every %ds)\n",
+            state.count, listen_spec, interval);
+
+    pthread_t refresher;
+    int thread_ok = pthread_create(&refresher, NULL, refresh_thread, &state) == 0;
+    if (thread_ok) {
+        run_server(listen_fd, pipe_fds[0], &state);
+
+        pthread_mutex_lock(&state.lock);
+        state.stop = 1;
+        pthread_cond_signal(&state.wake);
+        pthread_mutex_unlock(&state.lock);
+        pthread_join(refresher, NULL);
+    } else {
+        display_error("Failed to start refresher thread");
+    }
+
+    signal_fd = -1;
+    snapshot_free(atomic_exchange(&state.pending, NULL));
+    for (int i = 0; i < state.count; i++) {
+        free_crypto_data(&state.coins[i].quote);
+    }
+    free(state.coins);
+    pthread_mutex_destroy(&state.lock);
+    pthread_cond_destroy(&state.wake);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(listen_fd);
+
+    return thread_ok ? 0 : 1;
+}
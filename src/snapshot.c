@@ -0,0 +1,304 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../include/snapshot.h"
+
+#define SNAPSHOT_MAGIC "CCSNAP01"
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+#define SNAPSHOT_COLUMNS 8   // Seven double columns plus last_updated_at
+
+/**
+ * @brief On-disk header; offsets are from the start of the file
+ */
+struct snapshot_header {
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t count;
+    int64_t created_at;
+    char currency[16];
+    uint64_t columns[SNAPSHOT_COLUMNS];
+    uint64_t strings;          // String index (3 x uint32 per coin)
+    uint64_t string_table;
+    uint32_t string_table_size;
+    uint32_t reserved;
+};
+
+static size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+// Append a string to the table and return its offset
+static uint32_t add_string(char *table, uint32_t *used, const char *s) {
+    uint32_t offset = *used;
+    size_t len = s ? strlen(s) : 0;
+    if (len) {
+        memcpy(table + offset, s, len);
+    }
+    table[offset + len] = '\0';
+    *used += (uint32_t)len + 1;
+    return offset;
+}
+
+int snapshot_write(const char *path, const markets_data_t *markets, const char *currency) {
+    if (!path || !markets || !markets->success) {
+        return -1;
+    }
+
+    uint32_t count = 0;
+    size_t strings_size = 0;
+    for (int i = 0; i < markets->count; i++) {
+        const crypto_data_t *coin = &markets->coins[i];
+        if (!coin->success) {
+            continue;
+        }
+        count++;
+        strings_size += (coin->id ? strlen(coin->id) : 0) + 1;
+        strings_size += (coin->symbol ? strlen(coin->symbol) : 0) + 1;
+        strings_size += (coin->name ? strlen(coin->name) : 0) + 1;
+    }
+    if (strings_size > UINT32_MAX) {
+        return -1;
+    }
+
+    // Lay out the file
+    struct snapshot_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.count = count;
+    header.created_at = (int64_t)time(NULL);
+    snprintf(header.currency, sizeof(header.currency), "%s", currency ? currency : "usd");
+
+    size_t offset = align8(sizeof(header));
+    for (int c = 0; c < SNAPSHOT_COLUMNS; c++) {
+        header.columns[c] = offset;
+        offset = align8(offset + (size_t)count * 8);
+    }
+    header.strings = offset;
+    offset = align8(offset + (size_t)count * 3 * sizeof(uint32_t));
+    header.string_table = offset;
+    header.string_table_size = (uint32_t)strings_size;
+    size_t total = offset + strings_size;
+
+    char *file = calloc(1, total);
+    if (!file) {
+        return -1;
+    }
+    memcpy(file, &header, sizeof(header));
+
+    double *columns[7];
+    for (int c = 0; c < 7; c++) {
+        columns[c] = (double *)(file + header.columns[c]);
+    }
+    int64_t *updated = (int64_t *)(file + header.columns[7]);
+    uint32_t *index = (uint32_t *)(file + header.strings);
+    char *table = file + header.string_table;
+    uint32_t table_used = 0;
+
+    uint32_t row = 0;
+    for (int i = 0; i < markets->count; i++) {
+        const crypto_data_t *coin = &markets->coins[i];
+        if (!coin->success) {
+            continue;
+        }
+        columns[0][row] = coin->current_price;
+        columns[1][row] = coin->price_change_24h;
+        columns[2][row] = coin->price_change_percentage_24h;
+        columns[3][row] = coin->market_cap;
+        columns[4][row] = coin->volume_24h;
+        columns[5][row] = coin->high_24h;
+        columns[6][row] = coin->low_24h;
+        updated[row] = coin->last_updated_at;
+        index[row * 3 + SNAPSHOT_ID] = add_string(table, &table_used, coin->id);
+        index[row * 3 + SNAPSHOT_SYMBOL] = add_string(table, &table_used, coin->symbol);
+        index[row * 3 + SNAPSHOT_NAME] = add_string(table, &table_used, coin->name);
+        row++;
+    }
+
+    char tmp[1100];
+    snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp) {
+        free(file);
+        return -1;
+    }
+
+    int ok = fwrite(file, 1, total, fp) == total;
+    free(file);
+    if (fclose(fp) != 0) {
+        ok = 0;
+    }
+    if (!ok || rename(tmp, path) != 0) {
+        unlink(tmp);
+        return -1;
+    }
+
+    return 0;
+}
+
+int snapshot_open(const char *path, markets_snapshot_t *snapshot) {
+    if (!path || !snapshot) {
+        return -1;
+    }
+    memset(snapshot, 0, sizeof(*snapshot));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(struct snapshot_header)) {
+        close(fd);
+        return -1;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+
+    const struct snapshot_header *header = (const struct snapshot_header *)base;
+    int valid = memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) == 0 &&
+                header->byte_order == SNAPSHOT_BYTE_ORDER &&
+                memchr(header->currency, '\0', sizeof(header->currency)) != NULL;
+
+    // Every section must lie inside the file and be aligned
+    uint64_t count = header->count;
+    for (int c = 0; valid && c < SNAPSHOT_COLUMNS; c++) {
+        valid = header->columns[c] % 8 == 0 && header->columns[c] <= size &&
+                count * 8 <= size - header->columns[c];
+    }
+    valid = valid && header->strings % 4 == 0 && header->strings <= size &&
+            count * 3 * sizeof(uint32_t) <= size - header->strings;
+    valid = valid && header->string_table <= size &&
+            header->string_table_size <= size - header->string_table &&
+            (header->string_table_size == 0 ||
+             ((const char *)base)[header->string_table + header->string_table_size - 1] == '\0');
+
+    if (!valid) {
+        munmap(base, size);
+        return -1;
+    }
+
+    const char *bytes = (const char *)base;
+    snapshot->base = base;
+    snapshot->size = size;
+    snapshot->count = header->count;
+    snapshot->created_at = header->created_at;
+    snapshot->currency = header->currency;
+    snapshot->price = (const double *)(bytes + header->columns[0]);
+    snapshot->change_24h = (const double *)(bytes + header->columns[1]);
+    snapshot->change_percentage_24h = (const double *)(bytes + header->columns[2]);
+    snapshot->market_cap = (const double *)(bytes + header->columns[3]);
+    snapshot->volume_24h = (const double *)(bytes + header->columns[4]);
+    snapshot->high_24h = (const double *)(bytes + header->columns[5]);
+    snapshot->low_24h = (const double *)(bytes + header->columns[6]);
+    snapshot->last_updated_at = (const int64_t *)(bytes + header->columns[7]);
+    snapshot->strings = (const uint32_t *)(bytes + header->strings);
+    snapshot->string_table = bytes + header->string_table;
+    snapshot->string_table_size = header->string_table_size;
+
+    return 0;
+}
+
+void snapshot_close(markets_snapshot_t *snapshot) {
+    if (snapshot && snapshot->base) {
+        munmap(snapshot->base, snapshot->size);
+        memset(snapshot, 0, sizeof(*snapshot));
+    }
+}
+
+const char *snapshot_string(const markets_snapshot_t *snapshot, uint32_t index, int field) {
+    if (!snapshot || index >= snapshot->count || field < 0 || field > 2) {
+        return "";
+    }
+    uint32_t offset = snapshot->strings[index * 3 + (uint32_t)field];
+    // The table ends with a NUL, so any in-range offset yields a terminated string
+    return offset < snapshot->string_table_size ? snapshot->string_table + offset : "";
+}
+
+// Time in an archived file name "<name>.<created_at>", or -1 for other entries
+static int64_t archived_at(const char *entry, const char *name) {
+    size_t len = strlen(name);
+    if (strncmp(entry, name, len) != 0 || entry[len] != '.' ||
+        !isdigit((unsigned char)entry[len + 1])) {
+        return -1;
+    }
+    char *end = NULL;
+    long long at = strtoll(entry + len + 1, &end, 10);
+    return *end == '\0' ? (int64_t)at : -1;
+}
+
+int snapshot_archive(const char *path, const char *dir, const char *name) {
+    markets_snapshot_t snapshot;
+    if (!path || !dir || !name || snapshot_open(path, &snapshot) != 0) {
+        return -1;
+    }
+    int64_t created_at = snapshot.created_at;
+    snapshot_close(&snapshot);
+
+    DIR *listing = opendir(dir);
+    if (!listing) {
+        return -1;
+    }
+
+    // Drop expired copies and note the newest one kept
+    int64_t newest = -1;
+    char file[1100];
+    struct dirent *entry;
+    while ((entry = readdir(listing)) != NULL) {
+        int64_t at = archived_at(entry->d_name, name);
+        if (at < 0) {
+            continue;
+        }
+        if (at < created_at - SNAPSHOT_ARCHIVE_KEEP) {
+            snprintf(file, sizeof(file), "%s/%s", dir, entry->d_name);
+            unlink(file);
+        } else if (at > newest) {
+            newest = at;
+        }
+    }
+    closedir(listing);
+
+    if (newest >= 0 && created_at - newest < SNAPSHOT_ARCHIVE_INTERVAL) {
+        return 0;
+    }
+    snprintf(file, sizeof(file), "%s/%s.%lld", dir, name, (long long)created_at);
+    return link(path, file) == 0 || errno == EEXIST ? 0 : -1;
+}
+
+int snapshot_archive_find(const char *dir, const char *name, int64_t at, char *out, size_t size) {
+    DIR *listing = dir && name ? opendir(dir) : NULL;
+    if (!listing) {
+        return -1;
+    }
+
+    int64_t best = -1;
+    struct dirent *entry;
+    while ((entry = readdir(listing)) != NULL) {
+        int64_t created_at = archived_at(entry->d_name, name);
+        if (created_at >= 0 && created_at <= at && created_at > best) {
+            best = created_at;
+        }
+    }
+    closedir(listing);
+
+    if (best < 0) {
+        return -1;
+    }
+    int n = snprintf(out, size, "%s/%s.%lld", dir, name, (long long)best);
+    return n > 0 && (size_t)n < size ? 0 : -1;
+}
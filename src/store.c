@@ -0,0 +1,208 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "../include/store.h"
+#include "../include/paths.h"
+
+#define STORE_MAGIC 0x51544351u   // "QCTQ"
+#define STORE_VERSION 1
+
+/**
+ * @brief On-disk quote record
+ */
+struct quote_record {
+    uint32_t magic;
+    uint32_t version;
+    double current_price;
+    double price_change_24h;
+    double price_change_percentage_24h;
+    double market_cap;
+    double volume_24h;
+    double high_24h;
+    double low_24h;
+    int64_t last_updated_at;
+    int64_t fetched_at;
+    char id[64];
+    char symbol[32];
+    char name[64];
+    char currency[16];
+};
+
+// Record file name "<id>.<currency>"; rejects anything that could escape the directory
+static int record_path(const char *id, const char *currency, char *out, size_t size) {
+    if (!id || !currency || !*id || !*currency || id[0] == '.') {
+        return -1;
+    }
+    if (strchr(id, '/') || strchr(currency, '/') || strchr(currency, '.')) {
+        return -1;
+    }
+    
+    char name[128];
+    int n = snprintf(name, sizeof(name), "%s.%s", id, currency);
+    if (n < 0 || (size_t)n >= sizeof(name)) {
+        return -1;
+    }
+    
+    return paths_cache_file("quotes", name, out, size);
+}
+
+static void copy_field(char *dst, size_t size, const char *src) {
+    if (!src) {
+        dst[0] = '\0';
+        return;
+    }
+    size_t len = strlen(src);
+    if (len >= size) {
+        len = size - 1;
+    }
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+static char *dup_field(const char *src, size_t size) {
+    size_t len = strnlen(src, size);
+    if (len == 0) {
+        return NULL;
+    }
+    char *copy = malloc(len + 1);
+    if (copy) {
+        memcpy(copy, src, len);
+        copy[len] = '\0';
+    }
+    return copy;
+}
+
+int store_save_quote(const crypto_data_t *data) {
+    if (!data || !data->success) {
+        return -1;
+    }
+    
+    char path[1024];
+    if (record_path(data->id, data->currency, path, sizeof(path)) != 0) {
+        return -1;
+    }
+    
+    struct quote_record record;
+    memset(&record, 0, sizeof(record));
+    record.magic = STORE_MAGIC;
+    record.version = STORE_VERSION;
+    record.current_price = data->current_price;
+    record.price_change_24h = data->price_change_24h;
+    record.price_change_percentage_24h = data->price_change_percentage_24h;
+    record.market_cap = data->market_cap;
+    record.volume_24h = data->volume_24h;
+    record.high_24h = data->high_24h;
+    record.low_24h = data->low_24h;
+    record.last_updated_at = data->last_updated_at;
+    record.fetched_at = (int64_t)time(NULL);
+    copy_field(record.id, sizeof(record.id), data->id);
+    copy_field(record.symbol, sizeof(record.symbol), data->symbol);
+    copy_field(record.name, sizeof(record.name), data->name);
+    copy_field(record.currency, sizeof(record.currency), data->currency);
+    
+    // Write a private temp file and rename it over the record
+    char tmp[1100];
+    snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+    
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp) {
+        return -1;
+    }
+    
+    int ok = fwrite(&record, sizeof(record), 1, fp) == 1;
+    if (fclose(fp) != 0) {
+        ok = 0;
+    }
+    if (!ok || rename(tmp, path) != 0) {
+        unlink(tmp);
+        return -1;
+    }
+    
+    return 0;
+}
+
+int store_load_quote(const char *id, const char *currency, crypto_data_t *data, long *fetched_at) {
+    if (!data) {
+        return -1;
+    }
+    memset(data, 0, sizeof(*data));
+    
+    char path[1024];
+    if (record_path(id, currency, path, sizeof(path)) != 0) {
+        return -1;
+    }
+    
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return -1;
+    }
+    
+    struct quote_record record;
+    int ok = fread(&record, sizeof(record), 1, fp) == 1;
+    fclose(fp);
+    
+    if (!ok || record.magic != STORE_MAGIC || record.version != STORE_VERSION) {
+        return -1;
+    }
+    
+    data->id = dup_field(record.id, sizeof(record.id));
+    data->symbol = dup_field(record.symbol, sizeof(record.symbol));
+    data->name = dup_field(record.name, sizeof(record.name));
+    data->currency = dup_field(record.currency, sizeof(record.currency));
+    data->current_price = record.current_price;
+    data->price_change_24h = record.price_change_24h;
+    data->price_change_percentage_24h = record.price_change_percentage_24h;
+    data->market_cap = record.market_cap;
+    data->volume_24h = record.volume_24h;
+    data->high_24h = record.high_24h;
+    data->low_24h = record.low_24h;
+    data->last_updated_at = (long)record.last_updated_at;
+    data->success = 1;
+    
+    if (fetched_at) {
+        *fetched_at = (long)record.fetched_at;
+    }
+    
+    return 0;
+}
+
+long store_quote_age(const crypto_data_t *data, long fetched_at) {
+    long updated = data->last_updated_at > 0 ? data->last_updated_at : fetched_at;
+    long age = (long)time(NULL) - updated;
+    return age > 0 ? age : 0;
+}
+
+int store_lock_refresh(const char *id, const char *currency) {
+    char path[1024];
+    if (record_path(id, currency, path, sizeof(path)) != 0) {
+        return -1;
+    }
+    
+    size_t len = strlen(path);
+    if (len + sizeof(".lock") > sizeof(path)) {
+        return -1;
+    }
+    memcpy(path + len, ".lock", sizeof(".lock"));
+    
+    int fd = open(path, O_WRONLY | O_CREAT, 0600);
+    if (fd < 0) {
+        return -1;
+    }
+    
+    struct flock lock;
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    if (fcntl(fd, F_SETLK, &lock) != 0) {
+        close(fd);
+        return -1;
+    }
+    
+    return fd;
+}
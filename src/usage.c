@@ -0,0 +1,176 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../include/usage.h"
+#include "../include/paths.h"
+
+#define USAGE_FILE "usage"
+#define USAGE_LOCK_FILE "usage.lock"
+
+static double decayed(const usage_entry_t *entry, long now) {
+    long elapsed = now - entry->last_used;
+    if (elapsed <= 0) {
+        return entry->score;
+    }
+    return entry->score * exp2(-(double)elapsed / (double)USAGE_HALF_LIFE);
+}
+
+static int usage_path(const char *name, char *out, size_t size) {
+    if (paths_cache_dir(out, size) != 0) {
+        return -1;
+    }
+    size_t len = strlen(out);
+    int n = snprintf(out + len, size - len, "/%s", name);
+    return n < 0 || (size_t)n >= size - len ? -1 : 0;
+}
+
+static void copy_text(char *dst, size_t size, const char *src) {
+    snprintf(dst, size, "%s", src);
+}
+
+// First line "prefetch <time>", then "id currency score last_used" per pair
+void usage_load(usage_log_t *log) {
+    memset(log, 0, sizeof(*log));
+
+    char path[1024];
+    if (usage_path(USAGE_FILE, path, sizeof(path)) != 0) {
+        return;
+    }
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return;
+    }
+
+    if (fscanf(fp, "prefetch %ld", &log->last_prefetch) != 1) {
+        log->last_prefetch = 0;
+    }
+    usage_entry_t entry;
+    while (log->count < USAGE_MAX_ENTRIES &&
+           fscanf(fp, "%63s %15s %lf %ld", entry.id, entry.currency, &entry.score,
+                  &entry.last_used) == 4) {
+        if (entry.score > 0.0) {
+            log->entries[log->count++] = entry;
+        }
+    }
+    fclose(fp);
+}
+
+int usage_save(const usage_log_t *log) {
+    char path[1024];
+    if (usage_path(USAGE_FILE, path, sizeof(path)) != 0) {
+        return -1;
+    }
+
+    char tmp[1100];
+    snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+    FILE *fp = fopen(tmp, "w");
+    if (!fp) {
+        return -1;
+    }
+
+    fprintf(fp, "prefetch %ld\n", log->last_prefetch);
+    for (int i = 0; i < log->count; i++) {
+        const usage_entry_t *e = &log->entries[i];
+        fprintf(fp, "%s %s %.6f %ld\n", e->id, e->currency, e->score, e->last_used);
+    }
+
+    if (fclose(fp) != 0 || rename(tmp, path) != 0) {
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+void usage_touch(usage_log_t *log, const char *id, const char *currency, long now) {
+    // Ids and currencies are whitespace-free by construction; anything else
+    // would not survive the text format
+    if (!id || !currency || strlen(id) >= sizeof(log->entries[0].id) ||
+        strlen(currency) >= sizeof(log->entries[0].currency) || strpbrk(id, " \t\n") ||
+        strpbrk(currency, " \t\n")) {
+        return;
+    }
+
+    usage_entry_t *target = NULL;
+    for (int i = 0; i < log->count; i++) {
+        if (strcmp(log->entries[i].id, id) == 0 && strcmp(log->entries[i].currency, currency) == 0) {
+            target = &log->entries[i];
+            break;
+        }
+    }
+
+    if (!target) {
+        if (log->count < USAGE_MAX_ENTRIES) {
+            target = &log->entries[log->count++];
+        } else {
+            target = &log->entries[0];
+            for (int i = 1; i < log->count; i++) {
+                if (decayed(&log->entries[i], now) < decayed(target, now)) {
+                    target = &log->entries[i];
+                }
+            }
+        }
+        memset(target, 0, sizeof(*target));
+        copy_text(target->id, sizeof(target->id), id);
+        copy_text(target->currency, sizeof(target->currency), currency);
+        target->last_used = now;
+    }
+
+    target->score = decayed(target, now) + 1.0;
+    target->last_used = now;
+}
+
+int usage_hot(const usage_log_t *log, long now, usage_entry_t *out, int max) {
+    int count = 0;
+
+    // Insertion into a short sorted list
+    for (int i = 0; i < log->count; i++) {
+        usage_entry_t entry = log->entries[i];
+        entry.score = decayed(&entry, now);
+        entry.last_used = now;
+        if (entry.score < USAGE_HOT_SCORE) {
+            continue;
+        }
+
+        int j;
+        if (count < max) {
+            j = count++;
+        } else if (max > 0 && out[max - 1].score < entry.score) {
+            j = max - 1;
+        } else {
+            continue;
+        }
+        while (j > 0 && out[j - 1].score < entry.score) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = entry;
+    }
+    return count;
+}
+
+int usage_lock_prefetch(void) {
+    char path[1024];
+    if (usage_path(USAGE_LOCK_FILE, path, sizeof(path)) != 0) {
+        return -1;
+    }
+
+    int fd = open(path, O_WRONLY | O_CREAT, 0600);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct flock lock;
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    if (fcntl(fd, F_SETLK, &lock) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
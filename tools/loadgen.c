@@ -0,0 +1,429 @@
+#define _POSIX_C_SOURCE 200809L
+
+/*
+ * crypto-loadgen: closed-loop load against a local CoinGecko stand-in
+ *
+ * Starts the stub server (stubserver.c) on a free port, points the
+ * CoinGecko base URL at it and runs N client threads. Each client loops
+ * over the code path of `crypto <coin>`: provider URL build, fetch through
+ * a shared connection pool, parse, and full render (to /dev/null). The
+ * report has throughput and latency percentiles of complete iterations.
+ *
+ *   crypto-loadgen --clients 16 --duration 10s --latency 40ms --jitter 20ms
+ *   crypto-loadgen --serve-only --port 8701 --error-rate 0.05
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../include/api.h"
+#include "../include/parser.h"
+#include "../include/display.h"
+#include "../include/provider.h"
+#include "../include/planner.h"
+#include "stubserver.h"
+
+#define DEFAULT_CLIENTS 8
+#define DEFAULT_DURATION_MS 10000L
+#define MAX_CLIENTS 1024
+#define REQUEST_TIMEOUT_MS 5000L
+
+typedef struct {
+    int clients;
+    long duration_ms;        // Ignored when requests > 0
+    long requests;           // Total iterations across clients (0 = run for duration)
+    const char *coin;
+    const char *currency;
+    unsigned fields;
+    const char *target;      // External server instead of the stub
+    int serve_only;
+    stub_config_t stub;
+} loadgen_options_t;
+
+/**
+ * @brief Latencies of one client
+ */
+typedef struct {
+    pthread_t thread;
+    double *samples;         // Milliseconds per iteration
+    size_t count;
+    size_t capacity;
+    unsigned long failures;
+} client_t;
+
+static loadgen_options_t options;
+static api_pool_t *pool;
+static const provider_t *provider;
+static quote_query_t query;
+static atomic_long issued;
+static double stop_at_ms;
+static volatile sig_atomic_t interrupted;
+
+// Latencies against the local stub are well under a millisecond
+static double now_ms(void) {
+    return (double)api_monotonic_ns() / 1e6;
+}
+
+static void on_signal(int sig) {
+    (void)sig;
+    interrupted = 1;
+}
+
+// "800ms", "2s", or plain milliseconds
+static int parse_ms(const char *value, long *out) {
+    char *end = NULL;
+    double amount = value ? strtod(value, &end) : -1.0;
+    if (!value || end == value || amount < 0.0) {
+        return -1;
+    }
+    if (strcmp(end, "s") == 0) {
+        amount *= 1000.0;
+    } else if (strcmp(end, "ms") != 0 && *end != '\0') {
+        return -1;
+    }
+    *out = (long)amount;
+    return 0;
+}
+
+static int parse_rate(const char *value, double *out) {
+    char *end = NULL;
+    double rate = value ? strtod(value, &end) : -1.0;
+    if (!value || end == value || *end != '\0' || !(rate >= 0.0 && rate <= 1.0)) {
+        return -1;
+    }
+    *out = rate;
+    return 0;
+}
+
+static void print_usage(void) {
+    printf("Usage: crypto-loadgen [options]\n");
+    printf("  Drive the fetch/parse/render path of 'crypto <coin>' from concurrent clients\n");
+    printf("  against a local CoinGecko stand-in.\n\n");
+    printf("Load:\n");
+    printf("  --clients N        Concurrent closed-loop clients (default: %d)\n", DEFAULT_CLIENTS);
+    printf("  --duration D       Run time, e.g. 30s (default: %lds)\n", DEFAULT_DURATION_MS / 1000);
+    printf("  --requests N       Stop after N iterations instead\n");
+    printf("  --coin ID          CoinGecko id to quote (default: bitcoin)\n");
+    printf("  --currency CODE    Quote currency (default: usd)\n");
+    printf("  --fields price|all Fields to fetch, as 'crypto ID price --no-cache' or 'crypto ID'\n");
+    printf("  --target URL       Use a running server instead of the built-in one\n");
+    printf("Server:\n");
+    printf("  --serve-only       Only run the server (until interrupted)\n");
+    printf("  --port N           Port (default: any free port; 8701 with --serve-only)\n");
+    printf("  --latency D        Delay before every answer (default: 0)\n");
+    printf("  --jitter D         Extra delay, uniform in [0, D) (default: 0)\n");
+    printf("  --error-rate R     Share of requests answered with 500 (0..1)\n");
+    printf("  --429-rate R       Share of requests answered with 429 (0..1)\n");
+    printf("  --dir DIR          Serve DIR/<segment>.json where present\n");
+}
+
+static int parse_options(int argc, char *argv[]) {
+    memset(&options, 0, sizeof(options));
+    options.clients = DEFAULT_CLIENTS;
+    options.duration_ms = DEFAULT_DURATION_MS;
+    options.coin = "bitcoin";
+    options.currency = "usd";
+    options.fields = PLAN_ALL;
+    options.stub.port = -1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        int ok = 1;
+
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+            print_usage();
+            exit(0);
+        } else if (strcmp(arg, "--serve-only") == 0) {
+            options.serve_only = 1;
+            continue;
+        } else if (!value) {
+            ok = 0;
+        } else if (strcmp(arg, "--clients") == 0) {
+            options.clients = atoi(value);
+            ok = options.clients > 0 && options.clients <= MAX_CLIENTS;
+        } else if (strcmp(arg, "--duration") == 0) {
+            ok = parse_ms(value, &options.duration_ms) == 0 && options.duration_ms > 0;
+        } else if (strcmp(arg, "--requests") == 0) {
+            options.requests = atol(value);
+            ok = options.requests > 0;
+        } else if (strcmp(arg, "--coin") == 0) {
+            options.coin = value;
+        } else if (strcmp(arg, "--currency") == 0) {
+            options.currency = value;
+        } else if (strcmp(arg, "--fields") == 0) {
+            ok = strcmp(value, "price") == 0 || strcmp(value, "all") == 0;
+            options.fields = strcmp(value, "price") == 0 ? PLAN_PRICE : PLAN_ALL;
+        } else if (strcmp(arg, "--target") == 0) {
+            options.target = value;
+        } else if (strcmp(arg, "--port") == 0) {
+            options.stub.port = atoi(value);
+            ok = options.stub.port > 0 && options.stub.port < 65536;
+        } else if (strcmp(arg, "--latency") == 0) {
+            ok = parse_ms(value, &options.stub.latency_ms) == 0;
+        } else if (strcmp(arg, "--jitter") == 0) {
+            ok = parse_ms(value, &options.stub.jitter_ms) == 0;
+        } else if (strcmp(arg, "--error-rate") == 0) {
+            ok = parse_rate(value, &options.stub.error_rate) == 0;
+        } else if (strcmp(arg, "--429-rate") == 0) {
+            ok = parse_rate(value, &options.stub.throttle_rate) == 0;
+        } else if (strcmp(arg, "--dir") == 0) {
+            options.stub.dir = value;
+        } else {
+            fprintf(stderr, "Error: unknown option %s\n", arg);
+            print_usage();
+            return -1;
+        }
+
+        if (!ok) {
+            fprintf(stderr, "Error: invalid value for %s\n", arg);
+            return -1;
+        }
+        i++;
+    }
+
+    if (options.serve_only && options.target) {
+        fprintf(stderr, "Error: --serve-only starts the built-in server; it cannot be used with --target\n");
+        return -1;
+    }
+    if (options.stub.port < 0) {
+        options.stub.port = options.serve_only ? 8701 : 0;
+    }
+    if (options.stub.error_rate + options.stub.throttle_rate > 1.0) {
+        fprintf(stderr, "Error: --error-rate plus --429-rate exceeds 1\n");
+        return -1;
+    }
+    return 0;
+}
+
+static int record(client_t *client, double ms) {
+    if (client->count == client->capacity) {
+        size_t capacity = client->capacity ? client->capacity * 2 : 4096;
+        double *samples = realloc(client->samples, capacity * sizeof(double));
+        if (!samples) {
+            return -1;
+        }
+        client->samples = samples;
+        client->capacity = capacity;
+    }
+    client->samples[client->count++] = ms;
+    return 0;
+}
+
+// One iteration is the whole of 'crypto <coin>' past argument parsing
+static int run_once(void) {
+    char *url = provider->quote_url(&query);
+    if (!url) {
+        return -1;
+    }
+
+    char *json = NULL;
+    int rc = api_fetch_url(pool, url, &json, NULL);
+    free(url);
+
+    crypto_data_t data = {0};
+    if (rc == 0) {
+        data = provider->parse_quote(json, &query);
+    }
+    free(json);
+
+    if (!data.success) {
+        free_crypto_data(&data);
+        return -1;
+    }
+    if (options.fields == PLAN_PRICE) {
+        display_price_only(&data);
+    } else {
+        display_full_info(&data);
+    }
+    free_crypto_data(&data);
+    return 0;
+}
+
+static void *client_main(void *arg) {
+    client_t *client = arg;
+
+    while (!interrupted) {
+        if (options.requests > 0) {
+            if (atomic_fetch_add(&issued, 1) >= options.requests) {
+                break;
+            }
+        } else if (now_ms() >= stop_at_ms) {
+            break;
+        }
+
+        double started = now_ms();
+        int rc = run_once();
+        if (record(client, now_ms() - started) != 0) {
+            break;
+        }
+        if (rc != 0) {
+            client->failures++;
+        }
+    }
+    return NULL;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples
+static double percentile(const double *sorted, size_t count, double p) {
+    if (count == 0) {
+        return 0.0;
+    }
+    size_t rank = (size_t)(p / 100.0 * (double)count + 0.999999);
+    if (rank < 1) {
+        rank = 1;
+    }
+    return sorted[(rank > count ? count : rank) - 1];
+}
+
+static void report_server(const stub_server_t *server) {
+    printf("Server:       %lu requests, %lu injected 500, %lu injected 429, %lu not found\n",
+           atomic_load(&server->requests), atomic_load(&server->errors),
+           atomic_load(&server->throttled), atomic_load(&server->not_found));
+}
+
+static void report(client_t *clients, double elapsed_ms, const stub_server_t *server) {
+    size_t total = 0;
+    unsigned long failures = 0;
+    for (int i = 0; i < options.clients; i++) {
+        total += clients[i].count;
+        failures += clients[i].failures;
+    }
+
+    double *all = malloc((total ? total : 1) * sizeof(double));
+    if (!all) {
+        fprintf(stderr, "Error: out of memory\n");
+        return;
+    }
+    size_t n = 0;
+    double sum = 0.0;
+    for (int i = 0; i < options.clients; i++) {
+        memcpy(all + n, clients[i].samples, clients[i].count * sizeof(double));
+        n += clients[i].count;
+    }
+    for (size_t i = 0; i < n; i++) {
+        sum += all[i];
+    }
+    qsort(all, n, sizeof(double), compare_doubles);
+
+    printf("Clients:      %d (closed loop)\n", options.clients);
+    printf("Requests:     %zu in %.2f s, %lu failed (%.2f%%)\n", total, elapsed_ms / 1000.0,
+           failures, total ? 100.0 * (double)failures / (double)total : 0.0);
+    printf("Throughput:   %.1f req/s\n", elapsed_ms > 0.0 ? (double)total * 1000.0 / elapsed_ms : 0.0);
+    printf("Latency (ms): mean %.3f  p50 %.3f  p90 %.3f  p99 %.3f  p99.9 %.3f  max %.3f\n",
+           n ? sum / (double)n : 0.0, percentile(all, n, 50.0), percentile(all, n, 90.0),
+           percentile(all, n, 99.0), percentile(all, n, 99.9), n ? all[n - 1] : 0.0);
+    if (server) {
+        report_server(server);
+    }
+    free(all);
+}
+
+int main(int argc, char *argv[]) {
+    if (parse_options(argc, argv) != 0) {
+        return 1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    stub_server_t server;
+    int have_server = 0;
+    if (!options.target) {
+        if (stub_server_start(&options.stub, &server) != 0) {
+            return 1;
+        }
+        have_server = 1;
+    }
+
+    if (options.serve_only) {
+        fprintf(stderr, "Serving on http://127.0.0.1:%d (Ctrl+C to stop)\n", server.port);
+        while (!interrupted) {
+            pause();
+        }
+        report_server(&server);
+        stub_server_stop(&server);
+        return 0;
+    }
+
+    char base[256];
+    if (options.target) {
+        snprintf(base, sizeof(base), "%s", options.target);
+    } else {
+        snprintf(base, sizeof(base), "http://127.0.0.1:%d", server.port);
+    }
+    // Set before any thread reads it
+    setenv("CRYPTO_CLI_COINGECKO_URL", base, 1);
+    unsetenv("CRYPTO_CLI_REPLAY_DIR");
+
+    provider = provider_find("coingecko");
+    pool = api_pool_new(REQUEST_TIMEOUT_MS);
+    client_t *clients = calloc((size_t)options.clients, sizeof(client_t));
+    if (!provider || !pool || !clients) {
+        fprintf(stderr, "Error: cannot initialise the client\n");
+        return 1;
+    }
+    query.id = options.coin;
+    query.symbol = options.coin;
+    query.currency = options.currency;
+    query.fields = options.fields;
+
+    // Rendering is part of the path under test, but its output is not
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (saved_stdout < 0 || null_fd < 0) {
+        fprintf(stderr, "Error: cannot redirect output\n");
+        return 1;
+    }
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+
+    double started = now_ms();
+    stop_at_ms = started + (double)options.duration_ms;
+    int running = 0;
+    for (int i = 0; i < options.clients; i++) {
+        if (pthread_create(&clients[i].thread, NULL, client_main, &clients[i]) == 0) {
+            running = i + 1;
+        } else {
+            break;
+        }
+    }
+    for (int i = 0; i < running; i++) {
+        pthread_join(clients[i].thread, NULL);
+    }
+    double elapsed = now_ms() - started;
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    options.clients = running;
+    api_pool_free(pool);
+    report(clients, elapsed, have_server ? &server : NULL);
+
+    if (have_server) {
+        stub_server_stop(&server);
+    }
+    for (int i = 0; i < running; i++) {
+        free(clients[i].samples);
+    }
+    free(clients);
+    api_cleanup();
+    return 0;
+}
@@ -0,0 +1,536 @@
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <dirent.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "../include/intern.h"
+#include "stubserver.h"
+
+#define REQUEST_MAX 8192
+#define POLL_INTERVAL_MS 100     // How often idle connections check for shutdown
+#define SYNTHETIC_MARKETS 250    // Coins in a markets listing without ids=
+#define OHLC_ROWS 48             // 30-minute candles over a day
+
+/**
+ * @brief A recorded response, keyed by path segment
+ */
+struct stub_fixture {
+    struct stub_fixture *next;
+    char name[64];
+    char *body;
+    size_t size;
+};
+
+/**
+ * @brief Growable response body
+ */
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+    int failed;
+} body_t;
+
+typedef struct {
+    stub_server_t *server;
+    int fd;
+} connection_t;
+
+static void body_printf(body_t *body, const char *format, ...) {
+    if (body->failed) {
+        return;
+    }
+    for (;;) {
+        va_list args;
+        va_start(args, format);
+        size_t room = body->capacity - body->size;
+        int n = vsnprintf(body->data ? body->data + body->size : NULL, room, format, args);
+        va_end(args);
+        if (n < 0) {
+            body->failed = 1;
+            return;
+        }
+        if ((size_t)n < room) {
+            body->size += (size_t)n;
+            return;
+        }
+        size_t capacity = body->capacity ? body->capacity * 2 : 4096;
+        while (capacity - body->size <= (size_t)n) {
+            capacity *= 2;
+        }
+        char *data = realloc(body->data, capacity);
+        if (!data) {
+            body->failed = 1;
+            return;
+        }
+        body->data = data;
+        body->capacity = capacity;
+    }
+}
+
+// xorshift64*: per-connection, no locking
+static double next_random(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return (double)((*state * 2685821657736338717ULL) >> 11) / 9007199254740992.0;
+}
+
+static double synthetic_price(const char *id, size_t len) {
+    return 0.01 + (double)(intern_hash(INTERN_HASH_SEED, id, len) % 10000000u) / 100.0;
+}
+
+static void load_fixtures(stub_server_t *server, const char *dir) {
+    DIR *d = opendir(dir);
+    if (!d) {
+        fprintf(stderr, "Warning: cannot open %s, serving synthetic responses only\n", dir);
+        return;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len <= 5 || len - 5 >= sizeof(((struct stub_fixture *)0)->name) ||
+            strcmp(entry->d_name + len - 5, ".json") != 0) {
+            continue;
+        }
+
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        FILE *fp = fopen(path, "rb");
+        if (!fp) {
+            continue;
+        }
+        struct stub_fixture *fixture = calloc(1, sizeof(*fixture));
+        long size = -1;
+        if (fixture && fseek(fp, 0, SEEK_END) == 0 && (size = ftell(fp)) >= 0 &&
+            fseek(fp, 0, SEEK_SET) == 0 && (fixture->body = malloc((size_t)size + 1)) != NULL &&
+            fread(fixture->body, 1, (size_t)size, fp) == (size_t)size) {
+            memcpy(fixture->name, entry->d_name, len - 5);
+            fixture->size = (size_t)size;
+            fixture->next = server->fixtures;
+            server->fixtures = fixture;
+        } else if (fixture) {
+            free(fixture->body);
+            free(fixture);
+        }
+        fclose(fp);
+    }
+    closedir(d);
+}
+
+static const struct stub_fixture *find_fixture(const stub_server_t *server, const char *name,
+                                               size_t len) {
+    for (const struct stub_fixture *f = server->fixtures; f; f = f->next) {
+        if (strlen(f->name) == len && memcmp(f->name, name, len) == 0) {
+            return f;
+        }
+    }
+    return NULL;
+}
+
+// Value of a query parameter (not NUL-terminated; *len set), or NULL
+static const char *query_param(const char *query, const char *name, size_t *len) {
+    size_t name_len = strlen(name);
+    const char *p = query;
+    while (p && *p) {
+        if (strncmp(p, name, name_len) == 0 && p[name_len] == '=') {
+            const char *value = p + name_len + 1;
+            *len = strcspn(value, "&");
+            return value;
+        }
+        p = strchr(p, '&');
+        if (p) {
+            p++;
+        }
+    }
+    return NULL;
+}
+
+// simple/price: {"id": {"cur": p, "cur_market_cap": ..., ...}, ...}
+static void synthesize_price(body_t *body, const char *query) {
+    size_t ids_len = 0, cur_len = 0;
+    const char *ids = query_param(query, "ids", &ids_len);
+    const char *currencies = query_param(query, "vs_currencies", &cur_len);
+    if (!currencies) {
+        currencies = "usd";
+        cur_len = 3;
+    }
+    long now = (long)time(NULL);
+
+    body_printf(body, "{");
+    for (size_t start = 0; ids && start < ids_len;) {
+        size_t id_len = strcspn(ids + start, ",&");
+        if (id_len > ids_len - start) {
+            id_len = ids_len - start;
+        }
+        const char *id = ids + start;
+        double price = synthetic_price(id, id_len);
+        body_printf(body, "%s\"%.*s\":{", start ? "," : "", (int)id_len, id);
+        for (size_t c = 0; c < cur_len;) {
+            size_t code_len = strcspn(currencies + c, ",&");
+            if (code_len > cur_len - c) {
+                code_len = cur_len - c;
+            }
+            int n = (int)code_len;
+            const char *code = currencies + c;
+            body_printf(body, "%s\"%.*s\":%.6f,\"%.*s_market_cap\":%.2f,\"%.*s_24h_vol\":%.2f,"
+                        "\"%.*s_24h_change\":%.4f", c ? "," : "", n, code, price, n, code,
+                        price * 19e6, n, code, price * 4e5, n, code, 1.25);
+            c += code_len + 1;
+        }
+        body_printf(body, ",\"last_updated_at\":%ld}", now);
+        start += id_len + 1;
+    }
+    body_printf(body, "}");
+}
+
+static void market_entry(body_t *body, const char *id, size_t id_len, const char *currency,
+                         int first) {
+    double price = synthetic_price(id, id_len);
+    time_t now = time(NULL);
+    struct tm tm;
+    char updated[32];
+    gmtime_r(&now, &tm);
+    strftime(updated, sizeof(updated), "%Y-%m-%dT%H:%M:%S.000Z", &tm);
+    (void)currency;
+
+    body_printf(body, "%s{\"id\":\"%.*s\",\"symbol\":\"%.*s\",\"name\":\"%.*s\","
+                "\"current_price\":%.6f,\"market_cap\":%.2f,\"total_volume\":%.2f,"
+                "\"high_24h\":%.6f,\"low_24h\":%.6f,\"price_change_24h\":%.6f,"
+                "\"price_change_percentage_24h\":%.4f,\"last_updated\":\"%s\"}",
+                first ? "" : ",", (int)id_len, id, id_len < 4 ? (int)id_len : 4, id,
+                (int)id_len, id, price, price * 19e6, price * 4e5, price * 1.03, price * 0.97,
+                price * 0.0125, 1.25, updated);
+}
+
+// coins/markets: an array of coin objects, for ids= or a synthetic listing
+static void synthesize_markets(body_t *body, const char *query) {
+    size_t ids_len = 0, cur_len = 0, per_page_len = 0;
+    const char *ids = query_param(query, "ids", &ids_len);
+    const char *currency = query_param(query, "vs_currency", &cur_len);
+    const char *per_page = query_param(query, "per_page", &per_page_len);
+    (void)cur_len;
+
+    body_printf(body, "[");
+    if (ids) {
+        for (size_t start = 0; start < ids_len;) {
+            size_t id_len = strcspn(ids + start, ",&");
+            if (id_len > ids_len - start) {
+                id_len = ids_len - start;
+            }
+            market_entry(body, ids + start, id_len, currency, start == 0);
+            start += id_len + 1;
+        }
+    } else {
+        int count = per_page ? atoi(per_page) : SYNTHETIC_MARKETS;
+        for (int i = 0; i < count && i < SYNTHETIC_MARKETS; i++) {
+            char id[32];
+            int len = snprintf(id, sizeof(id), "coin-%d", i + 1);
+            market_entry(body, id, (size_t)len, currency, i == 0);
+        }
+    }
+    body_printf(body, "]");
+}
+
+// coins/{id}/ohlc: [[ms, open, high, low, close], ...]
+static void synthesize_ohlc(body_t *body, const char *path, size_t path_len) {
+    // /coins/{id}/ohlc: the id is the segment before the last
+    size_t end = path_len - strlen("/ohlc");
+    size_t start = end;
+    while (start > 0 && path[start - 1] != '/') {
+        start--;
+    }
+    double price = synthetic_price(path + start, end - start);
+    long long now_ms = (long long)time(NULL) * 1000;
+
+    body_printf(body, "[");
+    for (int i = 0; i < OHLC_ROWS; i++) {
+        double drift = 1.0 + 0.002 * (double)((i * 7) % 11 - 5);
+        body_printf(body, "%s[%lld,%.6f,%.6f,%.6f,%.6f]", i ? "," : "",
+                    now_ms - (long long)(OHLC_ROWS - i) * 1800000, price, price * drift * 1.01,
+                    price * drift * 0.99, price * drift);
+    }
+    body_printf(body, "]");
+}
+
+static int send_all(int fd, const char *data, size_t size) {
+    while (size > 0) {
+        ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+static int send_response(int fd, int status, const char *reason, const char *extra_headers,
+                         const char *body, size_t size) {
+    char header[256];
+    int n = snprintf(header, sizeof(header),
+                     "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\n"
+                     "Content-Length: %zu\r\n%s\r\n", status, reason, size, extra_headers);
+    // One buffer so the answer leaves in as few segments as possible
+    char *response = malloc((size_t)n + size);
+    if (!response) {
+        return -1;
+    }
+    memcpy(response, header, (size_t)n);
+    if (size) {
+        memcpy(response + n, body, size);
+    }
+    int rc = send_all(fd, response, (size_t)n + size);
+    free(response);
+    return rc;
+}
+
+static void sleep_ms(double ms) {
+    if (ms <= 0.0) {
+        return;
+    }
+    struct timespec ts = { (time_t)(ms / 1000.0), (long)((ms - (double)(long)(ms / 1000.0) * 1000.0) * 1e6) };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+// Answer one request line ("GET /path?query HTTP/1.1")
+static int handle_request(stub_server_t *server, int fd, char *line, uint64_t *rng) {
+    atomic_fetch_add(&server->requests, 1);
+
+    char *target = strchr(line, ' ');
+    if (!target || strncmp(line, "GET ", 4) != 0) {
+        return send_response(fd, 405, "Method Not Allowed", "", "", 0);
+    }
+    target++;
+    char *target_end = strchr(target, ' ');
+    if (target_end) {
+        *target_end = '\0';
+    }
+
+    const stub_config_t *config = &server->config;
+    sleep_ms((double)config->latency_ms + next_random(rng) * (double)config->jitter_ms);
+
+    double roll = next_random(rng);
+    if (roll < config->throttle_rate) {
+        atomic_fetch_add(&server->throttled, 1);
+        const char *body = "{\"status\":{\"error_code\":429,\"error_message\":\"Rate limited\"}}";
+        return send_response(fd, 429, "Too Many Requests", "Retry-After: 1\r\n", body, strlen(body));
+    }
+    if (roll < config->throttle_rate + config->error_rate) {
+        atomic_fetch_add(&server->errors, 1);
+        return send_response(fd, 500, "Internal Server Error", "", "", 0);
+    }
+
+    char *query = strchr(target, '?');
+    size_t path_len = query ? (size_t)(query - target) : strlen(target);
+    while (path_len > 0 && target[path_len - 1] == '/') {
+        path_len--;
+    }
+    size_t segment = path_len;
+    while (segment > 0 && target[segment - 1] != '/') {
+        segment--;
+    }
+    const char *name = target + segment;
+    size_t name_len = path_len - segment;
+    query = query ? query + 1 : "";
+
+    const struct stub_fixture *fixture = find_fixture(server, name, name_len);
+    if (fixture) {
+        return send_response(fd, 200, "OK", "", fixture->body, fixture->size);
+    }
+
+    body_t body = {0};
+    if (name_len == 5 && memcmp(name, "price", 5) == 0) {
+        synthesize_price(&body, query);
+    } else if (name_len == 7 && memcmp(name, "markets", 7) == 0) {
+        synthesize_markets(&body, query);
+    } else if (name_len == 4 && memcmp(name, "ohlc", 4) == 0) {
+        synthesize_ohlc(&body, target, path_len);
+    } else {
+        atomic_fetch_add(&server->not_found, 1);
+        return send_response(fd, 404, "Not Found", "", "", 0);
+    }
+
+    int rc = body.failed ? send_response(fd, 500, "Internal Server Error", "", "", 0)
+                         : send_response(fd, 200, "OK", "", body.data, body.size);
+    free(body.data);
+    return rc;
+}
+
+static void *connection_main(void *arg) {
+    connection_t *conn = arg;
+    stub_server_t *server = conn->server;
+    int fd = conn->fd;
+    free(conn);
+
+    uint64_t rng = 0x9E3779B97F4A7C15ULL ^ ((uint64_t)fd << 32) ^ (uint64_t)time(NULL);
+    char buffer[REQUEST_MAX + 1];
+    size_t used = 0;
+
+    while (!atomic_load(&server->stopping)) {
+        char *end = NULL;
+        buffer[used] = '\0';
+        while (!(end = strstr(buffer, "\r\n\r\n"))) {
+            if (used == REQUEST_MAX) {
+                goto done;
+            }
+            struct pollfd pfd = { fd, POLLIN, 0 };
+            int ready = poll(&pfd, 1, POLL_INTERVAL_MS);
+            if (atomic_load(&server->stopping)) {
+                goto done;
+            }
+            if (ready <= 0) {
+                continue;
+            }
+            ssize_t n = recv(fd, buffer + used, REQUEST_MAX - used, 0);
+            if (n <= 0) {
+                goto done;
+            }
+            used += (size_t)n;
+            buffer[used] = '\0';
+        }
+
+        size_t request_len = (size_t)(end - buffer) + 4;
+        char *line_end = strstr(buffer, "\r\n");
+        *line_end = '\0';
+        int close_after = strstr(line_end + 2, "Connection: close") != NULL;
+
+        if (handle_request(server, fd, buffer, &rng) != 0 || close_after) {
+            break;
+        }
+
+        // Keep any pipelined request that arrived behind this one
+        memmove(buffer, buffer + request_len, used - request_len);
+        used -= request_len;
+    }
+
+done:
+    close(fd);
+    atomic_fetch_sub(&server->connections, 1);
+    return NULL;
+}
+
+static void *acceptor_main(void *arg) {
+    stub_server_t *server = arg;
+
+    while (!atomic_load(&server->stopping)) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        connection_t *conn = malloc(sizeof(*conn));
+        pthread_t thread;
+        atomic_fetch_add(&server->connections, 1);
+        if (!conn) {
+            close(fd);
+            atomic_fetch_sub(&server->connections, 1);
+            continue;
+        }
+        conn->server = server;
+        conn->fd = fd;
+        if (pthread_create(&thread, NULL, connection_main, conn) != 0) {
+            free(conn);
+            close(fd);
+            atomic_fetch_sub(&server->connections, 1);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+    return NULL;
+}
+
+int stub_server_start(const stub_config_t *config, stub_server_t *server) {
+    memset(server, 0, sizeof(*server));
+    server->config = *config;
+    atomic_init(&server->stopping, 0);
+    atomic_init(&server->requests, 0);
+    atomic_init(&server->errors, 0);
+    atomic_init(&server->throttled, 0);
+    atomic_init(&server->not_found, 0);
+    atomic_init(&server->connections, 0);
+
+    if (config->dir) {
+        load_fixtures(server, config->dir);
+    }
+
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server->listen_fd < 0) {
+        perror("socket");
+        stub_server_stop(server);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)config->port);
+    socklen_t addr_len = sizeof(addr);
+    if (bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(server->listen_fd, SOMAXCONN) != 0 ||
+        getsockname(server->listen_fd, (struct sockaddr *)&addr, &addr_len) != 0) {
+        fprintf(stderr, "Error: cannot listen on 127.0.0.1:%d: %s\n", config->port, strerror(errno));
+        stub_server_stop(server);
+        return -1;
+    }
+    server->port = ntohs(addr.sin_port);
+
+    if (pthread_create(&server->acceptor, NULL, acceptor_main, server) != 0) {
+        fprintf(stderr, "Error: cannot start the server thread\n");
+        stub_server_stop(server);
+        return -1;
+    }
+    return 0;
+}
+
+void stub_server_stop(stub_server_t *server) {
+    int was_running = server->port != 0 && !atomic_exchange(&server->stopping, 1);
+
+    if (server->listen_fd > 0) {
+        // Wakes the acceptor out of accept()
+        shutdown(server->listen_fd, SHUT_RDWR);
+        if (was_running) {
+            pthread_join(server->acceptor, NULL);
+        }
+        close(server->listen_fd);
+        server->listen_fd = -1;
+    }
+
+    // Connections notice within one poll interval
+    while (atomic_load(&server->connections) > 0) {
+        sleep_ms(POLL_INTERVAL_MS / 4);
+    }
+
+    while (server->fixtures) {
+        struct stub_fixture *next = server->fixtures->next;
+        free(server->fixtures->body);
+        free(server->fixtures);
+        server->fixtures = next;
+    }
+}
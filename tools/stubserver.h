@@ -0,0 +1,63 @@
+#ifndef STUBSERVER_H
+#define STUBSERVER_H
+
+/**
+ * @file stubserver.h
+ * @brief Local stand-in for the CoinGecko API (crypto-loadgen)
+ *
+ * An HTTP/1.1 server on 127.0.0.1 with keep-alive and one thread per
+ * connection. A request is answered by the last segment of its path, like
+ * CRYPTO_CLI_REPLAY_DIR: "price", "markets" and "ohlc" are synthesised
+ * from the ids and currency in the query string, unless a recorded
+ * <segment>.json in the fixture directory takes precedence. Every answer
+ * waits latency plus a uniform share of jitter, and a configurable share of
+ * requests fails with 500 or is throttled with 429.
+ */
+
+#include <stdatomic.h>
+#include <pthread.h>
+
+/**
+ * @brief Server settings
+ */
+typedef struct {
+    int port;               // 0 picks a free port
+    long latency_ms;        // Delay before every answer
+    long jitter_ms;         // Extra delay, uniform in [0, jitter_ms)
+    double error_rate;      // Share of requests answered with 500 (0..1)
+    double throttle_rate;   // Share of requests answered with 429 (0..1)
+    const char *dir;        // Recorded responses (NULL for synthetic only)
+} stub_config_t;
+
+/**
+ * @brief A running server
+ */
+typedef struct {
+    stub_config_t config;
+    int port;               // Port actually bound
+    int listen_fd;
+    pthread_t acceptor;
+    atomic_int stopping;
+    atomic_ulong requests;
+    atomic_ulong errors;     // 500s injected
+    atomic_ulong throttled;  // 429s injected
+    atomic_ulong not_found;
+    atomic_int connections;  // Connection threads still running
+    struct stub_fixture *fixtures;
+} stub_server_t;
+
+/**
+ * @brief Load fixtures, bind and start accepting
+ *
+ * @param config Settings (copied; dir must outlive the server)
+ * @param server Output server
+ * @return int 0 on success, -1 on error (message printed)
+ */
+int stub_server_start(const stub_config_t *config, stub_server_t *server);
+
+/**
+ * @brief Stop accepting, close open connections and release the fixtures
+ */
+void stub_server_stop(stub_server_t *server);
+
+#endif /* STUBSERVER_H */